@@ -0,0 +1,479 @@
+// ----------------------------------------------------------------------------
+// Microbenchmarks of the wrapper's hot paths, run against the Steam simulator.
+//
+//     steam_wrapper_bench [filter]
+//
+// Every benchmark reports the wall time, heap allocations and allocated bytes
+// per operation. Allocations are counted by replacing the global operator new,
+// so they include whatever the simulator allocates on the way.
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/bulkPublisher.h"
+#include "../include/easySteam.h"
+#include "../include/logger.h"
+#include "../include/steamHelper.h"
+#include "../include/steamSimulator.h"
+#include "../include/workshopCrawler.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Allocation accounting.
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocated_bytes{0};
+
+void* counted_allocation(const std::size_t size) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* counted_aligned_allocation(const std::size_t size, const std::align_val_t alignment) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    const auto align = static_cast<std::size_t>(alignment);
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+
+#if defined(_WIN32)
+    return _aligned_malloc(rounded, align);
+#else
+    return std::aligned_alloc(align, rounded);
+#endif
+}
+
+void aligned_free(void* p) noexcept {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(const std::size_t size) {
+    if (void* p = counted_allocation(size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](const std::size_t size) {
+    if (void* p = counted_allocation(size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    if (void* p = counted_aligned_allocation(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment) {
+    if (void* p = counted_aligned_allocation(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept { return counted_allocation(size); }
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept { return counted_allocation(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { aligned_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { aligned_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { aligned_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// Harness.
+using clock_type = std::chrono::steady_clock;
+
+constexpr AppId_t bench_app_id = 480;
+constexpr std::chrono::milliseconds min_run_time{200};
+constexpr int min_runs = 3;
+constexpr uint32_t default_catalog_size = 10000;
+
+struct bench_result {
+    std::string name;
+    uint64_t ops = 0;
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+    double bytes_per_op = 0.0;
+};
+
+class bench_runner {
+
+private:
+    std::ostream& _out;
+    std::string_view _filter;
+
+public:
+    bench_runner(std::ostream& out, const std::string_view filter) noexcept : _out{out}, _filter{filter} {}
+
+    [[nodiscard]] bool enabled(const std::string_view name) const noexcept {
+        return _filter.empty() || name.find(_filter) != std::string_view::npos;
+    }
+
+    void header() const {
+        _out << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "ops" << std::setw(14) << "ns/op"
+             << std::setw(14) << "allocs/op" << std::setw(14) << "bytes/op" << '\n';
+    }
+
+    void report(const bench_result& result) const {
+        _out << std::left << std::setw(40) << result.name << std::right << std::setw(12) << result.ops << std::fixed
+             << std::setprecision(1) << std::setw(14) << result.ns_per_op << std::setprecision(2) << std::setw(14)
+             << result.allocs_per_op << std::setprecision(1) << std::setw(14) << result.bytes_per_op << '\n';
+    }
+
+    void note(const std::string_view line) const { _out << line << '\n'; }
+
+    /// @brief Repeats `run`, which performs `ops_per_run` operations, for at least min_run_time.
+    template <typename F>
+    void measure(const std::string_view name, const uint64_t ops_per_run, F&& run) const {
+        if (!enabled(name) || ops_per_run == 0) {
+            return;
+        }
+
+        run(); // Warm up.
+
+        uint64_t runs = 0;
+        const uint64_t allocations_before = allocation_count.load();
+        const uint64_t bytes_before = allocated_bytes.load();
+        const auto start = clock_type::now();
+        auto elapsed = clock_type::duration::zero();
+
+        while (runs < min_runs || elapsed < min_run_time) {
+            run();
+            ++runs;
+            elapsed = clock_type::now() - start;
+        }
+
+        const double ops = static_cast<double>(runs * ops_per_run);
+
+        bench_result result;
+        result.name = name;
+        result.ops = runs * ops_per_run;
+        result.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / ops;
+        result.allocs_per_op = static_cast<double>(allocation_count.load() - allocations_before) / ops;
+        result.bytes_per_op = static_cast<double>(allocated_bytes.load() - bytes_before) / ops;
+        report(result);
+    }
+};
+
+// Keeps the compiler from dropping a result nothing reads.
+const void* volatile escaped = nullptr;
+
+template <typename T>
+void do_not_optimize(const T& value) noexcept {
+    escaped = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+void configure_simulator(const uint32_t catalog_size, const std::chrono::microseconds query_latency = std::chrono::microseconds{0}) {
+    steam_simulator::config config;
+    config.catalog_size = catalog_size;
+    config.app_id = bench_app_id;
+    config.profiles.query.delay.mean = query_latency;
+    steam_simulator::configure(config);
+}
+
+UGCQueryHandle_t first_page_query(steam_helper& helper) {
+    UGCQueryHandle_t handle = k_UGCQueryHandleInvalid;
+    helper.create_all_query(handle, k_EUGCQuery_RankedByVote, k_EUGCMatchingUGCType_Items, bench_app_id, bench_app_id, 1);
+    return handle;
+}
+
+// ----------------------------------------------------------------------------
+// Query results: extraction per item, in the completion of a live query.
+void bench_query_extraction(const bench_runner& bench, steam_helper& helper) {
+    if (!bench.enabled("query/")) {
+        return;
+    }
+
+    bool done = false;
+    helper.send_query_request(first_page_query(helper), [&](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+        const uint64_t items = completed.m_unNumResultsReturned;
+
+        bench.measure("query/read_query_page (per item)", items, [&] {
+            query_page page;
+            helper.read_query_page(rc, completed, page);
+            do_not_optimize(page);
+        });
+
+        bench.measure("query/result_set_read (per item)", items, [&] {
+            const auto set = query_result_set::read(rc, completed);
+            do_not_optimize(set);
+        });
+
+        bench.measure("query/result_set_read_all (per item)", items, [&] {
+            const auto set = query_result_set::read(rc, completed, projection_metadata | projection_key_value_tags |
+                                                                       projection_children | projection_additional_previews);
+            do_not_optimize(set);
+        });
+
+        if (const auto set = query_result_set::read(rc, completed); set->size() != 0) {
+            bench.note("    query_result_set footprint: " + std::to_string(set->bytes_reserved() / set->size()) + " bytes/item");
+        }
+
+        done = true;
+    });
+
+    static_cast<void>(helper.run_callbacks_until([&done] { return done; }, std::chrono::seconds(10)));
+
+    // Legacy path: results kept by the helper, copied out on every call.
+    std::vector<SteamUGCDetails_t> details;
+    std::vector<char*> preview_urls;
+    done = false;
+    helper.send_query_request(first_page_query(helper), [&done](UGCQueryHandle_t) { done = true; });
+    static_cast<void>(helper.run_callbacks_until([&done] { return done; }, std::chrono::seconds(10)));
+
+    const auto results = helper.last_query_results();
+    bench.measure("query/get_query_results (per item)", results ? results->size() : 0, [&] {
+        details.clear();
+        preview_urls.clear();
+        helper.get_query_results(details, preview_urls);
+        do_not_optimize(details);
+    });
+}
+
+// ----------------------------------------------------------------------------
+// Utilities called on every completion.
+void bench_utilities(const bench_runner& bench) {
+    constexpr int result_values = k_EResultCommunityCooldown + 1;
+
+    bench.measure("util/result_to_string", result_values, [] {
+        for (int i = 0; i < result_values; ++i) {
+            do_not_optimize(steam_helper::result_to_string(static_cast<EResult>(i)));
+        }
+    });
+
+    // What every completed Steam call pays for its metrics.
+    steam_metrics metrics;
+
+    bench.measure("util/metrics record", result_values, [&metrics] {
+        for (int i = 0; i < result_values; ++i) {
+            metrics.operation_completed(operation_kind::query, static_cast<EResult>(i), std::chrono::microseconds{i * 1000});
+        }
+    });
+
+    // What every issued call pays to the scheduler, tokens never running out.
+    call_scheduler::config generous;
+    generous.buckets.fill({1e9, 1e9, 1e9, 1e9});
+    call_scheduler scheduler{generous};
+
+    bench.measure("util/scheduler acquire", result_values, [&scheduler] {
+        for (int i = 0; i < result_values; ++i) {
+            do_not_optimize(scheduler.try_acquire(operation_kind::query, call_priority::interactive));
+            scheduler.on_result(operation_kind::query, EResult::k_EResultOK);
+        }
+    });
+
+    constexpr int lines = 1000;
+
+    // Queued for the writer thread, the sink discards it.
+    bench.measure("util/log", lines, [] {
+        for (int i = 0; i < lines; ++i) {
+            log_warning("Steam") << "Query completed. Found " << i << " items\n";
+        }
+
+        logger::instance().flush();
+    });
+
+    // Below the runtime level, never formatted.
+    bench.measure("util/log (filtered)", lines, [] {
+        for (int i = 0; i < lines; ++i) {
+            log_info("Steam") << "Query completed. Found " << i << " items\n";
+        }
+    });
+}
+
+// ----------------------------------------------------------------------------
+// Operation table: issue, dispatch and retire, per operation.
+void bench_dispatch(const bench_runner& bench, steam_helper& helper) {
+    constexpr int batch = 256;
+
+    bench.measure("dispatch/create_item completion", batch, [&helper] {
+        int completed = 0;
+
+        for (int i = 0; i < batch; ++i) {
+            helper.create_workshop_item([&completed](EResult, PublishedFileId_t) { ++completed; });
+        }
+
+        static_cast<void>(helper.run_callbacks_until([&completed] { return completed == batch; }, std::chrono::seconds(10)));
+    });
+
+    // Items created above would otherwise slow every query down.
+    configure_simulator(default_catalog_size);
+
+    bench.measure("dispatch/query completion", batch, [&helper] {
+        int completed = 0;
+
+        for (int i = 0; i < batch; ++i) {
+            helper.send_query_request(first_page_query(helper),
+                                      [&completed](EResult, const SteamUGCQueryCompleted_t&) { ++completed; });
+        }
+
+        static_cast<void>(helper.run_callbacks_until([&completed] { return completed == batch; }, std::chrono::seconds(10)));
+    });
+}
+
+// ----------------------------------------------------------------------------
+// Wakeup latency: from a call result being due to its completion running.
+void bench_wakeup(const bench_runner& bench, steam_helper& helper) {
+    bench.measure("wakeup/poll_steam_callbacks", 1, [&helper] {
+        helper.create_workshop_item([](EResult, PublishedFileId_t) {});
+        static_cast<void>(poll_steam_callbacks(helper));
+    });
+
+    if (!bench.enabled("wakeup/callback_pump")) {
+        return;
+    }
+
+    helper.start_callback_pump();
+
+    bench.measure("wakeup/callback_pump", 1, [&helper] {
+        std::atomic<bool> completed{false};
+        helper.create_workshop_item([&completed](EResult, PublishedFileId_t) { completed.store(true); });
+
+        while (!completed.load()) {
+            std::this_thread::yield();
+        }
+    });
+
+    helper.stop_callback_pump();
+}
+
+// ----------------------------------------------------------------------------
+// Crawler scaling with the catalog size and the query concurrency.
+void bench_crawler(const bench_runner& bench, steam_helper& helper) {
+    if (!bench.enabled("crawler/")) {
+        return;
+    }
+
+    for (const uint32_t catalog_size : {2000u, 20000u}) {
+        for (const uint32_t in_flight : {1u, 8u}) {
+            configure_simulator(catalog_size, std::chrono::microseconds{500});
+
+            workshop_crawler::options options;
+            options.creator_app_id = bench_app_id;
+            options.consumer_app_id = bench_app_id;
+            options.matching_type = k_EUGCMatchingUGCType_All;
+            options.max_in_flight = in_flight;
+
+            const std::string name = "crawler/" + std::to_string(catalog_size) + " items, " + std::to_string(in_flight) + " in flight (per item)";
+
+            bench.measure(name, catalog_size, [&helper, &options] {
+                workshop_crawler crawler{helper, options};
+                const auto result = crawler.run();
+                do_not_optimize(result);
+            });
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Bulk publish: serial against pipelined, with Steam-like round trips.
+void bench_publish(const bench_runner& bench, steam_helper& helper) {
+    if (!bench.enabled("publish/")) {
+        return;
+    }
+
+    constexpr uint32_t items = 32;
+
+    std::vector<publish_entry> entries(items);
+
+    for (uint32_t i = 0; i < items; ++i) {
+        entries[i].app_id = bench_app_id;
+        entries[i].title = "Bench item " + std::to_string(i);
+        entries[i].changelog = "Bench release";
+    }
+
+    for (const uint32_t in_flight : {1u, 8u}) {
+        steam_simulator::config config;
+        config.catalog_size = default_catalog_size;
+        config.app_id = bench_app_id;
+        config.profiles.create_item.delay.mean = std::chrono::milliseconds{2};
+        config.profiles.submit_item.delay.mean = std::chrono::milliseconds{5};
+        steam_simulator::configure(config);
+
+        bulk_publisher::options options;
+        options.max_creates_in_flight = in_flight;
+        options.max_submits_in_flight = in_flight;
+
+        const std::string name = "publish/" + std::to_string(items) + " new items, " + std::to_string(in_flight) + " in flight (per item)";
+
+        bench.measure(name, items, [&helper, &options, &entries] {
+            const auto result = bulk_publisher{helper, options}.run(entries);
+            do_not_optimize(result);
+        });
+    }
+
+    configure_simulator(default_catalog_size);
+}
+
+} // namespace
+
+int main(const int argc, const char* argv[]) {
+    const std::string_view filter = argc > 1 ? argv[1] : "";
+
+    std::ostream& out = std::cout;
+
+    // Only the report goes to the console.
+    logger::instance().set_sink(nullptr);
+    logger::instance().set_level(log_level::warning);
+
+    configure_simulator(default_catalog_size);
+
+    steam_helper helper;
+    helper.app_id = bench_app_id;
+
+    // The wrapper's own costs are measured, not the rate limits.
+    helper.scheduler().configure(call_scheduler::config::unlimited());
+
+    if (!helper.initialized()) {
+        out << "Could not initialize the Steam simulator\n";
+        return EXIT_FAILURE;
+    }
+
+    const bench_runner bench{out, filter};
+    bench.header();
+
+    bench_query_extraction(bench, helper);
+    bench_utilities(bench);
+    bench_dispatch(bench, helper);
+    bench_wakeup(bench, helper);
+    bench_crawler(bench, helper);
+    bench_publish(bench, helper);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Bump allocator, everything it hands out is freed at once with the arena.
+class arena {
+
+public:
+    static constexpr std::size_t default_block_size = 16 * 1024;
+
+private:
+    std::vector<std::unique_ptr<std::byte[]>> _blocks;
+    std::byte* _cursor = nullptr;
+    std::size_t _remaining = 0;
+    std::size_t _block_size;
+    std::size_t _bytes_reserved = 0;
+    std::size_t _bytes_used = 0;
+
+    void* allocate_slow(std::size_t size, std::size_t alignment);
+
+public:
+    explicit arena(const std::size_t block_size = default_block_size) noexcept : _block_size{block_size} {}
+
+    arena(arena&&) noexcept = default;
+    arena& operator=(arena&&) noexcept = default;
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    /// @brief Copies the string, NUL terminated, the view excludes the terminator.
+    [[nodiscard]] std::string_view store(std::string_view value);
+
+    [[nodiscard]] std::size_t bytes_reserved() const noexcept { return _bytes_reserved; }
+
+    [[nodiscard]] std::size_t bytes_used() const noexcept { return _bytes_used; }
+};
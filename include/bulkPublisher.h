@@ -0,0 +1,153 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/contentFingerprint.h"
+#include "../include/contentValidation.h"
+#include "../include/previewPipeline.h"
+#include "../include/publishManifest.h"
+#include "../include/steamHelper.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Pipelined publish of many workshop items.
+//
+// Each item goes through create (new items only), update and submit. The
+// stages overlap across items: while some items upload, the next ones are
+// created, so they are ready to submit as soon as an upload slot frees up.
+// The total time then follows the slowest uploads rather than the sum of
+// every round trip. Calls run at background priority.
+//
+// With a preview cache directory, oversized previews are first shrunk and
+// re-encoded over the pool. Every item's content folder and preview are then
+// validated up front, in
+// parallel, so a bad path or oversized file fails its item before the batch
+// spends any upload time.
+//
+// With a fingerprint directory, the update stage first hashes the item's
+// content and preview and only sends the fields that changed since its last
+// successful submit, skipping the submit when none did.
+class bulk_publisher {
+
+public:
+    enum class stage : uint8_t { create, update, submit, done };
+
+    struct item_outcome {
+        std::size_t index = 0; // In the entries given to run().
+        PublishedFileId_t item_id = 0;
+        bool created = false;
+
+        // Nothing changed since the last successful submit, Steam was not called.
+        bool skipped = false;
+
+        // The content folder went out, not just the metadata or the preview.
+        bool content_sent = false;
+
+        // Of the content folder and preview, checked before the batch started.
+        content_report validation;
+
+        // k_EResultOK once submitted; k_EResultCancelled if never started.
+        EResult result = EResult::k_EResultCancelled;
+
+        // The stage the item stopped at, done when it got through.
+        stage reached = stage::create;
+
+        // From its first call to its outcome.
+        std::chrono::microseconds elapsed{0};
+    };
+
+    struct options {
+        uint32_t max_creates_in_flight = 4;
+        uint32_t max_submits_in_flight = 4;
+
+        // Leaves the items not started yet after a failure, otherwise each item is on its own.
+        bool stop_on_failure = false;
+
+        // Longest wait without any item making progress.
+        std::chrono::microseconds timeout{std::chrono::minutes(30)};
+
+        // Where the fingerprint of each item's last successful submit is kept,
+        // to skip what did not change; empty submits everything.
+        std::filesystem::path fingerprint_directory;
+
+        // Where previews too large to upload as they are get shrunk and re-encoded
+        // to, once per distinct image; empty uploads every preview as given.
+        std::filesystem::path preview_cache_directory;
+        preview_options preview;
+
+        // What the content and previews are checked against before the first call.
+        validation_limits validation;
+
+        // Called on run()'s thread as each item finishes, success or not.
+        std::function<void(const item_outcome&)> on_item;
+    };
+
+    struct result {
+        // First failure, k_EResultOK if every item was published.
+        EResult result = EResult::k_EResultOK;
+        std::vector<item_outcome> items; // In the order of the entries.
+        uint32_t published = 0;
+        uint32_t failed = 0;
+        std::chrono::microseconds elapsed{0};
+    };
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    // Shared with the in-flight completions, which may outlive the publisher.
+    struct publish_state {
+        std::mutex mutex;
+        std::deque<std::size_t> to_create;
+        std::deque<std::size_t> to_submit;
+        uint32_t creates_in_flight = 0;
+        uint32_t submits_in_flight = 0;
+        uint64_t completions = 0;
+        std::vector<clock::time_point> started;
+        std::vector<bool> settled;
+        std::deque<std::size_t> finished; // Not reported to on_item yet.
+        std::vector<std::optional<content_fingerprint>> fingerprints; // Saved once submitted.
+        result output;
+
+        void finish(std::size_t index, stage reached, EResult rc) noexcept;
+    };
+
+    // ------------------------------------------------------------------------
+    // Data members.
+    steam_helper& _helper;
+    options _options;
+    std::optional<fingerprint_store> _fingerprints;
+    content_fingerprinter _fingerprinter;
+
+    // ------------------------------------------------------------------------
+    // Pipeline stages, issued from run()'s thread.
+    // The entries with their previews replaced by the processed ones, or `requested` itself.
+    [[nodiscard]] const std::vector<publish_entry>& prepare_previews(const std::vector<publish_entry>& requested,
+                                                                     std::vector<publish_entry>& prepared) const;
+
+    bool issue_create(const std::shared_ptr<publish_state>& state, const publish_entry& entry, std::size_t index) noexcept;
+
+    bool issue_submit(const std::shared_ptr<publish_state>& state, const publish_entry& entry, std::size_t index) noexcept;
+
+    void report_finished(publish_state& state, const std::vector<publish_entry>& entries) noexcept;
+
+public:
+    bulk_publisher(steam_helper& helper, options publish_options) noexcept;
+
+    /// @brief Publishes every entry, returning once each one has its outcome.
+    [[nodiscard]] result run(const std::vector<publish_entry>& requested) noexcept;
+
+    [[nodiscard]] static std::string_view stage_name(stage reached) noexcept;
+};
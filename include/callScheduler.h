@@ -0,0 +1,140 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+#include "../include/steamMetrics.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Priority of the calls a thread issues. Interactive calls go first, bulk
+// work such as crawls and batch uploads should run as background.
+enum class call_priority : uint8_t { interactive, background };
+
+inline constexpr std::size_t call_priority_count = 2;
+
+// Calls issued by the current thread while the scope lives get its priority.
+//
+//     const call_priority_scope background{call_priority::background};
+//     helper.send_query_request(handle, completion);
+class call_priority_scope {
+
+private:
+    call_priority _previous;
+
+public:
+    explicit call_priority_scope(call_priority priority) noexcept;
+
+    ~call_priority_scope() noexcept;
+
+    call_priority_scope(const call_priority_scope&) = delete;
+    call_priority_scope& operator=(const call_priority_scope&) = delete;
+};
+
+[[nodiscard]] call_priority current_call_priority() noexcept;
+
+// ----------------------------------------------------------------------------
+// Client-side rate limiting of the outgoing UGC calls.
+//
+// Each operation kind draws from its own token bucket. Calls finding it empty
+// wait in a queue per priority, released as tokens come back. The refill rate
+// adapts AIMD style: every success adds `additive_increase / rate`, so about
+// `additive_increase` calls/s per second of clean traffic, and a rate limit
+// answer multiplies it by `multiplicative_decrease`, at most once per
+// `decrease_cooldown` so one burst of rejections counts once.
+class call_scheduler {
+
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct bucket_config {
+        double rate = 10.0;     // Calls per second to start with.
+        double burst = 20.0;    // Calls that may go at once after a quiet period.
+        double min_rate = 0.5;
+        double max_rate = 100.0;
+    };
+
+    struct config {
+        // False lets every call through at once, as if there was no scheduler.
+        bool enabled = true;
+
+        // Indexed by operation_kind.
+        std::array<bucket_config, operation_kind_count> buckets{{
+            {5.0, 10.0, 0.5, 50.0},     // create_item
+            {5.0, 10.0, 0.5, 50.0},     // submit_item
+            {20.0, 40.0, 1.0, 200.0},   // query
+        }};
+
+        double additive_increase = 1.0;
+        double multiplicative_decrease = 0.5;
+        std::chrono::milliseconds decrease_cooldown{1000};
+
+        [[nodiscard]] static config unlimited() noexcept {
+            config unlimited;
+            unlimited.enabled = false;
+            return unlimited;
+        }
+    };
+
+private:
+    struct bucket {
+        double rate = 0.0;
+        double tokens = 0.0;
+        clock::time_point refilled;
+        clock::time_point decreased;
+        std::array<std::deque<SteamAPICall_t>, call_priority_count> waiting;
+    };
+
+    mutable std::mutex _mutex;
+    config _config;
+    std::array<bucket, operation_kind_count> _buckets;
+
+    void refill(bucket& target, const bucket_config& limits, clock::time_point now) noexcept;
+
+    [[nodiscard]] bucket& bucket_of(const operation_kind kind) noexcept { return _buckets[static_cast<std::size_t>(kind)]; }
+
+    [[nodiscard]] const bucket_config& limits_of(const operation_kind kind) const noexcept {
+        return _config.buckets[static_cast<std::size_t>(kind)];
+    }
+
+public:
+    call_scheduler() noexcept;
+
+    explicit call_scheduler(const config& initial) noexcept;
+
+    /// @brief Replaces the limits and restarts every bucket full, the queued calls stay queued.
+    void configure(const config& updated) noexcept;
+
+    [[nodiscard]] config configuration() const noexcept;
+
+    /// @brief Takes a token for a call to issue right away.
+    /// @return false when the call has to wait: no token left, or calls of
+    /// the same or a higher priority are already waiting.
+    [[nodiscard]] bool try_acquire(operation_kind kind, call_priority priority, clock::time_point now = clock::now()) noexcept;
+
+    /// @brief Queues a call that could not be issued, identified by its operation key.
+    void enqueue(operation_kind kind, call_priority priority, SteamAPICall_t key);
+
+    /// @brief Appends the calls that got a token, highest priority first.
+    void take_ready(std::vector<SteamAPICall_t>& ready, clock::time_point now = clock::now());
+
+    /// @brief Feeds the AIMD control with the result of an issued call.
+    void on_result(operation_kind kind, EResult rc, clock::time_point now = clock::now()) noexcept;
+
+    /// @brief Forgets every waiting call.
+    void clear() noexcept;
+
+    [[nodiscard]] double rate(operation_kind kind) const noexcept;
+
+    [[nodiscard]] std::size_t waiting(operation_kind kind) const noexcept;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+#include "../include/threadPool.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// XXH64, fast non-cryptographic 64 bit hash; only compares local builds.
+class xxhash64 {
+
+private:
+    uint64_t _lanes[4];
+    unsigned char _buffer[32];
+    std::size_t _buffered = 0;
+    uint64_t _length = 0;
+    uint64_t _seed;
+
+public:
+    explicit xxhash64(uint64_t seed = 0) noexcept;
+
+    void update(const void* data, std::size_t size) noexcept;
+
+    void update(const std::string_view text) noexcept { update(text.data(), text.size()); }
+
+    [[nodiscard]] uint64_t digest() const noexcept;
+
+    [[nodiscard]] static uint64_t hash(const void* data, std::size_t size, uint64_t seed = 0) noexcept;
+};
+
+// ----------------------------------------------------------------------------
+// What an item was last submitted with, to tell whether a new submit changes anything.
+struct file_fingerprint {
+    std::string path; // Relative to the content folder, '/' separated.
+    uint64_t size = 0;
+    int64_t modified = 0; // Last write time in the filesystem clock's ticks.
+    uint64_t hash = 0;
+};
+
+struct content_fingerprint {
+    // 0 when the field was not set on the update.
+    uint64_t content = 0;
+    uint64_t preview = 0;
+    uint64_t metadata = 0; // Title and description.
+
+    std::vector<file_fingerprint> files; // Of the content folder, sorted by path.
+    std::optional<file_fingerprint> preview_file;
+
+    // Fields worth sending compared to a previous submit, none means the submit can be skipped.
+    struct changes {
+        bool content = true;
+        bool preview = true;
+        bool metadata = true;
+
+        [[nodiscard]] bool any() const noexcept { return content || preview || metadata; }
+    };
+
+    [[nodiscard]] changes changed_since(const content_fingerprint& previous) const noexcept;
+
+    // Fields this update leaves out are still what the previous submit sent.
+    void inherit_unset(const content_fingerprint& previous);
+};
+
+// ----------------------------------------------------------------------------
+// Hashes content folders and preview files, large files in blocks spread
+// over the pool. A file whose size and write time match the previous
+// fingerprint keeps its hash without being read.
+class content_fingerprinter {
+
+public:
+    // Files are hashed in blocks this large, the file hash combines the block hashes.
+    static constexpr uint64_t block_size = 4 << 20;
+
+    struct stats {
+        uint64_t files = 0;
+        uint64_t files_read = 0;
+        uint64_t bytes_read = 0;
+    };
+
+private:
+    thread_pool& _pool;
+
+    [[nodiscard]] bool hash_files(const std::filesystem::path& root, std::vector<file_fingerprint>& files,
+                                  const std::vector<file_fingerprint>* previous, stats& totals) const;
+
+public:
+    explicit content_fingerprinter(thread_pool& pool = thread_pool::shared()) noexcept;
+
+    /// @brief Fingerprints the fields given, reusing the unchanged file hashes of `previous`.
+    /// @return nullopt if a file could not be read, the reason logged.
+    [[nodiscard]] std::optional<content_fingerprint> fingerprint(const std::optional<std::filesystem::path>& content,
+                                                                 const std::optional<std::filesystem::path>& preview,
+                                                                 const std::optional<std::string>& title,
+                                                                 const std::optional<std::string>& description,
+                                                                 const content_fingerprint* previous = nullptr,
+                                                                 stats* totals = nullptr) const;
+};
+
+// ----------------------------------------------------------------------------
+// Fingerprints of the last successful submit of each item, one small text
+// file per item in a local directory, meant to be kept between CI runs.
+class fingerprint_store {
+
+private:
+    std::filesystem::path _directory;
+
+    [[nodiscard]] std::filesystem::path path_of(AppId_t app_id, PublishedFileId_t item_id) const;
+
+public:
+    explicit fingerprint_store(std::filesystem::path directory) noexcept;
+
+    [[nodiscard]] const std::filesystem::path& directory() const noexcept { return _directory; }
+
+    [[nodiscard]] std::optional<content_fingerprint> load(AppId_t app_id, PublishedFileId_t item_id) const;
+
+    /// @brief Replaces the item's fingerprint, written aside then renamed over the old one.
+    [[nodiscard]] bool save(AppId_t app_id, PublishedFileId_t item_id, const content_fingerprint& fingerprint) const;
+
+    void forget(AppId_t app_id, PublishedFileId_t item_id) const noexcept;
+};
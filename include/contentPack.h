@@ -0,0 +1,99 @@
+#pragma once
+
+#include "../include/contentStaging.h"
+#include "../include/mappedFile.h"
+#include "../include/threadPool.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Single file packing a whole content folder, to upload and install one large
+// sequential file instead of tens of thousands of small ones.
+//
+// Layout: a 16 byte header, the files' data in path order, an index sorted by
+// path, and a 32 byte footer locating the index. Each file is either stored
+// as is, which the reader serves straight from the mapping, or split in
+// blocks compressed independently with a fast LZ77 codec.
+struct pack_options {
+    uint32_t block_size = 1 << 20;
+
+    bool compress = true;
+
+    // Files compressing worse than this keep their bytes as they are, and are
+    // then served without a copy.
+    double min_saving = 1.0 / 16;
+};
+
+class content_pack_writer {
+
+public:
+    struct stats {
+        uint64_t files = 0;
+        uint64_t bytes = 0;        // Of the files.
+        uint64_t packed_bytes = 0; // Of the pack.
+        uint64_t compressed_files = 0;
+    };
+
+private:
+    pack_options _options;
+    thread_pool& _pool;
+
+public:
+    explicit content_pack_writer(pack_options options = {}, thread_pool& pool = thread_pool::shared()) noexcept;
+
+    /// @brief Packs the selected files of `source` into `pack`, streaming them
+    /// through in batches rather than holding the tree in memory.
+    /// @return nullopt if a file could not be read or the pack written, the reason logged.
+    [[nodiscard]] std::optional<stats> write(const std::filesystem::path& source, const std::filesystem::path& pack,
+                                             const staging_rules& rules = {}) const;
+};
+
+// ----------------------------------------------------------------------------
+// Memory mapped pack, files looked up by their '/' separated path.
+class content_pack {
+
+public:
+    static constexpr std::string_view file_name = "content.swpk";
+
+    enum class method : uint8_t { stored = 0, blocks = 1 };
+
+    struct entry {
+        std::string_view path; // Points into the mapping.
+        method storage = method::stored;
+        uint64_t offset = 0;
+        uint64_t stored_size = 0;
+        uint64_t size = 0;
+        uint64_t hash = 0; // XXH64 of the file's bytes.
+    };
+
+    struct view {
+        const std::byte* data = nullptr;
+        std::size_t size = 0;
+    };
+
+private:
+    mapped_file _mapping;
+    uint32_t _block_size = 0;
+    std::vector<entry> _entries; // Sorted by path.
+
+public:
+    /// @return nullopt if the file is not a pack or is damaged, the reason logged.
+    [[nodiscard]] static std::optional<content_pack> open(const std::filesystem::path& pack_path);
+
+    [[nodiscard]] const std::vector<entry>& entries() const noexcept { return _entries; }
+
+    [[nodiscard]] const entry* find(std::string_view path) const noexcept;
+
+    /// @brief The file's bytes right in the mapping, nullopt if missing or compressed.
+    [[nodiscard]] std::optional<view> view_of(std::string_view path) const noexcept;
+
+    /// @brief The file's bytes, decompressed if needed, optionally checked against its hash.
+    [[nodiscard]] bool read(std::string_view path, std::vector<std::byte>& out, bool verify = false) const;
+};
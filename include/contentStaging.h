@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../include/threadPool.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Which files of a build output go into the upload folder.
+//
+// Patterns are matched against the path relative to the source folder, '/'
+// separated: '*' and '?' stay within a path component, '**' spans any number
+// of them. A pattern without '/' is matched against the file name alone.
+struct staging_rules {
+    std::vector<std::string> include; // Empty for every file.
+    std::vector<std::string> exclude; // Wins over include.
+
+    [[nodiscard]] bool selects(std::string_view relative_path) const noexcept;
+
+    [[nodiscard]] static bool matches(std::string_view pattern, std::string_view relative_path) noexcept;
+};
+
+struct staging_options {
+    bool hardlinks = true;
+    bool reflinks = true; // Copy-on-write clones, where the filesystem has them.
+};
+
+// ----------------------------------------------------------------------------
+// Builds upload folders out of links to the source files instead of copies.
+//
+// Each file is hardlinked, reflinked (copy-on-write clone) when hardlinks are
+// off or not possible, and only copied as the last resort, with
+// copy_file_range where available so the bytes stay in the kernel. The
+// destination belongs to the stager: staging again over an existing tree
+// keeps the files still matching and removes everything else.
+//
+// A hardlink shares the source's bytes: a build rewriting files in place
+// during the upload changes what is sent, turn hardlinks off for those.
+class content_stager {
+
+public:
+    struct stats {
+        uint64_t files = 0;
+        uint64_t reused = 0; // Already staged, same file or same size and write time.
+        uint64_t hardlinked = 0;
+        uint64_t reflinked = 0;
+        uint64_t copied = 0;
+        uint64_t bytes_copied = 0;
+        uint64_t removed = 0; // Files and folders left over from a previous staging.
+    };
+
+private:
+    staging_options _options;
+    thread_pool& _pool;
+
+public:
+    explicit content_stager(staging_options stager_options = {}, thread_pool& pool = thread_pool::shared()) noexcept;
+
+    /// @brief Mirrors the selected files of `source` into `destination`, created if needed.
+    /// @return nullopt if a file could not be staged or the folders overlap, the reason logged.
+    [[nodiscard]] std::optional<stats> stage(const std::filesystem::path& source, const std::filesystem::path& destination,
+                                             const staging_rules& rules = {}) const;
+
+    /// @brief Removes a staged folder, the source files are left alone.
+    static bool remove(const std::filesystem::path& destination) noexcept;
+};
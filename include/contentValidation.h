@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../include/threadPool.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// What an upload may contain, checked locally before any Steam call.
+struct validation_limits {
+    uint64_t max_preview_bytes = 1 << 20; // Steam refuses larger preview images.
+    uint64_t max_file_bytes = 0;          // 0 for no limit.
+    uint64_t max_content_bytes = 0;       // Whole content folder, 0 for no limit.
+
+    // Files that must not be uploaded, patterns as in staging_rules.
+    std::vector<std::string> forbidden;
+
+    bool allow_empty_content = false;
+};
+
+enum class validation_problem : uint8_t {
+    missing,
+    not_a_folder,
+    unreadable,
+    empty_content,
+    file_too_large,
+    content_too_large,
+    forbidden_file,
+    preview_too_large,
+    preview_format, // Neither PNG, JPEG nor GIF.
+};
+
+struct validation_issue {
+    validation_problem problem;
+    std::filesystem::path path;
+    uint64_t size = 0;
+};
+
+struct content_report {
+    // Keeps the first ones only, a broken tree can have thousands.
+    static constexpr std::size_t max_issues = 64;
+
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+    uint64_t preview_bytes = 0;
+    std::vector<validation_issue> issues; // Sorted by path.
+    uint64_t issue_count = 0;             // Including the ones left out of `issues`.
+
+    [[nodiscard]] bool ok() const noexcept { return issue_count == 0; }
+};
+
+// ----------------------------------------------------------------------------
+// Walks content folders on the pool, one task per folder of each level,
+// checking every file can be opened and fits the limits, and reads the
+// preview's header for its format.
+class content_validator {
+
+public:
+    struct target {
+        std::optional<std::filesystem::path> content;
+        std::optional<std::filesystem::path> preview;
+    };
+
+private:
+    validation_limits _limits;
+    thread_pool& _pool;
+
+    void check_content(const std::filesystem::path& root, content_report& report) const;
+
+    void check_preview(const std::filesystem::path& preview, content_report& report) const;
+
+public:
+    explicit content_validator(validation_limits limits = {}, thread_pool& pool = thread_pool::shared()) noexcept;
+
+    [[nodiscard]] content_report validate(const std::optional<std::filesystem::path>& content,
+                                          const std::optional<std::filesystem::path>& preview) const;
+
+    /// @brief Validates a whole batch at once, the items spread over the pool as well.
+    [[nodiscard]] std::vector<content_report> validate(const std::vector<target>& targets) const;
+
+    [[nodiscard]] static std::string_view problem_name(validation_problem problem) noexcept;
+
+    /// @brief One line for the log, the path and what is wrong with it.
+    [[nodiscard]] static std::string describe(const validation_issue& issue);
+};
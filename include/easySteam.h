@@ -4,7 +4,9 @@
 #include <filesystem>
 #include <optional>
 
+#include "../include/bulkPublisher.h"
 #include "../include/steamHelper.h"
+#include "../include/querySpec.h"
 
 [[nodiscard]] bool poll_steam_callbacks(steam_helper& _steam_helper) noexcept;
 
@@ -15,6 +17,10 @@ namespace easySteam {
     extern std::unique_ptr<steam_helper> _steam_helper;
     extern bool initUpdateHandleCalled;
     std::optional<UGCUpdateHandle_t> getUpdateHandle();
+    std::optional<UGCQueryHandle_t> getQueryHandle();
+
+    // Prepared query, reusable and safe to execute from several threads.
+    using QuerySpec = query_spec;
 
     typedef struct {
         std::string title;
@@ -23,6 +29,8 @@ namespace easySteam {
     } WorkshopItem_t;
 
     void initializeSteamHelper();
+    void startCallbackPump();
+    void stopCallbackPump();
     void createItem(uint64_t app_id);
     
     void createQuery(   AccountID_t accountID, EUserUGCList listType,
@@ -47,17 +55,53 @@ namespace easySteam {
     bool returnLongDescription(const bool enabled);
     bool returnTotalOnly(const bool enabled);
     bool allowCachedResponse(const uint32 maxAgeSeconds);
+    // Mask of query_projection values, e.g. projection_ids_only for ID syncs.
+    bool setProjection(const uint32 projection, const uint32 playtimeStatsDays = 0);
     
     // Also processes the results and cleaning
+    // The image URLs stay valid until the next call.
     void sendQuery(std::vector<SteamUGCDetails_t> &itemListDetails, std::vector<char*> &imageListURL);
+    // Same, handing out the compact result set itself, nullptr on failure.
+    std::shared_ptr<const query_result_set> sendQuery();
+    // Executes the spec on a fresh handle, leaving the global query alone.
+    // Fields are read lazily from the returned set.
+    std::shared_ptr<const query_result_set> sendQuery(const QuerySpec& spec);
 
     void updateItem(uint64_t app_id, uint64_t item_id);
     void initUpdateHandle();
     void setPreviewImage(const std::filesystem::path& file_path);
+    // Same, shrunk to fit and re-encoded within Steam's size limit first if needed, cached in .workshop_previews next to it.
+    void setPreviewImage(const std::filesystem::path& file_path, uint32_t maxWidth, uint32_t maxHeight);
     void setWorkshopItemTitle(const std::string& title);
     void setWorkshopItemDescription(const std::string& description);
     void setWorkshopItemContent(const std::filesystem::path& directory_path);
+    // Uploads the files of a build output matching `include` (all if empty) and not `exclude`, glob patterns,
+    // hardlinked into .workshop_staging next to it instead of copied into a clean folder first.
+    void setWorkshopItemContent(const std::filesystem::path& directory_path, const std::vector<std::string>& include,
+                                const std::vector<std::string>& exclude = {});
+    // Uploads the folder as one compressed, indexed content.swpk written into .workshop_staging next to it,
+    // for items of many small files. The game reads the installed pack with content_pack.
+    void setWorkshopItemContentPacked(const std::filesystem::path& directory_path);
     void submitWorkshopItemUpdate(uint64_t item_id, const std::string& changelog_note);
+    // Legacy: truncates to long and reports 1/1 when no upload is in progress, prefer the overload below.
     void getWorkshopItemUploadProgress(long* remaining, long* totalSize);
+    // Bytes of the file uploading, false when no upload is in progress (not started yet, or over).
+    bool getWorkshopItemUploadProgress(uint64_t& processed, uint64_t& total, EItemUpdateStatus* status = nullptr);
+    // Progress of every upload, phase, bytes, rate and ETA, called from the thread running the callbacks.
+    upload_monitor::subscription subscribeUploadProgress(upload_monitor::subscriber callback);
+    void unsubscribeUploadProgress(upload_monitor::subscription subscription);
     void unsubscribeWorkshopItem(uint64_t item_id);
+
+    // Checks a content folder and preview image (empty for none) without calling Steam, logging each problem.
+    bool validateWorkshopContent(const std::filesystem::path& contentPath, const std::filesystem::path& previewPath = {});
+
+    // Creates, updates and submits every item of a JSON or CSV manifest, `maxInFlight` uploads at once.
+    // Items unchanged since their last publish from this manifest are skipped, see .workshop_fingerprints next to it.
+    // Oversized previews are shrunk into .workshop_previews next to it.
+    // Returns false unless every item was published, the per-item outcomes are logged.
+    bool publishManifest(const std::filesystem::path& manifestPath, uint32_t maxInFlight = 4);
+
+    // Operation latencies, in-flight counts and EResult counters, empty before initialization.
+    std::string metricsPrometheus();
+    std::string metricsJson();
 } // namespace easySteam
\ No newline at end of file
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <optional>
+#include <functional>
+#include <vector>
+#include <tuple>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <utility>
+
+#include "../include/easySteam.h"
+
+// Non-blocking counterpart of the easySteam API.
+//
+// Every call returns a future right away. Completions are dispatched from the
+// callback pump, which is started on first use, so `then` continuations run
+// on the pump thread unless the future was already ready when attached.
+namespace easySteam::async {
+
+    typedef struct {
+        EResult result;
+        PublishedFileId_t itemID;
+    } CreatedItem_t;
+
+    typedef struct {
+        EResult result;
+        PublishedFileId_t itemID;
+    } SubmittedItem_t;
+
+    typedef struct {
+        EResult result;
+        uint32 totalMatching;
+        std::vector<SteamUGCDetails_t> items;
+        std::vector<std::string> previewURLs;
+    } QueryPage_t;
+
+    template <typename T>
+    class future;
+
+    namespace detail {
+
+        template <typename T>
+        class shared_state {
+
+        private:
+            mutable std::mutex _mutex;
+            mutable std::condition_variable _cv;
+            std::optional<T> _value;
+            std::vector<std::function<void(const T&)>> _continuations;
+
+        public:
+            // Only the first value is kept, later ones are ignored.
+            void set_value(T value) {
+                std::vector<std::function<void(const T&)>> continuations;
+
+                {
+                    std::lock_guard<std::mutex> lock{_mutex};
+
+                    if (_value.has_value()) {
+                        return;
+                    }
+
+                    _value.emplace(std::move(value));
+                    continuations.swap(_continuations);
+                }
+
+                _cv.notify_all();
+
+                for (auto& continuation : continuations) {
+                    continuation(*_value);
+                }
+            }
+
+            void on_ready(std::function<void(const T&)>&& continuation) {
+                {
+                    std::lock_guard<std::mutex> lock{_mutex};
+
+                    if (!_value.has_value()) {
+                        _continuations.push_back(std::move(continuation));
+                        return;
+                    }
+                }
+
+                continuation(*_value);
+            }
+
+            [[nodiscard]] bool ready() const {
+                std::lock_guard<std::mutex> lock{_mutex};
+                return _value.has_value();
+            }
+
+            [[nodiscard]] const T& wait() const {
+                std::unique_lock<std::mutex> lock{_mutex};
+                _cv.wait(lock, [this] { return _value.has_value(); });
+                return *_value;
+            }
+
+            template <typename Rep, typename Period>
+            [[nodiscard]] bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+                std::unique_lock<std::mutex> lock{_mutex};
+                return _cv.wait_for(lock, timeout, [this] { return _value.has_value(); });
+            }
+        };
+
+        template <typename T>
+        struct is_future : std::false_type {};
+
+        template <typename T>
+        struct is_future<future<T>> : std::true_type {};
+
+        // `then` flattens continuations returning a future and maps void to std::monostate.
+        template <typename R>
+        struct then_result {
+            using type = future<std::conditional_t<std::is_void_v<R>, std::monostate, R>>;
+        };
+
+        template <typename T>
+        struct then_result<future<T>> {
+            using type = future<T>;
+        };
+
+        template <typename F, typename... Args, std::size_t... Is>
+        void for_each_indexed(F& f, std::index_sequence<Is...>, const Args&... args) {
+            (f(std::integral_constant<std::size_t, Is>{}, args), ...);
+        }
+
+    } // namespace detail
+
+    template <typename T>
+    class promise {
+
+    private:
+        std::shared_ptr<detail::shared_state<T>> _state = std::make_shared<detail::shared_state<T>>();
+
+    public:
+        [[nodiscard]] future<T> get_future() const { return future<T>{_state}; }
+
+        void set_value(T value) const { _state->set_value(std::move(value)); }
+    };
+
+    template <typename T>
+    class future {
+
+    private:
+        std::shared_ptr<detail::shared_state<T>> _state;
+
+    public:
+        using value_type = T;
+
+        future() = default;
+
+        explicit future(std::shared_ptr<detail::shared_state<T>> state) : _state{std::move(state)} {}
+
+        [[nodiscard]] bool valid() const { return _state != nullptr; }
+
+        [[nodiscard]] bool ready() const { return _state->ready(); }
+
+        void wait() const { static_cast<void>(_state->wait()); }
+
+        template <typename Rep, typename Period>
+        [[nodiscard]] bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const { return _state->wait_for(timeout); }
+
+        /// @brief Blocks until the value is available.
+        [[nodiscard]] const T& get() const { return _state->wait(); }
+
+        /// @brief Registers a callback without chaining a new future.
+        template <typename F>
+        void on_ready(F&& callback) const {
+            _state->on_ready(std::function<void(const T&)>{std::forward<F>(callback)});
+        }
+
+        /// @brief Chains a continuation, called with the value once available.
+        ///
+        /// A continuation returning a future is flattened, so async calls can be chained.
+        template <typename F>
+        auto then(F&& continuation) const -> typename detail::then_result<std::invoke_result_t<F&, const T&>>::type {
+            using R = std::invoke_result_t<F&, const T&>;
+            using next_future = typename detail::then_result<R>::type;
+            using U = typename next_future::value_type;
+
+            promise<U> next;
+
+            on_ready([next, continuation = std::forward<F>(continuation)](const T& value) mutable {
+                if constexpr (std::is_void_v<R>) {
+                    continuation(value);
+                    next.set_value(std::monostate{});
+                } else if constexpr (detail::is_future<R>::value) {
+                    continuation(value).on_ready([next](const U& inner) { next.set_value(inner); });
+                } else {
+                    next.set_value(continuation(value));
+                }
+            });
+
+            return next.get_future();
+        }
+    };
+
+    /// @brief Resolves once every future of the list is ready, values in order.
+    template <typename T>
+    [[nodiscard]] future<std::vector<T>> when_all(const std::vector<future<T>>& futures) {
+        struct join_state {
+            std::mutex mutex;
+            std::vector<std::optional<T>> values;
+            std::size_t remaining;
+            promise<std::vector<T>> done;
+        };
+
+        auto state = std::make_shared<join_state>();
+        state->values.resize(futures.size());
+        state->remaining = futures.size();
+
+        if (futures.empty()) {
+            state->done.set_value({});
+            return state->done.get_future();
+        }
+
+        for (std::size_t i = 0; i < futures.size(); ++i) {
+            futures[i].on_ready([state, i](const T& value) {
+                {
+                    std::lock_guard<std::mutex> lock{state->mutex};
+                    state->values[i].emplace(value);
+
+                    if (--state->remaining != 0) {
+                        return;
+                    }
+                }
+
+                std::vector<T> values;
+                values.reserve(state->values.size());
+
+                for (auto& v : state->values) {
+                    values.push_back(std::move(*v));
+                }
+
+                state->done.set_value(std::move(values));
+            });
+        }
+
+        return state->done.get_future();
+    }
+
+    /// @brief Resolves once every future is ready, with a tuple of their values.
+    template <typename... Ts>
+    [[nodiscard]] future<std::tuple<Ts...>> when_all(const future<Ts>&... futures) {
+        struct join_state {
+            std::mutex mutex;
+            std::tuple<std::optional<Ts>...> values;
+            std::size_t remaining = sizeof...(Ts);
+            promise<std::tuple<Ts...>> done;
+        };
+
+        auto state = std::make_shared<join_state>();
+
+        if constexpr (sizeof...(Ts) == 0) {
+            state->done.set_value({});
+        } else {
+            auto attach = [&state](auto index, const auto& f) {
+                using value_type = typename std::decay_t<decltype(f)>::value_type;
+
+                f.on_ready([state](const value_type& value) {
+                    {
+                        std::lock_guard<std::mutex> lock{state->mutex};
+                        std::get<decltype(index)::value>(state->values).emplace(value);
+
+                        if (--state->remaining != 0) {
+                            return;
+                        }
+                    }
+
+                    state->done.set_value(std::apply(
+                        [](auto&... values) { return std::tuple<Ts...>{std::move(*values)...}; },
+                        state->values));
+                });
+            };
+
+            detail::for_each_indexed(attach, std::index_sequence_for<Ts...>{}, futures...);
+        }
+
+        return state->done.get_future();
+    }
+
+    [[nodiscard]] future<CreatedItem_t> createItem(uint64_t app_id);
+
+    // Takes ownership of the query handle, it is released once the query completes.
+    [[nodiscard]] future<QueryPage_t> sendQuery(UGCQueryHandle_t query_handle);
+
+    // Executes the spec on a fresh handle, so the same spec can be in flight many times.
+    [[nodiscard]] future<QueryPage_t> sendQuery(const QuerySpec& spec);
+
+    [[nodiscard]] future<SubmittedItem_t> submitWorkshopItemUpdate(UGCUpdateHandle_t update_handle, const std::string& changelog_note);
+
+} // namespace easySteam::async
@@ -0,0 +1,49 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// 8 bit RGB image, rows top to bottom without padding.
+struct rgb_image {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels; // width * height * 3.
+
+    [[nodiscard]] bool empty() const noexcept { return width == 0 || height == 0; }
+};
+
+enum class image_format : uint8_t { unknown, png, jpeg, gif };
+
+struct image_info {
+    image_format format = image_format::unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// ----------------------------------------------------------------------------
+// Just what preview images need, without an imaging library: reading PNG,
+// shrinking, writing baseline JPEG. Other formats only get their size read.
+namespace image_codec {
+
+    /// @brief Format and size from the file's header, without decoding it.
+    [[nodiscard]] image_info probe(const std::byte* data, std::size_t size) noexcept;
+
+    /// @brief Non-interlaced PNG of any color type, transparency blended over `background`.
+    /// @return nullopt for anything else or a damaged file.
+    [[nodiscard]] std::optional<rgb_image> decode_png(const std::byte* data, std::size_t size, const uint8_t (&background)[3]);
+
+    /// @brief Area average down to fit within the bounds, the aspect ratio kept; never enlarges.
+    [[nodiscard]] rgb_image shrink_to_fit(const rgb_image& image, uint32_t max_width, uint32_t max_height);
+
+    /// @param quality 1 to 100, as libjpeg's.
+    [[nodiscard]] std::vector<std::byte> encode_jpeg(const rgb_image& image, int quality);
+
+    [[nodiscard]] std::string_view extension(image_format format) noexcept;
+
+} // namespace image_codec
@@ -0,0 +1,258 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+// Leveled, asynchronous logging.
+//
+//     log_info("Steam") << "Query completed. Found " << count << " items\n";
+//
+// A line is formatted on the caller's stack and handed to a lock-free ring
+// buffer, a background writer drains it into the sink. When the ring is full
+// the line is dropped and counted rather than blocking the caller.
+//
+// Lines below STEAM_WRAPPER_MIN_LOG_LEVEL compile to nothing. It defaults to
+// debug, and to info in NDEBUG builds; configure with
+// -DSTEAM_WRAPPER_MIN_LOG_LEVEL=trace|debug|info|warning|error|off.
+enum class log_level : uint8_t { trace = 0, debug = 1, info = 2, warning = 3, error = 4, off = 5 };
+
+#if !defined(STEAM_WRAPPER_MIN_LOG_LEVEL)
+#if defined(NDEBUG)
+#define STEAM_WRAPPER_MIN_LOG_LEVEL 2
+#else
+#define STEAM_WRAPPER_MIN_LOG_LEVEL 1
+#endif
+#endif
+
+inline constexpr log_level min_log_level = static_cast<log_level>(STEAM_WRAPPER_MIN_LOG_LEVEL);
+
+[[nodiscard]] std::string_view log_level_name(log_level level) noexcept;
+
+// One line as seen by a sink, the views are only valid during the call.
+struct log_record {
+    log_level level;
+    std::chrono::system_clock::time_point time;
+    std::string_view category;
+    std::string_view message;
+};
+
+// Called from the writer thread only, one record at a time.
+using log_sink = std::function<void(const log_record&)>;
+
+class logger {
+
+public:
+    static constexpr std::size_t ring_capacity = 1024;
+    static constexpr std::size_t message_capacity = 232;
+
+private:
+    // ------------------------------------------------------------------------
+    // Bounded multi-producer, single-consumer ring. A slot's sequence tells
+    // whose turn it is: equal to the position when free for the producer
+    // claiming it, position + 1 once the line is written.
+    struct slot {
+        std::atomic<std::size_t> sequence{0};
+        log_level level = log_level::info;
+        uint16_t length = 0;
+        std::chrono::system_clock::time_point time;
+        std::string_view category;
+        std::array<char, message_capacity> message;
+    };
+
+    // ------------------------------------------------------------------------
+    // Data members.
+    std::unique_ptr<slot[]> _slots;
+    alignas(64) std::atomic<std::size_t> _tail{0};
+    // Only advanced by the writer, read by flush().
+    alignas(64) std::atomic<std::size_t> _head{0};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<log_level> _level{log_level::trace};
+
+    // Writer thread. `_wake_mutex` only serializes going to sleep and being woken.
+    std::thread _writer;
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _writer_sleeping{false};
+    std::mutex _wake_mutex;
+    std::condition_variable _wake_cv;
+    std::condition_variable _drained_cv;
+
+    mutable std::mutex _sink_mutex;
+    log_sink _sink;
+
+    logger();
+
+    void write_loop() noexcept;
+
+    // Drains the committed slots, returns how many were written.
+    std::size_t drain() noexcept;
+
+    void write(const log_record& record) noexcept;
+
+    static void stop_at_exit() noexcept;
+
+public:
+    logger(const logger&) = delete;
+    logger& operator=(const logger&) = delete;
+
+    /// @brief The process wide logger, started on first use and flushed at exit.
+    [[nodiscard]] static logger& instance() noexcept;
+
+    /// @brief Queues a line, never blocks. Categories must outlive the writer, use literals.
+    /// @return false when the ring was full and the line dropped.
+    bool push(log_level level, std::string_view category, std::string_view message) noexcept;
+
+    /// @brief Blocks until every line queued so far went through the sink.
+    void flush() noexcept;
+
+    /// @brief Runtime threshold, on top of the compile-time one.
+    void set_level(log_level level) noexcept { _level.store(level, std::memory_order_relaxed); }
+
+    [[nodiscard]] log_level level() const noexcept { return _level.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] bool enabled(const log_level level) const noexcept {
+        return level >= min_log_level && level >= _level.load(std::memory_order_relaxed) && level != log_level::off;
+    }
+
+    /// @brief Replaces the sink, an empty one discards everything.
+    void set_sink(log_sink sink) noexcept;
+
+    [[nodiscard]] uint64_t dropped() const noexcept { return _dropped.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] uint64_t written() const noexcept { return _head.load(std::memory_order_relaxed); }
+
+    /// @brief "[category] message" on stdout, the default sink.
+    [[nodiscard]] static log_sink console_sink();
+
+    /// @brief Appends timestamped lines to the file, nullptr sink if it cannot be opened.
+    [[nodiscard]] static log_sink file_sink(const std::filesystem::path& path);
+};
+
+// ----------------------------------------------------------------------------
+// Line builder, formats into a fixed buffer and queues the line when destroyed.
+template <bool Enabled>
+class log_line;
+
+// Compiled out, every insertion is a no-op.
+template <>
+class log_line<false> {
+
+public:
+    constexpr log_line(log_level, std::string_view) noexcept {}
+
+    template <typename T>
+    constexpr const log_line& operator<<(const T&) const noexcept { return *this; }
+};
+
+template <>
+class log_line<true> {
+
+private:
+    log_level _level;
+    std::string_view _category;
+    bool _active;
+    std::size_t _length = 0;
+    std::array<char, logger::message_capacity> _buffer;
+
+    void append(const std::string_view text) noexcept {
+        const std::size_t count = std::min(text.size(), _buffer.size() - _length);
+        std::memcpy(_buffer.data() + _length, text.data(), count);
+        _length += count;
+    }
+
+    template <typename T>
+    void append_number(const T value) noexcept {
+        const auto [end, ec] = std::to_chars(_buffer.data() + _length, _buffer.data() + _buffer.size(), value);
+
+        if (ec == std::errc{}) {
+            _length = static_cast<std::size_t>(end - _buffer.data());
+        }
+    }
+
+public:
+    log_line(const log_level level, const std::string_view category) noexcept
+        : _level{level}, _category{category}, _active{logger::instance().enabled(level)} {}
+
+    log_line(const log_line&) = delete;
+    log_line& operator=(const log_line&) = delete;
+
+    ~log_line() {
+        if (_active) {
+            logger::instance().push(_level, _category, {_buffer.data(), _length});
+        }
+    }
+
+    log_line& operator<<(const std::string_view text) noexcept {
+        if (_active) {
+            append(text);
+        }
+        return *this;
+    }
+
+    log_line& operator<<(const char* text) noexcept { return *this << std::string_view{text != nullptr ? text : "(null)"}; }
+
+    log_line& operator<<(const std::string& text) noexcept { return *this << std::string_view{text}; }
+
+    log_line& operator<<(const char c) noexcept { return *this << std::string_view{&c, 1}; }
+
+    log_line& operator<<(const bool value) noexcept { return *this << (value ? "true" : "false"); }
+
+    // Quoted, like std::filesystem::path's stream insertion.
+    log_line& operator<<(const std::filesystem::path& path) noexcept {
+        if (_active) {
+            append("\"");
+            append(path.string());
+            append("\"");
+        }
+        return *this;
+    }
+
+    template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>, int> = 0>
+    log_line& operator<<(const T value) noexcept {
+        if (_active) {
+            append_number(value);
+        }
+        return *this;
+    }
+
+    template <typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    log_line& operator<<(const T value) noexcept {
+        if (_active) {
+            char text[32];
+            const int length = std::snprintf(text, sizeof(text), "%g", static_cast<double>(value));
+            append({text, static_cast<std::size_t>(std::max(length, 0))});
+        }
+        return *this;
+    }
+};
+
+template <log_level Level>
+using log_line_for = log_line<(Level >= min_log_level && Level != log_level::off)>;
+
+[[nodiscard]] inline log_line_for<log_level::trace> log_trace(const std::string_view category) noexcept { return {log_level::trace, category}; }
+
+[[nodiscard]] inline log_line_for<log_level::debug> log_debug(const std::string_view category) noexcept { return {log_level::debug, category}; }
+
+[[nodiscard]] inline log_line_for<log_level::info> log_info(const std::string_view category) noexcept { return {log_level::info, category}; }
+
+[[nodiscard]] inline log_line_for<log_level::warning> log_warning(const std::string_view category) noexcept { return {log_level::warning, category}; }
+
+[[nodiscard]] inline log_line_for<log_level::error> log_error(const std::string_view category) noexcept { return {log_level::error, category}; }
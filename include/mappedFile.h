@@ -0,0 +1,43 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <filesystem>
+
+// ----------------------------------------------------------------------------
+// Read-only memory mapping of a whole file.
+class mapped_file {
+
+private:
+    const std::byte* _data = nullptr;
+    std::size_t _size = 0;
+
+#ifdef _WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#else
+    int _fd = -1;
+#endif
+
+public:
+    mapped_file() noexcept = default;
+
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() noexcept { close(); }
+
+    [[nodiscard]] bool open(const std::filesystem::path& file_path) noexcept;
+
+    void close() noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return _data != nullptr; }
+
+    [[nodiscard]] const std::byte* data() const noexcept { return _data; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+};
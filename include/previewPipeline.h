@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../include/imageCodec.h"
+#include "../include/threadPool.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// What a preview image is brought down to before it is uploaded.
+struct preview_options {
+    uint32_t max_width = 1024;
+    uint32_t max_height = 1024;
+    uint64_t max_bytes = 1 << 20; // Steam refuses larger preview images.
+
+    // JPEG quality tried first, lowered down to min_quality to fit max_bytes,
+    // then the image is shrunk further.
+    int quality = 90;
+    int min_quality = 50;
+
+    uint8_t background[3] = {0, 0, 0}; // Transparent pixels are blended over it.
+};
+
+// ----------------------------------------------------------------------------
+// Shrinks and re-encodes preview images that are too large, to JPEG within
+// the byte budget. Results are cached by the hash of the source's bytes, so
+// an identical preview is processed once, whatever its name, across items
+// and runs. Previews already within bounds are used as they are.
+//
+// PNG is decoded without any library; a JPEG or GIF that needs shrinking
+// needs a decoder set with set_decoder().
+class preview_processor {
+
+public:
+    using decoder = std::function<std::optional<rgb_image>(const std::byte* data, std::size_t size)>;
+
+    struct result {
+        std::filesystem::path path; // To upload, the source itself if it was fine.
+        bool converted = false;
+        bool cached = false; // Converted by an earlier call.
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t bytes = 0;
+    };
+
+private:
+    std::filesystem::path _cache_directory;
+    preview_options _options;
+    decoder _decoder;
+    thread_pool& _pool;
+
+    [[nodiscard]] uint64_t options_seed() const noexcept;
+
+    [[nodiscard]] std::optional<result> convert(const std::filesystem::path& source, const std::byte* data, std::size_t size,
+                                                const std::filesystem::path& target) const;
+
+public:
+    explicit preview_processor(std::filesystem::path cache_directory, preview_options options = {},
+                               thread_pool& pool = thread_pool::shared()) noexcept;
+
+    /// @brief Reads the formats the built-in codec cannot, for previews too large to upload as they are.
+    void set_decoder(decoder custom) noexcept { _decoder = std::move(custom); }
+
+    /// @return nullopt if the preview is unreadable or could not be brought within bounds, the reason logged.
+    [[nodiscard]] std::optional<result> process(const std::filesystem::path& source) const;
+
+    /// @brief Processes a batch over the pool, sources with the same bytes only once.
+    [[nodiscard]] std::vector<std::optional<result>> process(const std::vector<std::filesystem::path>& sources) const;
+};
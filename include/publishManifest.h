@@ -0,0 +1,57 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// One item to publish: created first when it has no id yet, then updated with
+// the fields given, fields left out are not touched on Steam.
+struct publish_entry {
+    AppId_t app_id = 0;
+    PublishedFileId_t item_id = 0; // 0 creates a new item.
+    std::optional<std::string> title;
+    std::optional<std::string> description;
+    std::optional<std::filesystem::path> preview;
+    std::optional<std::filesystem::path> content;
+    std::string changelog;
+
+    // Where the entry starts in the manifest, for the messages.
+    std::size_t line = 0;
+};
+
+// ----------------------------------------------------------------------------
+// List of items to publish in one go, read from JSON or CSV.
+//
+// JSON is an array of objects, or an object with such an "items" array:
+//
+//     [{"app": 480, "item": "new", "title": "My mod", "content": "build/my_mod",
+//       "preview": "build/my_mod.png", "changelog": "First release"}]
+//
+// CSV has a header row naming the same columns, in any order, quoted as per
+// RFC 4180. The columns are app, item ("new", empty or an id), title,
+// description, preview, content and changelog; only app is required.
+// Relative paths are resolved against the manifest's directory.
+class publish_manifest {
+
+public:
+    enum class format { json, csv };
+
+    std::vector<publish_entry> entries;
+
+    /// @brief Reads the file, JSON if it ends in .json or starts with '[' or '{', CSV otherwise.
+    /// @return nullopt if it cannot be read or has any error, each one logged with its line.
+    [[nodiscard]] static std::optional<publish_manifest> load(const std::filesystem::path& path) noexcept;
+
+    [[nodiscard]] static std::optional<publish_manifest> parse(std::string_view text, format text_format,
+                                                               const std::filesystem::path& base_directory = {}) noexcept;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamHelper.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class query_disk_cache;
+
+// ----------------------------------------------------------------------------
+// Client-side cache of query pages, keyed by the normalized query key.
+//
+// A page younger than `ttl` is served without touching Steam. Up to `ttl + stale_ttl`
+// it is still served right away while a single background refresh replaces it.
+// The cache is bounded by `max_bytes`, least recently used pages go first.
+// With a disk cache attached, a page missing in memory is loaded from disk,
+// served as stale and refreshed, so a cold start shows the last session's results.
+// It must outlive the queries it sent.
+class query_cache {
+
+public:
+    using page_ptr = std::shared_ptr<const query_page>;
+    using page_callback = std::function<void(const page_ptr&)>;
+
+    struct options {
+        std::chrono::milliseconds ttl{std::chrono::seconds(60)};
+        std::chrono::milliseconds stale_ttl{std::chrono::minutes(5)};
+        std::size_t max_bytes = 64 * 1024 * 1024;
+        // Pages persisted longer ago are not served from the disk cache.
+        std::chrono::seconds disk_max_age{std::chrono::hours(24 * 7)};
+    };
+
+    struct statistics {
+        uint64_t hits;
+        uint64_t stale_hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t refreshes;
+        uint64_t disk_hits;
+        std::size_t entries;
+        std::size_t bytes;
+    };
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    // ------------------------------------------------------------------------
+    // Cache entries, `lru` holds the keys from most to least recently used.
+    struct entry {
+        page_ptr page;
+        clock::time_point stored_at;
+        std::size_t bytes = 0;
+        std::list<query_key>::iterator lru_position;
+        bool refreshing = false;
+        std::vector<page_callback> waiters;
+    };
+
+    // ------------------------------------------------------------------------
+    // Data members.
+    steam_helper& _helper;
+    options _options;
+
+    mutable std::mutex _mutex;
+    std::unordered_map<query_key, entry> _entries;
+    std::list<query_key> _lru;
+    std::size_t _bytes = 0;
+
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _stale_hits{0};
+    std::atomic<uint64_t> _misses{0};
+    std::atomic<uint64_t> _evictions{0};
+    std::atomic<uint64_t> _refreshes{0};
+    std::atomic<uint64_t> _disk_hits{0};
+
+    std::shared_ptr<const query_disk_cache> _disk;
+
+    // ------------------------------------------------------------------------
+    // Cache utils.
+    void refresh(const query_key& key, UGCQueryHandle_t query_handle) noexcept;
+
+    void on_refreshed(const query_key& key, page_ptr page) noexcept;
+
+    void touch(entry& cached) noexcept;
+
+    void evict_to_fit() noexcept;
+
+    // Called with the mutex held.
+    bool load_from_disk(const query_key& key) noexcept;
+
+public:
+    query_cache(steam_helper& helper, options cache_options) noexcept;
+
+    query_cache(const query_cache&) = delete;
+    query_cache& operator=(const query_cache&) = delete;
+
+    /// @brief Serves the query from the cache when possible, sends it otherwise.
+    ///
+    /// Takes ownership of the handle. Fresh and stale hits call back right away
+    /// on the calling thread, misses from the callback dispatch once the query
+    /// completes. Concurrent misses on the same key share a single request.
+    void send(UGCQueryHandle_t query_handle, page_callback callback) noexcept;
+
+    [[nodiscard]] page_ptr lookup(const query_key& key) noexcept;
+
+    void store(const query_key& key, page_ptr page) noexcept;
+
+    void invalidate(const query_key& key) noexcept;
+
+    void clear() noexcept;
+
+    /// @brief Falls back on a persisted cache for pages missing in memory.
+    void attach_disk_cache(std::shared_ptr<const query_disk_cache> disk) noexcept;
+
+    /// @brief Copies out every cached page, to be persisted with query_disk_cache::write.
+    [[nodiscard]] std::vector<std::pair<query_key, page_ptr>> snapshot() const;
+
+    [[nodiscard]] statistics stats() const noexcept;
+
+    [[nodiscard]] static std::size_t page_bytes(const query_page& page) noexcept;
+};
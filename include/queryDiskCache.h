@@ -0,0 +1,199 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/queryCache.h"
+#include "../include/mappedFile.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Persistent query cache, memory mapped for a fast cold start.
+//
+// The file is written once from a query_cache snapshot and opened read-only.
+// Opening only checks the header, lookups binary search the page records and
+// hand out views pointing straight into the mapping, nothing is parsed or copied.
+//
+// Layout, native byte order, every section 8 byte aligned:
+//
+//     file_header | page_record[page_count] | item_record[item_count] | string pool
+//
+// Page records are sorted by the stable hash of their serialized query key,
+// items of a page are contiguous and strings are referenced by offset and length.
+class query_disk_cache {
+
+public:
+    static constexpr char file_magic[8] = {'S', 'W', 'Q', 'C', 'A', 'C', 'H', 'E'};
+    static constexpr uint32 format_version = 1;
+    static constexpr uint32 byte_order_mark = 0x01020304;
+
+    // ------------------------------------------------------------------------
+    // On-disk records.
+    struct string_ref {
+        uint32 offset;
+        uint32 length;
+    };
+
+    struct file_header {
+        char magic[8];
+        uint32 version;
+        uint32 byte_order;
+        uint32 header_size;
+        uint32 page_record_size;
+        uint32 item_record_size;
+        uint32 page_count;
+        uint32 item_count;
+        uint32 reserved;
+        uint64 pages_offset;
+        uint64 items_offset;
+        uint64 strings_offset;
+        uint64 strings_size;
+        uint64 written_at;
+    };
+
+    struct page_record {
+        uint64 key_hash;
+        uint64 stored_at;
+        string_ref key;
+        string_ref next_cursor;
+        uint32 first_item;
+        uint32 item_count;
+        uint32 num_returned;
+        uint32 total_matching;
+    };
+
+    struct item_record {
+        uint64 published_file_id;
+        uint64 owner_steam_id;
+        uint64 file_handle;
+        uint64 preview_file_handle;
+        uint32 creator_app_id;
+        uint32 consumer_app_id;
+        uint32 time_created;
+        uint32 time_updated;
+        uint32 time_added_to_user_list;
+        uint32 votes_up;
+        uint32 votes_down;
+        uint32 num_children;
+        int32 file_size;
+        int32 preview_file_size;
+        float score;
+        int32 result;
+        int32 file_type;
+        int32 visibility;
+        uint8 banned;
+        uint8 accepted_for_use;
+        uint8 tags_truncated;
+        uint8 reserved[5];
+        string_ref title;
+        string_ref description;
+        string_ref tags;
+        string_ref file_name;
+        string_ref url;
+        string_ref preview_url;
+    };
+
+    // ------------------------------------------------------------------------
+    // Zero-copy views, valid while the cache stays open.
+    class item_view {
+
+    private:
+        const query_disk_cache* _cache;
+        const item_record* _record;
+
+    public:
+        item_view(const query_disk_cache& cache, const item_record& record) noexcept : _cache{&cache}, _record{&record} {}
+
+        [[nodiscard]] const item_record& record() const noexcept { return *_record; }
+
+        [[nodiscard]] PublishedFileId_t id() const noexcept { return _record->published_file_id; }
+
+        [[nodiscard]] std::string_view title() const noexcept { return _cache->string_at(_record->title); }
+
+        [[nodiscard]] std::string_view description() const noexcept { return _cache->string_at(_record->description); }
+
+        [[nodiscard]] std::string_view tags() const noexcept { return _cache->string_at(_record->tags); }
+
+        [[nodiscard]] std::string_view file_name() const noexcept { return _cache->string_at(_record->file_name); }
+
+        [[nodiscard]] std::string_view url() const noexcept { return _cache->string_at(_record->url); }
+
+        [[nodiscard]] std::string_view preview_url() const noexcept { return _cache->string_at(_record->preview_url); }
+
+        /// @brief Copies the item back into Steam's fixed-size details struct.
+        void to_details(SteamUGCDetails_t& details) const noexcept;
+    };
+
+    class page_view {
+
+    private:
+        const query_disk_cache* _cache;
+        const page_record* _record;
+
+    public:
+        page_view(const query_disk_cache& cache, const page_record& record) noexcept : _cache{&cache}, _record{&record} {}
+
+        [[nodiscard]] std::size_t size() const noexcept { return _record->item_count; }
+
+        [[nodiscard]] item_view operator[](const std::size_t index) const noexcept {
+            return {*_cache, _cache->_items[_record->first_item + index]};
+        }
+
+        [[nodiscard]] uint32 total_matching() const noexcept { return _record->total_matching; }
+
+        [[nodiscard]] std::string_view next_cursor() const noexcept { return _cache->string_at(_record->next_cursor); }
+
+        [[nodiscard]] std::chrono::system_clock::time_point stored_at() const noexcept {
+            return std::chrono::system_clock::time_point{std::chrono::seconds(_record->stored_at)};
+        }
+
+        /// @brief Materializes the page, for callers that need a query_page.
+        void to_page(query_page& page) const;
+    };
+
+private:
+    // ------------------------------------------------------------------------
+    // Data members.
+    mapped_file _file;
+    const file_header* _header = nullptr;
+    const page_record* _pages = nullptr;
+    const item_record* _items = nullptr;
+    const char* _strings = nullptr;
+
+    [[nodiscard]] std::string_view string_at(const string_ref ref) const noexcept;
+
+public:
+    query_disk_cache() noexcept = default;
+
+    query_disk_cache(const query_disk_cache&) = delete;
+    query_disk_cache& operator=(const query_disk_cache&) = delete;
+
+    /// @brief Maps the file and checks its header, false on a missing, foreign or stale-format file.
+    [[nodiscard]] bool open(const std::filesystem::path& file_path) noexcept;
+
+    void close() noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return _header != nullptr; }
+
+    [[nodiscard]] std::size_t page_count() const noexcept { return _header != nullptr ? _header->page_count : 0; }
+
+    [[nodiscard]] std::optional<page_view> find(const query_key& key) const noexcept;
+
+    /// @brief Writes the pages to a temporary file then renames it over `file_path`.
+    ///
+    /// On Windows the target can't be replaced while mapped, close readers first.
+    [[nodiscard]] static bool write(const std::filesystem::path& file_path,
+                                    const std::vector<std::pair<query_key, query_cache::page_ptr>>& pages) noexcept;
+
+    // FNV-1a, stable across runs so it can be persisted.
+    [[nodiscard]] static uint64 stable_hash(std::string_view bytes) noexcept;
+};
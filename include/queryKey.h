@@ -0,0 +1,79 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Fields a query returns, or-ed together. Details and the preview URL come
+// with every query unless `projection_ids_only` strips them down to IDs.
+enum query_projection : uint32 {
+    projection_default = 0,
+    projection_ids_only = 1u << 0,              // SetReturnOnlyIDs
+    projection_metadata = 1u << 1,              // SetReturnMetadata
+    projection_key_value_tags = 1u << 2,        // SetReturnKeyValueTags
+    projection_children = 1u << 3,              // SetReturnChildren
+    projection_additional_previews = 1u << 4,   // SetReturnAdditionalPreviews
+    projection_playtime_stats = 1u << 5,        // SetReturnPlaytimeStats
+    projection_statistics = 1u << 6,            // Read the item statistics, no Steam option needed
+};
+
+// ----------------------------------------------------------------------------
+// Normalized description of a UGC query, recorded while its handle is built.
+// Two queries with equal keys return the same results, which makes it the
+// key of the client-side query cache.
+struct query_key {
+    enum class kind : uint8 { all, user };
+
+    kind type = kind::all;
+    uint32 list_type = 0;
+    uint32 matching_type = 0;
+    uint32 sort_order = 0;
+    AccountID_t account_id = 0;
+    AppId_t creator_app_id = 0;
+    AppId_t consumer_app_id = 0;
+
+    uint32 page = 0;
+    std::string cursor;
+
+    // Kept sorted, the order tags are added in does not change the results.
+    std::vector<std::string> required_tags;
+    std::vector<std::string> excluded_tags;
+    bool match_any_tag = false;
+
+    std::string search_text;
+    std::string cloud_filename;
+    uint32 trend_days = 0;
+    RTime32 created_start = 0;
+    RTime32 created_end = 0;
+
+    bool long_description = false;
+    bool total_only = false;
+    uint32 projection = projection_default;
+    uint32 playtime_stats_days = 0;
+
+    void add_required_tag(const char* tag);
+
+    void add_excluded_tag(const char* tag);
+
+    [[nodiscard]] std::size_t hash() const noexcept;
+
+    // Canonical byte encoding, stable across runs and builds unlike hash().
+    [[nodiscard]] std::string serialize() const;
+
+    [[nodiscard]] bool operator==(const query_key& other) const noexcept;
+
+    [[nodiscard]] bool operator!=(const query_key& other) const noexcept { return !(*this == other); }
+};
+
+template <>
+struct std::hash<query_key> {
+    std::size_t operator()(const query_key& key) const noexcept { return key.hash(); }
+};
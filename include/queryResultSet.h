@@ -0,0 +1,207 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+#include "../include/arena.h"
+#include "../include/queryKey.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+class steam_helper;
+
+// ----------------------------------------------------------------------------
+// Compact copy of a SteamUGCDetails_t. Strings are packed to their actual
+// length in the owning result set's arena, instead of Steam's fixed buffers
+// (8000 bytes of description and 1025 of tags for every item).
+struct query_result_item {
+    PublishedFileId_t id = 0;
+    uint64 owner_steam_id = 0;
+    UGCHandle_t file_handle = 0;
+    UGCHandle_t preview_file_handle = 0;
+    AppId_t creator_app_id = 0;
+    AppId_t consumer_app_id = 0;
+    uint32 time_created = 0;
+    uint32 time_updated = 0;
+    uint32 time_added_to_user_list = 0;
+    uint32 votes_up = 0;
+    uint32 votes_down = 0;
+    uint32 num_children = 0;
+    int32 file_size = 0;
+    int32 preview_file_size = 0;
+    float score = 0.0f;
+    EResult result = EResult::k_EResultFail;
+    EWorkshopFileType file_type = EWorkshopFileType::k_EWorkshopFileTypeCommunity;
+    ERemoteStoragePublishedFileVisibility visibility = ERemoteStoragePublishedFileVisibility::k_ERemoteStoragePublishedFileVisibilityPublic;
+    bool banned = false;
+    bool accepted_for_use = false;
+    bool tags_truncated = false;
+
+    // NUL terminated, owned by the result set. On a lazy set the preview URL
+    // stays empty, query_result_set::preview_url reads it.
+    std::string_view title;
+    std::string_view description;
+    std::string_view tags;
+    std::string_view file_name;
+    std::string_view url;
+    std::string_view preview_url;
+
+    void to_details(SteamUGCDetails_t& details) const noexcept;
+};
+
+struct query_result_tag {
+    std::string_view key;
+    std::string_view value;
+};
+
+struct query_result_preview {
+    std::string_view url_or_video_id;
+    std::string_view original_file_name;
+    EItemPreviewType type;
+};
+
+// Read-only view over an array owned by the result set.
+template <typename T>
+struct result_span {
+    const T* first = nullptr;
+    std::size_t count = 0;
+
+    [[nodiscard]] const T* begin() const noexcept { return first; }
+
+    [[nodiscard]] const T* end() const noexcept { return first + count; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return count; }
+
+    [[nodiscard]] bool empty() const noexcept { return count == 0; }
+
+    [[nodiscard]] const T& operator[](const std::size_t index) const noexcept { return first[index]; }
+};
+
+// ----------------------------------------------------------------------------
+// Results of one query. Items and their strings live in a single arena,
+// released as one unit with the set.
+//
+// A set read eagerly copies details and preview URLs of every item up front.
+// A lazy set keeps the query handle alive instead and extracts each field of
+// an item the first time it is asked for, memoizing it; release() or dropping
+// the set gives the handle back. Lazy accessors are thread-safe.
+class query_result_set {
+
+public:
+    // Covers every EItemStatistic value.
+    static constexpr std::size_t statistic_count = 16;
+
+private:
+    enum field : uint16_t {
+        field_details = 1 << 0,
+        field_preview_url = 1 << 1,
+        field_metadata = 1 << 2,
+        field_key_value_tags = 1 << 3,
+        field_children = 1 << 4,
+        field_additional_previews = 1 << 5,
+    };
+
+    struct lazy_fields {
+        uint16_t loaded = 0;
+        uint16_t statistics_loaded = 0;
+        uint16_t statistics_found = 0;
+        // Kept out of the item, which readers may hold while another thread loads this.
+        std::string_view preview_url;
+        std::string_view metadata;
+        result_span<query_result_tag> key_value_tags;
+        result_span<PublishedFileId_t> children;
+        result_span<query_result_preview> additional_previews;
+        uint64 statistics[statistic_count] = {};
+    };
+
+    // ------------------------------------------------------------------------
+    // Data members.
+    EResult _result = EResult::k_EResultFail;
+    uint32 _total_matching = 0;
+    std::string_view _next_cursor;
+
+    steam_helper* _helper = nullptr;
+    UGCQueryHandle_t _handle = k_UGCQueryHandleInvalid;
+
+    mutable std::mutex _mutex;
+    mutable arena _arena;
+    mutable std::vector<query_result_item> _items;
+    mutable std::vector<lazy_fields> _fields; // Empty for eager sets.
+
+    // ------------------------------------------------------------------------
+    // Lazy extraction, called with the mutex held.
+    void load(std::size_t index, field wanted) const;
+
+    void load_details(std::size_t index) const;
+
+    void load_statistic(std::size_t index, std::size_t slot) const;
+
+public:
+    query_result_set() noexcept = default;
+
+    query_result_set(const query_result_set&) = delete;
+    query_result_set& operator=(const query_result_set&) = delete;
+
+    ~query_result_set() noexcept { release(); }
+
+    /// @brief Reads every result of a completed query, the handle is left to the caller.
+    ///
+    /// Only the projected fields are extracted: no preview URL for IDs-only
+    /// queries, and metadata, tags, children, previews or statistics when asked for.
+    [[nodiscard]] static std::shared_ptr<query_result_set> read(EResult rc, const SteamUGCQueryCompleted_t& completed,
+                                                                uint32 projection = projection_default);
+
+    /// @brief Takes ownership of the completed query's handle and reads nothing yet.
+    /// The helper must outlive the set.
+    [[nodiscard]] static std::shared_ptr<query_result_set> attach(steam_helper& helper, const SteamUGCQueryCompleted_t& completed);
+
+    /// @brief Packs the details, for results read some other way.
+    void add(const SteamUGCDetails_t& details, std::string_view preview_url);
+
+    [[nodiscard]] EResult result() const noexcept { return _result; }
+
+    [[nodiscard]] uint32 total_matching() const noexcept { return _total_matching; }
+
+    [[nodiscard]] std::string_view next_cursor() const noexcept { return _next_cursor; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return _items.size(); }
+
+    [[nodiscard]] bool empty() const noexcept { return _items.empty(); }
+
+    /// @brief The item's details. Items that failed to load have a result other than k_EResultOK.
+    [[nodiscard]] const query_result_item& operator[](std::size_t index) const;
+
+    [[nodiscard]] std::string_view preview_url(std::size_t index) const;
+
+    // The fields below need the matching projection on the query, and are
+    // only available from a lazy set or a set read with that projection.
+    [[nodiscard]] std::string_view metadata(std::size_t index) const;
+
+    [[nodiscard]] result_span<query_result_tag> key_value_tags(std::size_t index) const;
+
+    [[nodiscard]] std::optional<uint64> statistic(std::size_t index, EItemStatistic statistic) const;
+
+    [[nodiscard]] result_span<PublishedFileId_t> children(std::size_t index) const;
+
+    [[nodiscard]] result_span<query_result_preview> additional_previews(std::size_t index) const;
+
+    [[nodiscard]] bool holds_handle() const noexcept;
+
+    /// @brief Gives the query handle back, fields not read yet stay empty.
+    void release() noexcept;
+
+    // Everything the set holds, items and arena blocks included.
+    [[nodiscard]] std::size_t bytes_reserved() const noexcept {
+        return sizeof(*this) + _items.capacity() * sizeof(query_result_item) +
+               _fields.capacity() * sizeof(lazy_fields) + _arena.bytes_reserved();
+    }
+};
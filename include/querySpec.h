@@ -0,0 +1,110 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamHelper.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+// ----------------------------------------------------------------------------
+// Reusable description of a UGC query, built once and executed any number of
+// times, each execution on a fresh handle.
+//
+// Copies share everything but the page or cursor, so stepping through pages
+// or handing the spec to other threads costs no deep copy. Const members only
+// read that shared, immutable part and are safe to call concurrently.
+//
+//     const query_spec spec = query_spec::all(k_EUGCQuery_RankedByTrend, k_EUGCMatchingUGCType_Items, app_id, app_id)
+//                                 .required_tag("Maps")
+//                                 .projection(projection_ids_only);
+//
+//     UGCQueryHandle_t handle = spec.with_page(3).create_handle(helper);
+class query_spec {
+
+private:
+    // Filters and flags, with the page and cursor left empty.
+    struct shared_state {
+        query_key key;
+        uint32 max_cache_age_seconds = 0;
+    };
+
+    std::shared_ptr<const shared_state> _shared;
+    uint32 _page = 1;
+    std::string _cursor;
+
+    // Copies the shared part first if another spec still uses it.
+    [[nodiscard]] shared_state& mutate();
+
+    query_spec() = default;
+
+public:
+    /// @brief Spec of an "All" query, paged by number unless a cursor is set.
+    [[nodiscard]] static query_spec all(EUGCQuery list_type, EUGCMatchingUGCType matching_type,
+                                        AppId_t creator_app_id, AppId_t consumer_app_id);
+
+    /// @brief Spec of a "User" query.
+    [[nodiscard]] static query_spec user(AccountID_t account_id, EUserUGCList list_type, EUGCMatchingUGCType matching_type,
+                                         EUserUGCListSortOrder sort_order, AppId_t creator_app_id, AppId_t consumer_app_id);
+
+    // ------------------------------------------------------------------------
+    // Filters and flags.
+    query_spec& required_tag(const char* tag);
+
+    query_spec& excluded_tag(const char* tag);
+
+    query_spec& match_any_tag(bool match_any);
+
+    query_spec& search_text(const std::string& text);
+
+    query_spec& cloud_filename_filter(const std::string& file_name);
+
+    query_spec& ranked_by_trend_days(uint32 days);
+
+    query_spec& created_between(RTime32 start, RTime32 end);
+
+    query_spec& long_description(bool enabled);
+
+    query_spec& total_only(bool enabled);
+
+    query_spec& projection(uint32 projection, uint32 playtime_stats_days = 0);
+
+    // Not part of the key, a cached response answers the same query.
+    query_spec& allow_cached_response(uint32 max_age_seconds);
+
+    // ------------------------------------------------------------------------
+    // Paging, without touching the shared part.
+    [[nodiscard]] query_spec with_page(uint32 page) const;
+
+    [[nodiscard]] query_spec with_cursor(std::string cursor) const;
+
+    [[nodiscard]] uint32 page() const noexcept { return _page; }
+
+    [[nodiscard]] const std::string& cursor() const noexcept { return _cursor; }
+
+    // ------------------------------------------------------------------------
+    // Identity, matching the key the helper records for the created handle.
+    [[nodiscard]] query_key key() const;
+
+    [[nodiscard]] std::size_t hash() const noexcept;
+
+    [[nodiscard]] bool operator==(const query_spec& other) const noexcept;
+
+    [[nodiscard]] bool operator!=(const query_spec& other) const noexcept { return !(*this == other); }
+
+    // ------------------------------------------------------------------------
+    // Execution.
+
+    /// @brief Creates a handle with every filter applied, ready to send.
+    /// @return The handle, k_UGCQueryHandleInvalid if Steam rejected any part of the spec.
+    [[nodiscard]] UGCQueryHandle_t create_handle(steam_helper& helper) const noexcept;
+};
+
+template <>
+struct std::hash<query_spec> {
+    std::size_t operator()(const query_spec& spec) const noexcept { return spec.hash(); }
+};
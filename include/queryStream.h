@@ -0,0 +1,137 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamHelper.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+// ----------------------------------------------------------------------------
+// Streaming, page by page walk over a UGC query.
+//
+// "All" queries page with Steam's cursor, "User" lists with page numbers.
+// While the consumer works on page N, page N + 1 is already in flight.
+//
+//     query_stream stream{helper, k_EUGCQuery_RankedByPublicationDate,
+//                         k_EUGCMatchingUGCType_Items, app_id, app_id};
+//
+//     for (const query_page& page : stream) { ... }
+class query_stream {
+
+public:
+    // Applies filters to the freshly created handle of every page, false aborts the walk.
+    using query_configurator = std::function<bool(steam_helper&, UGCQueryHandle_t)>;
+
+    static constexpr std::chrono::seconds default_page_timeout{240};
+
+private:
+    // ------------------------------------------------------------------------
+    // Shared with the in-flight completion, which may outlive the stream.
+    struct state {
+        std::mutex mutex;
+        std::optional<query_page> ready;
+        bool in_flight = false;
+    };
+
+    enum class query_kind { all, user };
+
+    // ------------------------------------------------------------------------
+    // Data members.
+    steam_helper& _helper;
+    query_kind _kind;
+    query_configurator _configure;
+
+    EUGCQuery _all_list_type = EUGCQuery::k_EUGCQuery_RankedByPublicationDate;
+    AccountID_t _account_id = 0;
+    EUserUGCList _user_list_type = EUserUGCList::k_EUserUGCList_Published;
+    EUserUGCListSortOrder _sort_order = EUserUGCListSortOrder::k_EUserUGCListSortOrder_CreationOrderDesc;
+    EUGCMatchingUGCType _matching_type;
+    AppId_t _creator_app_id;
+    AppId_t _consumer_app_id;
+
+    std::shared_ptr<state> _state;
+    std::string _cursor;
+    uint32_t _page_number;
+    uint32_t _pages_fetched;
+    uint32_t _max_pages;
+    bool _exhausted;
+    std::chrono::microseconds _page_timeout;
+
+    // ------------------------------------------------------------------------
+    // Paging utils.
+    [[nodiscard]] UGCQueryHandle_t create_page_query() noexcept;
+
+    bool request_next_page() noexcept;
+
+    void advance(const query_page& page) noexcept;
+
+public:
+    query_stream(steam_helper& helper, EUGCQuery list_type, EUGCMatchingUGCType matching_type,
+                 AppId_t creator_app_id, AppId_t consumer_app_id,
+                 query_configurator configure = {}, uint32_t max_pages = 0) noexcept;
+
+    query_stream(steam_helper& helper, AccountID_t account_id, EUserUGCList list_type,
+                 EUGCMatchingUGCType matching_type, EUserUGCListSortOrder sort_order,
+                 AppId_t creator_app_id, AppId_t consumer_app_id,
+                 query_configurator configure = {}, uint32_t max_pages = 0) noexcept;
+
+    query_stream(const query_stream&) = delete;
+    query_stream& operator=(const query_stream&) = delete;
+
+    /// @brief Blocks until the next page is available and prefetches the one after.
+    /// @return The page, std::nullopt once the listing is exhausted. A failed page
+    /// is returned once with its EResult and ends the walk.
+    [[nodiscard]] std::optional<query_page> next_page() noexcept;
+
+    [[nodiscard]] bool exhausted() const noexcept { return _exhausted; }
+
+    [[nodiscard]] uint32_t pages_fetched() const noexcept { return _pages_fetched; }
+
+    void set_page_timeout(std::chrono::microseconds timeout) noexcept { _page_timeout = timeout; }
+
+    // ------------------------------------------------------------------------
+    // Single pass input range over the pages.
+    class iterator {
+
+    private:
+        query_stream* _stream = nullptr;
+        std::optional<query_page> _page;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = query_page;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const query_page*;
+        using reference = const query_page&;
+
+        iterator() noexcept = default;
+
+        explicit iterator(query_stream& stream) noexcept : _stream{&stream}, _page{stream.next_page()} {}
+
+        reference operator*() const noexcept { return *_page; }
+
+        pointer operator->() const noexcept { return &*_page; }
+
+        iterator& operator++() noexcept {
+            _page = _stream->next_page();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const noexcept { return !_page.has_value() && !other._page.has_value(); }
+
+        bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+    };
+
+    [[nodiscard]] iterator begin() noexcept { return iterator{*this}; }
+
+    [[nodiscard]] iterator end() const noexcept { return iterator{}; }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// ----------------------------------------------------------------------------
+// How steam_helper retries calls failing with a retryable EResult.
+//
+// Delays grow exponentially from `initial_backoff` up to `max_backoff`, with
+// equal jitter: half the delay is fixed, the other half random, so clients
+// failing together do not retry together.
+struct retry_policy {
+    // Attempts per call, the first one included. 1 disables retries.
+    uint32_t max_attempts = 5;
+    std::chrono::milliseconds initial_backoff{500};
+    std::chrono::milliseconds max_backoff{30000};
+    double multiplier = 2.0;
+
+    // Every call issued earns `budget_ratio` retries, at most `budget_capacity`
+    // saved up. When Steam fails everything, retries stay a fraction of the
+    // traffic instead of multiplying it.
+    double budget_ratio = 0.2;
+    double budget_capacity = 20.0;
+
+    [[nodiscard]] static retry_policy disabled() noexcept {
+        retry_policy policy;
+        policy.max_attempts = 1;
+        return policy;
+    }
+
+    /// @brief Delay before the given retry, 1 for the first one.
+    /// @param unit Uniform random number in [0, 1) drawing the jitter.
+    [[nodiscard]] std::chrono::milliseconds backoff(uint32_t retry, double unit) const noexcept;
+};
+
+// ----------------------------------------------------------------------------
+// Token bucket of retries, shared by every call of a steam_helper. Starts full.
+class retry_budget {
+
+private:
+    mutable std::mutex _mutex;
+    double _tokens;
+    double _ratio;
+    double _capacity;
+
+public:
+    explicit retry_budget(const retry_policy& policy = {}) noexcept;
+
+    /// @brief Refills the bucket with the policy's capacity.
+    void reset(const retry_policy& policy) noexcept;
+
+    /// @brief Called for every call issued, earns a share of a retry.
+    void deposit() noexcept;
+
+    /// @brief Takes one retry, false when the budget is exhausted.
+    [[nodiscard]] bool try_withdraw() noexcept;
+
+    [[nodiscard]] double tokens() const noexcept;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// UGC backend, chosen at compile time.
+//
+// The wrapper talks to the Steamworks API surface directly (SteamAPI_Init,
+// SteamUGC(), CCallResult, ...), so the production build pays nothing for the
+// choice. Configuring with -DSTEAM_WRAPPER_BACKEND=simulator defines
+// STEAM_WRAPPER_SIMULATOR and swaps in a source compatible, in-process
+// simulator instead, which needs neither the SDK nor a Steam client.
+#if defined(STEAM_WRAPPER_SIMULATOR)
+#include "../include/steamSimulatorApi.h"
+#else
+#include <inttypes.h> // Steam libs need this.
+#include <steam_api.h>
+#endif
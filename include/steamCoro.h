@@ -0,0 +1,307 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// C++20 coroutine layer over steam_helper.
+//
+// Opt-in, build with -DSTEAM_WRAPPER_COROUTINES=ON and link `steam_wrapper_coro`.
+// Coroutines are resumed straight from the Steam callback dispatch: an
+// awaitable hands the helper a completion capturing only itself, so no
+// thread is blocked waiting on a call.
+#if !defined(__cpp_impl_coroutine)
+#error "steamCoro.h requires C++20 coroutine support"
+#endif
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamHelper.h"
+#include "../include/querySpec.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <atomic>
+
+namespace steam_coro {
+
+// ----------------------------------------------------------------------------
+// Lazily started task, resumes its awaiter through symmetric transfer.
+template <typename T>
+class task;
+
+namespace detail {
+
+struct final_awaitable {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        if (auto continuation = handle.promise().continuation) {
+            return continuation;
+        }
+
+        return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct promise_base {
+    std::coroutine_handle<> continuation;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    final_awaitable final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() const noexcept { std::terminate(); }
+};
+
+template <typename T>
+struct promise final : promise_base {
+    std::optional<T> value;
+
+    task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+};
+
+template <>
+struct promise<void> final : promise_base {
+    task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+};
+
+} // namespace detail
+
+template <typename T = void>
+class task {
+
+public:
+    using promise_type = detail::promise<T>;
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+
+public:
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept : _handle{handle} {}
+
+    task(task&& other) noexcept : _handle{std::exchange(other._handle, {})} {}
+
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+
+            _handle = std::exchange(other._handle, {});
+        }
+
+        return *this;
+    }
+
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    ~task() {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !_handle || _handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+
+    T await_resume() {
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*_handle.promise().value);
+        }
+    }
+};
+
+namespace detail {
+
+template <typename T>
+task<T> promise<T>::get_return_object() noexcept {
+    return task<T>{std::coroutine_handle<promise<T>>::from_promise(*this)};
+}
+
+inline task<void> promise<void>::get_return_object() noexcept {
+    return task<void>{std::coroutine_handle<promise<void>>::from_promise(*this)};
+}
+
+} // namespace detail
+
+// ----------------------------------------------------------------------------
+// Results.
+struct created_item {
+    EResult result;
+    PublishedFileId_t item_id;
+};
+
+struct submitted_item {
+    EResult result;
+    PublishedFileId_t item_id;
+};
+
+using query_page = ::query_page;
+
+// ----------------------------------------------------------------------------
+// Awaitables. They live in the awaiting coroutine frame until resumed.
+class create_item_awaitable {
+
+private:
+    steam_helper& _helper;
+    AppId_t _app_id;
+    created_item _result{EResult::k_EResultFail, 0};
+    std::coroutine_handle<> _awaiting;
+
+public:
+    create_item_awaitable(steam_helper& helper, const AppId_t app_id) noexcept : _helper{helper}, _app_id{app_id} {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept;
+
+    created_item await_resume() const noexcept { return _result; }
+};
+
+class query_awaitable {
+
+private:
+    steam_helper& _helper;
+    UGCQueryHandle_t _query_handle;
+    query_page _result;
+    std::coroutine_handle<> _awaiting;
+
+public:
+    query_awaitable(steam_helper& helper, const UGCQueryHandle_t query_handle) noexcept : _helper{helper}, _query_handle{query_handle} {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept;
+
+    query_page await_resume() noexcept { return std::move(_result); }
+};
+
+class submit_awaitable {
+
+private:
+    steam_helper& _helper;
+    UGCUpdateHandle_t _update_handle;
+    std::string _change_note;
+    submitted_item _result{EResult::k_EResultFail, 0};
+    std::coroutine_handle<> _awaiting;
+
+public:
+    submit_awaitable(steam_helper& helper, const UGCUpdateHandle_t update_handle, std::string change_note) noexcept
+        : _helper{helper}, _update_handle{update_handle}, _change_note{std::move(change_note)} {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept;
+
+    submitted_item await_resume() const noexcept { return _result; }
+};
+
+// ----------------------------------------------------------------------------
+// Awaitable facade over a steam_helper.
+//
+//     steam_coro::ugc helper{steam};
+//     const auto created = co_await helper.create_item(app_id);
+class ugc {
+
+private:
+    steam_helper& _helper;
+
+public:
+    explicit ugc(steam_helper& helper) noexcept : _helper{helper} {}
+
+    [[nodiscard]] create_item_awaitable create_item(const AppId_t app_id) const noexcept { return {_helper, app_id}; }
+
+    // Takes ownership of the query handle, it is released once the query completes.
+    [[nodiscard]] query_awaitable query(const UGCQueryHandle_t query_handle) const noexcept { return {_helper, query_handle}; }
+
+    // Runs the spec on a fresh handle, a spec Steam rejects resumes with a failed page.
+    [[nodiscard]] query_awaitable query(const query_spec& spec) const noexcept { return {_helper, spec.create_handle(_helper)}; }
+
+    [[nodiscard]] submit_awaitable submit(const UGCUpdateHandle_t update_handle, std::string change_note) const noexcept {
+        return {_helper, update_handle, std::move(change_note)};
+    }
+
+    [[nodiscard]] steam_helper& helper() const noexcept { return _helper; }
+};
+
+// ----------------------------------------------------------------------------
+// Small executor: owns spawned tasks until they complete and drives the
+// Steam callbacks itself when the helper's pump is not running.
+class executor {
+
+private:
+    steam_helper& _helper;
+    std::atomic<std::size_t> _active_tasks;
+
+    struct detached {
+        struct promise_type {
+            detached get_return_object() const noexcept { return {}; }
+
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+
+            std::suspend_never final_suspend() const noexcept { return {}; }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+
+    static detached run_detached(executor& self, task<void> work);
+
+    void on_task_done() noexcept;
+
+    template <typename T>
+    static task<void> store_result(task<T> work, std::optional<T>& result) {
+        result.emplace(co_await std::move(work));
+    }
+
+public:
+    explicit executor(steam_helper& helper) noexcept : _helper{helper}, _active_tasks{0} {}
+
+    executor(const executor&) = delete;
+    executor& operator=(const executor&) = delete;
+
+    ~executor() noexcept { run_until_idle(); }
+
+    /// @brief Starts a task, the executor keeps it alive until it completes.
+    void spawn(task<void> work);
+
+    /// @brief Runs until every spawned task has completed.
+    void run_until_idle() noexcept;
+
+    [[nodiscard]] std::size_t active_tasks() const noexcept { return _active_tasks.load(); }
+
+    /// @brief Runs a single task to completion and returns its result.
+    template <typename T>
+    [[nodiscard]] T run(task<T> work) {
+        if constexpr (std::is_void_v<T>) {
+            spawn(std::move(work));
+            run_until_idle();
+        } else {
+            std::optional<T> result;
+            spawn(store_result(std::move(work), result));
+            run_until_idle();
+            return std::move(*result);
+        }
+    }
+};
+
+} // namespace steam_coro
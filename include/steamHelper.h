@@ -2,8 +2,18 @@
 
 // ----------------------------------------------------------------------------
 // Steam includes.
-#include <inttypes.h> // Steam libs need this.
-#include <steam_api.h>
+#include "../include/steamApi.h"
+
+#include "../include/callScheduler.h"
+#include "../include/contentPack.h"
+#include "../include/contentStaging.h"
+#include "../include/logger.h"
+#include "../include/queryKey.h"
+#include "../include/queryResultSet.h"
+#include "../include/retryPolicy.h"
+#include "../include/steamMetrics.h"
+#include "../include/steamResult.h"
+#include "../include/uploadMonitor.h"
 
 // ----------------------------------------------------------------------------
 // Standard includes.
@@ -16,17 +26,22 @@
 #include <functional>
 #include <limits>
 #include <optional>
+#include <random>
 #include <variant>
 #include <string>
 #include <unordered_map>
 #include <filesystem>
 #include <iomanip>
 #include <cstdint>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <type_traits>
+#include <mutex>
+#include <condition_variable>
 
 // ----------------------------------------------------------------------------
 // Utilities.
-[[nodiscard]] std::ostream& log(const std::string_view category) noexcept;
-
 template <typename F>
 struct scope_guard : F
 {
@@ -52,11 +67,26 @@ template <typename T>
 
 [[nodiscard]] std::string read_string() noexcept;
 
+// One page of query results, owning copies of everything read from the handle.
+struct query_page {
+    EResult result = EResult::k_EResultFail;
+    uint32 num_returned = 0;
+    uint32 total_matching = 0;
+    std::string next_cursor;
+    std::vector<SteamUGCDetails_t> items;
+    std::vector<std::string> preview_urls;
+};
+
 class steam_helper {
 
 private:
     // ------------------------------------------------------------------------
     // Constants.
+    static constexpr std::chrono::microseconds default_pump_min_interval{1000};
+    static constexpr std::chrono::microseconds default_pump_max_interval{50000};
+
+    // Tags the placeholder keys of calls waiting in the scheduler, kept apart from Steam's.
+    static constexpr SteamAPICall_t deferred_call_bit = SteamAPICall_t{1} << 63;
 
     // ------------------------------------------------------------------------
     // Type aliases.
@@ -64,54 +94,278 @@ private:
     using submit_item_continuation = std::function<void()>;
     using submit_query_continuation = std::function<void(UGCQueryHandle_t)>;
 
-    typedef struct query_result {
-        SteamUGCDetails_t item_details;
-        char* image_url;
-    } query_result_t;
+    // Completions are invoked whatever the outcome, with the call's EResult.
+    using create_item_completion = std::function<void(EResult, PublishedFileId_t)>;
+    using submit_item_completion = std::function<void(EResult, PublishedFileId_t)>;
+    using query_completion = std::function<void(EResult, const SteamUGCQueryCompleted_t&)>;
+    // The result set owns the query handle and reads fields on demand.
+    using query_results_completion = std::function<void(EResult, std::shared_ptr<query_result_set>)>;
+
+    // ------------------------------------------------------------------------
+    // In-flight operations.
+    //
+    // Every Steam API call gets its own entry in the operation table, owning
+    // the call result registration and the continuation, so any number of
+    // operations of the same kind can be in flight at once.
+    //
+    // A call failing with a retryable EResult is issued again after a backoff,
+    // under its first SteamAPICall_t which stays the operation's identity.
+    // A call the scheduler holds back is registered under a placeholder key
+    // instead, and issued when it gets a token.
+    struct operation_base;
+
+    // Issues the call again, updating `ugc_handle` if it needs a new one.
+    using reissue_function = std::function<SteamAPICall_t(operation_base&)>;
+
+    struct operation_base {
+        steam_helper* helper = nullptr;
+        SteamAPICall_t api_call = k_uAPICallInvalid;
+        uint64 ugc_handle = 0; // Query or update handle the call works on, if any.
+        operation_kind kind = operation_kind::query;
+        std::chrono::steady_clock::time_point issued;
+        uint32_t attempt = 1;
+        call_priority priority = call_priority::interactive;
+        reissue_function deferred_issue; // First issue, while the scheduler holds the call back.
+        reissue_function reissue;        // Empty when the call cannot be retried.
+
+        virtual ~operation_base() = default;
+
+        // Issues the deferred call or the retry, or completes it with the failure if that fails.
+        virtual void issue_pending() noexcept = 0;
+    };
+
+    template <typename Result, typename Completion>
+    struct operation final : operation_base {
+        using handler = void (steam_helper::*)(operation&, Result*, bool);
+
+        CCallResult<operation, Result> call_result;
+        Completion completion;
+        handler on_completed = nullptr;
+
+        // Last failure, reported as is if the retry cannot be issued.
+        Result failed_result{};
+        bool failed_io = false;
+
+        operation() noexcept { failed_result.m_eResult = EResult::k_EResultFail; }
+
+        void on_result(Result* result, bool io_failure) {
+            const EResult rc = io_failure ? EResult::k_EResultIOFailure : result->m_eResult;
+            helper->record_completion(*this, rc);
+
+            if (helper->schedule_retry(*this, rc)) {
+                failed_io = io_failure;
+
+                if (!io_failure) {
+                    failed_result = *result;
+                }
+                return;
+            }
+
+            (helper->*on_completed)(*this, result, io_failure);
+        }
+
+        void issue_pending() noexcept override {
+            issued = std::chrono::steady_clock::now();
+
+            const SteamAPICall_t pending = deferred_issue ? deferred_issue(*this) : reissue(*this);
+            deferred_issue = nullptr;
+
+            if (pending != k_uAPICallInvalid) {
+                call_result.Set(pending, this, &operation::on_result);
+                return;
+            }
+
+            (helper->*on_completed)(*this, &failed_result, failed_io);
+        }
+    };
+
+    using create_item_operation = operation<CreateItemResult_t, create_item_completion>;
+    using submit_item_operation = operation<SubmitItemUpdateResult_t, submit_item_completion>;
+    using query_operation = operation<SteamUGCQueryCompleted_t, query_completion>;
+    using query_results_operation = operation<SteamUGCQueryCompleted_t, query_results_completion>;
+
+    template <typename Result>
+    [[nodiscard]] static constexpr operation_kind operation_kind_of() noexcept {
+        if constexpr (std::is_same_v<Result, CreateItemResult_t>) {
+            return operation_kind::create_item;
+        } else if constexpr (std::is_same_v<Result, SubmitItemUpdateResult_t>) {
+            return operation_kind::submit_item;
+        } else {
+            static_assert(std::is_same_v<Result, SteamUGCQueryCompleted_t>);
+            return operation_kind::query;
+        }
+    }
 
     // ------------------------------------------------------------------------
     // Data members.
     bool _initialized;
-    std::atomic<int> _pending_operations;
-    std::vector<query_result_t> _query_results;
+    // Its in-flight gauges double as the pending operation count the pump sleeps on.
+    steam_metrics _metrics;
+    std::atomic<uint64_t> _completed_operations;
+
+    // Background callback pump. `_pump_mutex` also guards the wake-ups of
+    // callers blocked in `run_callbacks_until` while it runs.
+    std::thread _pump_thread;
+    std::atomic<bool> _pump_running;
+    std::chrono::microseconds _pump_min_interval;
+    std::chrono::microseconds _pump_max_interval;
+    mutable std::mutex _pump_mutex;
+    std::condition_variable _pump_cv;
+    std::condition_variable _completion_cv;
+    uint64_t _pump_wakeups = 0; // Bumped under `_pump_mutex` whenever work is queued.
+
+    // Operation table. Completed entries are retired rather than destroyed in
+    // place, their call result is still on the stack while the handler runs.
+    mutable std::mutex _operations_mutex;
+    std::unordered_map<SteamAPICall_t, std::unique_ptr<operation_base>> _operations;
+    std::vector<std::unique_ptr<operation_base>> _retired_operations;
+
+    // Normalized keys of the queries being built, until their handle is released.
+    mutable std::mutex _query_keys_mutex;
+    std::unordered_map<UGCQueryHandle_t, query_key> _query_keys;
+
+    // Fields set on each update handle, replayed on a fresh handle to retry a submit.
+    struct item_update {
+        AppId_t app_id = 0;
+        PublishedFileId_t item_id = 0;
+        std::optional<std::string> title;
+        std::optional<std::string> description;
+        std::optional<std::filesystem::path> content;
+        std::optional<std::filesystem::path> preview;
+        std::optional<std::filesystem::path> staged; // Removed once the submit succeeded.
+    };
+
+    mutable std::mutex _item_updates_mutex;
+    std::unordered_map<UGCUpdateHandle_t, item_update> _item_updates;
+
+    // Retries waiting out their backoff, issued again by run_callbacks.
+    mutable std::mutex _retry_mutex;
+    retry_policy _retry_policy;
+    retry_budget _retry_budget;
+    std::mt19937_64 _retry_random{std::random_device{}()};
+    struct scheduled_retry {
+        std::chrono::steady_clock::time_point due;
+        SteamAPICall_t key;
+        operation_kind kind;
+        call_priority priority;
+    };
+
+    std::vector<scheduled_retry> _retry_queue;
+
+    // Rate limits every call issued, first attempts and retries alike.
+    call_scheduler _scheduler;
+    std::atomic<uint64_t> _next_deferred_call{0};
+
+    // Progress of the submitted updates, sampled by run_callbacks.
+    upload_monitor _uploads;
+
+    // Results of the last query sent with a legacy continuation, replaced by the next one.
+    mutable std::mutex _query_results_mutex;
+    std::shared_ptr<const query_result_set> _query_results;
+    // Backs the char* URLs get_query_results hands out.
+    std::shared_ptr<const query_result_set> _legacy_query_results;
 
-    CCallResult<steam_helper, CreateItemResult_t> _create_item_result;
-    create_item_continuation _create_item_continuation;
+    // ------------------------------------------------------------------------
+    // Initialization utils.
+    [[nodiscard]] static bool initialize_steamworks();
+
+    // ------------------------------------------------------------------------
+    // Operation table utils.
+    template <typename Result, typename Completion>
+    std::unique_ptr<operation<Result, Completion>> make_operation(const SteamAPICall_t key, const uint64 ugc_handle, Completion&& completion,
+                                                                  void (steam_helper::*on_completed)(operation<Result, Completion>&, Result*, bool),
+                                                                  reissue_function&& reissue) noexcept;
+
+    template <typename Result, typename Completion>
+    SteamAPICall_t register_operation(const SteamAPICall_t api_call, const uint64 ugc_handle, Completion&& completion,
+                                      void (steam_helper::*on_completed)(operation<Result, Completion>&, Result*, bool),
+                                      reissue_function&& reissue = {}) noexcept;
 
-    CCallResult<steam_helper, SubmitItemUpdateResult_t> _submit_item_result;
-    submit_item_continuation _submit_item_continuation;
+    // Issues the call now if the scheduler has a token for it, queues it otherwise.
+    // Returns the call, or the placeholder key of the queued operation.
+    template <typename Result, typename Completion, typename Issue>
+    SteamAPICall_t issue_operation(Issue&& issue, const uint64 ugc_handle, Completion&& completion,
+                                   void (steam_helper::*on_completed)(operation<Result, Completion>&, Result*, bool),
+                                   reissue_function&& reissue = {}) noexcept;
 
-    CCallResult<steam_helper, SteamUGCQueryCompleted_t> _submit_query_result;
-    submit_query_continuation _submit_query_continuation;
+    void retire_operation(const SteamAPICall_t api_call) noexcept;
+
+    void release_retired_operations() noexcept;
+
+    void record_completion(const operation_base& operation, const EResult rc) noexcept;
 
     // ------------------------------------------------------------------------
-    // Initialization utils.
-    [[nodiscard]] static bool initialize_steamworks();
+    // Retry utils.
+
+    // Queues the operation for a retry if the result, its attempts and the budget allow it.
+    [[nodiscard]] bool schedule_retry(operation_base& operation, const EResult rc) noexcept;
+
+    // Hands the retries done with their backoff to the scheduler, then issues what it lets through.
+    void issue_scheduled_calls() noexcept;
+
+    [[nodiscard]] std::optional<std::chrono::steady_clock::time_point> next_retry_due() const noexcept;
+
+    // Interrupts the pump's backoff sleep, so queued work is dispatched right away.
+    void wake_pump() noexcept;
+
+    [[nodiscard]] reissue_function query_reissue(const UGCQueryHandle_t query_handle) noexcept;
+
+    [[nodiscard]] reissue_function submit_reissue(const UGCUpdateHandle_t update_handle, const char* change_note) noexcept;
 
     // ------------------------------------------------------------------------
-    // Other utils.
-    [[nodiscard]] static constexpr std::string_view result_to_string(const EResult rc) noexcept;
+    // Query key utils.
+    template <typename F>
+    void record_query_key(const UGCQueryHandle_t query_handle, F&& update) noexcept;
+
+    template <typename F>
+    void record_item_update(const UGCUpdateHandle_t update_handle, F&& update) noexcept;
+
+    // Copy of the fields recorded for the handle, nullopt if it is unknown, logged as unable to `what`.
+    [[nodiscard]] std::optional<item_update> find_item_update(const UGCUpdateHandle_t update_handle, const char* what) const noexcept;
 
     // ------------------------------------------------------------------------
     // Steam API callback handlers.
-    void on_create_item(CreateItemResult_t* result, bool io_failure);
+    void on_create_item(create_item_operation& operation, CreateItemResult_t* result, bool io_failure);
 
-    void on_submit_item(SubmitItemUpdateResult_t* result, bool io_failure);
+    void on_submit_item(submit_item_operation& operation, SubmitItemUpdateResult_t* result, bool io_failure);
 
-    void on_query_completed(SteamUGCQueryCompleted_t* result, bool io_failure);
+    void on_query_completed(query_operation& operation, SteamUGCQueryCompleted_t* result, bool io_failure);
+
+    void on_query_results(query_results_operation& operation, SteamUGCQueryCompleted_t* result, bool io_failure);
+
+    // ------------------------------------------------------------------------
+    // Callback pump.
+    void pump_callbacks() noexcept;
 
 public:
 
     AppId_t app_id = 0;
     PublishedFileId_t item_id = 0;
 
-    steam_helper() noexcept : _initialized{initialize_steamworks()}, _pending_operations{0} {};
+    steam_helper() noexcept : _initialized{initialize_steamworks()}, _completed_operations{0},
+                              _pump_running{false}, _pump_min_interval{default_pump_min_interval},
+                              _pump_max_interval{default_pump_max_interval} {};
 
     ~steam_helper() noexcept;
 
+    /// @brief Name of the EResult, as spelled in the Steamworks headers.
+    [[nodiscard]] static std::string_view result_to_string(const EResult rc) noexcept;
+
+    // The URLs point into the last result set and stay valid until the next get_query_results call.
     void get_query_results(std::vector<SteamUGCDetails_t> &itemDetails, std::vector<char*> &previewImageURL) noexcept;
 
-    void create_workshop_item(create_item_continuation&& continuation) noexcept;
+    // Same, from the given set.
+    void get_query_results(std::shared_ptr<const query_result_set> results, std::vector<SteamUGCDetails_t> &itemDetails,
+                           std::vector<char*> &previewImageURL) noexcept;
+
+    [[nodiscard]] std::shared_ptr<const query_result_set> last_query_results() const noexcept;
+
+    SteamAPICall_t create_workshop_item(create_item_continuation&& continuation) noexcept;
+
+    SteamAPICall_t create_workshop_item(create_item_completion&& completion) noexcept;
+
+    // Same, for an app other than `app_id`.
+    SteamAPICall_t create_workshop_item(const AppId_t creator_app_id, create_item_completion&& completion) noexcept;
     
     void create_user_query(UGCQueryHandle_t &query_handle, AccountID_t accountID,
                         EUserUGCList listType, EUGCMatchingUGCType matchingType,
@@ -122,6 +376,12 @@ public:
                         EUGCQuery listType, EUGCMatchingUGCType matchingType,
                         AppId_t creatorAppID, AppId_t consumerAppID,
                         uint32_t page) noexcept;
+
+    // Cursor based paging, "*" requests the first page.
+    void create_all_query(UGCQueryHandle_t &query_handle,
+                        EUGCQuery listType, EUGCMatchingUGCType matchingType,
+                        AppId_t creatorAppID, AppId_t consumerAppID,
+                        const std::string& cursor) noexcept;
     
     [[nodiscard]] bool set_cloud_filename_filter(const UGCQueryHandle_t query_handle, const char* match_cloud_name) noexcept;
 
@@ -131,6 +391,8 @@ public:
 
     [[nodiscard]] bool set_ranked_by_trend_days(const UGCQueryHandle_t query_handle, const uint32 unDays) noexcept;
 
+    [[nodiscard]] bool set_time_created_date_range(const UGCQueryHandle_t query_handle, const RTime32 start, const RTime32 end) noexcept;
+
     [[nodiscard]] bool add_required_tag(const UGCQueryHandle_t query_handle, const char* tagName) noexcept;
 
     [[nodiscard]] bool add_excluded_tag(const UGCQueryHandle_t query_handle, const char* tagName) noexcept;
@@ -141,13 +403,46 @@ public:
 
     [[nodiscard]] bool allow_cached_response(const UGCQueryHandle_t query_handle, const uint32 maxAgeSeconds) noexcept;
 
-    void send_query_request(UGCQueryHandle_t query_handle, submit_query_continuation&& continuation) noexcept;
+    /// @brief Selects the fields the query returns, a mask of query_projection values.
+    /// @param playtime_stats_days Window of the playtime statistics, with projection_playtime_stats.
+    [[nodiscard]] bool set_projection(const UGCQueryHandle_t query_handle, const uint32 projection, const uint32 playtime_stats_days = 0) noexcept;
+
+    SteamAPICall_t send_query_request(UGCQueryHandle_t query_handle, submit_query_continuation&& continuation) noexcept;
+
+    SteamAPICall_t send_query_request(UGCQueryHandle_t query_handle, query_completion&& completion) noexcept;
+
+    SteamAPICall_t send_query_request(UGCQueryHandle_t query_handle, query_results_completion&& completion) noexcept;
+
+    [[nodiscard]] bool get_query_result(const UGCQueryHandle_t query_handle, const uint32 index,
+                                        SteamUGCDetails_t& item_details, std::string& preview_url) noexcept;
+
+    void read_query_page(const EResult rc, const SteamUGCQueryCompleted_t& completed, query_page& page) noexcept;
 
     void release_query_handle(UGCQueryHandle_t query_handle) noexcept;
 
+    [[nodiscard]] std::optional<query_key> get_query_key(const UGCQueryHandle_t query_handle) const noexcept;
+
+    /// @brief Creates a handle matching the key, every filter applied, ready to send.
+    /// @return The handle, k_UGCQueryHandleInvalid if Steam rejected any part of the key.
+    [[nodiscard]] UGCQueryHandle_t create_query_handle(const query_key& key, const uint32 max_cache_age_seconds = 0) noexcept;
+
     [[nodiscard]] std::optional<UGCUpdateHandle_t> start_workshop_item_update(const PublishedFileId_t item_id) noexcept;
+
+    [[nodiscard]] std::optional<UGCUpdateHandle_t> start_workshop_item_update(const AppId_t consumer_app_id, const PublishedFileId_t item_id) noexcept;
     
     bool set_workshop_item_content(const UGCUpdateHandle_t update_handle, const std::filesystem::path& directory_path) noexcept;
+
+    /// @brief Sets the content to the selected files of `source`, linked into `<staging_root>/<app>-<item>`
+    /// rather than copied. A staging folder left by a failed submit is brought up to date, a successful one removes it.
+    bool stage_workshop_item_content(const UGCUpdateHandle_t update_handle, const std::filesystem::path& source,
+                                     const std::filesystem::path& staging_root, const staging_rules& rules = {},
+                                     const staging_options& options = {}) noexcept;
+
+    /// @brief Sets the content to one pack of the selected files of `source`, `<staging_root>/<app>-<item>/content.swpk`,
+    /// for items of many small files. Installed, it is read with content_pack. A successful submit removes it.
+    bool pack_workshop_item_content(const UGCUpdateHandle_t update_handle, const std::filesystem::path& source,
+                                    const std::filesystem::path& staging_root, const staging_rules& rules = {},
+                                    const pack_options& options = {}) noexcept;
     
     bool set_workshop_item_description(const UGCUpdateHandle_t update_handle, const std::string& description) noexcept;
 
@@ -155,20 +450,64 @@ public:
 
     bool set_workshop_item_title(const UGCUpdateHandle_t update_handle, const std::string title) noexcept;
 
-    void submit_item_update(const UGCUpdateHandle_t handle, const char* change_note, submit_item_continuation&& continuation) noexcept;
+    SteamAPICall_t submit_item_update(const UGCUpdateHandle_t handle, const char* change_note, submit_item_continuation&& continuation) noexcept;
 
+    SteamAPICall_t submit_item_update(const UGCUpdateHandle_t handle, const char* change_note, submit_item_completion&& completion) noexcept;
+
+    /// @return true while Steam reports the update in progress, whatever its phase.
     bool get_item_upload_progress(const UGCUpdateHandle_t update_handle, uint64_t *Processed, uint64_t *Total) noexcept;
 
+    /// @brief Phase of the update and bytes of the file uploading, k_EItemUpdateStatusInvalid when none. Follows the update
+    /// onto the handle a retry submitted it again on.
+    [[nodiscard]] EItemUpdateStatus get_item_upload_status(const UGCUpdateHandle_t update_handle, uint64_t& processed, uint64_t& total) noexcept;
+
     bool run_callbacks() noexcept;
 
+    void start_callback_pump(std::chrono::microseconds min_interval = default_pump_min_interval,
+                             std::chrono::microseconds max_interval = default_pump_max_interval) noexcept;
+
+    void stop_callback_pump() noexcept;
+
+    [[nodiscard]] bool callback_pump_running() const noexcept;
+
+    [[nodiscard]] bool wait_for_pending_operations(std::chrono::microseconds timeout) noexcept;
+
+    [[nodiscard]] bool run_callbacks_until(const std::function<bool()>& done, std::chrono::microseconds timeout) noexcept;
+
+    [[nodiscard]] uint64_t completed_operations() const noexcept;
+
+    /// @brief Applies to the calls failing from now on, and refills the retry budget.
+    void set_retry_policy(const retry_policy& policy) noexcept;
+
+    [[nodiscard]] retry_policy get_retry_policy() const noexcept;
+
     [[nodiscard]] bool unsubscribe_item(PublishedFileId_t item_id) noexcept;
 
     [[nodiscard]] bool initialized() const noexcept;
 
     [[nodiscard]] bool any_pending_operation() const noexcept;
 
-    void add_pending_operation() noexcept;
+    [[nodiscard]] std::size_t in_flight_operations() const noexcept;
+
+    [[nodiscard]] bool is_operation_in_flight(const SteamAPICall_t api_call) const noexcept;
+
+    void add_pending_operation(const operation_kind kind) noexcept;
+
+    void remove_pending_operation(const operation_kind kind) noexcept;
+
+    /// @brief Latency histograms, in-flight gauges and EResult counters of the calls issued so far.
+    [[nodiscard]] const steam_metrics& metrics() const noexcept;
+
+    [[nodiscard]] steam_metrics& metrics() noexcept;
+
+    /// @brief Client-side rate limits of the outgoing calls, configure() to change them.
+    [[nodiscard]] const call_scheduler& scheduler() const noexcept;
+
+    [[nodiscard]] call_scheduler& scheduler() noexcept;
+
+    /// @brief Progress of every submitted update, subscribe() to follow them without polling.
+    [[nodiscard]] const upload_monitor& uploads() const noexcept;
 
-    void remove_pending_operation() noexcept;
+    [[nodiscard]] upload_monitor& uploads() noexcept;
 
 };
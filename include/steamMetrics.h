@@ -0,0 +1,185 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Operation metrics.
+//
+// Every asynchronous Steam call is accounted to an operation kind: an in-flight
+// gauge, the EResult it completed with and its latency, from being issued to
+// its call result being dispatched. Recording is a handful of relaxed atomic
+// increments, reading takes a snapshot and never blocks the recorders.
+enum class operation_kind : uint8_t { create_item, submit_item, query };
+
+inline constexpr std::size_t operation_kind_count = 3;
+
+[[nodiscard]] std::string_view operation_kind_name(operation_kind kind) noexcept;
+
+// ----------------------------------------------------------------------------
+// Log-linear latency histogram in microseconds, in the spirit of HdrHistogram:
+// values below 32 are exact, above that every power of two is split in 32
+// buckets, so any recorded value is reported within about 3%. Covers up to
+// 2^40 us (12 days), larger values are clamped.
+class latency_histogram {
+
+public:
+    static constexpr unsigned sub_bucket_bits = 5;
+    static constexpr uint64_t sub_bucket_count = uint64_t{1} << sub_bucket_bits;
+    static constexpr unsigned max_value_bits = 40;
+    static constexpr std::size_t bucket_count = (max_value_bits - sub_bucket_bits + 1) * sub_bucket_count;
+    static constexpr uint64_t max_value = (uint64_t{1} << max_value_bits) - 1;
+
+    // Point in time copy, consistent enough for reporting.
+    struct snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        std::vector<uint64_t> buckets;
+
+        [[nodiscard]] double mean() const noexcept;
+
+        /// @brief Highest value equivalent to the q-th quantile, q in [0, 1]; 0 when empty.
+        [[nodiscard]] uint64_t percentile(double q) const noexcept;
+    };
+
+private:
+    // 9KB a histogram, kept off the owner's stack.
+    std::unique_ptr<std::atomic<uint64_t>[]> _buckets;
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _min{UINT64_MAX};
+    std::atomic<uint64_t> _max{0};
+
+public:
+    latency_histogram();
+
+    [[nodiscard]] static std::size_t bucket_index(uint64_t value) noexcept;
+
+    // Highest value landing in the bucket.
+    [[nodiscard]] static uint64_t bucket_upper_bound(std::size_t index) noexcept;
+
+    void record(uint64_t value) noexcept;
+
+    void record(const std::chrono::microseconds duration) noexcept {
+        record(static_cast<uint64_t>(std::max<std::chrono::microseconds::rep>(duration.count(), 0)));
+    }
+
+    [[nodiscard]] snapshot read() const;
+
+    void reset() noexcept;
+};
+
+// ----------------------------------------------------------------------------
+// Counters of one steam_helper.
+class steam_metrics {
+
+public:
+    // EResult values at or past this one are counted as "other".
+    static constexpr std::size_t result_capacity = 128;
+
+    struct operation_snapshot {
+        operation_kind kind = operation_kind::create_item;
+        int64_t in_flight = 0;
+        uint64_t issued = 0;
+        uint64_t completed = 0;
+        // Calls Steam refused to issue, they never went in flight.
+        uint64_t issue_failures = 0;
+        // Retryable failures issued again, and those the retry budget turned down.
+        uint64_t retries = 0;
+        uint64_t retries_denied = 0;
+        // Non zero EResult counts, in EResult order.
+        std::vector<std::pair<EResult, uint64_t>> results;
+        uint64_t other_results = 0;
+        latency_histogram::snapshot latency;
+    };
+
+    struct snapshot {
+        std::array<operation_snapshot, operation_kind_count> operations;
+        uint64_t callback_runs = 0;
+        uint64_t pump_iterations = 0;
+        uint64_t wait_timeouts = 0;
+    };
+
+private:
+    struct operation_counters {
+        std::atomic<int64_t> in_flight{0};
+        std::atomic<uint64_t> issued{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> issue_failures{0};
+        std::atomic<uint64_t> retries{0};
+        std::atomic<uint64_t> retries_denied{0};
+        std::array<std::atomic<uint64_t>, result_capacity> results{};
+        std::atomic<uint64_t> other_results{0};
+        latency_histogram latency;
+    };
+
+    std::array<operation_counters, operation_kind_count> _operations;
+    std::atomic<int64_t> _in_flight{0};
+    std::atomic<uint64_t> _callback_runs{0};
+    std::atomic<uint64_t> _pump_iterations{0};
+    std::atomic<uint64_t> _wait_timeouts{0};
+
+    [[nodiscard]] operation_counters& counters(const operation_kind kind) noexcept { return _operations[static_cast<std::size_t>(kind)]; }
+
+    [[nodiscard]] const operation_counters& counters(const operation_kind kind) const noexcept {
+        return _operations[static_cast<std::size_t>(kind)];
+    }
+
+public:
+    // ------------------------------------------------------------------------
+    // Recording.
+    void operation_issued(operation_kind kind) noexcept;
+
+    void operation_finished(operation_kind kind) noexcept;
+
+    void issue_failed(operation_kind kind) noexcept;
+
+    void operation_completed(operation_kind kind, EResult result, std::chrono::microseconds latency) noexcept;
+
+    void operation_retried(const operation_kind kind) noexcept { counters(kind).retries.fetch_add(1, std::memory_order_relaxed); }
+
+    void retry_denied(const operation_kind kind) noexcept { counters(kind).retries_denied.fetch_add(1, std::memory_order_relaxed); }
+
+    void callback_run() noexcept { _callback_runs.fetch_add(1, std::memory_order_relaxed); }
+
+    void pump_iteration() noexcept { _pump_iterations.fetch_add(1, std::memory_order_relaxed); }
+
+    void wait_timed_out() noexcept { _wait_timeouts.fetch_add(1, std::memory_order_relaxed); }
+
+    // ------------------------------------------------------------------------
+    // Reading.
+    [[nodiscard]] int64_t in_flight() const noexcept { return _in_flight.load(); }
+
+    [[nodiscard]] int64_t in_flight(const operation_kind kind) const noexcept { return counters(kind).in_flight.load(); }
+
+    [[nodiscard]] uint64_t result_count(operation_kind kind, EResult result) const noexcept;
+
+    [[nodiscard]] snapshot read() const;
+
+    /// @brief Clears the counters and histograms, the in-flight gauges are kept.
+    void reset() noexcept;
+
+    /// @brief Prometheus text exposition: latencies as summaries in seconds,
+    /// results and pump activity as counters, in-flight operations as gauges.
+    [[nodiscard]] std::string to_prometheus() const;
+
+    /// @brief The same as a JSON object, latencies in microseconds.
+    [[nodiscard]] std::string to_json() const;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// ----------------------------------------------------------------------------
+// EResult taxonomy.
+//
+// Retryable results are the transient ones: Steam or the connection to it was
+// busy, throttled or briefly unreachable, and the same call may succeed later.
+// Everything else is fatal, retrying would fail the same way. That includes
+// k_EResultLimitExceeded, a quota or size limit (file too large, too many items)
+// rather than throttling, which is k_EResultRateLimitExceeded.
+enum class result_class : uint8_t { success, retryable, fatal };
+
+struct result_info {
+    EResult code = EResult::k_EResultNone;
+    std::string_view name = "unknown EResult value";
+    result_class category = result_class::fatal;
+};
+
+namespace steam_result_detail {
+
+    // In EResult order, as spelled in the Steamworks headers.
+    inline constexpr result_info known_results[] = {
+    {EResult::k_EResultNone, "EResult::k_EResultNone", result_class::fatal},
+    {EResult::k_EResultOK, "EResult::k_EResultOK", result_class::success},
+    {EResult::k_EResultFail, "EResult::k_EResultFail", result_class::fatal},
+    {EResult::k_EResultNoConnection, "EResult::k_EResultNoConnection", result_class::retryable},
+    {EResult::k_EResultInvalidPassword, "EResult::k_EResultInvalidPassword", result_class::fatal},
+    {EResult::k_EResultLoggedInElsewhere, "EResult::k_EResultLoggedInElsewhere", result_class::fatal},
+    {EResult::k_EResultInvalidProtocolVer, "EResult::k_EResultInvalidProtocolVer", result_class::fatal},
+    {EResult::k_EResultInvalidParam, "EResult::k_EResultInvalidParam", result_class::fatal},
+    {EResult::k_EResultFileNotFound, "EResult::k_EResultFileNotFound", result_class::fatal},
+    {EResult::k_EResultBusy, "EResult::k_EResultBusy", result_class::retryable},
+    {EResult::k_EResultInvalidState, "EResult::k_EResultInvalidState", result_class::fatal},
+    {EResult::k_EResultInvalidName, "EResult::k_EResultInvalidName", result_class::fatal},
+    {EResult::k_EResultInvalidEmail, "EResult::k_EResultInvalidEmail", result_class::fatal},
+    {EResult::k_EResultDuplicateName, "EResult::k_EResultDuplicateName", result_class::fatal},
+    {EResult::k_EResultAccessDenied, "EResult::k_EResultAccessDenied", result_class::fatal},
+    {EResult::k_EResultTimeout, "EResult::k_EResultTimeout", result_class::retryable},
+    {EResult::k_EResultBanned, "EResult::k_EResultBanned", result_class::fatal},
+    {EResult::k_EResultAccountNotFound, "EResult::k_EResultAccountNotFound", result_class::fatal},
+    {EResult::k_EResultInvalidSteamID, "EResult::k_EResultInvalidSteamID", result_class::fatal},
+    {EResult::k_EResultServiceUnavailable, "EResult::k_EResultServiceUnavailable", result_class::retryable},
+    {EResult::k_EResultNotLoggedOn, "EResult::k_EResultNotLoggedOn", result_class::retryable},
+    {EResult::k_EResultPending, "EResult::k_EResultPending", result_class::retryable},
+    {EResult::k_EResultEncryptionFailure, "EResult::k_EResultEncryptionFailure", result_class::fatal},
+    {EResult::k_EResultInsufficientPrivilege, "EResult::k_EResultInsufficientPrivilege", result_class::fatal},
+    {EResult::k_EResultLimitExceeded, "EResult::k_EResultLimitExceeded", result_class::fatal},
+    {EResult::k_EResultRevoked, "EResult::k_EResultRevoked", result_class::fatal},
+    {EResult::k_EResultExpired, "EResult::k_EResultExpired", result_class::fatal},
+    {EResult::k_EResultAlreadyRedeemed, "EResult::k_EResultAlreadyRedeemed", result_class::fatal},
+    {EResult::k_EResultDuplicateRequest, "EResult::k_EResultDuplicateRequest", result_class::fatal},
+    {EResult::k_EResultAlreadyOwned, "EResult::k_EResultAlreadyOwned", result_class::fatal},
+    {EResult::k_EResultIPNotFound, "EResult::k_EResultIPNotFound", result_class::fatal},
+    {EResult::k_EResultPersistFailed, "EResult::k_EResultPersistFailed", result_class::retryable},
+    {EResult::k_EResultLockingFailed, "EResult::k_EResultLockingFailed", result_class::retryable},
+    {EResult::k_EResultLogonSessionReplaced, "EResult::k_EResultLogonSessionReplaced", result_class::fatal},
+    {EResult::k_EResultConnectFailed, "EResult::k_EResultConnectFailed", result_class::retryable},
+    {EResult::k_EResultHandshakeFailed, "EResult::k_EResultHandshakeFailed", result_class::retryable},
+    {EResult::k_EResultIOFailure, "EResult::k_EResultIOFailure", result_class::retryable},
+    {EResult::k_EResultRemoteDisconnect, "EResult::k_EResultRemoteDisconnect", result_class::retryable},
+    {EResult::k_EResultShoppingCartNotFound, "EResult::k_EResultShoppingCartNotFound", result_class::fatal},
+    {EResult::k_EResultBlocked, "EResult::k_EResultBlocked", result_class::fatal},
+    {EResult::k_EResultIgnored, "EResult::k_EResultIgnored", result_class::fatal},
+    {EResult::k_EResultNoMatch, "EResult::k_EResultNoMatch", result_class::fatal},
+    {EResult::k_EResultAccountDisabled, "EResult::k_EResultAccountDisabled", result_class::fatal},
+    {EResult::k_EResultServiceReadOnly, "EResult::k_EResultServiceReadOnly", result_class::retryable},
+    {EResult::k_EResultAccountNotFeatured, "EResult::k_EResultAccountNotFeatured", result_class::fatal},
+    {EResult::k_EResultAdministratorOK, "EResult::k_EResultAdministratorOK", result_class::fatal},
+    {EResult::k_EResultContentVersion, "EResult::k_EResultContentVersion", result_class::fatal},
+    {EResult::k_EResultTryAnotherCM, "EResult::k_EResultTryAnotherCM", result_class::retryable},
+    {EResult::k_EResultPasswordRequiredToKickSession, "EResult::k_EResultPasswordRequiredToKickSession", result_class::fatal},
+    {EResult::k_EResultAlreadyLoggedInElsewhere, "EResult::k_EResultAlreadyLoggedInElsewhere", result_class::fatal},
+    {EResult::k_EResultSuspended, "EResult::k_EResultSuspended", result_class::fatal},
+    {EResult::k_EResultCancelled, "EResult::k_EResultCancelled", result_class::fatal},
+    {EResult::k_EResultDataCorruption, "EResult::k_EResultDataCorruption", result_class::fatal},
+    {EResult::k_EResultDiskFull, "EResult::k_EResultDiskFull", result_class::fatal},
+    {EResult::k_EResultRemoteCallFailed, "EResult::k_EResultRemoteCallFailed", result_class::retryable},
+    {EResult::k_EResultPasswordUnset, "EResult::k_EResultPasswordUnset", result_class::fatal},
+    {EResult::k_EResultExternalAccountUnlinked, "EResult::k_EResultExternalAccountUnlinked", result_class::fatal},
+    {EResult::k_EResultPSNTicketInvalid, "EResult::k_EResultPSNTicketInvalid", result_class::fatal},
+    {EResult::k_EResultExternalAccountAlreadyLinked, "EResult::k_EResultExternalAccountAlreadyLinked", result_class::fatal},
+    {EResult::k_EResultRemoteFileConflict, "EResult::k_EResultRemoteFileConflict", result_class::fatal},
+    {EResult::k_EResultIllegalPassword, "EResult::k_EResultIllegalPassword", result_class::fatal},
+    {EResult::k_EResultSameAsPreviousValue, "EResult::k_EResultSameAsPreviousValue", result_class::fatal},
+    {EResult::k_EResultAccountLogonDenied, "EResult::k_EResultAccountLogonDenied", result_class::fatal},
+    {EResult::k_EResultCannotUseOldPassword, "EResult::k_EResultCannotUseOldPassword", result_class::fatal},
+    {EResult::k_EResultInvalidLoginAuthCode, "EResult::k_EResultInvalidLoginAuthCode", result_class::fatal},
+    {EResult::k_EResultAccountLogonDeniedNoMail, "EResult::k_EResultAccountLogonDeniedNoMail", result_class::fatal},
+    {EResult::k_EResultHardwareNotCapableOfIPT, "EResult::k_EResultHardwareNotCapableOfIPT", result_class::fatal},
+    {EResult::k_EResultIPTInitError, "EResult::k_EResultIPTInitError", result_class::fatal},
+    {EResult::k_EResultParentalControlRestricted, "EResult::k_EResultParentalControlRestricted", result_class::fatal},
+    {EResult::k_EResultFacebookQueryError, "EResult::k_EResultFacebookQueryError", result_class::fatal},
+    {EResult::k_EResultExpiredLoginAuthCode, "EResult::k_EResultExpiredLoginAuthCode", result_class::fatal},
+    {EResult::k_EResultIPLoginRestrictionFailed, "EResult::k_EResultIPLoginRestrictionFailed", result_class::fatal},
+    {EResult::k_EResultAccountLockedDown, "EResult::k_EResultAccountLockedDown", result_class::fatal},
+    {EResult::k_EResultAccountLogonDeniedVerifiedEmailRequired, "EResult::k_EResultAccountLogonDeniedVerifiedEmailRequired", result_class::fatal},
+    {EResult::k_EResultNoMatchingURL, "EResult::k_EResultNoMatchingURL", result_class::fatal},
+    {EResult::k_EResultBadResponse, "EResult::k_EResultBadResponse", result_class::fatal},
+    {EResult::k_EResultRequirePasswordReEntry, "EResult::k_EResultRequirePasswordReEntry", result_class::fatal},
+    {EResult::k_EResultValueOutOfRange, "EResult::k_EResultValueOutOfRange", result_class::fatal},
+    {EResult::k_EResultUnexpectedError, "EResult::k_EResultUnexpectedError", result_class::fatal},
+    {EResult::k_EResultDisabled, "EResult::k_EResultDisabled", result_class::fatal},
+    {EResult::k_EResultInvalidCEGSubmission, "EResult::k_EResultInvalidCEGSubmission", result_class::fatal},
+    {EResult::k_EResultRestrictedDevice, "EResult::k_EResultRestrictedDevice", result_class::fatal},
+    {EResult::k_EResultRegionLocked, "EResult::k_EResultRegionLocked", result_class::fatal},
+    {EResult::k_EResultRateLimitExceeded, "EResult::k_EResultRateLimitExceeded", result_class::retryable},
+    {EResult::k_EResultAccountLoginDeniedNeedTwoFactor, "EResult::k_EResultAccountLoginDeniedNeedTwoFactor", result_class::fatal},
+    {EResult::k_EResultItemDeleted, "EResult::k_EResultItemDeleted", result_class::fatal},
+    {EResult::k_EResultAccountLoginDeniedThrottle, "EResult::k_EResultAccountLoginDeniedThrottle", result_class::fatal},
+    {EResult::k_EResultTwoFactorCodeMismatch, "EResult::k_EResultTwoFactorCodeMismatch", result_class::fatal},
+    {EResult::k_EResultTwoFactorActivationCodeMismatch, "EResult::k_EResultTwoFactorActivationCodeMismatch", result_class::fatal},
+    {EResult::k_EResultAccountAssociatedToMultiplePartners, "EResult::k_EResultAccountAssociatedToMultiplePartners", result_class::fatal},
+    {EResult::k_EResultNotModified, "EResult::k_EResultNotModified", result_class::fatal},
+    {EResult::k_EResultNoMobileDevice, "EResult::k_EResultNoMobileDevice", result_class::fatal},
+    {EResult::k_EResultTimeNotSynced, "EResult::k_EResultTimeNotSynced", result_class::fatal},
+    {EResult::k_EResultSmsCodeFailed, "EResult::k_EResultSmsCodeFailed", result_class::fatal},
+    {EResult::k_EResultAccountLimitExceeded, "EResult::k_EResultAccountLimitExceeded", result_class::fatal},
+    {EResult::k_EResultAccountActivityLimitExceeded, "EResult::k_EResultAccountActivityLimitExceeded", result_class::fatal},
+    {EResult::k_EResultPhoneActivityLimitExceeded, "EResult::k_EResultPhoneActivityLimitExceeded", result_class::fatal},
+    {EResult::k_EResultRefundToWallet, "EResult::k_EResultRefundToWallet", result_class::fatal},
+    {EResult::k_EResultEmailSendFailure, "EResult::k_EResultEmailSendFailure", result_class::fatal},
+    {EResult::k_EResultNotSettled, "EResult::k_EResultNotSettled", result_class::fatal},
+    {EResult::k_EResultNeedCaptcha, "EResult::k_EResultNeedCaptcha", result_class::fatal},
+    {EResult::k_EResultGSLTDenied, "EResult::k_EResultGSLTDenied", result_class::fatal},
+    {EResult::k_EResultGSOwnerDenied, "EResult::k_EResultGSOwnerDenied", result_class::fatal},
+    {EResult::k_EResultInvalidItemType, "EResult::k_EResultInvalidItemType", result_class::fatal},
+    {EResult::k_EResultIPBanned, "EResult::k_EResultIPBanned", result_class::fatal},
+    {EResult::k_EResultGSLTExpired, "EResult::k_EResultGSLTExpired", result_class::fatal},
+    {EResult::k_EResultInsufficientFunds, "EResult::k_EResultInsufficientFunds", result_class::fatal},
+    {EResult::k_EResultTooManyPending, "EResult::k_EResultTooManyPending", result_class::retryable},
+    {EResult::k_EResultNoSiteLicensesFound, "EResult::k_EResultNoSiteLicensesFound", result_class::fatal},
+    {EResult::k_EResultWGNetworkSendExceeded, "EResult::k_EResultWGNetworkSendExceeded", result_class::fatal},
+    {EResult::k_EResultAccountNotFriends, "EResult::k_EResultAccountNotFriends", result_class::fatal},
+    {EResult::k_EResultLimitedUserAccount, "EResult::k_EResultLimitedUserAccount", result_class::fatal},
+    {EResult::k_EResultCantRemoveItem, "EResult::k_EResultCantRemoveItem", result_class::fatal},
+    {EResult::k_EResultAccountDeleted, "EResult::k_EResultAccountDeleted", result_class::fatal},
+    {EResult::k_EResultExistingUserCancelledLicense, "EResult::k_EResultExistingUserCancelledLicense", result_class::fatal},
+    {EResult::k_EResultCommunityCooldown, "EResult::k_EResultCommunityCooldown", result_class::fatal},
+    };
+
+    inline constexpr std::size_t table_size = static_cast<std::size_t>(EResult::k_EResultCommunityCooldown) + 1;
+
+    // Indexed by value, holes and unknown values keep the defaults.
+    inline constexpr std::array<result_info, table_size> results_by_value = [] {
+        std::array<result_info, table_size> table{};
+
+        for (std::size_t i = 0; i < table_size; ++i) {
+            table[i].code = static_cast<EResult>(i);
+        }
+
+        for (const result_info& info : known_results) {
+            table[static_cast<std::size_t>(info.code)] = info;
+        }
+
+        return table;
+    }();
+
+} // namespace steam_result_detail
+
+[[nodiscard]] constexpr result_info describe_result(const EResult rc) noexcept {
+    const auto index = static_cast<std::size_t>(rc);
+
+    if (index < steam_result_detail::table_size) {
+        return steam_result_detail::results_by_value[index];
+    }
+
+    return {rc, result_info{}.name, result_class::fatal};
+}
+
+[[nodiscard]] constexpr result_class classify_result(const EResult rc) noexcept { return describe_result(rc).category; }
+
+[[nodiscard]] constexpr bool is_retryable_result(const EResult rc) noexcept { return classify_result(rc) == result_class::retryable; }
+
+static_assert(classify_result(EResult::k_EResultOK) == result_class::success);
+static_assert(is_retryable_result(EResult::k_EResultBusy) && is_retryable_result(EResult::k_EResultRateLimitExceeded));
+static_assert(!is_retryable_result(EResult::k_EResultAccessDenied) && !is_retryable_result(EResult::k_EResultLimitExceeded));
@@ -0,0 +1,90 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Control surface of the in-process Steam simulator.
+//
+// Only available with -DSTEAM_WRAPPER_BACKEND=simulator. The simulator
+// answers the UGC calls from a synthetic catalog generated from a seed, so
+// two runs with the same configuration see the same items, the same latencies
+// and the same injected faults.
+//
+//     steam_simulator::config config;
+//     config.catalog_size = 10000;
+//     config.profiles.query.injected.busy = 0.05;
+//     steam_simulator::configure(config);
+#if !defined(STEAM_WRAPPER_SIMULATOR)
+#error "steamSimulator.h requires the simulator backend, configure with -DSTEAM_WRAPPER_BACKEND=simulator"
+#endif
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstdint>
+
+class steam_simulator {
+
+public:
+    // ------------------------------------------------------------------------
+    // Delay between an API call and its call result becoming dispatchable.
+    struct latency {
+        enum class distribution { fixed, uniform, normal, exponential };
+
+        distribution shape = distribution::fixed;
+        std::chrono::microseconds mean{0};
+        // Half width for uniform, standard deviation for normal, unused otherwise.
+        std::chrono::microseconds spread{0};
+    };
+
+    // Probabilities in [0, 1], drawn in that order for every call.
+    struct faults {
+        double busy = 0.0;                // k_EResultBusy
+        double rate_limit_exceeded = 0.0; // k_EResultRateLimitExceeded
+        double io_failure = 0.0;          // Call result dispatched with bIOFailure set.
+    };
+
+    struct operation_profile {
+        latency delay;
+        faults injected;
+    };
+
+    struct config {
+        uint64_t seed = 0x5eed;
+        uint32_t catalog_size = 1000;
+        AppId_t app_id = 480;
+        // Simulated upload throughput for the submit progress, 0 completes instantly.
+        uint64_t upload_bytes_per_second = 0;
+
+        struct {
+            operation_profile create_item;
+            operation_profile submit_item;
+            operation_profile query;
+            operation_profile subscribe;
+        } profiles;
+    };
+
+    struct statistics {
+        uint64_t calls_issued = 0;
+        uint64_t calls_dispatched = 0;
+        uint64_t calls_cancelled = 0;
+        uint64_t faults_injected = 0;
+        uint64_t query_handles_open = 0;
+        uint64_t update_handles_open = 0;
+    };
+
+    /// @brief Resets the simulator: regenerates the catalog, drops pending calls and open handles.
+    static void configure(const config& new_config) noexcept;
+
+    [[nodiscard]] static config configuration() noexcept;
+
+    [[nodiscard]] static statistics stats() noexcept;
+
+    /// @brief Current number of items, grows with CreateItem.
+    [[nodiscard]] static uint32_t catalog_size() noexcept;
+
+    /// @brief Number of call results not dispatched yet.
+    [[nodiscard]] static uint32_t pending_calls() noexcept;
+};
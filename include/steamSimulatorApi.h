@@ -0,0 +1,476 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Source compatible subset of the Steamworks API, backed by the in-process
+// simulator (see steamSimulator.h). Only built with STEAM_WRAPPER_SIMULATOR.
+//
+// Names, values and layouts follow the SDK so the wrapper compiles unchanged,
+// but ISteamUGC's members are plain, non-virtual functions.
+#if !defined(STEAM_WRAPPER_SIMULATOR)
+#error "steamSimulatorApi.h is only part of the simulator build, include steamApi.h instead"
+#endif
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Types and constants.
+typedef uint8_t uint8;
+typedef int32_t int32;
+typedef uint32_t uint32;
+typedef int64_t int64;
+typedef uint64_t uint64;
+
+typedef uint32 AppId_t;
+typedef uint32 AccountID_t;
+typedef uint32 RTime32;
+typedef uint64 PublishedFileId_t;
+typedef uint64 UGCQueryHandle_t;
+typedef uint64 UGCUpdateHandle_t;
+typedef uint64 UGCHandle_t;
+typedef uint64 SteamAPICall_t;
+
+const SteamAPICall_t k_uAPICallInvalid = 0x0;
+const UGCQueryHandle_t k_UGCQueryHandleInvalid = 0xffffffffffffffffull;
+const UGCUpdateHandle_t k_UGCUpdateHandleInvalid = 0xffffffffffffffffull;
+const PublishedFileId_t k_PublishedFileIdInvalid = 0;
+
+const uint32 kNumUGCResultsPerPage = 50;
+const uint32 k_cchDeveloperMetadataMax = 5000;
+const int k_cchPublishedDocumentTitleMax = 128 + 1;
+const int k_cchPublishedDocumentDescriptionMax = 8000;
+const int k_cchTagListMax = 1024 + 1;
+const int k_cchFilenameMax = 260;
+const int k_cchPublishedFileURLMax = 256;
+
+enum EResult {
+    k_EResultNone = 0,
+    k_EResultOK = 1,
+    k_EResultFail = 2,
+    k_EResultNoConnection = 3,
+    k_EResultInvalidPassword = 5,
+    k_EResultLoggedInElsewhere = 6,
+    k_EResultInvalidProtocolVer = 7,
+    k_EResultInvalidParam = 8,
+    k_EResultFileNotFound = 9,
+    k_EResultBusy = 10,
+    k_EResultInvalidState = 11,
+    k_EResultInvalidName = 12,
+    k_EResultInvalidEmail = 13,
+    k_EResultDuplicateName = 14,
+    k_EResultAccessDenied = 15,
+    k_EResultTimeout = 16,
+    k_EResultBanned = 17,
+    k_EResultAccountNotFound = 18,
+    k_EResultInvalidSteamID = 19,
+    k_EResultServiceUnavailable = 20,
+    k_EResultNotLoggedOn = 21,
+    k_EResultPending = 22,
+    k_EResultEncryptionFailure = 23,
+    k_EResultInsufficientPrivilege = 24,
+    k_EResultLimitExceeded = 25,
+    k_EResultRevoked = 26,
+    k_EResultExpired = 27,
+    k_EResultAlreadyRedeemed = 28,
+    k_EResultDuplicateRequest = 29,
+    k_EResultAlreadyOwned = 30,
+    k_EResultIPNotFound = 31,
+    k_EResultPersistFailed = 32,
+    k_EResultLockingFailed = 33,
+    k_EResultLogonSessionReplaced = 34,
+    k_EResultConnectFailed = 35,
+    k_EResultHandshakeFailed = 36,
+    k_EResultIOFailure = 37,
+    k_EResultRemoteDisconnect = 38,
+    k_EResultShoppingCartNotFound = 39,
+    k_EResultBlocked = 40,
+    k_EResultIgnored = 41,
+    k_EResultNoMatch = 42,
+    k_EResultAccountDisabled = 43,
+    k_EResultServiceReadOnly = 44,
+    k_EResultAccountNotFeatured = 45,
+    k_EResultAdministratorOK = 46,
+    k_EResultContentVersion = 47,
+    k_EResultTryAnotherCM = 48,
+    k_EResultPasswordRequiredToKickSession = 49,
+    k_EResultAlreadyLoggedInElsewhere = 50,
+    k_EResultSuspended = 51,
+    k_EResultCancelled = 52,
+    k_EResultDataCorruption = 53,
+    k_EResultDiskFull = 54,
+    k_EResultRemoteCallFailed = 55,
+    k_EResultPasswordUnset = 56,
+    k_EResultExternalAccountUnlinked = 57,
+    k_EResultPSNTicketInvalid = 58,
+    k_EResultExternalAccountAlreadyLinked = 59,
+    k_EResultRemoteFileConflict = 60,
+    k_EResultIllegalPassword = 61,
+    k_EResultSameAsPreviousValue = 62,
+    k_EResultAccountLogonDenied = 63,
+    k_EResultCannotUseOldPassword = 64,
+    k_EResultInvalidLoginAuthCode = 65,
+    k_EResultAccountLogonDeniedNoMail = 66,
+    k_EResultHardwareNotCapableOfIPT = 67,
+    k_EResultIPTInitError = 68,
+    k_EResultParentalControlRestricted = 69,
+    k_EResultFacebookQueryError = 70,
+    k_EResultExpiredLoginAuthCode = 71,
+    k_EResultIPLoginRestrictionFailed = 72,
+    k_EResultAccountLockedDown = 73,
+    k_EResultAccountLogonDeniedVerifiedEmailRequired = 74,
+    k_EResultNoMatchingURL = 75,
+    k_EResultBadResponse = 76,
+    k_EResultRequirePasswordReEntry = 77,
+    k_EResultValueOutOfRange = 78,
+    k_EResultUnexpectedError = 79,
+    k_EResultDisabled = 80,
+    k_EResultInvalidCEGSubmission = 81,
+    k_EResultRestrictedDevice = 82,
+    k_EResultRegionLocked = 83,
+    k_EResultRateLimitExceeded = 84,
+    k_EResultAccountLoginDeniedNeedTwoFactor = 85,
+    k_EResultItemDeleted = 86,
+    k_EResultAccountLoginDeniedThrottle = 87,
+    k_EResultTwoFactorCodeMismatch = 88,
+    k_EResultTwoFactorActivationCodeMismatch = 89,
+    k_EResultAccountAssociatedToMultiplePartners = 90,
+    k_EResultNotModified = 91,
+    k_EResultNoMobileDevice = 92,
+    k_EResultTimeNotSynced = 93,
+    k_EResultSmsCodeFailed = 94,
+    k_EResultAccountLimitExceeded = 95,
+    k_EResultAccountActivityLimitExceeded = 96,
+    k_EResultPhoneActivityLimitExceeded = 97,
+    k_EResultRefundToWallet = 98,
+    k_EResultEmailSendFailure = 99,
+    k_EResultNotSettled = 100,
+    k_EResultNeedCaptcha = 101,
+    k_EResultGSLTDenied = 102,
+    k_EResultGSOwnerDenied = 103,
+    k_EResultInvalidItemType = 104,
+    k_EResultIPBanned = 105,
+    k_EResultGSLTExpired = 106,
+    k_EResultInsufficientFunds = 107,
+    k_EResultTooManyPending = 108,
+    k_EResultNoSiteLicensesFound = 109,
+    k_EResultWGNetworkSendExceeded = 110,
+    k_EResultAccountNotFriends = 111,
+    k_EResultLimitedUserAccount = 112,
+    k_EResultCantRemoveItem = 113,
+    k_EResultAccountDeleted = 114,
+    k_EResultExistingUserCancelledLicense = 115,
+    k_EResultCommunityCooldown = 116,
+};
+
+enum EWorkshopFileType {
+    k_EWorkshopFileTypeFirst = 0,
+    k_EWorkshopFileTypeCommunity = 0,
+    k_EWorkshopFileTypeMicrotransaction = 1,
+    k_EWorkshopFileTypeCollection = 2,
+    k_EWorkshopFileTypeArt = 3,
+    k_EWorkshopFileTypeVideo = 4,
+    k_EWorkshopFileTypeScreenshot = 5,
+    k_EWorkshopFileTypeGame = 6,
+    k_EWorkshopFileTypeSoftware = 7,
+    k_EWorkshopFileTypeConcept = 8,
+    k_EWorkshopFileTypeWebGuide = 9,
+    k_EWorkshopFileTypeIntegratedGuide = 10,
+    k_EWorkshopFileTypeMerch = 11,
+    k_EWorkshopFileTypeControllerBinding = 12,
+    k_EWorkshopFileTypeSteamworksAccessInvite = 13,
+    k_EWorkshopFileTypeSteamVideo = 14,
+    k_EWorkshopFileTypeGameManagedItem = 15,
+    k_EWorkshopFileTypeMax = 16,
+};
+
+enum ERemoteStoragePublishedFileVisibility {
+    k_ERemoteStoragePublishedFileVisibilityPublic = 0,
+    k_ERemoteStoragePublishedFileVisibilityFriendsOnly = 1,
+    k_ERemoteStoragePublishedFileVisibilityPrivate = 2,
+    k_ERemoteStoragePublishedFileVisibilityUnlisted = 3,
+};
+
+enum EUserUGCList {
+    k_EUserUGCList_Published,
+    k_EUserUGCList_VotedOn,
+    k_EUserUGCList_VotedUp,
+    k_EUserUGCList_VotedDown,
+    k_EUserUGCList_WillVoteLater,
+    k_EUserUGCList_Favorited,
+    k_EUserUGCList_Subscribed,
+    k_EUserUGCList_UsedOrPlayed,
+    k_EUserUGCList_Followed,
+};
+
+enum EUGCMatchingUGCType {
+    k_EUGCMatchingUGCType_Items = 0,
+    k_EUGCMatchingUGCType_Items_Mtx = 1,
+    k_EUGCMatchingUGCType_Items_ReadyToUse = 2,
+    k_EUGCMatchingUGCType_Collections = 3,
+    k_EUGCMatchingUGCType_Artwork = 4,
+    k_EUGCMatchingUGCType_Videos = 5,
+    k_EUGCMatchingUGCType_Screenshots = 6,
+    k_EUGCMatchingUGCType_AllGuides = 7,
+    k_EUGCMatchingUGCType_WebGuides = 8,
+    k_EUGCMatchingUGCType_IntegratedGuides = 9,
+    k_EUGCMatchingUGCType_UsableInGame = 10,
+    k_EUGCMatchingUGCType_ControllerBindings = 11,
+    k_EUGCMatchingUGCType_GameManagedItems = 12,
+    k_EUGCMatchingUGCType_All = ~0,
+};
+
+enum EUserUGCListSortOrder {
+    k_EUserUGCListSortOrder_CreationOrderDesc,
+    k_EUserUGCListSortOrder_CreationOrderAsc,
+    k_EUserUGCListSortOrder_TitleAsc,
+    k_EUserUGCListSortOrder_LastUpdatedDesc,
+    k_EUserUGCListSortOrder_SubscriptionDateDesc,
+    k_EUserUGCListSortOrder_VoteScoreDesc,
+    k_EUserUGCListSortOrder_ForModeration,
+};
+
+enum EUGCQuery {
+    k_EUGCQuery_RankedByVote = 0,
+    k_EUGCQuery_RankedByPublicationDate = 1,
+    k_EUGCQuery_AcceptedForGameRankedByAcceptanceDate = 2,
+    k_EUGCQuery_RankedByTrend = 3,
+    k_EUGCQuery_FavoritedByFriendsRankedByPublicationDate = 4,
+    k_EUGCQuery_CreatedByFriendsRankedByPublicationDate = 5,
+    k_EUGCQuery_RankedByNumTimesReported = 6,
+    k_EUGCQuery_CreatedByFollowedUsersRankedByPublicationDate = 7,
+    k_EUGCQuery_NotYetRated = 8,
+    k_EUGCQuery_RankedByTotalVotesAsc = 9,
+    k_EUGCQuery_RankedByVotesUp = 10,
+    k_EUGCQuery_RankedByTextSearch = 11,
+    k_EUGCQuery_RankedByTotalUniqueSubscriptions = 12,
+    k_EUGCQuery_RankedByPlaytimeTrend = 13,
+    k_EUGCQuery_RankedByTotalPlaytime = 14,
+    k_EUGCQuery_RankedByAveragePlaytimeTrend = 15,
+    k_EUGCQuery_RankedByLifetimeAveragePlaytime = 16,
+    k_EUGCQuery_RankedByPlaytimeSessionsTrend = 17,
+    k_EUGCQuery_RankedByLifetimePlaytimeSessions = 18,
+    k_EUGCQuery_RankedByLastUpdatedDate = 19,
+};
+
+enum EItemUpdateStatus {
+    k_EItemUpdateStatusInvalid = 0,
+    k_EItemUpdateStatusPreparingConfig = 1,
+    k_EItemUpdateStatusPreparingContent = 2,
+    k_EItemUpdateStatusUploadingContent = 3,
+    k_EItemUpdateStatusUploadingPreviewFile = 4,
+    k_EItemUpdateStatusCommittingChanges = 5,
+};
+
+enum EItemStatistic {
+    k_EItemStatistic_NumSubscriptions = 0,
+    k_EItemStatistic_NumFavorites = 1,
+    k_EItemStatistic_NumFollowers = 2,
+    k_EItemStatistic_NumUniqueSubscriptions = 3,
+    k_EItemStatistic_NumUniqueFavorites = 4,
+    k_EItemStatistic_NumUniqueFollowers = 5,
+    k_EItemStatistic_NumUniqueWebsiteViews = 6,
+    k_EItemStatistic_ReportScore = 7,
+    k_EItemStatistic_NumSecondsPlayed = 8,
+    k_EItemStatistic_NumPlaytimeSessions = 9,
+    k_EItemStatistic_NumComments = 10,
+    k_EItemStatistic_NumSecondsPlayedDuringTimePeriod = 11,
+    k_EItemStatistic_NumPlaytimeSessionsDuringTimePeriod = 12,
+};
+
+enum EItemPreviewType {
+    k_EItemPreviewType_Image = 0,
+    k_EItemPreviewType_YouTubeVideo = 1,
+    k_EItemPreviewType_Sketchfab = 2,
+    k_EItemPreviewType_EnvironmentMap_HorizontalCross = 3,
+    k_EItemPreviewType_EnvironmentMap_LatLong = 4,
+    k_EItemPreviewType_ReservedMax = 255,
+};
+
+// ----------------------------------------------------------------------------
+// Call results.
+struct SteamUGCDetails_t {
+    PublishedFileId_t m_nPublishedFileId;
+    EResult m_eResult;
+    EWorkshopFileType m_eFileType;
+    AppId_t m_nCreatorAppID;
+    AppId_t m_nConsumerAppID;
+    char m_rgchTitle[k_cchPublishedDocumentTitleMax];
+    char m_rgchDescription[k_cchPublishedDocumentDescriptionMax];
+    uint64 m_ulSteamIDOwner;
+    uint32 m_rtimeCreated;
+    uint32 m_rtimeUpdated;
+    uint32 m_rtimeAddedToUserList;
+    ERemoteStoragePublishedFileVisibility m_eVisibility;
+    bool m_bBanned;
+    bool m_bAcceptedForUse;
+    bool m_bTagsTruncated;
+    char m_rgchTags[k_cchTagListMax];
+    UGCHandle_t m_hFile;
+    UGCHandle_t m_hPreviewFile;
+    char m_pchFileName[k_cchFilenameMax];
+    int32 m_nFileSize;
+    int32 m_nPreviewFileSize;
+    char m_rgchURL[k_cchPublishedFileURLMax];
+    uint32 m_unVotesUp;
+    uint32 m_unVotesDown;
+    float m_flScore;
+    uint32 m_unNumChildren;
+};
+
+struct SteamUGCQueryCompleted_t {
+    enum { k_iCallback = 3401 };
+    UGCQueryHandle_t m_handle;
+    EResult m_eResult;
+    uint32 m_unNumResultsReturned;
+    uint32 m_unTotalMatchingResults;
+    bool m_bCachedData;
+    char m_rgchNextCursor[k_cchPublishedFileURLMax];
+};
+
+struct CreateItemResult_t {
+    enum { k_iCallback = 3403 };
+    EResult m_eResult;
+    PublishedFileId_t m_nPublishedFileId;
+    bool m_bUserNeedsToAcceptWorkshopLegalAgreement;
+};
+
+struct SubmitItemUpdateResult_t {
+    enum { k_iCallback = 3404 };
+    EResult m_eResult;
+    bool m_bUserNeedsToAcceptWorkshopLegalAgreement;
+    PublishedFileId_t m_nPublishedFileId;
+};
+
+struct RemoteStorageSubscribePublishedFileResult_t {
+    enum { k_iCallback = 1313 };
+    EResult m_eResult;
+    PublishedFileId_t m_nPublishedFileId;
+};
+
+struct RemoteStorageUnsubscribePublishedFileResult_t {
+    enum { k_iCallback = 1315 };
+    EResult m_eResult;
+    PublishedFileId_t m_nPublishedFileId;
+};
+
+// ----------------------------------------------------------------------------
+// UGC interface, implemented by the simulator.
+class ISteamUGC {
+
+public:
+    UGCQueryHandle_t CreateQueryUserUGCRequest(AccountID_t unAccountID, EUserUGCList eListType, EUGCMatchingUGCType eMatchingUGCType,
+                                               EUserUGCListSortOrder eSortOrder, AppId_t nCreatorAppID, AppId_t nConsumerAppID, uint32 unPage);
+    UGCQueryHandle_t CreateQueryAllUGCRequest(EUGCQuery eQueryType, EUGCMatchingUGCType eMatchingeMatchingUGCTypeFileType,
+                                              AppId_t nCreatorAppID, AppId_t nConsumerAppID, uint32 unPage);
+    UGCQueryHandle_t CreateQueryAllUGCRequest(EUGCQuery eQueryType, EUGCMatchingUGCType eMatchingeMatchingUGCTypeFileType,
+                                              AppId_t nCreatorAppID, AppId_t nConsumerAppID, const char* pchCursor = nullptr);
+    SteamAPICall_t SendQueryUGCRequest(UGCQueryHandle_t handle);
+    bool GetQueryUGCResult(UGCQueryHandle_t handle, uint32 index, SteamUGCDetails_t* pDetails);
+    bool GetQueryUGCPreviewURL(UGCQueryHandle_t handle, uint32 index, char* pchURL, uint32 cchURLSize);
+    bool GetQueryUGCMetadata(UGCQueryHandle_t handle, uint32 index, char* pchMetadata, uint32 cchMetadatasize);
+    bool GetQueryUGCChildren(UGCQueryHandle_t handle, uint32 index, PublishedFileId_t* pvecPublishedFileID, uint32 cMaxEntries);
+    bool GetQueryUGCStatistic(UGCQueryHandle_t handle, uint32 index, EItemStatistic eStatType, uint64* pStatValue);
+    uint32 GetQueryUGCNumAdditionalPreviews(UGCQueryHandle_t handle, uint32 index);
+    bool GetQueryUGCAdditionalPreview(UGCQueryHandle_t handle, uint32 index, uint32 previewIndex, char* pchURLOrVideoID, uint32 cchURLSize,
+                                      char* pchOriginalFileName, uint32 cchOriginalFileNameSize, EItemPreviewType* pPreviewType);
+    uint32 GetQueryUGCNumKeyValueTags(UGCQueryHandle_t handle, uint32 index);
+    bool GetQueryUGCKeyValueTag(UGCQueryHandle_t handle, uint32 index, uint32 keyValueTagIndex, char* pchKey, uint32 cchKeySize,
+                                char* pchValue, uint32 cchValueSize);
+    bool ReleaseQueryUGCRequest(UGCQueryHandle_t handle);
+
+    bool AddRequiredTag(UGCQueryHandle_t handle, const char* pTagName);
+    bool AddExcludedTag(UGCQueryHandle_t handle, const char* pTagName);
+    bool SetReturnOnlyIDs(UGCQueryHandle_t handle, bool bReturnOnlyIDs);
+    bool SetReturnKeyValueTags(UGCQueryHandle_t handle, bool bReturnKeyValueTags);
+    bool SetReturnLongDescription(UGCQueryHandle_t handle, bool bReturnLongDescription);
+    bool SetReturnMetadata(UGCQueryHandle_t handle, bool bReturnMetadata);
+    bool SetReturnChildren(UGCQueryHandle_t handle, bool bReturnChildren);
+    bool SetReturnAdditionalPreviews(UGCQueryHandle_t handle, bool bReturnAdditionalPreviews);
+    bool SetReturnTotalOnly(UGCQueryHandle_t handle, bool bReturnTotalOnly);
+    bool SetReturnPlaytimeStats(UGCQueryHandle_t handle, uint32 unDays);
+    bool SetAllowCachedResponse(UGCQueryHandle_t handle, uint32 unMaxAgeSeconds);
+    bool SetCloudFileNameFilter(UGCQueryHandle_t handle, const char* pMatchCloudFileName);
+    bool SetMatchAnyTag(UGCQueryHandle_t handle, bool bMatchAnyTag);
+    bool SetSearchText(UGCQueryHandle_t handle, const char* pSearchText);
+    bool SetRankedByTrendDays(UGCQueryHandle_t handle, uint32 unDays);
+    bool SetTimeCreatedDateRange(UGCQueryHandle_t handle, RTime32 rtStart, RTime32 rtEnd);
+
+    SteamAPICall_t CreateItem(AppId_t nConsumerAppId, EWorkshopFileType eFileType);
+    UGCUpdateHandle_t StartItemUpdate(AppId_t nConsumerAppId, PublishedFileId_t nPublishedFileID);
+    bool SetItemTitle(UGCUpdateHandle_t handle, const char* pchTitle);
+    bool SetItemDescription(UGCUpdateHandle_t handle, const char* pchDescription);
+    bool SetItemContent(UGCUpdateHandle_t handle, const char* pszContentFolder);
+    bool SetItemPreview(UGCUpdateHandle_t handle, const char* pszPreviewFile);
+    SteamAPICall_t SubmitItemUpdate(UGCUpdateHandle_t handle, const char* pchChangeNote);
+    EItemUpdateStatus GetItemUpdateProgress(UGCUpdateHandle_t handle, uint64* punBytesProcessed, uint64* punBytesTotal);
+
+    SteamAPICall_t SubscribeItem(PublishedFileId_t nPublishedFileID);
+    SteamAPICall_t UnsubscribeItem(PublishedFileId_t nPublishedFileID);
+};
+
+ISteamUGC* SteamUGC();
+
+bool SteamAPI_Init();
+void SteamAPI_Shutdown();
+void SteamAPI_RunCallbacks();
+
+// ----------------------------------------------------------------------------
+// Call result registration, dispatched from SteamAPI_RunCallbacks.
+namespace steam_simulator_detail {
+
+using call_result_handler = void (*)(void* target, void* result, bool io_failure);
+
+void register_call_result(SteamAPICall_t api_call, int callback_id, void* target, call_result_handler handler);
+
+void unregister_call_result(SteamAPICall_t api_call, void* target);
+
+} // namespace steam_simulator_detail
+
+template <class T, class P>
+class CCallResult {
+
+public:
+    typedef void (T::*func_t)(P*, bool);
+
+private:
+    SteamAPICall_t m_hAPICall = k_uAPICallInvalid;
+    T* m_pObj = nullptr;
+    func_t m_Func = nullptr;
+
+    static void Dispatch(void* target, void* result, bool io_failure) {
+        auto* self = static_cast<CCallResult*>(target);
+        self->m_hAPICall = k_uAPICallInvalid;
+        (self->m_pObj->*self->m_Func)(static_cast<P*>(result), io_failure);
+    }
+
+public:
+    CCallResult() = default;
+
+    CCallResult(const CCallResult&) = delete;
+    CCallResult& operator=(const CCallResult&) = delete;
+
+    ~CCallResult() { Cancel(); }
+
+    void Set(SteamAPICall_t hAPICall, T* p, func_t func) {
+        Cancel();
+
+        m_hAPICall = hAPICall;
+        m_pObj = p;
+        m_Func = func;
+
+        if (hAPICall != k_uAPICallInvalid) {
+            steam_simulator_detail::register_call_result(hAPICall, P::k_iCallback, this, &CCallResult::Dispatch);
+        }
+    }
+
+    bool IsActive() const { return m_hAPICall != k_uAPICallInvalid; }
+
+    void Cancel() {
+        if (m_hAPICall != k_uAPICallInvalid) {
+            steam_simulator_detail::unregister_call_result(m_hAPICall, this);
+            m_hAPICall = k_uAPICallInvalid;
+        }
+    }
+};
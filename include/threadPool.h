@@ -0,0 +1,64 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Fixed set of worker threads for the CPU and disk bound work around uploads:
+// hashing, validation, image processing.
+//
+// parallel_for() runs on the calling thread too and only waits for workers
+// that actually started, so it may be nested or called from a task without
+// ever waiting on a queue stuck behind itself.
+class thread_pool {
+
+private:
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::deque<std::function<void()>> _tasks;
+    bool _stopping = false;
+
+    void work() noexcept;
+
+    void run_parallel(std::size_t count, const std::function<void(std::size_t)>& body);
+
+public:
+    /// @param threads Workers to start, 0 for one per hardware thread.
+    explicit thread_pool(std::size_t threads = 0);
+
+    // Runs the tasks still queued, then joins the workers.
+    ~thread_pool() noexcept;
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /// @brief Process-wide pool, started on first use.
+    [[nodiscard]] static thread_pool& shared();
+
+    [[nodiscard]] std::size_t size() const noexcept { return _workers.size(); }
+
+    void submit(std::function<void()> task);
+
+    /// @brief Calls body(i) for every i in [0, count), spread over the workers
+    /// and the calling thread, and returns once all calls are done.
+    template <typename F>
+    void parallel_for(const std::size_t count, F&& body) {
+        if (count <= 1 || _workers.empty()) {
+            for (std::size_t i = 0; i < count; ++i) {
+                body(i);
+            }
+            return;
+        }
+
+        run_parallel(count, std::function<void(std::size_t)>{std::ref(body)});
+    }
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamApi.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Progress of one submitted item update.
+struct upload_progress {
+    // The handle given to submit_item_update, kept when a retry moves to a new one.
+    UGCUpdateHandle_t update_handle = k_UGCUpdateHandleInvalid;
+    PublishedFileId_t item_id = 0;
+
+    // k_EItemUpdateStatusInvalid until Steam starts on it, e.g. while rate limited.
+    EItemUpdateStatus status = EItemUpdateStatus::k_EItemUpdateStatusInvalid;
+
+    // Of the phase uploading: the content folder, then the preview file.
+    uint64_t bytes_processed = 0;
+    uint64_t bytes_total = 0;
+
+    // Smoothed upload rate, carried over from one phase to the next.
+    double bytes_per_second = 0.0;
+
+    // Time left in the phase uploading, once a rate is known.
+    std::optional<std::chrono::milliseconds> eta;
+
+    std::chrono::microseconds elapsed{0};
+
+    // Set once, on the last event of the upload.
+    bool finished = false;
+    EResult result = EResult::k_EResultPending;
+};
+
+// ----------------------------------------------------------------------------
+// Progress of every submitted update, sampled from the callback dispatch.
+//
+// run_callbacks() samples each active upload every `sample_interval` and
+// tells the subscribers of those which changed, then once more when the
+// upload completes. Subscribers run on the thread dispatching the callbacks,
+// the pump when it is running, and must not block it.
+class upload_monitor {
+
+public:
+    using clock = std::chrono::steady_clock;
+    using subscriber = std::function<void(const upload_progress&)>;
+    using subscription = uint64_t;
+
+    struct config {
+        std::chrono::milliseconds sample_interval{250};
+
+        // Time constant of the rate's exponential moving average.
+        std::chrono::milliseconds smoothing{2000};
+    };
+
+private:
+    struct upload {
+        upload_progress progress;
+        UGCUpdateHandle_t current_handle = k_UGCUpdateHandleInvalid;
+        clock::time_point started;
+        clock::time_point sampled;
+    };
+
+    mutable std::mutex _mutex;
+    config _config;
+    clock::time_point _last_sample;
+    std::unordered_map<UGCUpdateHandle_t, upload> _uploads;
+
+    // Copied out before being called, so they may unsubscribe from within.
+    mutable std::mutex _subscribers_mutex;
+    std::vector<std::pair<subscription, std::shared_ptr<const subscriber>>> _subscribers;
+    subscription _next_subscription = 1;
+
+    void publish(const std::vector<upload_progress>& events) const;
+
+public:
+    /// @brief Folds a sample into the progress: phase, bytes, smoothed rate and ETA.
+    /// @return Whether anything a subscriber sees changed.
+    static bool advance(upload_progress& progress, EItemUpdateStatus status, uint64_t processed, uint64_t total,
+                        std::chrono::microseconds since_last_sample, std::chrono::milliseconds smoothing) noexcept;
+
+    void configure(const config& updated) noexcept;
+
+    // ------------------------------------------------------------------------
+    // Fed by steam_helper.
+    void track(UGCUpdateHandle_t update_handle, PublishedFileId_t item_id, clock::time_point now = clock::now());
+
+    // A retry submitted the update again on a new handle.
+    void rebind(UGCUpdateHandle_t update_handle, UGCUpdateHandle_t current_handle) noexcept;
+
+    void finish(UGCUpdateHandle_t update_handle, EResult result, clock::time_point now = clock::now());
+
+    /// @brief Samples the active uploads if the interval elapsed since the last time.
+    void sample(clock::time_point now = clock::now());
+
+    // ------------------------------------------------------------------------
+    // Readers.
+    [[nodiscard]] subscription subscribe(subscriber callback);
+
+    void unsubscribe(subscription id) noexcept;
+
+    [[nodiscard]] std::optional<upload_progress> progress(UGCUpdateHandle_t update_handle) const;
+
+    /// @brief The handle the upload is running on now, another one after a retry, the handle itself if not tracked.
+    [[nodiscard]] UGCUpdateHandle_t current_handle(UGCUpdateHandle_t update_handle) const noexcept;
+
+    [[nodiscard]] std::vector<upload_progress> uploads() const;
+
+    [[nodiscard]] std::size_t active() const noexcept;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/steamHelper.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Parallel crawl of an app's entire workshop.
+//
+// The catalog is split into disjoint creation date windows, walked
+// concurrently with the query cursor. A window reporting more matches than
+// `split_threshold` is halved and both halves are crawled instead.
+class workshop_crawler {
+
+public:
+    using query_configurator = std::function<bool(steam_helper&, UGCQueryHandle_t)>;
+
+    struct options {
+        AppId_t creator_app_id = 0;
+        AppId_t consumer_app_id = 0;
+        EUGCMatchingUGCType matching_type = EUGCMatchingUGCType::k_EUGCMatchingUGCType_Items;
+
+        // Inclusive creation date bounds, 0 for the end means now.
+        RTime32 created_after = 0;
+        RTime32 created_before = 0;
+
+        uint32_t initial_shards = 16;
+        uint32_t max_in_flight = 8;
+        uint32_t split_threshold = 50 * kNumUGCResultsPerPage;
+        RTime32 min_window = 60 * 60;
+
+        // Longest wait for the next page to complete, the crawl itself may run longer.
+        std::chrono::microseconds stall_timeout{std::chrono::minutes(30)};
+
+        // Limit on the whole crawl, 0 for none.
+        std::chrono::microseconds deadline{0};
+
+        // Applied to every page's handle on top of the date range.
+        query_configurator configure;
+    };
+
+    struct result {
+        EResult result = EResult::k_EResultOK;
+        std::vector<SteamUGCDetails_t> items;
+        std::vector<std::string> preview_urls;
+
+        uint32_t pages = 0;
+        uint32_t windows = 0;
+        uint32_t splits = 0;
+        uint32_t duplicates = 0;
+    };
+
+private:
+    // ------------------------------------------------------------------------
+    // One creation date window, walked page by page.
+    struct window {
+        RTime32 start;
+        RTime32 end;
+        std::string cursor;
+    };
+
+    // Shared with the in-flight completions, which may outlive the crawler.
+    struct crawl_state {
+        uint32_t split_threshold;
+        RTime32 min_window;
+
+        std::mutex mutex;
+        std::deque<window> pending;
+        uint32_t in_flight = 0;
+        uint64_t completions = 0;
+        std::unordered_set<PublishedFileId_t> seen;
+        result output;
+    };
+
+    // ------------------------------------------------------------------------
+    // Data members.
+    steam_helper& _helper;
+    options _options;
+
+    // ------------------------------------------------------------------------
+    // Crawl utils.
+    bool issue(const std::shared_ptr<crawl_state>& state, const window& shard) noexcept;
+
+    static void on_page(crawl_state& state, const window& shard, query_page&& page) noexcept;
+
+public:
+    workshop_crawler(steam_helper& helper, options crawl_options) noexcept;
+
+    /// @brief Crawls every item created in the configured window.
+    /// @return The de-duplicated items, and the first failing EResult if any
+    /// window could not be walked to its end.
+    [[nodiscard]] result run() noexcept;
+};
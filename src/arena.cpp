@@ -0,0 +1,58 @@
+#include "../include/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+void* arena::allocate_slow(const std::size_t size, const std::size_t alignment) {
+    // Oversized requests get a block of their own, the current one stays in use.
+    const std::size_t block_size = std::max(_block_size, size + alignment);
+
+    _blocks.push_back(std::make_unique<std::byte[]>(block_size));
+    _bytes_reserved += block_size;
+
+    std::byte* block = _blocks.back().get();
+
+    if (block_size > _block_size) {
+        void* aligned = block;
+        std::size_t space = block_size;
+        return std::align(alignment, size, aligned, space);
+    }
+
+    _cursor = block;
+    _remaining = block_size;
+
+    void* aligned = _cursor;
+    std::align(alignment, size, aligned, _remaining);
+
+    _cursor = static_cast<std::byte*>(aligned) + size;
+    _remaining -= size;
+    return aligned;
+}
+
+[[nodiscard]] void* arena::allocate(const std::size_t size, const std::size_t alignment) {
+    _bytes_used += size;
+
+    void* aligned = _cursor;
+
+    if (_cursor != nullptr && std::align(alignment, size, aligned, _remaining) != nullptr) {
+        _cursor = static_cast<std::byte*>(aligned) + size;
+        _remaining -= size;
+        return aligned;
+    }
+
+    return allocate_slow(size, alignment);
+}
+
+[[nodiscard]] std::string_view arena::store(const std::string_view value) {
+    // Empty strings share a terminator, they still read as valid C strings.
+    if (value.empty()) {
+        return {"", 0};
+    }
+
+    auto* chars = static_cast<char*>(allocate(value.size() + 1, alignof(char)));
+    std::memcpy(chars, value.data(), value.size());
+    chars[value.size()] = '\0';
+
+    return {chars, value.size()};
+}
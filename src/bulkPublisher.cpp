@@ -0,0 +1,387 @@
+#include "../include/bulkPublisher.h"
+
+#include <algorithm>
+
+bulk_publisher::bulk_publisher(steam_helper& helper, options publish_options) noexcept
+    : _helper{helper}, _options{std::move(publish_options)} {
+    if (!_options.fingerprint_directory.empty()) {
+        _fingerprints.emplace(_options.fingerprint_directory);
+    }
+}
+
+[[nodiscard]] std::string_view bulk_publisher::stage_name(const stage reached) noexcept {
+    switch (reached) {
+        case stage::create: return "create";
+        case stage::update: return "update";
+        case stage::submit: return "submit";
+        case stage::done: return "done";
+    }
+
+    return "unknown";
+}
+
+namespace {
+
+    [[nodiscard]] EResult result_of(const validation_problem problem) noexcept {
+        switch (problem) {
+            case validation_problem::missing:
+            case validation_problem::not_a_folder:
+            case validation_problem::unreadable: return EResult::k_EResultFileNotFound;
+            case validation_problem::file_too_large:
+            case validation_problem::content_too_large:
+            case validation_problem::preview_too_large: return EResult::k_EResultLimitExceeded;
+            default: return EResult::k_EResultInvalidParam;
+        }
+    }
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Pipeline utils.
+void bulk_publisher::publish_state::finish(const std::size_t index, const stage reached, const EResult rc) noexcept {
+    // Settled already, by a timeout the late completion lost to.
+    if (settled[index]) {
+        return;
+    }
+
+    settled[index] = true;
+    item_outcome& outcome = output.items[index];
+
+    outcome.result = rc;
+    outcome.reached = rc == EResult::k_EResultOK ? stage::done : reached;
+    outcome.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - started[index]);
+
+    if (rc == EResult::k_EResultOK) {
+        ++output.published;
+    } else {
+        ++output.failed;
+
+        if (output.result == EResult::k_EResultOK) {
+            output.result = rc;
+        }
+    }
+
+    finished.push_back(index);
+    ++completions;
+}
+
+bool bulk_publisher::issue_create(const std::shared_ptr<publish_state>& state, const publish_entry& entry, const std::size_t index) noexcept {
+    const SteamAPICall_t api_call = _helper.create_workshop_item(entry.app_id,
+        [state, index](const EResult rc, const PublishedFileId_t item_id) {
+            std::lock_guard<std::mutex> lock{state->mutex};
+            --state->creates_in_flight;
+
+            if (rc != EResult::k_EResultOK) {
+                state->finish(index, stage::create, rc);
+                return;
+            }
+
+            item_outcome& outcome = state->output.items[index];
+            outcome.item_id = item_id;
+            outcome.created = true;
+            outcome.reached = stage::update;
+
+            state->to_submit.push_back(index);
+            ++state->completions;
+        });
+
+    return api_call != k_uAPICallInvalid;
+}
+
+bool bulk_publisher::issue_submit(const std::shared_ptr<publish_state>& state, const publish_entry& entry, const std::size_t index) noexcept {
+    PublishedFileId_t item_id = 0;
+
+    {
+        std::lock_guard<std::mutex> lock{state->mutex};
+        item_id = state->output.items[index].item_id;
+    }
+
+    const auto fail = [&state, index](const EResult rc) {
+        std::lock_guard<std::mutex> lock{state->mutex};
+        --state->submits_in_flight;
+        state->finish(index, stage::update, rc);
+        return true;
+    };
+
+    // Only what changed since the last successful submit goes out, nothing at all if nothing did.
+    content_fingerprint::changes changed;
+
+    if (_fingerprints.has_value()) {
+        const std::optional<content_fingerprint> previous =
+            entry.item_id != 0 ? _fingerprints->load(entry.app_id, item_id) : std::nullopt;
+
+        std::optional<content_fingerprint> current = _fingerprinter.fingerprint(entry.content, entry.preview, entry.title, entry.description,
+                                                                                previous.has_value() ? &*previous : nullptr);
+
+        if (current.has_value() && previous.has_value()) {
+            changed = current->changed_since(*previous);
+            current->inherit_unset(*previous);
+        }
+
+        // Unreadable content is left for Steam to report, without a fingerprint to save.
+        std::lock_guard<std::mutex> lock{state->mutex};
+        state->fingerprints[index] = std::move(current);
+
+        // Saved all the same, touched files then keep their new write times.
+        if (!changed.any()) {
+            log_info("Publish") << "Line " << entry.line << ": item " << item_id << " unchanged, not submitted\n";
+
+            --state->submits_in_flight;
+            state->output.items[index].skipped = true;
+            state->finish(index, stage::done, EResult::k_EResultOK);
+            return true;
+        }
+    }
+
+    const std::optional<UGCUpdateHandle_t> handle = _helper.start_workshop_item_update(entry.app_id, item_id);
+
+    if (!handle.has_value()) {
+        return fail(EResult::k_EResultFail);
+    }
+
+    const bool applied = (!changed.metadata || !entry.title.has_value() || _helper.set_workshop_item_title(*handle, *entry.title)) &&
+                         (!changed.metadata || !entry.description.has_value() || _helper.set_workshop_item_description(*handle, *entry.description)) &&
+                         (!changed.content || !entry.content.has_value() || _helper.set_workshop_item_content(*handle, *entry.content)) &&
+                         (!changed.preview || !entry.preview.has_value() || _helper.set_workshop_item_preview_image(*handle, *entry.preview));
+
+    if (!applied) {
+        log_error("Publish") << "Line " << entry.line << ": Steam rejected the fields of item " << item_id << "\n";
+        return fail(EResult::k_EResultInvalidParam);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{state->mutex};
+        item_outcome& outcome = state->output.items[index];
+        outcome.reached = stage::submit;
+        outcome.content_sent = changed.content && entry.content.has_value();
+    }
+
+    const SteamAPICall_t api_call = _helper.submit_item_update(*handle, entry.changelog.c_str(),
+        [state, index](const EResult rc, PublishedFileId_t) {
+            std::lock_guard<std::mutex> lock{state->mutex};
+            --state->submits_in_flight;
+            state->finish(index, stage::submit, rc);
+        });
+
+    return api_call != k_uAPICallInvalid;
+}
+
+void bulk_publisher::report_finished(publish_state& state, const std::vector<publish_entry>& entries) noexcept {
+    for (;;) {
+        item_outcome outcome;
+        std::optional<content_fingerprint> fingerprint;
+
+        {
+            std::lock_guard<std::mutex> lock{state.mutex};
+
+            if (state.finished.empty()) {
+                return;
+            }
+
+            outcome = state.output.items[state.finished.front()];
+            fingerprint = std::move(state.fingerprints[outcome.index]);
+            state.finished.pop_front();
+        }
+
+        // What Steam has now, the next run compares against it.
+        if (outcome.result == EResult::k_EResultOK && fingerprint.has_value() &&
+            !_fingerprints->save(entries[outcome.index].app_id, outcome.item_id, *fingerprint)) {
+            log_warning("Publish") << "Item " << outcome.item_id << " will be submitted in full next time\n";
+        }
+
+        if (outcome.result != EResult::k_EResultOK) {
+            log_error("Publish") << "Item " << outcome.index << " failed at " << stage_name(outcome.reached) << ": "
+                                 << steam_helper::result_to_string(outcome.result) << "\n";
+        }
+
+        if (_options.on_item) {
+            _options.on_item(outcome);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Run.
+[[nodiscard]] const std::vector<publish_entry>& bulk_publisher::prepare_previews(const std::vector<publish_entry>& requested,
+                                                                               std::vector<publish_entry>& prepared) const {
+    if (_options.preview_cache_directory.empty()) {
+        return requested;
+    }
+
+    std::vector<std::filesystem::path> sources;
+    std::vector<std::size_t> owners;
+
+    for (std::size_t i = 0; i < requested.size(); ++i) {
+        if (requested[i].preview.has_value()) {
+            sources.push_back(*requested[i].preview);
+            owners.push_back(i);
+        }
+    }
+
+    const std::vector<std::optional<preview_processor::result>> processed =
+        preview_processor{_options.preview_cache_directory, _options.preview}.process(sources);
+
+    prepared = requested;
+
+    // One that could not be processed keeps its own, validation then tells why.
+    for (std::size_t i = 0; i < processed.size(); ++i) {
+        if (processed[i].has_value()) {
+            prepared[owners[i]].preview = processed[i]->path;
+        }
+    }
+
+    return prepared;
+}
+
+[[nodiscard]] bulk_publisher::result bulk_publisher::run(const std::vector<publish_entry>& requested) noexcept {
+    const clock::time_point start = clock::now();
+
+    std::vector<publish_entry> prepared;
+    const std::vector<publish_entry>& entries = prepare_previews(requested, prepared);
+
+    auto state = std::make_shared<publish_state>();
+    state->started.resize(entries.size());
+    state->settled.resize(entries.size());
+    state->fingerprints.resize(entries.size());
+    state->output.items.resize(entries.size());
+
+    std::vector<content_validator::target> targets(entries.size());
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        targets[i] = {entries[i].content, entries[i].preview};
+    }
+
+    // The whole batch is checked before the first call, an item that cannot
+    // be uploaded fails here rather than after a create and an upload.
+    std::vector<content_report> reports = content_validator{_options.validation}.validate(targets);
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        state->output.items[i].index = i;
+        state->output.items[i].item_id = entries[i].item_id;
+        state->output.items[i].validation = std::move(reports[i]);
+
+        if (const content_report& report = state->output.items[i].validation; !report.ok()) {
+            for (const validation_issue& issue : report.issues) {
+                log_error("Publish") << "Line " << entries[i].line << ": " << content_validator::describe(issue) << "\n";
+            }
+
+            state->started[i] = clock::now();
+            state->finish(i, stage::update, result_of(report.issues.front().problem));
+        } else if (entries[i].item_id == 0) {
+            state->to_create.push_back(i);
+        } else {
+            state->output.items[i].reached = stage::update;
+            state->to_submit.push_back(i);
+        }
+    }
+
+    const uint32_t max_creates = std::max<uint32_t>(1, _options.max_creates_in_flight);
+    const uint32_t max_submits = std::max<uint32_t>(1, _options.max_submits_in_flight);
+
+    // Bulk traffic, calls issued interactively meanwhile go first.
+    const call_priority_scope background{call_priority::background};
+
+    // Calls are issued from this thread only, completions just move items along.
+    for (;;) {
+        uint64_t completions_seen = 0;
+
+        {
+            std::unique_lock<std::mutex> lock{state->mutex};
+
+            if (_options.stop_on_failure && state->output.failed != 0) {
+                // Stop feeding the pipeline, drain what is already in flight.
+                state->to_create.clear();
+                state->to_submit.clear();
+            }
+
+            while (state->submits_in_flight < max_submits && !state->to_submit.empty()) {
+                const std::size_t index = state->to_submit.front();
+                state->to_submit.pop_front();
+                ++state->submits_in_flight;
+
+                if (state->started[index] == clock::time_point{}) {
+                    state->started[index] = clock::now();
+                }
+
+                lock.unlock();
+                const bool issued = issue_submit(state, entries[index], index);
+                lock.lock();
+
+                if (!issued) {
+                    --state->submits_in_flight;
+                    state->finish(index, stage::submit, EResult::k_EResultFail);
+                }
+            }
+
+            // Creates run ahead just enough to refill the submit slots, an
+            // item created long before it can be uploaded gains nothing.
+            while (state->creates_in_flight < max_creates && !state->to_create.empty() &&
+                   state->creates_in_flight + state->to_submit.size() < max_submits) {
+                const std::size_t index = state->to_create.front();
+                state->to_create.pop_front();
+                ++state->creates_in_flight;
+                state->started[index] = clock::now();
+
+                lock.unlock();
+                const bool issued = issue_create(state, entries[index], index);
+                lock.lock();
+
+                if (!issued) {
+                    --state->creates_in_flight;
+                    state->finish(index, stage::create, EResult::k_EResultFail);
+                }
+            }
+
+            completions_seen = state->completions;
+
+            if (state->creates_in_flight == 0 && state->submits_in_flight == 0 &&
+                state->to_create.empty() && state->to_submit.empty()) {
+                break;
+            }
+
+            // Items that failed issuing still have to be reported.
+            if (!state->finished.empty()) {
+                lock.unlock();
+                report_finished(*state, entries);
+                continue;
+            }
+        }
+
+        const bool progressed = _helper.run_callbacks_until([&state, completions_seen] {
+            std::lock_guard<std::mutex> lock{state->mutex};
+            return state->completions != completions_seen;
+        }, _options.timeout);
+
+        report_finished(*state, entries);
+
+        if (!progressed) {
+            log_error("Publish") << "Bulk publish timed out\n";
+
+            {
+                std::lock_guard<std::mutex> lock{state->mutex};
+                state->to_create.clear();
+                state->to_submit.clear();
+
+                for (std::size_t i = 0; i < entries.size(); ++i) {
+                    if (state->started[i] != clock::time_point{}) {
+                        state->finish(i, state->output.items[i].reached, EResult::k_EResultTimeout);
+                    }
+                }
+            }
+
+            report_finished(*state, entries);
+            break;
+        }
+    }
+
+    report_finished(*state, entries);
+
+    std::lock_guard<std::mutex> lock{state->mutex};
+    state->output.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start);
+
+    log_info("Publish") << "Bulk publish done: " << state->output.published << " published, "
+                        << state->output.failed << " failed\n";
+
+    // In-flight completions may still reference the shared state, hand out a copy.
+    return state->output;
+}
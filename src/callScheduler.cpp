@@ -0,0 +1,166 @@
+#include "../include/callScheduler.h"
+
+#include <algorithm>
+
+namespace {
+
+    thread_local call_priority current_priority = call_priority::interactive;
+
+    // A bucket never stops refilling, whatever min_rate says.
+    constexpr double rate_floor = 0.01;
+
+    // Answers telling the client to slow down, as opposed to plain failures. The same retryable
+    // ones as in steamResult.h: k_EResultLimitExceeded is a quota or size limit, slowing down does not lift it.
+    [[nodiscard]] bool is_rate_limit(const EResult rc) noexcept {
+        return rc == EResult::k_EResultRateLimitExceeded || rc == EResult::k_EResultTooManyPending;
+    }
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Priorities.
+call_priority_scope::call_priority_scope(const call_priority priority) noexcept : _previous{current_priority} {
+    current_priority = priority;
+}
+
+call_priority_scope::~call_priority_scope() noexcept { current_priority = _previous; }
+
+[[nodiscard]] call_priority current_call_priority() noexcept { return current_priority; }
+
+// ----------------------------------------------------------------------------
+// Scheduler.
+call_scheduler::call_scheduler() noexcept : call_scheduler{config{}} {}
+
+call_scheduler::call_scheduler(const config& initial) noexcept { configure(initial); }
+
+void call_scheduler::configure(const config& updated) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _config = updated;
+
+    const clock::time_point now = clock::now();
+
+    for (std::size_t i = 0; i < operation_kind_count; ++i) {
+        const bucket_config& limits = _config.buckets[i];
+        _buckets[i].rate = std::max(std::min(std::max(limits.rate, limits.min_rate), limits.max_rate), rate_floor);
+        _buckets[i].tokens = limits.burst;
+        _buckets[i].refilled = now;
+        _buckets[i].decreased = clock::time_point{};
+    }
+}
+
+[[nodiscard]] call_scheduler::config call_scheduler::configuration() const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _config;
+}
+
+void call_scheduler::refill(bucket& target, const bucket_config& limits, const clock::time_point now) noexcept {
+    const std::chrono::duration<double> elapsed = now - target.refilled;
+
+    if (elapsed.count() > 0) {
+        target.tokens = std::min(target.tokens + elapsed.count() * target.rate, limits.burst);
+        target.refilled = now;
+    }
+}
+
+[[nodiscard]] bool call_scheduler::try_acquire(const operation_kind kind, const call_priority priority, const clock::time_point now) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    if (!_config.enabled) {
+        return true;
+    }
+
+    bucket& target = bucket_of(kind);
+
+    // No overtaking the calls already waiting at the same or a higher priority.
+    for (std::size_t level = 0; level <= static_cast<std::size_t>(priority); ++level) {
+        if (!target.waiting[level].empty()) {
+            return false;
+        }
+    }
+
+    refill(target, limits_of(kind), now);
+
+    if (target.tokens < 1.0) {
+        return false;
+    }
+
+    target.tokens -= 1.0;
+    return true;
+}
+
+void call_scheduler::enqueue(const operation_kind kind, const call_priority priority, const SteamAPICall_t key) {
+    std::lock_guard<std::mutex> lock{_mutex};
+    bucket_of(kind).waiting[static_cast<std::size_t>(priority)].push_back(key);
+}
+
+void call_scheduler::take_ready(std::vector<SteamAPICall_t>& ready, const clock::time_point now) {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    for (std::size_t kind = 0; kind < operation_kind_count; ++kind) {
+        bucket& target = _buckets[kind];
+        refill(target, _config.buckets[kind], now);
+
+        for (auto& queue : target.waiting) {
+            while (!queue.empty() && (!_config.enabled || target.tokens >= 1.0)) {
+                ready.push_back(queue.front());
+                queue.pop_front();
+
+                if (_config.enabled) {
+                    target.tokens -= 1.0;
+                }
+            }
+        }
+    }
+}
+
+void call_scheduler::on_result(const operation_kind kind, const EResult rc, const clock::time_point now) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    if (!_config.enabled) {
+        return;
+    }
+
+    bucket& target = bucket_of(kind);
+    const bucket_config& limits = limits_of(kind);
+
+    if (is_rate_limit(rc)) {
+        if (now - target.decreased >= _config.decrease_cooldown) {
+            target.rate = std::max({target.rate * _config.multiplicative_decrease, limits.min_rate, rate_floor});
+            target.decreased = now;
+        }
+
+        // Whatever was saved up would only run into the limit again.
+        target.tokens = std::min(target.tokens, 0.0);
+        return;
+    }
+
+    if (rc == EResult::k_EResultOK) {
+        target.rate = std::min(target.rate + _config.additive_increase / target.rate, limits.max_rate);
+    }
+}
+
+void call_scheduler::clear() noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    for (bucket& target : _buckets) {
+        for (auto& queue : target.waiting) {
+            queue.clear();
+        }
+    }
+}
+
+[[nodiscard]] double call_scheduler::rate(const operation_kind kind) const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _buckets[static_cast<std::size_t>(kind)].rate;
+}
+
+[[nodiscard]] std::size_t call_scheduler::waiting(const operation_kind kind) const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    std::size_t count = 0;
+
+    for (const auto& queue : _buckets[static_cast<std::size_t>(kind)].waiting) {
+        count += queue.size();
+    }
+
+    return count;
+}
@@ -0,0 +1,536 @@
+#include "../include/contentFingerprint.h"
+
+#include "../include/logger.h"
+#include "../include/mappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+    constexpr uint64_t prime1 = 0x9e3779b185ebca87ull;
+    constexpr uint64_t prime2 = 0xc2b2ae3d27d4eb4full;
+    constexpr uint64_t prime3 = 0x165667b19e3779f9ull;
+    constexpr uint64_t prime4 = 0x85ebca77c2b2ae63ull;
+    constexpr uint64_t prime5 = 0x27d4eb2f165667c5ull;
+
+    [[nodiscard]] constexpr uint64_t rotate_left(const uint64_t value, const unsigned bits) noexcept {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Little endian reads, whatever the host.
+    [[nodiscard]] uint64_t read64(const unsigned char* p) noexcept {
+        uint64_t value = 0;
+
+        for (int i = 7; i >= 0; --i) {
+            value = (value << 8) | p[i];
+        }
+
+        return value;
+    }
+
+    [[nodiscard]] uint64_t read32(const unsigned char* p) noexcept {
+        return uint64_t{p[0]} | (uint64_t{p[1]} << 8) | (uint64_t{p[2]} << 16) | (uint64_t{p[3]} << 24);
+    }
+
+    [[nodiscard]] constexpr uint64_t round(uint64_t accumulator, const uint64_t input) noexcept {
+        accumulator += input * prime2;
+        accumulator = rotate_left(accumulator, 31);
+        return accumulator * prime1;
+    }
+
+    [[nodiscard]] constexpr uint64_t merge_round(uint64_t accumulator, const uint64_t value) noexcept {
+        accumulator ^= round(0, value);
+        return accumulator * prime1 + prime4;
+    }
+
+    void update_u64(xxhash64& hash, const uint64_t value) noexcept {
+        unsigned char bytes[8];
+
+        for (int i = 0; i < 8; ++i) {
+            bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+
+        hash.update(bytes, sizeof(bytes));
+    }
+
+    // 0 stands for a field left out.
+    [[nodiscard]] uint64_t non_zero(const uint64_t hash) noexcept { return hash != 0 ? hash : 1; }
+
+    [[nodiscard]] int64_t modified_ticks(const std::filesystem::path& path, std::error_code& ec) {
+        return static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+    }
+
+    // Paths are stored one per line, the escapes keep them there.
+    [[nodiscard]] std::string escape_path(const std::string& path) {
+        std::string escaped;
+        escaped.reserve(path.size());
+
+        for (const char c : path) {
+            if (c == '\\') {
+                escaped += "\\\\";
+            } else if (c == '\n') {
+                escaped += "\\n";
+            } else if (c == '\r') {
+                escaped += "\\r";
+            } else {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    [[nodiscard]] std::string unescape_path(const std::string_view escaped) {
+        std::string path;
+        path.reserve(escaped.size());
+
+        for (std::size_t i = 0; i < escaped.size(); ++i) {
+            if (escaped[i] != '\\' || i + 1 == escaped.size()) {
+                path += escaped[i];
+                continue;
+            }
+
+            const char next = escaped[++i];
+            path += next == 'n' ? '\n' : next == 'r' ? '\r' : next;
+        }
+
+        return path;
+    }
+
+    constexpr std::string_view store_header = "steam_wrapper_fingerprint 1";
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// XXH64.
+xxhash64::xxhash64(const uint64_t seed) noexcept
+    : _lanes{seed + prime1 + prime2, seed + prime2, seed, seed - prime1}, _buffer{}, _seed{seed} {}
+
+void xxhash64::update(const void* data, std::size_t size) noexcept {
+    if (size == 0) {
+        return;
+    }
+
+    auto p = static_cast<const unsigned char*>(data);
+    _length += size;
+
+    if (_buffered + size < sizeof(_buffer)) {
+        std::memcpy(_buffer + _buffered, p, size);
+        _buffered += size;
+        return;
+    }
+
+    if (_buffered != 0) {
+        const std::size_t fill = sizeof(_buffer) - _buffered;
+        std::memcpy(_buffer + _buffered, p, fill);
+        p += fill;
+        size -= fill;
+        _buffered = 0;
+
+        for (int lane = 0; lane < 4; ++lane) {
+            _lanes[lane] = round(_lanes[lane], read64(_buffer + 8 * lane));
+        }
+    }
+
+    for (; size >= 32; p += 32, size -= 32) {
+        _lanes[0] = round(_lanes[0], read64(p));
+        _lanes[1] = round(_lanes[1], read64(p + 8));
+        _lanes[2] = round(_lanes[2], read64(p + 16));
+        _lanes[3] = round(_lanes[3], read64(p + 24));
+    }
+
+    std::memcpy(_buffer, p, size);
+    _buffered = size;
+}
+
+[[nodiscard]] uint64_t xxhash64::digest() const noexcept {
+    uint64_t hash;
+
+    if (_length >= 32) {
+        hash = rotate_left(_lanes[0], 1) + rotate_left(_lanes[1], 7) + rotate_left(_lanes[2], 12) + rotate_left(_lanes[3], 18);
+
+        for (const uint64_t lane : _lanes) {
+            hash = merge_round(hash, lane);
+        }
+    } else {
+        hash = _seed + prime5;
+    }
+
+    hash += _length;
+
+    const unsigned char* p = _buffer;
+    std::size_t left = _buffered;
+
+    for (; left >= 8; p += 8, left -= 8) {
+        hash ^= round(0, read64(p));
+        hash = rotate_left(hash, 27) * prime1 + prime4;
+    }
+
+    if (left >= 4) {
+        hash ^= read32(p) * prime1;
+        hash = rotate_left(hash, 23) * prime2 + prime3;
+        p += 4;
+        left -= 4;
+    }
+
+    for (; left != 0; ++p, --left) {
+        hash ^= *p * prime5;
+        hash = rotate_left(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+[[nodiscard]] uint64_t xxhash64::hash(const void* data, const std::size_t size, const uint64_t seed) noexcept {
+    xxhash64 state{seed};
+    state.update(data, size);
+    return state.digest();
+}
+
+// ----------------------------------------------------------------------------
+// Fingerprints.
+[[nodiscard]] content_fingerprint::changes content_fingerprint::changed_since(const content_fingerprint& previous) const noexcept {
+    changes changed;
+    changed.content = content != 0 && content != previous.content;
+    changed.preview = preview != 0 && preview != previous.preview;
+    changed.metadata = metadata != 0 && metadata != previous.metadata;
+    return changed;
+}
+
+void content_fingerprint::inherit_unset(const content_fingerprint& previous) {
+    if (content == 0) {
+        content = previous.content;
+        files = previous.files;
+    }
+
+    if (preview == 0) {
+        preview = previous.preview;
+        preview_file = previous.preview_file;
+    }
+
+    if (metadata == 0) {
+        metadata = previous.metadata;
+    }
+}
+
+content_fingerprinter::content_fingerprinter(thread_pool& pool) noexcept : _pool{pool} {}
+
+[[nodiscard]] bool content_fingerprinter::hash_files(const std::filesystem::path& root, std::vector<file_fingerprint>& files,
+                                                     const std::vector<file_fingerprint>* previous, stats& totals) const {
+    // A block of a file to read, the unchanged files are not read at all.
+    struct block {
+        std::size_t file;
+        std::size_t mapping;
+        uint64_t offset;
+    };
+
+    // Mapped once and shared by their blocks, this many files at most at a time to bound open descriptors.
+    constexpr std::size_t batch_files = 1024;
+
+    std::vector<std::size_t> reading;
+    std::vector<std::vector<uint64_t>> block_hashes(files.size());
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        file_fingerprint& file = files[i];
+
+        if (previous != nullptr) {
+            const auto it = std::lower_bound(previous->begin(), previous->end(), file.path,
+                                             [](const file_fingerprint& known, const std::string& path) { return known.path < path; });
+
+            if (it != previous->end() && it->path == file.path && it->size == file.size && it->modified == file.modified) {
+                file.hash = it->hash;
+                continue;
+            }
+        }
+
+        ++totals.files_read;
+        totals.bytes_read += file.size;
+
+        if (file.size == 0) {
+            file.hash = xxhash64::hash(nullptr, 0);
+            continue;
+        }
+
+        block_hashes[i].resize((file.size + block_size - 1) / block_size);
+        reading.push_back(i);
+    }
+
+    std::atomic<bool> failed{false};
+    std::vector<block> blocks;
+
+    for (std::size_t first = 0; first < reading.size(); first += batch_files) {
+        const std::size_t count = std::min(batch_files, reading.size() - first);
+        std::vector<mapped_file> mappings(count);
+
+        _pool.parallel_for(count, [&](const std::size_t index) {
+            const file_fingerprint& file = files[reading[first + index]];
+            const std::filesystem::path path = root / std::filesystem::u8path(file.path);
+
+            if (!mappings[index].open(path) || mappings[index].size() != file.size) {
+                log_error("Fingerprint") << "Could not read '" << path.string() << "'\n";
+                failed.store(true);
+            }
+        });
+
+        if (failed.load()) {
+            return false;
+        }
+
+        blocks.clear();
+
+        for (std::size_t index = 0; index < count; ++index) {
+            const std::size_t file = reading[first + index];
+
+            for (uint64_t b = 0; b < block_hashes[file].size(); ++b) {
+                blocks.push_back({file, index, b * block_size});
+            }
+        }
+
+        _pool.parallel_for(blocks.size(), [&](const std::size_t index) {
+            const block& target = blocks[index];
+            const uint64_t length = std::min<uint64_t>(block_size, files[target.file].size - target.offset);
+            block_hashes[target.file][target.offset / block_size] = xxhash64::hash(mappings[target.mapping].data() + target.offset, length);
+        });
+    }
+
+    // One block is the file's own hash, longer files hash their block hashes.
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const std::vector<uint64_t>& hashes = block_hashes[i];
+
+        if (hashes.size() == 1) {
+            files[i].hash = hashes.front();
+        } else if (hashes.size() > 1) {
+            xxhash64 combined{files[i].size};
+
+            for (const uint64_t hash : hashes) {
+                update_u64(combined, hash);
+            }
+
+            files[i].hash = combined.digest();
+        }
+    }
+
+    totals.files += files.size();
+    return true;
+}
+
+[[nodiscard]] std::optional<content_fingerprint> content_fingerprinter::fingerprint(const std::optional<std::filesystem::path>& content,
+                                                                                    const std::optional<std::filesystem::path>& preview,
+                                                                                    const std::optional<std::string>& title,
+                                                                                    const std::optional<std::string>& description,
+                                                                                    const content_fingerprint* previous,
+                                                                                    stats* totals) const {
+    content_fingerprint result;
+    stats counted;
+    std::error_code ec;
+
+    if (content.has_value()) {
+        std::filesystem::recursive_directory_iterator it{*content, std::filesystem::directory_options::skip_permission_denied, ec};
+
+        for (; !ec && it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+            // Broken links and the like are not part of the upload either.
+            const bool regular = it->is_regular_file(ec);
+
+            if (ec || !regular) {
+                ec.clear();
+                continue;
+            }
+
+            file_fingerprint& file = result.files.emplace_back();
+            file.path = it->path().lexically_relative(*content).generic_u8string();
+            file.size = it->file_size(ec);
+            file.modified = modified_ticks(it->path(), ec);
+
+            if (ec) {
+                break;
+            }
+        }
+
+        if (ec) {
+            log_error("Fingerprint") << "Could not list '" << content->string() << "': " << ec.message() << "\n";
+            return std::nullopt;
+        }
+
+        std::sort(result.files.begin(), result.files.end(),
+                  [](const file_fingerprint& left, const file_fingerprint& right) { return left.path < right.path; });
+
+        if (!hash_files(*content, result.files, previous != nullptr ? &previous->files : nullptr, counted)) {
+            return std::nullopt;
+        }
+
+        xxhash64 digest;
+
+        for (const file_fingerprint& file : result.files) {
+            digest.update(file.path.data(), file.path.size() + 1);
+            update_u64(digest, file.size);
+            update_u64(digest, file.hash);
+        }
+
+        result.content = non_zero(digest.digest());
+    }
+
+    if (preview.has_value()) {
+        std::vector<file_fingerprint> file(1);
+        file.front().path = preview->filename().generic_u8string();
+        file.front().size = std::filesystem::file_size(*preview, ec);
+        file.front().modified = ec ? 0 : modified_ticks(*preview, ec);
+
+        if (ec) {
+            log_error("Fingerprint") << "Could not read '" << preview->string() << "': " << ec.message() << "\n";
+            return std::nullopt;
+        }
+
+        std::vector<file_fingerprint> known;
+
+        if (previous != nullptr && previous->preview_file.has_value()) {
+            known.push_back(*previous->preview_file);
+        }
+
+        if (!hash_files(preview->parent_path(), file, &known, counted)) {
+            return std::nullopt;
+        }
+
+        result.preview_file = std::move(file.front());
+        result.preview = non_zero(result.preview_file->hash);
+    }
+
+    if (title.has_value() || description.has_value()) {
+        xxhash64 digest;
+        digest.update(title.has_value() ? "t" : "-");
+        digest.update(title.value_or("").c_str(), title.value_or("").size() + 1);
+        digest.update(description.has_value() ? "d" : "-");
+        digest.update(description.value_or(""));
+        result.metadata = non_zero(digest.digest());
+    }
+
+    if (totals != nullptr) {
+        *totals = counted;
+    }
+
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Store.
+fingerprint_store::fingerprint_store(std::filesystem::path directory) noexcept : _directory{std::move(directory)} {}
+
+[[nodiscard]] std::filesystem::path fingerprint_store::path_of(const AppId_t app_id, const PublishedFileId_t item_id) const {
+    return _directory / (std::to_string(app_id) + "-" + std::to_string(item_id) + ".fingerprint");
+}
+
+[[nodiscard]] std::optional<content_fingerprint> fingerprint_store::load(const AppId_t app_id, const PublishedFileId_t item_id) const {
+    std::ifstream file{path_of(app_id, item_id)};
+
+    if (!file) {
+        return std::nullopt;
+    }
+
+    content_fingerprint fingerprint;
+    std::string line;
+
+    if (!std::getline(file, line) || line != store_header) {
+        log_warning("Fingerprint") << "Ignoring '" << path_of(app_id, item_id).string() << "', unknown format\n";
+        return std::nullopt;
+    }
+
+    while (std::getline(file, line)) {
+        std::istringstream fields{line};
+        std::string kind;
+        fields >> kind;
+
+        bool valid = true;
+
+        if (kind == "content") {
+            valid = static_cast<bool>(fields >> std::hex >> fingerprint.content);
+        } else if (kind == "preview") {
+            valid = static_cast<bool>(fields >> std::hex >> fingerprint.preview);
+        } else if (kind == "metadata") {
+            valid = static_cast<bool>(fields >> std::hex >> fingerprint.metadata);
+        } else if (kind == "file" || kind == "preview_file") {
+            file_fingerprint entry;
+            valid = static_cast<bool>(fields >> std::dec >> entry.size >> entry.modified >> std::hex >> entry.hash);
+
+            // The path is the rest of the line, spaces included.
+            std::string path;
+            std::getline(fields >> std::ws, path);
+            entry.path = unescape_path(path);
+
+            if (kind == "file") {
+                fingerprint.files.push_back(std::move(entry));
+            } else {
+                fingerprint.preview_file = std::move(entry);
+            }
+        } else {
+            valid = kind.empty();
+        }
+
+        if (!valid) {
+            log_warning("Fingerprint") << "Ignoring '" << path_of(app_id, item_id).string() << "', malformed line '" << line << "'\n";
+            return std::nullopt;
+        }
+    }
+
+    // Written sorted, but a hand edited file would break the lookups.
+    std::sort(fingerprint.files.begin(), fingerprint.files.end(),
+              [](const file_fingerprint& left, const file_fingerprint& right) { return left.path < right.path; });
+
+    return fingerprint;
+}
+
+[[nodiscard]] bool fingerprint_store::save(const AppId_t app_id, const PublishedFileId_t item_id, const content_fingerprint& fingerprint) const {
+    std::error_code ec;
+    std::filesystem::create_directories(_directory, ec);
+
+    const std::filesystem::path target = path_of(app_id, item_id);
+    std::filesystem::path written = target;
+    written += ".tmp";
+
+    {
+        std::ofstream file{written, std::ios::trunc};
+        file << store_header << "\n" << std::hex
+             << "content " << fingerprint.content << "\n"
+             << "preview " << fingerprint.preview << "\n"
+             << "metadata " << fingerprint.metadata << "\n";
+
+        const auto write_file = [&file](const std::string_view kind, const file_fingerprint& entry) {
+            file << kind << " " << std::dec << entry.size << " " << entry.modified << " " << std::hex << entry.hash << " "
+                 << escape_path(entry.path) << "\n";
+        };
+
+        if (fingerprint.preview_file.has_value()) {
+            write_file("preview_file", *fingerprint.preview_file);
+        }
+
+        for (const file_fingerprint& entry : fingerprint.files) {
+            write_file("file", entry);
+        }
+
+        if (!file.flush()) {
+            log_error("Fingerprint") << "Could not write '" << written.string() << "'\n";
+            return false;
+        }
+    }
+
+    std::filesystem::rename(written, target, ec);
+
+    if (ec) {
+        log_error("Fingerprint") << "Could not replace '" << target.string() << "': " << ec.message() << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+void fingerprint_store::forget(const AppId_t app_id, const PublishedFileId_t item_id) const noexcept {
+    std::error_code ec;
+    std::filesystem::remove(path_of(app_id, item_id), ec);
+}
@@ -0,0 +1,671 @@
+#include "../include/contentPack.h"
+
+#include "../include/contentFingerprint.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+
+    constexpr char pack_magic[4] = {'S', 'W', 'P', 'K'};
+    constexpr uint32_t pack_version = 1;
+    constexpr std::size_t header_size = 16;
+    constexpr std::size_t footer_size = 32;
+    constexpr std::size_t max_path_size = 0xffff;
+
+    // Set in a block's header when its bytes are stored as they are.
+    constexpr uint32_t raw_block = 0x80000000u;
+
+    // Small files are compressed together, this many or this large at most, to bound open files and memory.
+    constexpr std::size_t batch_files = 1024;
+    constexpr uint64_t batch_bytes = 64ull << 20;
+
+    [[nodiscard]] uint32_t read_u32(const uint8_t* p) noexcept {
+        return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+    }
+
+    [[nodiscard]] uint64_t read_u64(const uint8_t* p) noexcept { return uint64_t{read_u32(p)} | (uint64_t{read_u32(p + 4)} << 32); }
+
+    void put_u32(std::vector<uint8_t>& out, const uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void put_u64(std::vector<uint8_t>& out, const uint64_t value) {
+        put_u32(out, static_cast<uint32_t>(value));
+        put_u32(out, static_cast<uint32_t>(value >> 32));
+    }
+
+    // ------------------------------------------------------------------------
+    // LZ77 in the LZ4 block layout: a token with the literal and match
+    // lengths, the literals, then a 16 bit offset back into the output.
+    constexpr std::size_t min_match = 4;
+    constexpr int hash_bits = 14;
+
+    // Each 255 byte of a match length stands for 255 more bytes out, nothing in the layout expands further.
+    constexpr uint64_t max_expansion = 255;
+
+    void put_length(std::vector<uint8_t>& out, std::size_t length) {
+        for (; length >= 255; length -= 255) {
+            out.push_back(255);
+        }
+
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    void lz_compress(const uint8_t* source, const std::size_t size, std::vector<uint8_t>& out) {
+        out.clear();
+        out.reserve(size + size / 255 + 16);
+
+        std::vector<uint32_t> table(std::size_t{1} << hash_bits, 0); // Position + 1 of the last sequence seen.
+        std::size_t anchor = 0;
+        std::size_t i = 0;
+
+        // The tail is always left as literals, as LZ4 decoders expect.
+        const std::size_t match_end = size > 5 ? size - 5 : 0;
+        const std::size_t search_end = size > 12 ? size - 12 : 0;
+
+        const auto emit = [&](const std::size_t literal_end, const std::size_t offset, const std::size_t match_length) {
+            const std::size_t literals = literal_end - anchor;
+            const std::size_t token_at = out.size();
+            out.push_back(static_cast<uint8_t>(std::min<std::size_t>(literals, 15) << 4));
+
+            if (literals >= 15) {
+                put_length(out, literals - 15);
+            }
+
+            out.insert(out.end(), source + anchor, source + literal_end);
+
+            if (match_length != 0) {
+                out.push_back(static_cast<uint8_t>(offset));
+                out.push_back(static_cast<uint8_t>(offset >> 8));
+
+                const std::size_t extra = match_length - min_match;
+                out[token_at] |= static_cast<uint8_t>(std::min<std::size_t>(extra, 15));
+
+                if (extra >= 15) {
+                    put_length(out, extra - 15);
+                }
+            }
+        };
+
+        while (i < search_end) {
+            uint32_t sequence;
+            std::memcpy(&sequence, source + i, sizeof(sequence));
+
+            const uint32_t slot = (sequence * 2654435761u) >> (32 - hash_bits);
+            const std::size_t candidate = table[slot];
+            table[slot] = static_cast<uint32_t>(i + 1);
+
+            if (candidate != 0 && i - (candidate - 1) <= 0xffff && std::memcmp(source + candidate - 1, source + i, min_match) == 0) {
+                const std::size_t match = candidate - 1;
+                std::size_t length = min_match;
+
+                while (i + length < match_end && source[match + length] == source[i + length]) {
+                    ++length;
+                }
+
+                emit(i, i - match, length);
+                i += length;
+                anchor = i;
+                continue;
+            }
+
+            // Steps faster through data that does not compress.
+            i += 1 + ((i - anchor) >> 6);
+        }
+
+        emit(size, 0, 0);
+    }
+
+    [[nodiscard]] bool lz_decompress(const uint8_t* source, const std::size_t size, std::byte* target, const std::size_t target_size) noexcept {
+        const auto out = reinterpret_cast<uint8_t*>(target);
+        std::size_t in = 0;
+        std::size_t produced = 0;
+
+        const auto read_length = [&](std::size_t& length) {
+            for (;;) {
+                if (in == size) {
+                    return false;
+                }
+
+                const uint8_t byte = source[in++];
+                length += byte;
+
+                if (byte != 255) {
+                    return true;
+                }
+            }
+        };
+
+        while (in < size) {
+            const uint8_t token = source[in++];
+            std::size_t literals = token >> 4;
+
+            if ((literals == 15 && !read_length(literals)) || literals > size - in || literals > target_size - produced) {
+                return false;
+            }
+
+            std::memcpy(out + produced, source + in, literals);
+            in += literals;
+            produced += literals;
+
+            if (in == size) {
+                break;
+            }
+
+            if (size - in < 2) {
+                return false;
+            }
+
+            const std::size_t offset = source[in] | (std::size_t{source[in + 1]} << 8);
+            in += 2;
+
+            std::size_t length = token & 15;
+
+            if ((length == 15 && !read_length(length)) || offset == 0 || offset > produced) {
+                return false;
+            }
+
+            length += min_match;
+
+            if (length > target_size - produced) {
+                return false;
+            }
+
+            // Overlapping matches repeat what they just wrote, byte by byte.
+            for (std::size_t k = 0; k < length; ++k, ++produced) {
+                out[produced] = out[produced - offset];
+            }
+        }
+
+        return produced == target_size;
+    }
+
+    // ------------------------------------------------------------------------
+    // Writing.
+    struct packed_file {
+        std::string relative;
+        std::filesystem::path source;
+        uint64_t size = 0;
+    };
+
+    struct index_entry {
+        std::string path;
+        content_pack::method storage = content_pack::method::stored;
+        uint64_t offset = 0;
+        uint64_t stored_size = 0;
+        uint64_t size = 0;
+        uint64_t hash = 0;
+    };
+
+    [[nodiscard]] bool worth_it(const std::size_t compressed, const uint64_t size, const double min_saving) noexcept {
+        return static_cast<double>(compressed) + sizeof(uint32_t) <= static_cast<double>(size) * (1.0 - min_saving);
+    }
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Writer.
+content_pack_writer::content_pack_writer(const pack_options options, thread_pool& pool) noexcept : _options{options}, _pool{pool} {}
+
+[[nodiscard]] std::optional<content_pack_writer::stats> content_pack_writer::write(const std::filesystem::path& source, const std::filesystem::path& pack,
+                                                                                   const staging_rules& rules) const {
+    std::error_code ec;
+
+    if (!std::filesystem::is_directory(source, ec)) {
+        log_error("Pack") << "Source folder '" << source.string() << "' not found\n";
+        return std::nullopt;
+    }
+
+    std::vector<packed_file> files;
+    std::filesystem::recursive_directory_iterator it{source, std::filesystem::directory_options::skip_permission_denied, ec};
+
+    for (; !ec && it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+        const bool regular = it->is_regular_file(ec);
+
+        if (ec || !regular) {
+            ec.clear();
+            continue;
+        }
+
+        std::string relative = it->path().lexically_relative(source).generic_u8string();
+
+        if (!rules.selects(relative)) {
+            continue;
+        }
+
+        // The index stores path lengths on 16 bits.
+        if (relative.size() > max_path_size) {
+            log_error("Pack") << "Path of '" << it->path().string() << "' is longer than " << max_path_size << " bytes, cannot pack it\n";
+            return std::nullopt;
+        }
+
+        files.push_back({std::move(relative), it->path(), static_cast<uint64_t>(it->file_size(ec))});
+    }
+
+    if (ec) {
+        log_error("Pack") << "Could not list '" << source.string() << "': " << ec.message() << "\n";
+        return std::nullopt;
+    }
+
+    std::sort(files.begin(), files.end(), [](const packed_file& a, const packed_file& b) { return a.relative < b.relative; });
+
+    std::filesystem::path written = pack;
+    written += ".tmp";
+    std::ofstream out{written, std::ios::binary | std::ios::trunc};
+
+    if (!out) {
+        log_error("Pack") << "Could not create '" << written.string() << "'\n";
+        return std::nullopt;
+    }
+
+    const uint32_t block_size = std::max<uint32_t>(4096, std::min<uint32_t>(_options.block_size, raw_block - 1));
+
+    {
+        std::vector<uint8_t> header{pack_magic, pack_magic + 4};
+        put_u32(header, pack_version);
+        put_u32(header, block_size);
+        put_u32(header, 0);
+        out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    }
+
+    stats totals;
+    uint64_t position = header_size;
+    std::vector<index_entry> index;
+    index.reserve(files.size());
+    bool failed = false;
+
+    const auto append = [&](const void* data, const std::size_t size) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position += size;
+    };
+
+    const auto append_block = [&](const std::vector<uint8_t>& compressed, const std::byte* raw, const uint32_t raw_size) {
+        std::vector<uint8_t> header;
+
+        if (compressed.empty()) {
+            put_u32(header, raw_block | raw_size);
+            append(header.data(), header.size());
+            append(raw, raw_size);
+        } else {
+            put_u32(header, static_cast<uint32_t>(compressed.size()));
+            append(header.data(), header.size());
+            append(compressed.data(), compressed.size());
+        }
+    };
+
+    // Files of a single block, compressed a batch at a time over the pool and written in order.
+    std::vector<std::size_t> batch;
+    uint64_t batched_bytes = 0;
+
+    const auto flush_batch = [&] {
+        struct prepared {
+            mapped_file mapping;
+            std::vector<uint8_t> compressed; // Empty when not worth it.
+            uint64_t hash = 0;
+            bool ok = true;
+        };
+
+        std::vector<prepared> ready(batch.size());
+
+        _pool.parallel_for(batch.size(), [&](const std::size_t i) {
+            const packed_file& file = files[batch[i]];
+            prepared& target = ready[i];
+
+            if (!target.mapping.open(file.source) || target.mapping.size() != file.size) {
+                target.ok = false;
+                return;
+            }
+
+            const auto bytes = reinterpret_cast<const uint8_t*>(target.mapping.data());
+            target.hash = xxhash64::hash(bytes, file.size);
+
+            if (_options.compress) {
+                lz_compress(bytes, file.size, target.compressed);
+
+                if (!worth_it(target.compressed.size(), file.size, _options.min_saving)) {
+                    target.compressed = {};
+                }
+            }
+        });
+
+        for (std::size_t i = 0; i < batch.size() && !failed; ++i) {
+            const packed_file& file = files[batch[i]];
+            prepared& done = ready[i];
+
+            if (!done.ok) {
+                log_error("Pack") << "Could not read '" << file.source.string() << "'\n";
+                failed = true;
+                break;
+            }
+
+            index_entry entry{file.relative, content_pack::method::stored, position, file.size, file.size, done.hash};
+
+            if (!done.compressed.empty()) {
+                entry.storage = content_pack::method::blocks;
+                append_block(done.compressed, nullptr, 0);
+                entry.stored_size = position - entry.offset;
+                ++totals.compressed_files;
+            } else {
+                append(done.mapping.data(), file.size);
+            }
+
+            index.push_back(std::move(entry));
+        }
+
+        batch.clear();
+        batched_bytes = 0;
+    };
+
+    // Larger files go block by block, a window of blocks compressed at a time.
+    const auto write_large = [&](const packed_file& file) {
+        mapped_file mapping;
+
+        if (!mapping.open(file.source) || mapping.size() != file.size) {
+            log_error("Pack") << "Could not read '" << file.source.string() << "'\n";
+            failed = true;
+            return;
+        }
+
+        const auto bytes = reinterpret_cast<const uint8_t*>(mapping.data());
+        const uint64_t blocks = (file.size + block_size - 1) / block_size;
+        index_entry entry{file.relative, content_pack::method::stored, position, file.size, file.size, 0};
+
+        // The first block tells whether the file compresses at all, media usually does not.
+        std::vector<uint8_t> probe;
+
+        if (_options.compress) {
+            lz_compress(bytes, block_size, probe);
+        }
+
+        if (!_options.compress || !worth_it(probe.size(), block_size, _options.min_saving)) {
+            entry.hash = xxhash64::hash(bytes, file.size);
+            append(mapping.data(), file.size);
+            index.push_back(std::move(entry));
+            return;
+        }
+
+        entry.storage = content_pack::method::blocks;
+        xxhash64 hash;
+        const std::size_t window = std::max<std::size_t>(2, _pool.size() * 2);
+        std::vector<std::vector<uint8_t>> compressed(window);
+
+        for (uint64_t first = 0; first < blocks; first += window) {
+            const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(window, blocks - first));
+
+            _pool.parallel_for(count, [&](const std::size_t i) {
+                const uint64_t offset = (first + i) * block_size;
+                const auto length = static_cast<std::size_t>(std::min<uint64_t>(block_size, file.size - offset));
+
+                if (first + i == 0) {
+                    compressed[i] = std::move(probe);
+                } else {
+                    lz_compress(bytes + offset, length, compressed[i]);
+                }
+
+                if (!worth_it(compressed[i].size(), length, 0.0)) {
+                    compressed[i].clear();
+                }
+            });
+
+            for (std::size_t i = 0; i < count; ++i) {
+                const uint64_t offset = (first + i) * block_size;
+                const auto length = static_cast<uint32_t>(std::min<uint64_t>(block_size, file.size - offset));
+
+                hash.update(bytes + offset, length);
+                append_block(compressed[i], mapping.data() + offset, length);
+            }
+        }
+
+        entry.hash = hash.digest();
+        entry.stored_size = position - entry.offset;
+        ++totals.compressed_files;
+        index.push_back(std::move(entry));
+    };
+
+    for (std::size_t i = 0; i < files.size() && !failed; ++i) {
+        const packed_file& file = files[i];
+        totals.bytes += file.size;
+
+        if (file.size > block_size) {
+            flush_batch();
+
+            if (!failed) {
+                write_large(file);
+            }
+            continue;
+        }
+
+        // Empty files cannot be mapped, nothing to write for them anyway.
+        if (file.size == 0) {
+            flush_batch();
+            index.push_back({file.relative, content_pack::method::stored, position, 0, 0, xxhash64::hash(nullptr, 0)});
+            continue;
+        }
+
+        batch.push_back(i);
+        batched_bytes += file.size;
+
+        if (batch.size() == batch_files || batched_bytes >= batch_bytes) {
+            flush_batch();
+        }
+    }
+
+    if (!failed) {
+        flush_batch();
+    }
+
+    if (!failed) {
+        std::vector<uint8_t> serialized;
+
+        for (const index_entry& entry : index) {
+            serialized.push_back(static_cast<uint8_t>(entry.path.size()));
+            serialized.push_back(static_cast<uint8_t>(entry.path.size() >> 8));
+            serialized.insert(serialized.end(), entry.path.begin(), entry.path.end());
+            serialized.push_back(static_cast<uint8_t>(entry.storage));
+            put_u64(serialized, entry.offset);
+            put_u64(serialized, entry.stored_size);
+            put_u64(serialized, entry.size);
+            put_u64(serialized, entry.hash);
+        }
+
+        std::vector<uint8_t> footer;
+        put_u64(footer, position);
+        put_u64(footer, serialized.size());
+        put_u64(footer, xxhash64::hash(serialized.data(), serialized.size()));
+        put_u32(footer, static_cast<uint32_t>(index.size()));
+        footer.insert(footer.end(), pack_magic, pack_magic + 4);
+
+        append(serialized.data(), serialized.size());
+        append(footer.data(), footer.size());
+    }
+
+    out.close();
+
+    if (failed || !out) {
+        if (!failed) {
+            log_error("Pack") << "Could not write '" << written.string() << "'\n";
+        }
+
+        std::filesystem::remove(written, ec);
+        return std::nullopt;
+    }
+
+    std::filesystem::rename(written, pack, ec);
+
+    if (ec) {
+        log_error("Pack") << "Could not replace '" << pack.string() << "': " << ec.message() << "\n";
+        return std::nullopt;
+    }
+
+    totals.files = index.size();
+    totals.packed_bytes = position;
+
+    log_debug("Pack") << "Packed " << totals.files << " files, " << totals.bytes << " bytes into " << totals.packed_bytes << " bytes\n";
+    return totals;
+}
+
+// ----------------------------------------------------------------------------
+// Reader.
+[[nodiscard]] std::optional<content_pack> content_pack::open(const std::filesystem::path& pack_path) {
+    content_pack pack;
+
+    if (!pack._mapping.open(pack_path)) {
+        log_error("Pack") << "Could not open '" << pack_path.string() << "'\n";
+        return std::nullopt;
+    }
+
+    const auto bytes = reinterpret_cast<const uint8_t*>(pack._mapping.data());
+    const std::size_t size = pack._mapping.size();
+
+    const auto damaged = [&pack_path](const char* reason) {
+        log_error("Pack") << "'" << pack_path.string() << "' is not a valid pack: " << reason << "\n";
+        return std::nullopt;
+    };
+
+    if (size < header_size + footer_size || std::memcmp(bytes, pack_magic, 4) != 0 || std::memcmp(bytes + size - 4, pack_magic, 4) != 0) {
+        return damaged("no pack header");
+    }
+
+    if (read_u32(bytes + 4) != pack_version) {
+        return damaged("unknown version");
+    }
+
+    pack._block_size = read_u32(bytes + 8);
+
+    const uint8_t* footer = bytes + size - footer_size;
+    const uint64_t index_offset = read_u64(footer);
+    const uint64_t index_size = read_u64(footer + 8);
+    const uint32_t count = read_u32(footer + 24);
+
+    if (pack._block_size == 0 || index_offset < header_size || index_offset > size - footer_size || index_size != size - footer_size - index_offset) {
+        return damaged("index out of bounds");
+    }
+
+    const uint8_t* index = bytes + index_offset;
+
+    if (xxhash64::hash(index, index_size) != read_u64(footer + 16)) {
+        return damaged("index checksum mismatch");
+    }
+
+    pack._entries.reserve(count);
+    std::size_t at = 0;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (index_size - at < 2) {
+            return damaged("truncated index");
+        }
+
+        const std::size_t path_size = index[at] | (std::size_t{index[at + 1]} << 8);
+        at += 2;
+
+        if (index_size - at < path_size + 33) {
+            return damaged("truncated index");
+        }
+
+        entry parsed;
+        parsed.path = {reinterpret_cast<const char*>(index + at), path_size};
+        at += path_size;
+        parsed.storage = static_cast<method>(index[at++]);
+        parsed.offset = read_u64(index + at);
+        parsed.stored_size = read_u64(index + at + 8);
+        parsed.size = read_u64(index + at + 16);
+        parsed.hash = read_u64(index + at + 24);
+        at += 32;
+
+        // Bounds what read allocates for the file by what its blocks can decompress to.
+        const bool known = parsed.storage == method::stored ? parsed.stored_size == parsed.size
+                                                            : parsed.storage == method::blocks && parsed.size / max_expansion <= parsed.stored_size;
+
+        if (!known || parsed.offset < header_size || parsed.offset > index_offset || parsed.stored_size > index_offset - parsed.offset) {
+            return damaged("entry out of bounds");
+        }
+
+        // Looked up by binary search.
+        if (!pack._entries.empty() && !(pack._entries.back().path < parsed.path)) {
+            return damaged("index not sorted");
+        }
+
+        pack._entries.push_back(parsed);
+    }
+
+    return pack;
+}
+
+[[nodiscard]] const content_pack::entry* content_pack::find(const std::string_view path) const noexcept {
+    const auto it = std::lower_bound(_entries.begin(), _entries.end(), path, [](const entry& e, const std::string_view p) { return e.path < p; });
+    return it != _entries.end() && it->path == path ? &*it : nullptr;
+}
+
+[[nodiscard]] std::optional<content_pack::view> content_pack::view_of(const std::string_view path) const noexcept {
+    const entry* found = find(path);
+
+    if (found == nullptr || found->storage != method::stored) {
+        return std::nullopt;
+    }
+
+    return view{_mapping.data() + found->offset, static_cast<std::size_t>(found->size)};
+}
+
+[[nodiscard]] bool content_pack::read(const std::string_view path, std::vector<std::byte>& out, const bool verify) const {
+    const entry* found = find(path);
+
+    if (found == nullptr) {
+        return false;
+    }
+
+    const auto bytes = reinterpret_cast<const uint8_t*>(_mapping.data());
+    out.resize(static_cast<std::size_t>(found->size));
+
+    if (found->storage == method::stored) {
+        std::memcpy(out.data(), bytes + found->offset, out.size());
+    } else {
+        const uint8_t* block = bytes + found->offset;
+        const uint8_t* const end = block + found->stored_size;
+        std::size_t produced = 0;
+
+        while (produced < out.size()) {
+            if (end - block < 4) {
+                return false;
+            }
+
+            const uint32_t header = read_u32(block);
+            const std::size_t stored = header & ~raw_block;
+            const std::size_t length = std::min<std::size_t>(_block_size, out.size() - produced);
+            block += 4;
+
+            if (static_cast<std::size_t>(end - block) < stored) {
+                return false;
+            }
+
+            if ((header & raw_block) != 0) {
+                if (stored != length) {
+                    return false;
+                }
+
+                std::memcpy(out.data() + produced, block, length);
+            } else if (!lz_decompress(block, stored, out.data() + produced, length)) {
+                return false;
+            }
+
+            block += stored;
+            produced += length;
+        }
+
+        if (block != end) {
+            return false;
+        }
+    }
+
+    if (verify && xxhash64::hash(out.data(), out.size()) != found->hash) {
+        log_error("Pack") << "'" << found->path << "' does not match its checksum\n";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,421 @@
+#include "../include/contentStaging.h"
+
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <set>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <sys/clonefile.h>
+#endif
+
+namespace {
+
+    [[nodiscard]] bool glob(std::string_view pattern, std::string_view path) noexcept {
+        for (;;) {
+            if (pattern.empty()) {
+                return path.empty();
+            }
+
+            if (pattern.substr(0, 2) == "**") {
+                pattern.remove_prefix(2);
+
+                // "**/" also matches no folder at all, so tries right after each '/' only.
+                const bool whole_components = !pattern.empty() && pattern.front() == '/';
+
+                if (whole_components) {
+                    pattern.remove_prefix(1);
+                }
+
+                for (std::size_t i = 0;;) {
+                    if (glob(pattern, path.substr(i))) {
+                        return true;
+                    }
+
+                    if (whole_components) {
+                        if ((i = path.find('/', i)) == std::string_view::npos) {
+                            return false;
+                        }
+                        ++i;
+                    } else if (i++ == path.size()) {
+                        return false;
+                    }
+                }
+            }
+
+            if (pattern.front() == '*') {
+                pattern.remove_prefix(1);
+
+                for (std::size_t i = 0;; ++i) {
+                    if (glob(pattern, path.substr(i))) {
+                        return true;
+                    }
+
+                    if (i == path.size() || path[i] == '/') {
+                        return false;
+                    }
+                }
+            }
+
+            if (path.empty() || (pattern.front() == '?' ? path.front() == '/' : pattern.front() != path.front())) {
+                return false;
+            }
+
+            pattern.remove_prefix(1);
+            path.remove_prefix(1);
+        }
+    }
+
+    // True when `inner` is `outer` or lies somewhere below it.
+    [[nodiscard]] bool contains(const std::filesystem::path& outer, const std::filesystem::path& inner) {
+        const auto [outer_end, inner_it] = std::mismatch(outer.begin(), outer.end(), inner.begin(), inner.end());
+        return outer_end == outer.end();
+    }
+
+    [[nodiscard]] bool unsupported(const int error) noexcept {
+        return error == EXDEV || error == EPERM || error == EACCES || error == ENOTSUP || error == EOPNOTSUPP ||
+               error == EINVAL || error == ENOSYS || error == EMLINK
+#ifdef ENOTTY
+               || error == ENOTTY
+#endif
+            ;
+    }
+
+    // Copy-on-write clone, false where the filesystem or platform has none.
+    [[nodiscard]] bool clone_file(const std::filesystem::path& source, const std::filesystem::path& destination, int& error) noexcept {
+#if defined(__linux__) && defined(FICLONE)
+        const int from = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (from < 0) {
+            error = errno;
+            return false;
+        }
+
+        struct stat info;
+        const mode_t mode = ::fstat(from, &info) == 0 ? (info.st_mode & 0777) : 0644;
+        const int to = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+
+        if (to < 0) {
+            error = errno;
+            ::close(from);
+            return false;
+        }
+
+        const bool cloned = ::ioctl(to, FICLONE, from) == 0;
+        error = cloned ? 0 : errno;
+
+        ::close(to);
+        ::close(from);
+
+        if (!cloned) {
+            ::unlink(destination.c_str());
+        }
+
+        return cloned;
+#elif defined(__APPLE__)
+        if (::clonefile(source.c_str(), destination.c_str(), 0) == 0) {
+            return true;
+        }
+
+        error = errno;
+        return false;
+#else
+        (void)source;
+        (void)destination;
+        error = ENOTSUP;
+        return false;
+#endif
+    }
+
+    // Kernel side copy where available, a plain copy otherwise.
+    [[nodiscard]] bool copy_file(const std::filesystem::path& source, const std::filesystem::path& destination, const uint64_t size) noexcept {
+#ifdef __linux__
+        const int from = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (from >= 0) {
+            struct stat info;
+            const mode_t mode = ::fstat(from, &info) == 0 ? (info.st_mode & 0777) : 0644;
+            const int to = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+            uint64_t copied = 0;
+
+            if (to >= 0) {
+                while (copied < size) {
+                    const ssize_t chunk = ::copy_file_range(from, nullptr, to, nullptr, static_cast<std::size_t>(size - copied), 0);
+
+                    if (chunk <= 0) {
+                        break;
+                    }
+
+                    copied += static_cast<uint64_t>(chunk);
+                }
+
+                ::close(to);
+            }
+
+            ::close(from);
+
+            if (to >= 0 && copied == size) {
+                return true;
+            }
+
+            // Started by copy_file_range, finished below.
+            if (to >= 0) {
+                ::unlink(destination.c_str());
+            }
+        }
+#endif
+        std::error_code ec;
+        return std::filesystem::copy_file(source, destination, ec) && !ec;
+    }
+
+    struct staged_file {
+        std::string relative; // '/' separated.
+        std::filesystem::path source;
+        uint64_t size = 0;
+        std::filesystem::file_time_type modified;
+    };
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Rules.
+[[nodiscard]] bool staging_rules::matches(const std::string_view pattern, const std::string_view relative_path) noexcept {
+    if (pattern.find('/') != std::string_view::npos) {
+        return glob(pattern, relative_path);
+    }
+
+    const std::size_t slash = relative_path.rfind('/');
+    return glob(pattern, slash == std::string_view::npos ? relative_path : relative_path.substr(slash + 1));
+}
+
+[[nodiscard]] bool staging_rules::selects(const std::string_view relative_path) const noexcept {
+    const auto matching = [relative_path](const std::string& pattern) { return matches(pattern, relative_path); };
+
+    return (include.empty() || std::any_of(include.begin(), include.end(), matching)) &&
+           std::none_of(exclude.begin(), exclude.end(), matching);
+}
+
+// ----------------------------------------------------------------------------
+// Staging.
+content_stager::content_stager(const staging_options stager_options, thread_pool& pool) noexcept : _options{stager_options}, _pool{pool} {}
+
+[[nodiscard]] std::optional<content_stager::stats> content_stager::stage(const std::filesystem::path& source, const std::filesystem::path& destination,
+                                                                         const staging_rules& rules) const {
+    std::error_code ec;
+
+    if (!std::filesystem::is_directory(source, ec)) {
+        log_error("Staging") << "Source folder '" << source.string() << "' not found\n";
+        return std::nullopt;
+    }
+
+    const std::filesystem::path source_root = std::filesystem::canonical(source, ec);
+    std::filesystem::path destination_root;
+
+    if (!ec) {
+        destination_root = std::filesystem::weakly_canonical(destination, ec);
+    }
+
+    // Staging into the build output would stage itself, and cleaning the other way round deletes it.
+    if (ec || contains(source_root, destination_root) || contains(destination_root, source_root)) {
+        log_error("Staging") << "Staging folder '" << destination.string() << "' overlaps the source folder '" << source.string() << "'\n";
+        return std::nullopt;
+    }
+
+    std::vector<staged_file> files;
+    std::set<std::string> folders;
+    std::filesystem::recursive_directory_iterator it{source_root, std::filesystem::directory_options::skip_permission_denied, ec};
+
+    for (; !ec && it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+        const bool regular = it->is_regular_file(ec);
+
+        if (ec || !regular) {
+            ec.clear();
+            continue;
+        }
+
+        const std::string relative = it->path().lexically_relative(source_root).generic_u8string();
+
+        if (!rules.selects(relative)) {
+            continue;
+        }
+
+        staged_file file;
+        file.relative = relative;
+        file.source = it->path();
+        file.size = it->file_size(ec);
+        file.modified = it->last_write_time(ec);
+
+        if (ec) {
+            break;
+        }
+
+        for (std::size_t slash = relative.find('/'); slash != std::string::npos; slash = relative.find('/', slash + 1)) {
+            folders.insert(relative.substr(0, slash));
+        }
+
+        files.push_back(std::move(file));
+    }
+
+    if (ec) {
+        log_error("Staging") << "Could not list '" << source.string() << "': " << ec.message() << "\n";
+        return std::nullopt;
+    }
+
+    std::sort(files.begin(), files.end(), [](const staged_file& a, const staged_file& b) { return a.relative < b.relative; });
+
+    stats totals;
+    totals.files = files.size();
+
+    // What a previous staging left and this one does not want goes first.
+    const auto staged = [&files](const std::string& relative) {
+        const auto it = std::lower_bound(files.begin(), files.end(), relative,
+                                         [](const staged_file& file, const std::string& path) { return file.relative < path; });
+        return it != files.end() && it->relative == relative;
+    };
+
+    if (std::filesystem::exists(destination_root, ec)) {
+        std::vector<std::filesystem::path> stale;
+        std::filesystem::recursive_directory_iterator existing{destination_root, ec};
+
+        for (; !ec && existing != std::filesystem::recursive_directory_iterator{}; existing.increment(ec)) {
+            const std::string relative = existing->path().lexically_relative(destination_root).generic_u8string();
+            const bool folder = existing->is_directory(ec) && !existing->is_symlink(ec);
+
+            const bool wanted = folder ? folders.count(relative) != 0 : staged(relative);
+
+            if (!wanted) {
+                stale.push_back(existing->path());
+
+                if (folder) {
+                    existing.disable_recursion_pending();
+                }
+            }
+        }
+
+        for (std::size_t i = 0; !ec && i < stale.size(); ++i) {
+            const std::uintmax_t count = std::filesystem::remove_all(stale[i], ec);
+            totals.removed += ec ? 0 : count;
+        }
+
+        if (ec) {
+            log_error("Staging") << "Could not clean '" << destination.string() << "': " << ec.message() << "\n";
+            return std::nullopt;
+        }
+    }
+
+    std::filesystem::create_directories(destination_root, ec);
+
+    for (const std::string& folder : folders) {
+        std::filesystem::create_directories(destination_root / std::filesystem::u8path(folder), ec);
+    }
+
+    if (ec) {
+        log_error("Staging") << "Could not create '" << destination.string() << "': " << ec.message() << "\n";
+        return std::nullopt;
+    }
+
+    // Given up on for the whole folder after the first refusal, usually a cross-device link.
+    std::atomic<bool> hardlinks{_options.hardlinks};
+    std::atomic<bool> reflinks{_options.reflinks};
+    std::atomic<bool> failed{false};
+    std::atomic<uint64_t> reused{0}, hardlinked{0}, reflinked{0}, copied{0}, bytes_copied{0};
+
+    _pool.parallel_for(files.size(), [&](const std::size_t index) {
+        const staged_file& file = files[index];
+        const std::filesystem::path target = destination_root / std::filesystem::u8path(file.relative);
+        std::error_code file_ec;
+
+        if (failed.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        if (std::filesystem::is_regular_file(target, file_ec)) {
+            if (std::filesystem::equivalent(file.source, target, file_ec) ||
+                (std::filesystem::file_size(target, file_ec) == file.size && std::filesystem::last_write_time(target, file_ec) == file.modified && !file_ec)) {
+                ++reused;
+                return;
+            }
+
+            // A hardlink written through would change the source, only ever replaced.
+            if (!std::filesystem::remove(target, file_ec)) {
+                log_error("Staging") << "Could not replace '" << target.string() << "'\n";
+                failed.store(true);
+                return;
+            }
+        }
+
+        if (hardlinks.load(std::memory_order_relaxed)) {
+            file_ec.clear();
+            std::filesystem::create_hard_link(file.source, target, file_ec);
+
+            if (!file_ec) {
+                ++hardlinked;
+                return;
+            }
+
+            if (unsupported(file_ec.value()) && hardlinks.exchange(false)) {
+                log_debug("Staging") << "No hardlinks into '" << destination.string() << "' (" << file_ec.message() << "), trying clones\n";
+            }
+        }
+
+        if (reflinks.load(std::memory_order_relaxed)) {
+            int error = 0;
+
+            if (clone_file(file.source, target, error)) {
+                std::filesystem::last_write_time(target, file.modified, file_ec);
+                ++reflinked;
+                return;
+            }
+
+            if (unsupported(error) && reflinks.exchange(false)) {
+                log_debug("Staging") << "No clones into '" << destination.string() << "', copying\n";
+            }
+        }
+
+        if (!copy_file(file.source, target, file.size)) {
+            log_error("Staging") << "Could not stage '" << file.source.string() << "'\n";
+            failed.store(true);
+            return;
+        }
+
+        // Same write time as the source, the next staging then reuses the copy.
+        file_ec.clear();
+        std::filesystem::last_write_time(target, file.modified, file_ec);
+        ++copied;
+        bytes_copied += file.size;
+    });
+
+    if (failed.load()) {
+        return std::nullopt;
+    }
+
+    totals.reused = reused.load();
+    totals.hardlinked = hardlinked.load();
+    totals.reflinked = reflinked.load();
+    totals.copied = copied.load();
+    totals.bytes_copied = bytes_copied.load();
+
+    log_debug("Staging") << "Staged " << totals.files << " files into '" << destination.string() << "': " << totals.reused << " reused, "
+                         << totals.hardlinked << " hardlinked, " << totals.reflinked << " cloned, " << totals.copied << " copied\n";
+    return totals;
+}
+
+bool content_stager::remove(const std::filesystem::path& destination) noexcept {
+    std::error_code ec;
+    std::filesystem::remove_all(destination, ec);
+
+    if (ec) {
+        log_error("Staging") << "Could not remove staging folder '" << destination.string() << "': " << ec.message() << "\n";
+        return false;
+    }
+
+    return true;
+}
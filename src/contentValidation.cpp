@@ -0,0 +1,214 @@
+#include "../include/contentValidation.h"
+
+#include "../include/contentStaging.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
+namespace {
+
+    void add_issue(content_report& report, const validation_problem problem, const std::filesystem::path& path, const uint64_t size = 0) {
+        ++report.issue_count;
+
+        if (report.issues.size() < content_report::max_issues) {
+            report.issues.push_back({problem, path, size});
+        }
+    }
+
+    [[nodiscard]] bool forbidden(const std::vector<std::string>& patterns, const std::string& relative) noexcept {
+        return std::any_of(patterns.begin(), patterns.end(),
+                           [&relative](const std::string& pattern) { return staging_rules::matches(pattern, relative); });
+    }
+
+    // Steam takes PNG, JPEG and GIF previews, told apart by their first bytes.
+    [[nodiscard]] bool known_image(const unsigned char* header, const std::size_t size) noexcept {
+        static constexpr unsigned char png[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        static constexpr unsigned char jpeg[] = {0xff, 0xd8, 0xff};
+        static constexpr unsigned char gif[] = {'G', 'I', 'F', '8'};
+
+        const auto starts_with = [header, size](const unsigned char* magic, const std::size_t length) {
+            return size >= length && std::equal(magic, magic + length, header);
+        };
+
+        return starts_with(png, sizeof(png)) || starts_with(jpeg, sizeof(jpeg)) || starts_with(gif, sizeof(gif));
+    }
+
+} // namespace
+
+content_validator::content_validator(validation_limits limits, thread_pool& pool) noexcept : _limits{std::move(limits)}, _pool{pool} {}
+
+void content_validator::check_content(const std::filesystem::path& root, content_report& report) const {
+    std::error_code ec;
+
+    if (!std::filesystem::exists(root, ec)) {
+        add_issue(report, validation_problem::missing, root);
+        return;
+    }
+
+    if (!std::filesystem::is_directory(root, ec)) {
+        add_issue(report, validation_problem::not_a_folder, root);
+        return;
+    }
+
+    std::mutex mutex;
+    std::vector<std::filesystem::path> level{root};
+
+    // Folders of a level are listed in parallel, their subfolders make the next level.
+    while (!level.empty()) {
+        std::vector<std::filesystem::path> next;
+
+        _pool.parallel_for(level.size(), [&](const std::size_t index) {
+            const std::filesystem::path& folder = level[index];
+            content_report found;
+            std::vector<std::filesystem::path> subfolders;
+            std::error_code walk_ec;
+
+            std::filesystem::directory_iterator it{folder, walk_ec};
+
+            for (; !walk_ec && it != std::filesystem::directory_iterator{}; it.increment(walk_ec)) {
+                std::error_code entry_ec;
+                const std::filesystem::file_status status = it->status(entry_ec);
+
+                // A broken link is also what Steam would fail to read.
+                if (entry_ec) {
+                    add_issue(found, validation_problem::unreadable, it->path());
+                    continue;
+                }
+
+                if (std::filesystem::is_directory(status)) {
+                    // Linked folders are not followed, they may loop.
+                    if (!it->is_symlink(entry_ec)) {
+                        subfolders.push_back(it->path());
+                    }
+                    continue;
+                }
+
+                if (!std::filesystem::is_regular_file(status)) {
+                    continue;
+                }
+
+                const uint64_t size = it->file_size(entry_ec);
+                const std::string relative = it->path().lexically_relative(root).generic_u8string();
+
+                ++found.files;
+                found.bytes += size;
+
+                if (forbidden(_limits.forbidden, relative)) {
+                    add_issue(found, validation_problem::forbidden_file, it->path(), size);
+                } else if (_limits.max_file_bytes != 0 && size > _limits.max_file_bytes) {
+                    add_issue(found, validation_problem::file_too_large, it->path(), size);
+                } else if (entry_ec || !std::ifstream{it->path(), std::ios::binary}.is_open()) {
+                    add_issue(found, validation_problem::unreadable, it->path(), size);
+                }
+            }
+
+            // Could not be listed, or not to the end.
+            if (walk_ec) {
+                add_issue(found, validation_problem::unreadable, folder);
+            }
+
+            std::lock_guard<std::mutex> lock{mutex};
+            report.files += found.files;
+            report.bytes += found.bytes;
+            report.issue_count += found.issue_count - found.issues.size();
+
+            for (validation_issue& issue : found.issues) {
+                add_issue(report, issue.problem, issue.path, issue.size);
+            }
+
+            next.insert(next.end(), std::make_move_iterator(subfolders.begin()), std::make_move_iterator(subfolders.end()));
+        });
+
+        level = std::move(next);
+    }
+
+    if (report.files == 0 && !_limits.allow_empty_content) {
+        add_issue(report, validation_problem::empty_content, root);
+    }
+
+    if (_limits.max_content_bytes != 0 && report.bytes > _limits.max_content_bytes) {
+        add_issue(report, validation_problem::content_too_large, root, report.bytes);
+    }
+}
+
+void content_validator::check_preview(const std::filesystem::path& preview, content_report& report) const {
+    std::error_code ec;
+
+    if (!std::filesystem::is_regular_file(preview, ec)) {
+        add_issue(report, std::filesystem::exists(preview, ec) ? validation_problem::unreadable : validation_problem::missing, preview);
+        return;
+    }
+
+    report.preview_bytes = std::filesystem::file_size(preview, ec);
+    std::ifstream file{preview, std::ios::binary};
+    unsigned char header[8] = {};
+
+    if (ec || !file.is_open()) {
+        add_issue(report, validation_problem::unreadable, preview);
+        return;
+    }
+
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if (!known_image(header, static_cast<std::size_t>(file.gcount()))) {
+        add_issue(report, validation_problem::preview_format, preview, report.preview_bytes);
+    }
+
+    if (report.preview_bytes > _limits.max_preview_bytes) {
+        add_issue(report, validation_problem::preview_too_large, preview, report.preview_bytes);
+    }
+}
+
+[[nodiscard]] content_report content_validator::validate(const std::optional<std::filesystem::path>& content,
+                                                         const std::optional<std::filesystem::path>& preview) const {
+    content_report report;
+
+    if (content.has_value()) {
+        check_content(*content, report);
+    }
+
+    if (preview.has_value()) {
+        check_preview(*preview, report);
+    }
+
+    std::stable_sort(report.issues.begin(), report.issues.end(),
+                     [](const validation_issue& a, const validation_issue& b) { return a.path < b.path; });
+    return report;
+}
+
+[[nodiscard]] std::vector<content_report> content_validator::validate(const std::vector<target>& targets) const {
+    std::vector<content_report> reports(targets.size());
+
+    _pool.parallel_for(targets.size(), [&](const std::size_t index) {
+        reports[index] = validate(targets[index].content, targets[index].preview);
+    });
+
+    return reports;
+}
+
+[[nodiscard]] std::string_view content_validator::problem_name(const validation_problem problem) noexcept {
+    switch (problem) {
+    case validation_problem::missing: return "not found";
+    case validation_problem::not_a_folder: return "not a folder";
+    case validation_problem::unreadable: return "unreadable";
+    case validation_problem::empty_content: return "no files";
+    case validation_problem::file_too_large: return "file too large";
+    case validation_problem::content_too_large: return "content too large";
+    case validation_problem::forbidden_file: return "forbidden file";
+    case validation_problem::preview_too_large: return "preview too large";
+    case validation_problem::preview_format: return "preview neither PNG, JPEG nor GIF";
+    }
+
+    return "invalid";
+}
+
+[[nodiscard]] std::string content_validator::describe(const validation_issue& issue) {
+    std::string line = "'" + issue.path.string() + "': " + std::string{problem_name(issue.problem)};
+
+    if (issue.size != 0) {
+        line += " (" + std::to_string(issue.size) + " bytes)";
+    }
+
+    return line;
+}
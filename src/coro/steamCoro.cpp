@@ -0,0 +1,84 @@
+#include "../../include/steamCoro.h"
+
+#include <chrono>
+
+namespace steam_coro {
+
+// ----------------------------------------------------------------------------
+// Awaitables.
+bool create_item_awaitable::await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    _awaiting = awaiting;
+
+    // Per call, awaits for different apps may be in flight together.
+    const SteamAPICall_t api_call = _helper.create_workshop_item(_app_id,
+        [this](const EResult rc, const PublishedFileId_t item_id) {
+            _result = {rc, item_id};
+            _awaiting.resume();
+        });
+
+    // Not issued, the completion will never run: resume right away.
+    return api_call != k_uAPICallInvalid;
+}
+
+bool query_awaitable::await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    _awaiting = awaiting;
+
+    const SteamAPICall_t api_call = _helper.send_query_request(_query_handle,
+        [this](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+            // The handle is released once this returns, extract before resuming.
+            _helper.read_query_page(rc, completed, _result);
+            _awaiting.resume();
+        });
+
+    return api_call != k_uAPICallInvalid;
+}
+
+bool submit_awaitable::await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    _awaiting = awaiting;
+
+    const SteamAPICall_t api_call = _helper.submit_item_update(_update_handle, _change_note.c_str(),
+        [this](const EResult rc, const PublishedFileId_t item_id) {
+            _result = {rc, item_id};
+            _awaiting.resume();
+        });
+
+    return api_call != k_uAPICallInvalid;
+}
+
+// ----------------------------------------------------------------------------
+// Executor.
+executor::detached executor::run_detached(executor& self, task<void> work) {
+    co_await std::move(work);
+    self.on_task_done();
+}
+
+// Tasks finish from a completion, the helper wakes its waiters right after.
+void executor::on_task_done() noexcept {
+    _active_tasks.fetch_sub(1);
+}
+
+void executor::spawn(task<void> work) {
+    _active_tasks.fetch_add(1);
+    run_detached(*this, std::move(work));
+}
+
+void executor::run_until_idle() noexcept {
+    using clock = std::chrono::steady_clock;
+    const clock::time_point deadline = clock::now() + std::chrono::seconds(240);
+
+    while (_active_tasks.load() > 0) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - clock::now());
+
+        if (remaining.count() <= 0) {
+            log_error("Steam") << "Coroutine executor timed out waiting for its tasks\n";
+            return;
+        }
+
+        if (!_helper.run_callbacks_until([this] { return _active_tasks.load() == 0; }, remaining) && !_helper.initialized()) {
+            log_error("Steam") << "Coroutine executor stopped, Steam API is not initialized\n";
+            return;
+        }
+    }
+}
+
+} // namespace steam_coro
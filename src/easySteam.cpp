@@ -13,13 +13,35 @@ namespace easySteam {
         _steam_helper.reset(new steam_helper);
     }
 
+    /// @brief Runs the Steam callbacks on a background thread.
+    ///
+    /// Blocking calls then sleep until their operation completes instead of
+    /// polling the Steam API themselves.
+    void startCallbackPump() {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return;
+        }
+
+        _steam_helper->start_callback_pump();
+    }
+
+    void stopCallbackPump() {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return;
+        }
+
+        _steam_helper->stop_callback_pump();
+    }
+
     bool setCloudFilenameFilter(const char* cloudFileName) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -32,11 +54,11 @@ namespace easySteam {
     /// @param matchAnyTag
     bool setMatchAnyTag(const bool matchAnyTag) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -45,11 +67,11 @@ namespace easySteam {
 
     bool setSearchText(const char* searchText) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -58,11 +80,11 @@ namespace easySteam {
 
     bool setRankedByTrendDays(const uint32 nbDays) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -71,11 +93,11 @@ namespace easySteam {
     
     bool addRequiredTag(const char* tagName) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -84,11 +106,11 @@ namespace easySteam {
 
     bool addExcludedTag(const char* tagName) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -97,11 +119,11 @@ namespace easySteam {
 
     bool returnLongDescription(const bool enabled) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -110,11 +132,11 @@ namespace easySteam {
 
     bool returnTotalOnly(const bool enabled) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
@@ -123,17 +145,30 @@ namespace easySteam {
 
     bool allowCachedResponse(const uint32 maxAgeSeconds) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return false;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
             return false;
         }
 
         return _steam_helper->allow_cached_response(queryHandle, maxAgeSeconds);
     }
 
+    bool setProjection(const uint32 projection, const uint32 playtimeStatsDays) {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return false;
+        }
+        if(queryHandle == 0) {
+            log_error("easySteam") << "Please create a query first.\n";
+            return false;
+        }
+
+        return _steam_helper->set_projection(queryHandle, projection, playtimeStatsDays);
+    }
+
     /// @brief "User" query creation function.
     /// @param accountID
     /// @param listType
@@ -144,11 +179,11 @@ namespace easySteam {
     /// @param page
     void createQuery(AccountID_t accountID, EUserUGCList listType, EUGCMatchingUGCType matchingType, EUserUGCListSortOrder sortOrder, AppId_t creatorAppID, AppId_t consumerAppID, uint32_t page) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return;
         }
         if (creatorAppID == 0 || consumerAppID == 0) {
-            std::cout << "Please set your app ID.\n";
+            log_error("easySteam") << "Please set your app ID.\n";
             return;
         }
 
@@ -163,11 +198,11 @@ namespace easySteam {
     /// @param page 
     void createQuery(EUGCQuery listType, EUGCMatchingUGCType matchingType, AppId_t creatorAppID, AppId_t consumerAppID, uint32_t page) {
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return;
         }
         if (creatorAppID == 0 || consumerAppID == 0) {
-            std::cout << "Please set your app ID.\n";
+            log_error("easySteam") << "Please set your app ID.\n";
             return;
         }
 
@@ -178,7 +213,7 @@ namespace easySteam {
         
         int it = 1;
 
-        for (const auto& itemInfo : itemList) {
+        for ([[maybe_unused]] const auto& itemInfo : itemList) {
             // Parse the item info after each third index
             if (it % 3 == 0) {
                 
@@ -200,36 +235,116 @@ namespace easySteam {
     void sendQuery(std::vector<SteamUGCDetails_t> &itemListDetails, std::vector<char*> &imageListURL) {
 
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return;
+        }
+
+        if (auto results = sendQuery(); results != nullptr) {
+            _steam_helper->get_query_results(std::move(results), itemListDetails, imageListURL);
+        }
+
+        // if (workshopItems.empty()) {
+        //     std::cout << "No items found.\n";
+        //     return {};
+        // }
+    }
+
+    /// @brief Sends the query to the Steam API and returns the result set.
+    /// @note This function should be called after creating a query.
+    std::shared_ptr<const query_result_set> sendQuery() {
+
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return nullptr;
         }
         if(queryHandle == 0) {
-            std::cout << "Please create a query first.\n";
+            log_error("easySteam") << "Please create a query first.\n";
+            return nullptr;
         }
 
+        // Shared, the query may still complete after polling timed out.
+        struct outcome {
+            std::atomic<bool> done{false};
+            std::shared_ptr<const query_result_set> results;
+        };
+
+        auto state = std::make_shared<outcome>();
+        steam_helper* helper = _steam_helper.get();
+
+        // Read from this query's own completion, the helper's last results may already be another query's.
         _steam_helper->send_query_request(queryHandle,
-            [&](UGCQueryHandle_t query_handle) {
-                std::cout << "Query went successfully.\n";
+            [state, helper](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+                if (rc == EResult::k_EResultOK) {
+                    log_debug("easySteam") << "Query went successfully.\n";
+
+                    const auto key = helper->get_query_key(completed.m_handle);
+                    state->results = query_result_set::read(rc, completed, key.has_value() ? key->projection : projection_default);
+                }
+
+                state->done.store(true);
             });
 
         if (poll_steam_callbacks(*_steam_helper)) {
-            std::cout << "Steam callbacks processed successfully.\n";
+            log_debug("easySteam") << "Steam callbacks processed successfully.\n";
         } else {
-            std::cout << "Error processing Steam callbacks or timed out.\n";
+            log_error("easySteam") << "Error processing Steam callbacks or timed out.\n";
         }
 
-        _steam_helper->get_query_results(itemListDetails, imageListURL);
+        // The query handle is released by the helper once the query completes.
+        queryHandle = 0;
 
-        _steam_helper->release_query_handle(queryHandle);
+        return state->done.load() ? state->results : nullptr;
+    }
 
-        // if (workshopItems.empty()) {
-        //     std::cout << "No items found.\n";
-        //     return {};
-        // }
+    /// @brief Executes a prepared query on a fresh handle.
+    /// @param spec
+    /// @return The lazily read result set, nullptr on failure.
+    std::shared_ptr<const query_result_set> sendQuery(const QuerySpec& spec) {
+
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return nullptr;
+        }
+
+        const UGCQueryHandle_t query_handle = spec.create_handle(*_steam_helper);
+
+        if (query_handle == k_UGCQueryHandleInvalid) {
+            log_error("easySteam") << "Error: the query could not be created.\n";
+            return nullptr;
+        }
+
+        // Shared, the query may still complete after waiting timed out.
+        struct outcome {
+            std::atomic<bool> done{false};
+            std::shared_ptr<query_result_set> results;
+        };
+
+        auto state = std::make_shared<outcome>();
+
+        const SteamAPICall_t api_call = _steam_helper->send_query_request(query_handle,
+            [state](const EResult rc, std::shared_ptr<query_result_set> results) {
+                if (rc == EResult::k_EResultOK) {
+                    state->results = std::move(results);
+                }
+
+                state->done.store(true);
+            });
+
+        if (api_call == k_uAPICallInvalid) {
+            return nullptr;
+        }
+
+        if (!_steam_helper->run_callbacks_until([&state] { return state->done.load(); }, std::chrono::seconds(240))) {
+            log_error("easySteam") << "Error processing Steam callbacks or timed out.\n";
+            return nullptr;
+        }
+
+        return state->results;
     }
 
     void createItem(uint64_t app_id) {
         if (app_id == 0) {
-            std::cout << "Please set your app ID.\n";
+            log_error("easySteam") << "Please set your app ID.\n";
             return;
         }
 
@@ -237,14 +352,14 @@ namespace easySteam {
 
         _steam_helper->create_workshop_item(
             [&](const PublishedFileId_t new_item_id) {
-                std::cout << "Successfully created new workshop item: " << new_item_id << ".\n";
+                log_info("easySteam") << "Successfully created new workshop item: " << new_item_id << ".\n";
                 itemID = new_item_id;
             });
 
         if (poll_steam_callbacks(*_steam_helper)) {
-            std::cout << "Steam callbacks processed successfully.\n";
+            log_debug("easySteam") << "Steam callbacks processed successfully.\n";
         } else {
-            std::cout << "Error processing Steam callbacks or timed out.\n";
+            log_error("easySteam") << "Error processing Steam callbacks or timed out.\n";
         }
     }
 
@@ -252,13 +367,13 @@ namespace easySteam {
     {
         if (initUpdateHandleCalled)
         {
-            std::cout << "Error : you should call initUpdateHandle only once, before changing your item content.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle only once, before changing your item content.\n";
             return;
         }
 
         if (!_steam_helper)
         {
-            std::cout << "Steam helper is not initialized.\n";
+            log_error("easySteam") << "Steam helper is not initialized.\n";
             return;
         }
         if (easySteam::appID != 0) {
@@ -270,7 +385,7 @@ namespace easySteam {
 
         if (!update_handle.has_value())
         {
-            std::cout << "Failed to initialize update handle.\n";
+            log_error("easySteam") << "Failed to initialize update handle.\n";
         }
     }
 
@@ -279,34 +394,43 @@ namespace easySteam {
         return update_handle;
     }
 
+    std::optional<UGCQueryHandle_t> getQueryHandle()
+    {
+        if (queryHandle == 0 || queryHandle == k_UGCQueryHandleInvalid) {
+            return std::nullopt;
+        }
+
+        return queryHandle;
+    }
+
     void updateItem(uint64_t app_id, uint64_t item_id) {
         
         _steam_helper->app_id = app_id;
 
         if (!easySteam::update_handle.has_value())
         {
-            std::cout << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
             return;
         }
 
         if (easySteam::update_handle.value() != item_id)
         {
-            std::cout << "Error : you should call initUpdateHandle with the correct item_id.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle with the correct item_id.\n";
             return;
         }
 
         if (!update_handle.has_value()) {
-            std::cout << "Failure getting update handle\n";
+            log_error("easySteam") << "Failure getting update handle\n";
             return;
         }
 
-        std::cout << "Update handle obtained successfully.\n";
+        log_debug("easySteam") << "Update handle obtained successfully.\n";
     }
 
     void setPreviewImage(const std::filesystem::path& file_path) {
         if (!easySteam::update_handle.has_value())
         {
-            std::cout << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
             return;
         }
 
@@ -314,53 +438,113 @@ namespace easySteam {
 
         if (!_steam_helper->set_workshop_item_preview_image(handle, file_path))
         {
-            std::cout << "Failure setting workshop item preview image\n";
+            log_error("easySteam") << "Failure setting workshop item preview image\n";
         }
     }
 
+    void setPreviewImage(const std::filesystem::path& file_path, uint32_t maxWidth, uint32_t maxHeight) {
+        preview_options options;
+        options.max_width = maxWidth;
+        options.max_height = maxHeight;
+
+        const std::optional<preview_processor::result> processed =
+            preview_processor{file_path.parent_path() / ".workshop_previews", options}.process(file_path);
+
+        if (!processed.has_value()) {
+            log_error("easySteam") << "Failure processing workshop item preview image\n";
+            return;
+        }
+
+        setPreviewImage(processed->path);
+    }
+
     void setWorkshopItemTitle(const std::string& title) {
         if (!easySteam::update_handle.has_value())
         {
-            std::cout << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
             return;
         }
 
         UGCUpdateHandle_t handle = easySteam::update_handle.value();
         if (!_steam_helper->set_workshop_item_title(handle, title)) {
-            std::cout << "Failure setting workshop item title\n";
+            log_error("easySteam") << "Failure setting workshop item title\n";
         }
     }
 
     void setWorkshopItemDescription(const std::string& description) {
         if (!easySteam::update_handle.has_value())
         {
-            std::cout << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
             return;
         }
 
         UGCUpdateHandle_t handle = easySteam::update_handle.value();
         if (!_steam_helper->set_workshop_item_description(handle, description)) {
-            std::cout << "Failure setting workshop item description\n";
+            log_error("easySteam") << "Failure setting workshop item description\n";
         }
     }
 
     void setWorkshopItemContent(const std::filesystem::path& directory_path) {
         if (!easySteam::update_handle.has_value())
         {
-            std::cout << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
             return;
         }
 
         UGCUpdateHandle_t handle = easySteam::update_handle.value();
         if (!_steam_helper->set_workshop_item_content(handle, directory_path)) {
-            std::cout << "Failure setting workshop item content\n";
+            log_error("easySteam") << "Failure setting workshop item content\n";
+        }
+    }
+
+    void setWorkshopItemContent(const std::filesystem::path& directory_path, const std::vector<std::string>& include,
+                                const std::vector<std::string>& exclude) {
+        if (!easySteam::update_handle.has_value())
+        {
+            log_error("easySteam") << "Error : you should call initUpdateHandle before setting the workshop item content.\n";
+            return;
+        }
+
+        // Next to the build output, on the same filesystem so the files can be hardlinked.
+        std::filesystem::path folder = directory_path.lexically_normal();
+
+        if (!folder.has_filename()) {
+            folder = folder.parent_path();
+        }
+
+        const std::filesystem::path staging_root = folder.parent_path() / ".workshop_staging";
+
+        UGCUpdateHandle_t handle = easySteam::update_handle.value();
+        if (!_steam_helper->stage_workshop_item_content(handle, directory_path, staging_root, staging_rules{include, exclude})) {
+            log_error("easySteam") << "Failure setting workshop item content\n";
+        }
+    }
+
+    void setWorkshopItemContentPacked(const std::filesystem::path& directory_path) {
+        if (!easySteam::update_handle.has_value())
+        {
+            log_error("easySteam") << "Error : you should call initUpdateHandle before setting the workshop item content.\n";
+            return;
+        }
+
+        std::filesystem::path folder = directory_path.lexically_normal();
+
+        if (!folder.has_filename()) {
+            folder = folder.parent_path();
+        }
+
+        const std::filesystem::path staging_root = folder.parent_path() / ".workshop_staging";
+
+        UGCUpdateHandle_t handle = easySteam::update_handle.value();
+        if (!_steam_helper->pack_workshop_item_content(handle, directory_path, staging_root)) {
+            log_error("easySteam") << "Failure setting workshop item content\n";
         }
     }
 
     void submitWorkshopItemUpdate(uint64_t item_id, const std::string& changelog_note) {
         if (!easySteam::update_handle.has_value())
         {
-            std::cout << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
             return;
         }
 
@@ -368,7 +552,7 @@ namespace easySteam {
         _steam_helper->submit_item_update(handle,
             changelog_note.c_str(),
             [item_id] {
-                std::cout << "Successfully updated workshop item: " << item_id << ".\n";
+                log_info("easySteam") << "Successfully updated workshop item: " << item_id << ".\n";
             });
 
     }
@@ -376,7 +560,7 @@ namespace easySteam {
     void getWorkshopItemUploadProgress(long *remaining, long *totalSize) {
         if (!easySteam::update_handle.has_value())
         {
-            std::cout << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
             return;
         }
 
@@ -395,17 +579,112 @@ namespace easySteam {
         *totalSize = static_cast<long>(total);
     }
 
+    bool validateWorkshopContent(const std::filesystem::path& contentPath, const std::filesystem::path& previewPath) {
+        const content_report report = content_validator{}.validate(
+            contentPath, previewPath.empty() ? std::nullopt : std::optional<std::filesystem::path>{previewPath});
+
+        for (const validation_issue& issue : report.issues) {
+            log_error("easySteam") << content_validator::describe(issue) << "\n";
+        }
+
+        if (report.issue_count > report.issues.size()) {
+            log_error("easySteam") << (report.issue_count - report.issues.size()) << " more problems not listed\n";
+        }
+
+        return report.ok();
+    }
+
+    bool publishManifest(const std::filesystem::path& manifestPath, uint32_t maxInFlight) {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return false;
+        }
+
+        const std::optional<publish_manifest> manifest = publish_manifest::load(manifestPath);
+
+        if (!manifest.has_value()) {
+            return false;
+        }
+
+        bulk_publisher::options options;
+        options.max_submits_in_flight = maxInFlight;
+        // Next to the manifest, so CI caches can keep it between releases.
+        options.fingerprint_directory = manifestPath.parent_path() / ".workshop_fingerprints";
+        options.preview_cache_directory = manifestPath.parent_path() / ".workshop_previews";
+        options.on_item = [&manifest](const bulk_publisher::item_outcome& outcome) {
+            if (outcome.result == EResult::k_EResultOK) {
+                log_info("easySteam") << "Published workshop item " << outcome.item_id << " (manifest line "
+                                      << manifest->entries[outcome.index].line << ").\n";
+            }
+        };
+
+        const bulk_publisher::result result = bulk_publisher{*_steam_helper, std::move(options)}.run(manifest->entries);
+        return result.result == EResult::k_EResultOK && result.published == manifest->entries.size();
+    }
+
+    bool getWorkshopItemUploadProgress(uint64_t& processed, uint64_t& total, EItemUpdateStatus* status) {
+        processed = 0;
+        total = 0;
+
+        if (!easySteam::update_handle.has_value())
+        {
+            log_error("easySteam") << "Error : you should call initUpdateHandle before getting the upload progress.\n";
+            return false;
+        }
+
+        const EItemUpdateStatus current = _steam_helper->get_item_upload_status(easySteam::update_handle.value(), processed, total);
+
+        if (status != nullptr) {
+            *status = current;
+        }
+
+        return current != EItemUpdateStatus::k_EItemUpdateStatusInvalid;
+    }
+
+    upload_monitor::subscription subscribeUploadProgress(upload_monitor::subscriber callback) {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return 0;
+        }
+
+        return _steam_helper->uploads().subscribe(std::move(callback));
+    }
+
+    void unsubscribeUploadProgress(upload_monitor::subscription subscription) {
+        if (_steam_helper) {
+            _steam_helper->uploads().unsubscribe(subscription);
+        }
+    }
+
     void unsubscribeWorkshopItem(uint64_t item_id) {
 
         if (!_steam_helper) {
-            std::cout << "Error: _steam_helper is not initialized.\n";
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
             return;
         }
 
         if (!_steam_helper->unsubscribe_item(item_id)) {
-            std::cout << "Failed to unsubscribe from workshop item: " << item_id << ".\n";
+            log_error("easySteam") << "Failed to unsubscribe from workshop item: " << item_id << ".\n";
+        }
+
+    }
+
+    std::string metricsPrometheus() {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return {};
+        }
+
+        return _steam_helper->metrics().to_prometheus();
+    }
+
+    std::string metricsJson() {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            return {};
         }
 
+        return _steam_helper->metrics().to_json();
     }
 
 } // namespace easySteam
@@ -0,0 +1,137 @@
+#include "../include/easySteamAsync.h"
+
+namespace easySteam::async {
+
+    namespace {
+
+        // Completions are delivered from the callback pump, make sure it runs.
+        bool ensureCallbackPump() {
+            if (!_steam_helper) {
+                log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+                return false;
+            }
+
+            if (!_steam_helper->callback_pump_running()) {
+                _steam_helper->start_callback_pump();
+            }
+
+            return _steam_helper->callback_pump_running();
+        }
+
+    } // namespace
+
+    /// @brief Creates a new workshop item for the given app.
+    /// @param app_id
+    /// @return Future resolved with the new item ID, or the failing EResult.
+    future<CreatedItem_t> createItem(uint64_t app_id) {
+        promise<CreatedItem_t> created;
+
+        if (app_id == 0) {
+            log_error("easySteam") << "Please set your app ID.\n";
+            created.set_value({EResult::k_EResultInvalidParam, 0});
+            return created.get_future();
+        }
+
+        if (!ensureCallbackPump()) {
+            created.set_value({EResult::k_EResultFail, 0});
+            return created.get_future();
+        }
+
+        // Per call rather than through the shared app_id, creations for different apps may be in flight together.
+        const SteamAPICall_t api_call = _steam_helper->create_workshop_item(static_cast<AppId_t>(app_id),
+            [created](const EResult rc, const PublishedFileId_t new_item_id) {
+                created.set_value({rc, new_item_id});
+            });
+
+        if (api_call == k_uAPICallInvalid) {
+            created.set_value({EResult::k_EResultFail, 0});
+        }
+
+        return created.get_future();
+    }
+
+    /// @brief Sends a query created with easySteam::createQuery.
+    /// @param query_handle
+    /// @return Future resolved with the returned page of items, or the failing EResult.
+    future<QueryPage_t> sendQuery(UGCQueryHandle_t query_handle) {
+        promise<QueryPage_t> page;
+
+        if (query_handle == 0 || query_handle == k_UGCQueryHandleInvalid) {
+            log_error("easySteam") << "Please create a query first.\n";
+            page.set_value({EResult::k_EResultInvalidParam, 0, {}, {}});
+            return page.get_future();
+        }
+
+        if (!ensureCallbackPump()) {
+            page.set_value({EResult::k_EResultFail, 0, {}, {}});
+            return page.get_future();
+        }
+
+        const SteamAPICall_t api_call = _steam_helper->send_query_request(query_handle,
+            [page](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+                query_page read;
+                _steam_helper->read_query_page(rc, completed, read);
+                page.set_value({rc, read.total_matching, std::move(read.items), std::move(read.preview_urls)});
+            });
+
+        if (api_call == k_uAPICallInvalid) {
+            page.set_value({EResult::k_EResultFail, 0, {}, {}});
+        }
+
+        return page.get_future();
+    }
+
+    /// @brief Executes a prepared query on a fresh handle.
+    /// @param spec Query to run, unchanged so it can be sent again.
+    /// @return Future resolved with the returned page of items, or the failing EResult.
+    future<QueryPage_t> sendQuery(const QuerySpec& spec) {
+        if (!_steam_helper) {
+            log_error("easySteam") << "Error: _steam_helper is not initialized.\n";
+            promise<QueryPage_t> page;
+            page.set_value({EResult::k_EResultFail, 0, {}, {}});
+            return page.get_future();
+        }
+
+        const UGCQueryHandle_t query_handle = spec.create_handle(*_steam_helper);
+
+        if (query_handle == k_UGCQueryHandleInvalid) {
+            log_error("easySteam") << "Steam rejected the query spec, no query handle could be created.\n";
+            promise<QueryPage_t> page;
+            page.set_value({EResult::k_EResultFail, 0, {}, {}});
+            return page.get_future();
+        }
+
+        return sendQuery(query_handle);
+    }
+
+    /// @brief Submits the changes made through an update handle.
+    /// @param update_handle
+    /// @param changelog_note
+    /// @return Future resolved once the upload finished, with its EResult.
+    future<SubmittedItem_t> submitWorkshopItemUpdate(UGCUpdateHandle_t update_handle, const std::string& changelog_note) {
+        promise<SubmittedItem_t> submitted;
+
+        if (update_handle == k_UGCUpdateHandleInvalid) {
+            log_error("easySteam") << "Error : you should call initUpdateHandle before submitting.\n";
+            submitted.set_value({EResult::k_EResultInvalidParam, 0});
+            return submitted.get_future();
+        }
+
+        if (!ensureCallbackPump()) {
+            submitted.set_value({EResult::k_EResultFail, 0});
+            return submitted.get_future();
+        }
+
+        const SteamAPICall_t api_call = _steam_helper->submit_item_update(update_handle, changelog_note.c_str(),
+            [submitted](const EResult rc, const PublishedFileId_t item_id) {
+                submitted.set_value({rc, item_id});
+            });
+
+        if (api_call == k_uAPICallInvalid) {
+            submitted.set_value({EResult::k_EResultFail, 0});
+        }
+
+        return submitted.get_future();
+    }
+
+} // namespace easySteam::async
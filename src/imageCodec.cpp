@@ -0,0 +1,979 @@
+#include "../include/imageCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+    [[nodiscard]] uint32_t read_be32(const uint8_t* p) noexcept {
+        return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | uint32_t{p[3]};
+    }
+
+    [[nodiscard]] uint32_t read_be16(const uint8_t* p) noexcept { return (uint32_t{p[0]} << 8) | uint32_t{p[1]}; }
+
+    [[nodiscard]] uint32_t read_le16(const uint8_t* p) noexcept { return uint32_t{p[0]} | (uint32_t{p[1]} << 8); }
+
+    constexpr uint8_t png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    // Larger images are not previews, and would take gigabytes to decode.
+    constexpr uint32_t max_dimension = 16384;
+
+    // ------------------------------------------------------------------------
+    // Inflate (RFC 1951), decoding a canonical Huffman code bit by bit.
+    class inflater {
+
+    private:
+        struct huffman {
+            uint16_t count[16] = {};
+            uint16_t symbol[288] = {};
+        };
+
+        const uint8_t* _data;
+        std::size_t _size;
+        std::size_t _position = 0;
+        uint32_t _bit_buffer = 0;
+        int _bit_count = 0;
+        bool _overrun = false;
+
+        std::vector<uint8_t>& _output;
+        std::size_t _limit;
+
+        [[nodiscard]] int bits(const int needed) noexcept {
+            uint32_t value = _bit_buffer;
+
+            while (_bit_count < needed) {
+                if (_position == _size) {
+                    _overrun = true;
+                    return 0;
+                }
+
+                value |= uint32_t{_data[_position++]} << _bit_count;
+                _bit_count += 8;
+            }
+
+            _bit_buffer = value >> needed;
+            _bit_count -= needed;
+            return static_cast<int>(value & ((1u << needed) - 1));
+        }
+
+        // Codes left unused by the lengths: negative when over-subscribed, positive when incomplete.
+        static int build(huffman& table, const uint8_t* lengths, const int count) noexcept {
+            uint16_t offsets[16] = {};
+            std::fill(std::begin(table.count), std::end(table.count), uint16_t{0});
+
+            for (int i = 0; i < count; ++i) {
+                ++table.count[lengths[i]];
+            }
+
+            table.count[0] = 0;
+
+            int left = 1;
+
+            for (int length = 1; length < 16; ++length) {
+                left = (left << 1) - table.count[length];
+
+                if (left < 0) {
+                    return left;
+                }
+            }
+
+            for (int length = 1; length < 15; ++length) {
+                offsets[length + 1] = static_cast<uint16_t>(offsets[length] + table.count[length]);
+            }
+
+            for (int i = 0; i < count; ++i) {
+                if (lengths[i] != 0) {
+                    table.symbol[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+                }
+            }
+
+            return left;
+        }
+
+        // As zlib: no over-subscribed code, and no incomplete one unless it has a single symbol.
+        [[nodiscard]] static bool usable(const huffman& table, const int left) noexcept {
+            int used = 0;
+
+            for (int length = 1; length < 16; ++length) {
+                used += table.count[length];
+            }
+
+            return left == 0 || (left > 0 && used == table.count[1]);
+        }
+
+        [[nodiscard]] int decode(const huffman& table) noexcept {
+            int code = 0;
+            int first = 0;
+            int index = 0;
+
+            for (int length = 1; length < 16; ++length) {
+                code |= bits(1);
+
+                if (_overrun) {
+                    return -1;
+                }
+
+                const int count = table.count[length];
+
+                if (code - count < first) {
+                    return table.symbol[index + (code - first)];
+                }
+
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+
+            return -1;
+        }
+
+        [[nodiscard]] bool stored() noexcept {
+            _bit_buffer = 0;
+            _bit_count = 0;
+
+            if (_position + 4 > _size) {
+                return false;
+            }
+
+            const std::size_t length = _data[_position] | (std::size_t{_data[_position + 1]} << 8);
+            const std::size_t complement = _data[_position + 2] | (std::size_t{_data[_position + 3]} << 8);
+            _position += 4;
+
+            if (length != (~complement & 0xffff) || _position + length > _size || _output.size() + length > _limit) {
+                return false;
+            }
+
+            _output.insert(_output.end(), _data + _position, _data + _position + length);
+            _position += length;
+            return true;
+        }
+
+        [[nodiscard]] bool codes(const huffman& lengths, const huffman& distances) noexcept {
+            static constexpr uint16_t length_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                         35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+            static constexpr uint8_t length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                         3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+            static constexpr uint16_t distance_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                                           193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                                           6145, 8193, 12289, 16385, 24577};
+            static constexpr uint8_t distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+            for (;;) {
+                int symbol = decode(lengths);
+
+                if (symbol < 0) {
+                    return false;
+                }
+
+                if (symbol < 256) {
+                    if (_output.size() == _limit) {
+                        return false;
+                    }
+
+                    _output.push_back(static_cast<uint8_t>(symbol));
+                    continue;
+                }
+
+                if (symbol == 256) {
+                    return true;
+                }
+
+                if ((symbol -= 257) >= 29) {
+                    return false;
+                }
+
+                const std::size_t length = length_base[symbol] + static_cast<std::size_t>(bits(length_extra[symbol]));
+                const int distance_symbol = decode(distances);
+
+                if (distance_symbol < 0 || distance_symbol >= 30) {
+                    return false;
+                }
+
+                const std::size_t distance = distance_base[distance_symbol] + static_cast<std::size_t>(bits(distance_extra[distance_symbol]));
+
+                if (_overrun || distance > _output.size() || _output.size() + length > _limit) {
+                    return false;
+                }
+
+                // May overlap what it copies, byte by byte on purpose.
+                for (std::size_t i = 0; i < length; ++i) {
+                    _output.push_back(_output[_output.size() - distance]);
+                }
+            }
+        }
+
+        [[nodiscard]] bool fixed() noexcept {
+            uint8_t lengths[288 + 30];
+            std::fill(lengths, lengths + 144, uint8_t{8});
+            std::fill(lengths + 144, lengths + 256, uint8_t{9});
+            std::fill(lengths + 256, lengths + 280, uint8_t{7});
+            std::fill(lengths + 280, lengths + 288, uint8_t{8});
+            std::fill(lengths + 288, lengths + 318, uint8_t{5});
+
+            huffman literal;
+            huffman distance;
+            (void)build(literal, lengths, 288);
+            (void)build(distance, lengths + 288, 30);
+            return codes(literal, distance);
+        }
+
+        [[nodiscard]] bool dynamic() noexcept {
+            static constexpr uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+            const int literal_count = bits(5) + 257;
+            const int distance_count = bits(5) + 1;
+            const int code_count = bits(4) + 4;
+
+            if (_overrun || literal_count > 286 || distance_count > 30) {
+                return false;
+            }
+
+            uint8_t lengths[286 + 30] = {};
+
+            for (int i = 0; i < code_count; ++i) {
+                lengths[order[i]] = static_cast<uint8_t>(bits(3));
+            }
+
+            huffman code_lengths;
+
+            if (build(code_lengths, lengths, 19) != 0) {
+                return false;
+            }
+
+            std::fill(std::begin(lengths), std::end(lengths), uint8_t{0});
+
+            for (int i = 0; i < literal_count + distance_count;) {
+                int symbol = decode(code_lengths);
+
+                if (symbol < 0) {
+                    return false;
+                }
+
+                if (symbol < 16) {
+                    lengths[i++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                uint8_t repeated = 0;
+                int repeat = 0;
+
+                if (symbol == 16) {
+                    if (i == 0) {
+                        return false;
+                    }
+
+                    repeated = lengths[i - 1];
+                    repeat = 3 + bits(2);
+                } else if (symbol == 17) {
+                    repeat = 3 + bits(3);
+                } else {
+                    repeat = 11 + bits(7);
+                }
+
+                if (_overrun || i + repeat > literal_count + distance_count) {
+                    return false;
+                }
+
+                while (repeat-- != 0) {
+                    lengths[i++] = repeated;
+                }
+            }
+
+            // Without an end of block code nothing could be decoded.
+            if (lengths[256] == 0) {
+                return false;
+            }
+
+            huffman literal;
+            huffman distance;
+            const int literal_left = build(literal, lengths, literal_count);
+            const int distance_left = build(distance, lengths + literal_count, distance_count);
+
+            if (!usable(literal, literal_left) || !usable(distance, distance_left)) {
+                return false;
+            }
+
+            return codes(literal, distance);
+        }
+
+    public:
+        inflater(const uint8_t* data, const std::size_t size, std::vector<uint8_t>& output, const std::size_t limit) noexcept
+            : _data{data}, _size{size}, _output{output}, _limit{limit} {}
+
+        [[nodiscard]] bool run() noexcept {
+            for (bool last = false; !last;) {
+                last = bits(1) != 0;
+                const int type = bits(2);
+
+                if (_overrun) {
+                    return false;
+                }
+
+                const bool decoded = type == 0 ? stored() : type == 1 ? fixed() : type == 2 ? dynamic() : false;
+
+                if (!decoded) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    // ------------------------------------------------------------------------
+    // PNG rows.
+    [[nodiscard]] uint8_t paeth(const int a, const int b, const int c) noexcept {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        return static_cast<uint8_t>(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+    }
+
+    [[nodiscard]] bool unfilter(std::vector<uint8_t>& raw, const uint32_t height, const std::size_t stride, const std::size_t pixel_bytes) noexcept {
+        std::vector<uint8_t> previous(stride, 0);
+
+        for (uint32_t y = 0; y < height; ++y) {
+            uint8_t* row = raw.data() + y * (stride + 1);
+            const uint8_t filter = row[0];
+            uint8_t* line = row + 1;
+
+            for (std::size_t x = 0; x < stride; ++x) {
+                const int left = x >= pixel_bytes ? line[x - pixel_bytes] : 0;
+                const int up = previous[x];
+                const int up_left = x >= pixel_bytes ? previous[x - pixel_bytes] : 0;
+
+                switch (filter) {
+                    case 0: break;
+                    case 1: line[x] = static_cast<uint8_t>(line[x] + left); break;
+                    case 2: line[x] = static_cast<uint8_t>(line[x] + up); break;
+                    case 3: line[x] = static_cast<uint8_t>(line[x] + ((left + up) >> 1)); break;
+                    case 4: line[x] = static_cast<uint8_t>(line[x] + paeth(left, up, up_left)); break;
+                    default: return false;
+                }
+            }
+
+            std::memcpy(previous.data(), line, stride);
+        }
+
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // Baseline JPEG.
+    constexpr uint8_t zigzag[64] = {0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+                                    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+                                    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+                                    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+    constexpr uint8_t luma_quantization[64] = {16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+                                               14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+                                               18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+                                               49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+
+    constexpr uint8_t chroma_quantization[64] = {17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+                                                 24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+                                                 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+                                                 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+
+    // The example tables of the standard's annex K, good for any image.
+    constexpr uint8_t dc_luma_counts[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+    constexpr uint8_t dc_chroma_counts[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+    constexpr uint8_t dc_symbols[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+    constexpr uint8_t ac_luma_counts[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+    constexpr uint8_t ac_luma_symbols[162] = {
+        0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81,
+        0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18,
+        0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+        0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75,
+        0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+        0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+        0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5,
+        0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+    constexpr uint8_t ac_chroma_counts[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+    constexpr uint8_t ac_chroma_symbols[162] = {
+        0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08,
+        0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0, 0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25,
+        0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47,
+        0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74,
+        0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+        0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba,
+        0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4,
+        0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+    struct huffman_code {
+        uint16_t code[256] = {};
+        uint8_t length[256] = {};
+
+        huffman_code(const uint8_t (&counts)[16], const uint8_t* symbols) noexcept {
+            uint16_t next = 0;
+
+            for (int bits = 1, k = 0; bits <= 16; ++bits, next <<= 1) {
+                for (int i = 0; i < counts[bits - 1]; ++i, ++k, ++next) {
+                    code[symbols[k]] = next;
+                    length[symbols[k]] = static_cast<uint8_t>(bits);
+                }
+            }
+        }
+    };
+
+    class bit_writer {
+
+    private:
+        std::vector<std::byte>& _output;
+        uint32_t _buffer = 0;
+        int _count = 0;
+
+    public:
+        explicit bit_writer(std::vector<std::byte>& output) noexcept : _output{output} {}
+
+        void write(const uint32_t value, const int bits) {
+            _buffer = (_buffer << bits) | (value & ((1u << bits) - 1));
+            _count += bits;
+
+            while (_count >= 8) {
+                const auto byte = static_cast<uint8_t>(_buffer >> (_count - 8));
+                _output.push_back(std::byte{byte});
+
+                // A 0xff in the data must not read as a marker.
+                if (byte == 0xff) {
+                    _output.push_back(std::byte{0});
+                }
+
+                _count -= 8;
+            }
+        }
+
+        void flush() {
+            if (_count != 0) {
+                write(0x7f, 8 - _count);
+            }
+        }
+    };
+
+    struct dct_table {
+        float c[8][8];
+
+        dct_table() noexcept {
+            const float pi = 3.14159265358979f;
+
+            for (int u = 0; u < 8; ++u) {
+                const float scale = u == 0 ? std::sqrt(0.125f) : 0.5f;
+
+                for (int x = 0; x < 8; ++x) {
+                    c[u][x] = scale * std::cos((2.0f * x + 1.0f) * u * pi / 16.0f);
+                }
+            }
+        }
+    };
+
+    void encode_block(bit_writer& out, const float (&samples)[64], const float (&divisors)[64], int& previous_dc,
+                      const huffman_code& dc, const huffman_code& ac) {
+        static const dct_table dct;
+        float rows[64];
+        int coefficients[64];
+
+        for (int y = 0; y < 8; ++y) {
+            for (int u = 0; u < 8; ++u) {
+                float sum = 0.0f;
+
+                for (int x = 0; x < 8; ++x) {
+                    sum += dct.c[u][x] * samples[y * 8 + x];
+                }
+
+                rows[y * 8 + u] = sum;
+            }
+        }
+
+        for (int u = 0; u < 8; ++u) {
+            for (int v = 0; v < 8; ++v) {
+                float sum = 0.0f;
+
+                for (int y = 0; y < 8; ++y) {
+                    sum += dct.c[v][y] * rows[y * 8 + u];
+                }
+
+                coefficients[v * 8 + u] = static_cast<int>(std::lround(sum / divisors[v * 8 + u]));
+            }
+        }
+
+        const auto magnitude = [](const int value) {
+            int bits = 0;
+
+            for (int rest = std::abs(value); rest != 0; rest >>= 1) {
+                ++bits;
+            }
+
+            return bits;
+        };
+
+        // Negative values are sent as their one's complement in as many bits.
+        const auto write_value = [&out](const int value, const int bits) {
+            if (bits != 0) {
+                out.write(static_cast<uint32_t>(value < 0 ? value + (1 << bits) - 1 : value), bits);
+            }
+        };
+
+        const int difference = coefficients[0] - previous_dc;
+        previous_dc = coefficients[0];
+
+        const int dc_bits = magnitude(difference);
+        out.write(dc.code[dc_bits], dc.length[dc_bits]);
+        write_value(difference, dc_bits);
+
+        int run = 0;
+
+        for (int k = 1; k < 64; ++k) {
+            const int value = coefficients[zigzag[k]];
+
+            if (value == 0) {
+                ++run;
+                continue;
+            }
+
+            for (; run > 15; run -= 16) {
+                out.write(ac.code[0xf0], ac.length[0xf0]);
+            }
+
+            const int bits = magnitude(value);
+            const int symbol = (run << 4) | bits;
+            out.write(ac.code[symbol], ac.length[symbol]);
+            write_value(value, bits);
+            run = 0;
+        }
+
+        if (run != 0) {
+            out.write(ac.code[0x00], ac.length[0x00]);
+        }
+    }
+
+    void put_u8(std::vector<std::byte>& out, const unsigned value) { out.push_back(static_cast<std::byte>(value & 0xff)); }
+
+    void put_u16(std::vector<std::byte>& out, const unsigned value) {
+        put_u8(out, value >> 8);
+        put_u8(out, value);
+    }
+
+    void put_huffman_table(std::vector<std::byte>& out, const unsigned id, const uint8_t (&counts)[16], const uint8_t* symbols) {
+        unsigned total = 0;
+
+        for (const uint8_t count : counts) {
+            total += count;
+        }
+
+        put_u16(out, 0xffc4);
+        put_u16(out, 2 + 1 + 16 + total);
+        put_u8(out, id);
+
+        for (const uint8_t count : counts) {
+            put_u8(out, count);
+        }
+
+        for (unsigned i = 0; i < total; ++i) {
+            put_u8(out, symbols[i]);
+        }
+    }
+
+} // namespace
+
+namespace image_codec {
+
+    [[nodiscard]] image_info probe(const std::byte* data, const std::size_t size) noexcept {
+        const auto bytes = reinterpret_cast<const uint8_t*>(data);
+        image_info info;
+
+        if (size >= 24 && std::memcmp(bytes, png_signature, 8) == 0 && std::memcmp(bytes + 12, "IHDR", 4) == 0) {
+            info = {image_format::png, read_be32(bytes + 16), read_be32(bytes + 20)};
+        } else if (size >= 10 && std::memcmp(bytes, "GIF8", 4) == 0) {
+            info = {image_format::gif, read_le16(bytes + 6), read_le16(bytes + 8)};
+        } else if (size >= 4 && bytes[0] == 0xff && bytes[1] == 0xd8) {
+            info.format = image_format::jpeg;
+
+            // The size is in the start of frame segment, after any metadata.
+            for (std::size_t at = 2; at + 9 <= size && bytes[at] == 0xff;) {
+                const uint8_t marker = bytes[at + 1];
+
+                if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+                    info.height = read_be16(bytes + at + 5);
+                    info.width = read_be16(bytes + at + 7);
+                    break;
+                }
+
+                at += 2 + read_be16(bytes + at + 2);
+            }
+        }
+
+        return info;
+    }
+
+    [[nodiscard]] std::optional<rgb_image> decode_png(const std::byte* data, const std::size_t size, const uint8_t (&background)[3]) {
+        const auto bytes = reinterpret_cast<const uint8_t*>(data);
+
+        if (size < 8 || std::memcmp(bytes, png_signature, 8) != 0) {
+            return std::nullopt;
+        }
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint8_t depth = 0;
+        uint8_t color = 0;
+        std::vector<uint8_t> compressed;
+        uint8_t palette[256][4] = {};
+        std::optional<uint32_t> color_key[3];
+        bool header = false;
+
+        for (std::size_t at = 8; at + 12 <= size;) {
+            const uint32_t length = read_be32(bytes + at);
+            const uint8_t* type = bytes + at + 4;
+            const uint8_t* chunk = bytes + at + 8;
+
+            if (length > size - at - 12) {
+                return std::nullopt;
+            }
+
+            if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+                width = read_be32(chunk);
+                height = read_be32(chunk + 4);
+                depth = chunk[8];
+                color = chunk[9];
+
+                // Compression and filter method 0 are the only ones, interlaced images are not supported.
+                if (chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0) {
+                    return std::nullopt;
+                }
+
+                header = true;
+            } else if (std::memcmp(type, "PLTE", 4) == 0) {
+                for (uint32_t i = 0; i < length / 3 && i < 256; ++i) {
+                    palette[i][0] = chunk[i * 3];
+                    palette[i][1] = chunk[i * 3 + 1];
+                    palette[i][2] = chunk[i * 3 + 2];
+                    palette[i][3] = 0xff;
+                }
+            } else if (std::memcmp(type, "tRNS", 4) == 0) {
+                if (color == 3) {
+                    for (uint32_t i = 0; i < length && i < 256; ++i) {
+                        palette[i][3] = chunk[i];
+                    }
+                } else {
+                    for (uint32_t i = 0; i < 3 && (i + 1) * 2 <= length; ++i) {
+                        color_key[i] = read_be16(chunk + i * 2);
+                    }
+                }
+            } else if (std::memcmp(type, "IDAT", 4) == 0) {
+                compressed.insert(compressed.end(), chunk, chunk + length);
+            } else if (std::memcmp(type, "IEND", 4) == 0) {
+                break;
+            }
+
+            at += 12 + length;
+        }
+
+        const int channels = color == 0 ? 1 : color == 2 ? 3 : color == 3 ? 1 : color == 4 ? 2 : color == 6 ? 4 : 0;
+        const bool valid_depth = depth == 8 || (depth == 16 && color != 3) || ((depth == 1 || depth == 2 || depth == 4) && (color == 0 || color == 3));
+
+        if (!header || channels == 0 || !valid_depth || width == 0 || height == 0 || width > max_dimension || height > max_dimension ||
+            compressed.size() < 2) {
+            return std::nullopt;
+        }
+
+        // zlib wrapper: deflate, no preset dictionary.
+        if ((compressed[0] & 0x0f) != 8 || ((compressed[0] << 8) | compressed[1]) % 31 != 0 || (compressed[1] & 0x20) != 0) {
+            return std::nullopt;
+        }
+
+        const std::size_t stride = (std::size_t{width} * channels * depth + 7) / 8;
+        const std::size_t pixel_bytes = std::max<std::size_t>(1, channels * depth / 8);
+        const std::size_t expected = (stride + 1) * height;
+
+        // Deflate expands at most 1032 to 1, a header claiming more than the data can hold is damaged.
+        if (expected / 1032 > compressed.size()) {
+            return std::nullopt;
+        }
+
+        std::vector<uint8_t> raw;
+        raw.reserve(expected);
+
+        if (!inflater{compressed.data() + 2, compressed.size() - 2, raw, expected}.run() || raw.size() != expected ||
+            !unfilter(raw, height, stride, pixel_bytes)) {
+            return std::nullopt;
+        }
+
+        rgb_image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(std::size_t{width} * height * 3);
+
+        const uint32_t max_sample = (1u << depth) - 1;
+
+        for (uint32_t y = 0; y < height; ++y) {
+            const uint8_t* line = raw.data() + y * (stride + 1) + 1;
+            uint8_t* out = image.pixels.data() + std::size_t{y} * width * 3;
+
+            // Raw value of the sample, 16 bit ones whole for the color key.
+            const auto sample = [line, depth, channels](const uint32_t x, const int channel) -> uint32_t {
+                const std::size_t index = std::size_t{x} * channels + channel;
+
+                if (depth == 8) {
+                    return line[index];
+                }
+
+                if (depth == 16) {
+                    return read_be16(line + index * 2);
+                }
+
+                const std::size_t bit = index * depth;
+                return (line[bit / 8] >> (8 - depth - bit % 8)) & ((1u << depth) - 1);
+            };
+
+            const auto to_8bit = [depth, max_sample](const uint32_t value) -> uint32_t {
+                return depth == 16 ? value >> 8 : depth == 8 ? value : value * 255 / max_sample;
+            };
+
+            for (uint32_t x = 0; x < width; ++x) {
+                uint32_t rgb[3];
+                uint32_t alpha = 255;
+
+                if (color == 3) {
+                    const uint32_t index = sample(x, 0);
+                    rgb[0] = palette[index][0];
+                    rgb[1] = palette[index][1];
+                    rgb[2] = palette[index][2];
+                    alpha = palette[index][3];
+                } else if (color == 0 || color == 4) {
+                    const uint32_t gray = sample(x, 0);
+                    rgb[0] = rgb[1] = rgb[2] = to_8bit(gray);
+                    alpha = color == 4 ? to_8bit(sample(x, 1)) : (color_key[0] == gray ? 0 : 255);
+                } else {
+                    const uint32_t r = sample(x, 0);
+                    const uint32_t g = sample(x, 1);
+                    const uint32_t b = sample(x, 2);
+                    rgb[0] = to_8bit(r);
+                    rgb[1] = to_8bit(g);
+                    rgb[2] = to_8bit(b);
+                    alpha = color == 6 ? to_8bit(sample(x, 3)) : (color_key[0] == r && color_key[1] == g && color_key[2] == b ? 0 : 255);
+                }
+
+                for (int c = 0; c < 3; ++c) {
+                    out[x * 3 + c] = static_cast<uint8_t>((rgb[c] * alpha + background[c] * (255 - alpha) + 127) / 255);
+                }
+            }
+        }
+
+        return image;
+    }
+
+    [[nodiscard]] rgb_image shrink_to_fit(const rgb_image& image, const uint32_t max_width, const uint32_t max_height) {
+        const double scale = std::min({1.0, static_cast<double>(max_width) / image.width, static_cast<double>(max_height) / image.height});
+
+        if (image.empty() || scale >= 1.0) {
+            return image;
+        }
+
+        const auto width = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(image.width * scale)));
+        const auto height = std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(image.height * scale)));
+
+        // Share of each source pixel in each output pixel along one axis.
+        struct tap {
+            uint32_t source;
+            float weight;
+        };
+
+        const auto taps = [](const uint32_t from, const uint32_t to) {
+            std::vector<std::vector<tap>> result(to);
+            const double ratio = static_cast<double>(from) / to;
+
+            for (uint32_t i = 0; i < to; ++i) {
+                const double start = i * ratio;
+                const double end = (i + 1) * ratio;
+
+                for (auto j = static_cast<uint32_t>(start); j < from && j < end; ++j) {
+                    const double covered = std::min(end, j + 1.0) - std::max(start, static_cast<double>(j));
+                    result[i].push_back({j, static_cast<float>(covered / ratio)});
+                }
+            }
+
+            return result;
+        };
+
+        const std::vector<std::vector<tap>> columns = taps(image.width, width);
+        const std::vector<std::vector<tap>> rows = taps(image.height, height);
+
+        std::vector<float> horizontal(std::size_t{width} * image.height * 3);
+
+        for (uint32_t y = 0; y < image.height; ++y) {
+            const uint8_t* in = image.pixels.data() + std::size_t{y} * image.width * 3;
+            float* out = horizontal.data() + std::size_t{y} * width * 3;
+
+            for (uint32_t x = 0; x < width; ++x) {
+                for (const tap& t : columns[x]) {
+                    for (int c = 0; c < 3; ++c) {
+                        out[x * 3 + c] += t.weight * in[t.source * 3 + c];
+                    }
+                }
+            }
+        }
+
+        rgb_image result;
+        result.width = width;
+        result.height = height;
+        result.pixels.resize(std::size_t{width} * height * 3);
+
+        for (uint32_t y = 0; y < height; ++y) {
+            uint8_t* out = result.pixels.data() + std::size_t{y} * width * 3;
+
+            for (std::size_t i = 0; i < std::size_t{width} * 3; ++i) {
+                float sum = 0.0f;
+
+                for (const tap& t : rows[y]) {
+                    sum += t.weight * horizontal[std::size_t{t.source} * width * 3 + i];
+                }
+
+                out[i] = static_cast<uint8_t>(std::clamp(std::lround(sum), 0l, 255l));
+            }
+        }
+
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::byte> encode_jpeg(const rgb_image& image, int quality) {
+        std::vector<std::byte> out;
+
+        if (image.empty() || image.width > 0xffff || image.height > 0xffff) {
+            return out;
+        }
+
+        quality = std::clamp(quality, 1, 100);
+        const int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+        uint8_t tables[2][64];
+        float divisors[2][64];
+
+        for (int i = 0; i < 64; ++i) {
+            tables[0][i] = static_cast<uint8_t>(std::clamp((luma_quantization[i] * scale + 50) / 100, 1, 255));
+            tables[1][i] = static_cast<uint8_t>(std::clamp((chroma_quantization[i] * scale + 50) / 100, 1, 255));
+            divisors[0][i] = tables[0][i];
+            divisors[1][i] = tables[1][i];
+        }
+
+        put_u16(out, 0xffd8);
+
+        // JFIF header, square pixels.
+        put_u16(out, 0xffe0);
+        put_u16(out, 16);
+        for (const char c : {'J', 'F', 'I', 'F', '\0'}) {
+            put_u8(out, static_cast<unsigned>(c));
+        }
+        put_u16(out, 0x0101);
+        put_u8(out, 0);
+        put_u16(out, 1);
+        put_u16(out, 1);
+        put_u16(out, 0);
+
+        put_u16(out, 0xffdb);
+        put_u16(out, 2 + 2 * 65);
+
+        for (unsigned table = 0; table < 2; ++table) {
+            put_u8(out, table);
+
+            for (int k = 0; k < 64; ++k) {
+                put_u8(out, tables[table][zigzag[k]]);
+            }
+        }
+
+        // Chroma at half the resolution both ways, as about every JPEG.
+        put_u16(out, 0xffc0);
+        put_u16(out, 17);
+        put_u8(out, 8);
+        put_u16(out, image.height);
+        put_u16(out, image.width);
+        put_u8(out, 3);
+
+        for (const unsigned component : {1u, 2u, 3u}) {
+            put_u8(out, component);
+            put_u8(out, component == 1 ? 0x22 : 0x11); // Sampling factors.
+            put_u8(out, component == 1 ? 0 : 1);       // Quantization table.
+        }
+
+        put_huffman_table(out, 0x00, dc_luma_counts, dc_symbols);
+        put_huffman_table(out, 0x10, ac_luma_counts, ac_luma_symbols);
+        put_huffman_table(out, 0x01, dc_chroma_counts, dc_symbols);
+        put_huffman_table(out, 0x11, ac_chroma_counts, ac_chroma_symbols);
+
+        put_u16(out, 0xffda);
+        put_u16(out, 12);
+        put_u8(out, 3);
+
+        for (const unsigned component : {1u, 2u, 3u}) {
+            put_u8(out, component);
+            put_u8(out, component == 1 ? 0x00 : 0x11); // Huffman tables.
+        }
+
+        // Whole spectrum in one scan, no successive approximation.
+        put_u8(out, 0);
+        put_u8(out, 63);
+        put_u8(out, 0);
+
+        static const huffman_code dc_luma{dc_luma_counts, dc_symbols};
+        static const huffman_code ac_luma{ac_luma_counts, ac_luma_symbols};
+        static const huffman_code dc_chroma{dc_chroma_counts, dc_symbols};
+        static const huffman_code ac_chroma{ac_chroma_counts, ac_chroma_symbols};
+
+        bit_writer bits{out};
+        int previous_dc[3] = {};
+
+        // Edge pixels repeat past the image's right and bottom borders.
+        const auto pixel = [&image](const uint32_t x, const uint32_t y) {
+            return image.pixels.data() + (std::size_t{std::min(y, image.height - 1)} * image.width + std::min(x, image.width - 1)) * 3;
+        };
+
+        for (uint32_t mcu_y = 0; mcu_y < image.height; mcu_y += 16) {
+            for (uint32_t mcu_x = 0; mcu_x < image.width; mcu_x += 16) {
+                float luma[4][64];
+                float chroma[2][64] = {};
+
+                for (uint32_t y = 0; y < 16; ++y) {
+                    for (uint32_t x = 0; x < 16; ++x) {
+                        const uint8_t* p = pixel(mcu_x + x, mcu_y + y);
+                        const float r = p[0];
+                        const float g = p[1];
+                        const float b = p[2];
+
+                        luma[(y / 8) * 2 + x / 8][(y % 8) * 8 + x % 8] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+
+                        const int at = (y / 2) * 8 + x / 2;
+                        chroma[0][at] += 0.25f * (-0.168736f * r - 0.331264f * g + 0.5f * b);
+                        chroma[1][at] += 0.25f * (0.5f * r - 0.418688f * g - 0.081312f * b);
+                    }
+                }
+
+                for (const auto& block : luma) {
+                    encode_block(bits, block, divisors[0], previous_dc[0], dc_luma, ac_luma);
+                }
+
+                encode_block(bits, chroma[0], divisors[1], previous_dc[1], dc_chroma, ac_chroma);
+                encode_block(bits, chroma[1], divisors[1], previous_dc[2], dc_chroma, ac_chroma);
+            }
+        }
+
+        bits.flush();
+        put_u16(out, 0xffd9);
+        return out;
+    }
+
+    [[nodiscard]] std::string_view extension(const image_format format) noexcept {
+        switch (format) {
+            case image_format::png: return ".png";
+            case image_format::jpeg: return ".jpg";
+            case image_format::gif: return ".gif";
+            case image_format::unknown: break;
+        }
+
+        return "";
+    }
+
+} // namespace image_codec
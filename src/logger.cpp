@@ -0,0 +1,253 @@
+// ----------------------------------------------------------------------------
+// Logger includes.
+#include "../include/logger.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Longest the writer sleeps without being woken, bounds the delay of a missed wake-up.
+constexpr std::chrono::milliseconds writer_idle_timeout{50};
+
+// Longest flush() waits for the writer to catch up, a stuck sink must not hang the caller.
+constexpr std::chrono::seconds flush_timeout{1};
+
+} // namespace
+
+[[nodiscard]] std::string_view log_level_name(const log_level level) noexcept {
+    switch (level) {
+        case log_level::trace: return "trace";
+        case log_level::debug: return "debug";
+        case log_level::info: return "info";
+        case log_level::warning: return "warning";
+        case log_level::error: return "error";
+        case log_level::off: return "off";
+    }
+
+    return "unknown";
+}
+
+// ----------------------------------------------------------------------------
+// Lifetime.
+//
+// The instance is never destroyed: steam_helper and friends log from their own
+// destructors, which may run after any static logger would be gone. At exit the
+// queue is flushed and later lines are written synchronously instead.
+logger::logger() : _slots{std::make_unique<slot[]>(ring_capacity)}, _sink{console_sink()} {
+    for (std::size_t i = 0; i < ring_capacity; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    _running.store(true);
+    _writer = std::thread{&logger::write_loop, this};
+}
+
+[[nodiscard]] logger& logger::instance() noexcept {
+    static logger* const instance = [] {
+        auto* created = new logger{};
+        std::atexit(&logger::stop_at_exit);
+        return created;
+    }();
+
+    return *instance;
+}
+
+void logger::stop_at_exit() noexcept {
+    logger& self = instance();
+    self.flush();
+
+    {
+        std::lock_guard<std::mutex> lock{self._wake_mutex};
+        self._running.store(false);
+    }
+
+    self._wake_cv.notify_all();
+
+    // Not joined: on Windows exit handlers of a DLL run under the loader lock,
+    // which a thread needs to exit.
+    self._writer.detach();
+}
+
+// ----------------------------------------------------------------------------
+// Producers.
+bool logger::push(const log_level level, const std::string_view category, std::string_view message) noexcept {
+    // Lines keep the trailing newline of the old stream based logging, sinks add their own.
+    if (!message.empty() && message.back() == '\n') {
+        message.remove_suffix(1);
+    }
+
+    const auto now = std::chrono::system_clock::now();
+
+    if (!_running.load(std::memory_order_acquire)) {
+        write({level, now, category, message});
+        return true;
+    }
+
+    std::size_t position = _tail.load(std::memory_order_relaxed);
+    slot* claimed = nullptr;
+
+    while (true) {
+        slot& candidate = _slots[position & (ring_capacity - 1)];
+        const std::size_t sequence = candidate.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if (difference == 0) {
+            if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                claimed = &candidate;
+                break;
+            }
+        } else if (difference < 0) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = _tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    claimed->level = level;
+    claimed->time = now;
+    claimed->category = category;
+    claimed->length = static_cast<uint16_t>(std::min(message.size(), message_capacity));
+    std::memcpy(claimed->message.data(), message.data(), claimed->length);
+    claimed->sequence.store(position + 1, std::memory_order_seq_cst);
+
+    // Pairs with the writer announcing its sleep before checking the ring one last time.
+    if (_writer_sleeping.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock{_wake_mutex};
+        _wake_cv.notify_one();
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Writer.
+std::size_t logger::drain() noexcept {
+    const std::size_t first = _head.load(std::memory_order_relaxed);
+    std::size_t head = first;
+
+    while (true) {
+        slot& next = _slots[head & (ring_capacity - 1)];
+
+        if (next.sequence.load(std::memory_order_acquire) != head + 1) {
+            break;
+        }
+
+        write({next.level, next.time, next.category, {next.message.data(), next.length}});
+
+        next.sequence.store(head + ring_capacity, std::memory_order_release);
+        _head.store(++head, std::memory_order_release);
+    }
+
+    return head - first;
+}
+
+void logger::write_loop() noexcept {
+    uint64_t reported_drops = 0;
+
+    while (_running.load(std::memory_order_acquire)) {
+        const std::size_t written = drain();
+
+        if (const uint64_t drops = _dropped.load(std::memory_order_relaxed); drops != reported_drops) {
+            const std::string note = std::to_string(drops - reported_drops) + " log lines dropped, the ring was full";
+            write({log_level::warning, std::chrono::system_clock::now(), "Log", note});
+            reported_drops = drops;
+        }
+
+        if (written != 0) {
+            std::lock_guard<std::mutex> lock{_wake_mutex};
+            _drained_cv.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{_wake_mutex};
+        _writer_sleeping.store(true, std::memory_order_seq_cst);
+
+        const auto ready = [this] {
+            const std::size_t head = _head.load(std::memory_order_relaxed);
+            return !_running.load(std::memory_order_acquire) ||
+                   _slots[head & (ring_capacity - 1)].sequence.load(std::memory_order_seq_cst) == head + 1;
+        };
+
+        _wake_cv.wait_for(lock, writer_idle_timeout, ready);
+        _writer_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void logger::write(const log_record& record) noexcept {
+    std::lock_guard<std::mutex> lock{_sink_mutex};
+
+    if (_sink) {
+        _sink(record);
+    }
+}
+
+void logger::flush() noexcept {
+    if (!_running.load(std::memory_order_acquire) || std::this_thread::get_id() == _writer.get_id()) {
+        return;
+    }
+
+    const std::size_t target = _tail.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> lock{_wake_mutex};
+    _wake_cv.notify_one();
+
+    // Positions are drained in order, the writer passing `target` means every
+    // line queued before the call went through the sink.
+    _drained_cv.wait_for(lock, flush_timeout, [this, target] { return _head.load(std::memory_order_acquire) >= target; });
+}
+
+void logger::set_sink(log_sink sink) noexcept {
+    std::lock_guard<std::mutex> lock{_sink_mutex};
+    _sink = std::move(sink);
+}
+
+// ----------------------------------------------------------------------------
+// Sinks.
+[[nodiscard]] log_sink logger::console_sink() {
+    return [](const log_record& record) {
+        std::fprintf(stdout, "[%.*s] %.*s\n", static_cast<int>(record.category.size()), record.category.data(),
+                     static_cast<int>(record.message.size()), record.message.data());
+        std::fflush(stdout);
+    };
+}
+
+[[nodiscard]] log_sink logger::file_sink(const std::filesystem::path& path) {
+    std::shared_ptr<std::FILE> file{std::fopen(path.string().c_str(), "a"), [](std::FILE* f) {
+                                        if (f != nullptr) {
+                                            std::fclose(f);
+                                        }
+                                    }};
+
+    if (!file) {
+        return nullptr;
+    }
+
+    return [file](const log_record& record) {
+        const std::time_t time = std::chrono::system_clock::to_time_t(record.time);
+        std::tm local{};
+
+#if defined(_WIN32)
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
+        const std::string_view level = log_level_name(record.level);
+        std::fprintf(file.get(), "%s %-7.*s [%.*s] %.*s\n", stamp, static_cast<int>(level.size()), level.data(),
+                     static_cast<int>(record.category.size()), record.category.data(), static_cast<int>(record.message.size()),
+                     record.message.data());
+        std::fflush(file.get());
+    };
+}
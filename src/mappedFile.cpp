@@ -0,0 +1,151 @@
+#include "../include/mappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+    : _data{std::exchange(other._data, nullptr)}, _size{std::exchange(other._size, 0)},
+#ifdef _WIN32
+      _file{std::exchange(other._file, nullptr)}, _mapping{std::exchange(other._mapping, nullptr)}
+#else
+      _fd{std::exchange(other._fd, -1)}
+#endif
+{}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+    if (this != &other) {
+        close();
+
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+#ifdef _WIN32
+        _file = std::exchange(other._file, nullptr);
+        _mapping = std::exchange(other._mapping, nullptr);
+#else
+        _fd = std::exchange(other._fd, -1);
+#endif
+    }
+
+    return *this;
+}
+
+#ifdef _WIN32
+
+[[nodiscard]] bool mapped_file::open(const std::filesystem::path& file_path) noexcept {
+    close();
+
+    HANDLE file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    _file = file;
+    _mapping = mapping;
+    _data = static_cast<const std::byte*>(view);
+    _size = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+void mapped_file::close() noexcept {
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+
+    if (_mapping != nullptr) {
+        CloseHandle(_mapping);
+    }
+
+    if (_file != nullptr) {
+        CloseHandle(_file);
+    }
+
+    _data = nullptr;
+    _size = 0;
+    _mapping = nullptr;
+    _file = nullptr;
+}
+
+#else
+
+[[nodiscard]] bool mapped_file::open(const std::filesystem::path& file_path) noexcept {
+    close();
+
+    const int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    _fd = fd;
+    _data = static_cast<const std::byte*>(view);
+    _size = static_cast<std::size_t>(info.st_size);
+    return true;
+}
+
+void mapped_file::close() noexcept {
+    if (_data != nullptr) {
+        ::munmap(const_cast<std::byte*>(_data), _size);
+    }
+
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+
+    _data = nullptr;
+    _size = 0;
+    _fd = -1;
+}
+
+#endif
@@ -0,0 +1,215 @@
+#include "../include/previewPipeline.h"
+
+#include "../include/contentFingerprint.h"
+#include "../include/logger.h"
+#include "../include/mappedFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+    // Written aside then renamed, a reader never sees half a file.
+    [[nodiscard]] bool write_atomically(const std::filesystem::path& target, const std::vector<std::byte>& bytes) {
+        std::filesystem::path written = target;
+        written += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            std::ofstream file{written, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+            if (!file.flush()) {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(written, target, ec);
+
+        if (ec) {
+            std::filesystem::remove(written, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] std::string hex(const uint64_t value) {
+        char text[17];
+        std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+        return text;
+    }
+
+} // namespace
+
+preview_processor::preview_processor(std::filesystem::path cache_directory, preview_options options, thread_pool& pool) noexcept
+    : _cache_directory{std::move(cache_directory)}, _options{options}, _pool{pool} {}
+
+// Changing any option gives other cache entries rather than stale ones.
+[[nodiscard]] uint64_t preview_processor::options_seed() const noexcept {
+    const uint64_t fields[] = {_options.max_width, _options.max_height, _options.max_bytes, static_cast<uint64_t>(_options.quality),
+                               static_cast<uint64_t>(_options.min_quality), _options.background[0], _options.background[1],
+                               _options.background[2]};
+    return xxhash64::hash(fields, sizeof(fields));
+}
+
+[[nodiscard]] std::optional<preview_processor::result> preview_processor::convert(const std::filesystem::path& source, const std::byte* data,
+                                                                                   const std::size_t size, const std::filesystem::path& target) const {
+    const bool png = image_codec::probe(data, size).format == image_format::png;
+    std::optional<rgb_image> image;
+
+    if (png) {
+        image = image_codec::decode_png(data, size, _options.background);
+    }
+
+    if (!image.has_value() && _decoder) {
+        image = _decoder(data, size);
+    }
+
+    if (!image.has_value() || image->empty()) {
+        log_error("Preview") << "Could not decode '" << source.string() << "'"
+                             << (png ? ", interlaced or damaged PNG\n" : ", only PNG is read without a decoder\n");
+        return std::nullopt;
+    }
+
+    rgb_image scaled = image_codec::shrink_to_fit(*image, _options.max_width, _options.max_height);
+    std::vector<std::byte> encoded;
+
+    // Highest quality within the budget, a smaller image when even the lowest is over.
+    for (int attempt = 0; attempt < 8 && !scaled.empty(); ++attempt) {
+        encoded = image_codec::encode_jpeg(scaled, _options.quality);
+
+        if (encoded.size() > _options.max_bytes) {
+            int low = std::min(_options.min_quality, _options.quality);
+            int high = _options.quality - 1;
+            std::vector<std::byte> best;
+
+            while (low <= high) {
+                const int middle = (low + high) / 2;
+                std::vector<std::byte> candidate = image_codec::encode_jpeg(scaled, middle);
+
+                if (candidate.size() <= _options.max_bytes) {
+                    best = std::move(candidate);
+                    low = middle + 1;
+                } else {
+                    high = middle - 1;
+                }
+            }
+
+            encoded = std::move(best);
+        }
+
+        if (!encoded.empty()) {
+            break;
+        }
+
+        scaled = image_codec::shrink_to_fit(scaled, scaled.width * 3 / 4, scaled.height * 3 / 4);
+    }
+
+    if (encoded.empty()) {
+        log_error("Preview") << "Could not fit '" << source.string() << "' within " << _options.max_bytes << " bytes\n";
+        return std::nullopt;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(_cache_directory, ec);
+
+    if (!write_atomically(target, encoded)) {
+        log_error("Preview") << "Could not write '" << target.string() << "'\n";
+        return std::nullopt;
+    }
+
+    log_debug("Preview") << "Converted '" << source.string() << "' to " << scaled.width << "x" << scaled.height << ", "
+                         << encoded.size() << " bytes\n";
+
+    result converted;
+    converted.path = target;
+    converted.converted = true;
+    converted.width = scaled.width;
+    converted.height = scaled.height;
+    converted.bytes = encoded.size();
+    return converted;
+}
+
+[[nodiscard]] std::optional<preview_processor::result> preview_processor::process(const std::filesystem::path& source) const {
+    mapped_file mapping;
+
+    if (!mapping.open(source)) {
+        log_error("Preview") << "Could not read '" << source.string() << "'\n";
+        return std::nullopt;
+    }
+
+    const image_info info = image_codec::probe(mapping.data(), mapping.size());
+
+    if (info.format != image_format::unknown && info.width != 0 && info.width <= _options.max_width &&
+        info.height <= _options.max_height && mapping.size() <= _options.max_bytes) {
+        return result{source, false, false, info.width, info.height, mapping.size()};
+    }
+
+    const std::filesystem::path target = _cache_directory / (hex(xxhash64::hash(mapping.data(), mapping.size(), options_seed())) + ".jpg");
+    std::error_code ec;
+
+    if (const uint64_t cached_size = std::filesystem::file_size(target, ec); !ec && cached_size != 0) {
+        mapped_file cached;
+        const image_info cached_info = cached.open(target) ? image_codec::probe(cached.data(), cached.size()) : image_info{};
+        return result{target, true, true, cached_info.width, cached_info.height, cached_size};
+    }
+
+    return convert(source, mapping.data(), mapping.size(), target);
+}
+
+[[nodiscard]] std::vector<std::optional<preview_processor::result>> preview_processor::process(const std::vector<std::filesystem::path>& sources) const {
+    std::vector<std::optional<result>> results(sources.size());
+    std::vector<std::optional<uint64_t>> hashes(sources.size());
+
+    // Hashed first, so previews with the same bytes are processed once whatever their names.
+    _pool.parallel_for(sources.size(), [&](const std::size_t index) {
+        mapped_file mapping;
+
+        if (mapping.open(sources[index])) {
+            hashes[index] = xxhash64::hash(mapping.data(), mapping.size());
+        }
+    });
+
+    std::unordered_map<uint64_t, std::size_t> first_of;
+    std::vector<std::size_t> unique;
+    std::vector<std::size_t> origin(sources.size());
+
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        origin[i] = i;
+
+        // Unreadable ones are left to process() to report.
+        if (!hashes[i].has_value()) {
+            unique.push_back(i);
+            continue;
+        }
+
+        const auto [it, inserted] = first_of.emplace(*hashes[i], i);
+        origin[i] = it->second;
+
+        if (inserted) {
+            unique.push_back(i);
+        }
+    }
+
+    _pool.parallel_for(unique.size(), [&](const std::size_t index) {
+        results[unique[index]] = process(sources[unique[index]]);
+    });
+
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        if (origin[i] == i || !results[origin[i]].has_value()) {
+            continue;
+        }
+
+        results[i] = results[origin[i]];
+
+        if (!results[i]->converted) {
+            results[i]->path = sources[i];
+        }
+    }
+
+    return results;
+}
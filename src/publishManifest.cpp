@@ -0,0 +1,561 @@
+#include "../include/publishManifest.h"
+
+#include "../include/logger.h"
+
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+    // A field as read from either format, numbers kept as their text.
+    struct field_value {
+        std::string text;
+        bool null = false;
+    };
+
+    template <typename T>
+    [[nodiscard]] bool parse_id(std::string_view text, T& id) noexcept {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), id);
+        return error == std::errc{} && end == text.data() + text.size() && !text.empty();
+    }
+
+    [[nodiscard]] std::filesystem::path resolve(const std::string& text, const std::filesystem::path& base_directory) {
+        const std::filesystem::path path = std::filesystem::u8path(text);
+        return path.is_relative() && !base_directory.empty() ? base_directory / path : path;
+    }
+
+    // Same columns and keys for both formats.
+    [[nodiscard]] bool assign_field(publish_entry& entry, const std::string_view name, field_value&& value,
+                                    const std::filesystem::path& base_directory, std::string& error) {
+        const bool empty = value.null || value.text.empty();
+
+        if (name == "app" || name == "app_id") {
+            if (!parse_id(value.text, entry.app_id) || entry.app_id == 0) {
+                error = "invalid app id '" + value.text + "'";
+                return false;
+            }
+        } else if (name == "item" || name == "item_id") {
+            if (empty || value.text == "new") {
+                entry.item_id = 0;
+            } else if (!parse_id(value.text, entry.item_id)) {
+                error = "invalid item id '" + value.text + "', expected a number or \"new\"";
+                return false;
+            }
+        } else if (name == "title") {
+            entry.title = empty ? std::nullopt : std::optional<std::string>{std::move(value.text)};
+        } else if (name == "description") {
+            entry.description = empty ? std::nullopt : std::optional<std::string>{std::move(value.text)};
+        } else if (name == "preview") {
+            entry.preview = empty ? std::nullopt : std::optional<std::filesystem::path>{resolve(value.text, base_directory)};
+        } else if (name == "content") {
+            entry.content = empty ? std::nullopt : std::optional<std::filesystem::path>{resolve(value.text, base_directory)};
+        } else if (name == "changelog") {
+            entry.changelog = std::move(value.text);
+        } else {
+            error = "unknown field '" + std::string{name} + "'";
+            return false;
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] bool known_field(const std::string_view name) noexcept {
+        return name == "app" || name == "app_id" || name == "item" || name == "item_id" || name == "title" ||
+               name == "description" || name == "preview" || name == "content" || name == "changelog";
+    }
+
+    void append_utf8(std::string& out, const uint32_t code_point) {
+        if (code_point < 0x80) {
+            out += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            out += static_cast<char>(0xc0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else if (code_point < 0x10000) {
+            out += static_cast<char>(0xe0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // JSON: just what a manifest needs, objects of scalars in an array.
+    class json_reader {
+
+    private:
+        std::string_view _text;
+        std::size_t _position = 0;
+        std::size_t _line = 1;
+
+        [[nodiscard]] bool at_end() const noexcept { return _position >= _text.size(); }
+
+        [[nodiscard]] char peek() const noexcept { return at_end() ? '\0' : _text[_position]; }
+
+        [[nodiscard]] bool read_hex(uint32_t& value) noexcept {
+            if (_text.size() - _position < 4) {
+                return false;
+            }
+
+            const auto [end, error] = std::from_chars(_text.data() + _position, _text.data() + _position + 4, value, 16);
+
+            if (error != std::errc{} || end != _text.data() + _position + 4) {
+                return false;
+            }
+
+            _position += 4;
+            return true;
+        }
+
+    public:
+        std::string error;
+
+        explicit json_reader(const std::string_view text) noexcept : _text{text} {}
+
+        [[nodiscard]] std::size_t line() const noexcept { return _line; }
+
+        void skip_whitespace() noexcept {
+            while (!at_end()) {
+                const char c = _text[_position];
+
+                if (c == '\n') {
+                    ++_line;
+                } else if (c != ' ' && c != '\t' && c != '\r') {
+                    return;
+                }
+
+                ++_position;
+            }
+        }
+
+        [[nodiscard]] bool consume(const char expected) noexcept {
+            skip_whitespace();
+
+            if (peek() != expected) {
+                return false;
+            }
+
+            ++_position;
+            return true;
+        }
+
+        [[nodiscard]] bool expect(const char expected) {
+            if (consume(expected)) {
+                return true;
+            }
+
+            error = at_end() ? std::string{"unexpected end, expected '"} + expected + "'"
+                             : std::string{"unexpected '"} + peek() + "', expected '" + expected + "'";
+            return false;
+        }
+
+        [[nodiscard]] bool read_string(std::string& out) {
+            if (!expect('"')) {
+                return false;
+            }
+
+            out.clear();
+
+            while (!at_end()) {
+                const char c = _text[_position++];
+
+                if (c == '"') {
+                    return true;
+                }
+
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    error = "control character in a string";
+                    return false;
+                }
+
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+
+                if (at_end()) {
+                    break;
+                }
+
+                switch (const char escaped = _text[_position++]) {
+                    case '"': case '\\': case '/': out += escaped; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        uint32_t code_point = 0;
+
+                        if (!read_hex(code_point)) {
+                            error = "invalid \\u escape";
+                            return false;
+                        }
+
+                        // Characters past the BMP come as a surrogate pair.
+                        if (code_point >= 0xd800 && code_point < 0xdc00) {
+                            uint32_t low = 0;
+                            const bool paired = _text.substr(_position, 2) == "\\u";
+
+                            if (paired) {
+                                _position += 2;
+                            }
+
+                            if (!paired || !read_hex(low) || low < 0xdc00 || low >= 0xe000) {
+                                error = "unpaired surrogate in a \\u escape";
+                                return false;
+                            }
+
+                            code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                        } else if (code_point >= 0xdc00 && code_point < 0xe000) {
+                            error = "unpaired surrogate in a \\u escape";
+                            return false;
+                        }
+
+                        append_utf8(out, code_point);
+                        break;
+                    }
+                    default:
+                        error = std::string{"invalid escape '\\"} + escaped + "'";
+                        return false;
+                }
+            }
+
+            error = "unterminated string";
+            return false;
+        }
+
+        // Strings, numbers, booleans or null, as text.
+        [[nodiscard]] bool read_scalar(field_value& value) {
+            skip_whitespace();
+            value = {};
+
+            if (peek() == '"') {
+                return read_string(value.text);
+            }
+
+            if (peek() == '{' || peek() == '[') {
+                error = "nested values are not supported in a manifest entry";
+                return false;
+            }
+
+            const std::size_t start = _position;
+
+            while (!at_end() && std::string_view{",}] \t\r\n"}.find(_text[_position]) == std::string_view::npos) {
+                ++_position;
+            }
+
+            value.text = std::string{_text.substr(start, _position - start)};
+
+            if (value.text == "null") {
+                value.text.clear();
+                value.null = true;
+            } else if (value.text.empty()) {
+                error = at_end() ? "unexpected end, expected a value" : std::string{"unexpected '"} + peek() + "'";
+                return false;
+            }
+
+            return true;
+        }
+
+        [[nodiscard]] bool finished() noexcept {
+            skip_whitespace();
+            return at_end();
+        }
+    };
+
+    [[nodiscard]] bool read_json_entry(json_reader& reader, const std::filesystem::path& base_directory, publish_entry& entry) {
+        reader.skip_whitespace();
+        entry.line = reader.line();
+
+        if (!reader.expect('{')) {
+            return false;
+        }
+
+        if (reader.consume('}')) {
+            return true;
+        }
+
+        do {
+            std::string name;
+            field_value value;
+
+            if (!reader.read_string(name) || !reader.expect(':') || !reader.read_scalar(value) ||
+                !assign_field(entry, name, std::move(value), base_directory, reader.error)) {
+                return false;
+            }
+        } while (reader.consume(','));
+
+        return reader.expect('}');
+    }
+
+    [[nodiscard]] bool read_json(const std::string_view text, const std::filesystem::path& base_directory,
+                                 std::vector<publish_entry>& entries, std::size_t& error_line, std::string& error) {
+        json_reader reader{text};
+
+        const auto fail = [&] {
+            error_line = reader.line();
+            error = std::move(reader.error);
+            return false;
+        };
+
+        // {"items": [...]} or [...] directly.
+        const bool wrapped = reader.consume('{');
+
+        if (wrapped) {
+            std::string name;
+
+            if (!reader.read_string(name) || !reader.expect(':')) {
+                return fail();
+            }
+
+            if (name != "items") {
+                reader.error = "expected the \"items\" array, found '" + name + "'";
+                return fail();
+            }
+        }
+
+        if (!reader.expect('[')) {
+            return fail();
+        }
+
+        if (!reader.consume(']')) {
+            do {
+                publish_entry& entry = entries.emplace_back();
+
+                if (!read_json_entry(reader, base_directory, entry)) {
+                    return fail();
+                }
+            } while (reader.consume(','));
+
+            if (!reader.expect(']')) {
+                return fail();
+            }
+        }
+
+        if ((wrapped && !reader.expect('}')) || !reader.finished()) {
+            if (reader.error.empty()) {
+                reader.error = "unexpected content after the manifest";
+            }
+
+            return fail();
+        }
+
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // CSV, RFC 4180: quoted fields may hold separators, quotes doubled and line breaks.
+    class csv_reader {
+
+    private:
+        std::string_view _text;
+        std::size_t _position = 0;
+        std::size_t _line = 1;
+
+    public:
+        std::string error;
+
+        explicit csv_reader(const std::string_view text) noexcept : _text{text} {
+            // Spreadsheets like to start with a byte order mark.
+            if (_text.substr(0, 3) == "\xef\xbb\xbf") {
+                _position = 3;
+            }
+        }
+
+        [[nodiscard]] std::size_t line() const noexcept { return _line; }
+
+        [[nodiscard]] bool at_end() const noexcept { return _position >= _text.size(); }
+
+        /// @brief Reads the next record, blank lines skipped; false at the end or on error.
+        [[nodiscard]] bool read_record(std::vector<std::string>& fields, std::size_t& record_line) {
+            fields.clear();
+
+            while (!at_end() && (_text[_position] == '\n' || _text[_position] == '\r')) {
+                _line += _text[_position] == '\n';
+                ++_position;
+            }
+
+            if (at_end()) {
+                return false;
+            }
+
+            record_line = _line;
+            std::string& first = fields.emplace_back();
+            std::string* field = &first;
+
+            while (!at_end()) {
+                const char c = _text[_position];
+
+                if (c == '"' && field->empty()) {
+                    ++_position;
+
+                    for (;;) {
+                        if (at_end()) {
+                            error = "unterminated quoted field";
+                            return false;
+                        }
+
+                        const char quoted = _text[_position++];
+
+                        if (quoted == '"') {
+                            if (_position < _text.size() && _text[_position] == '"') {
+                                *field += '"';
+                                ++_position;
+                                continue;
+                            }
+
+                            break;
+                        }
+
+                        _line += quoted == '\n';
+                        *field += quoted;
+                    }
+
+                    if (!at_end() && _text[_position] != ',' && _text[_position] != '\n' && _text[_position] != '\r') {
+                        error = "unexpected character after a quoted field";
+                        return false;
+                    }
+
+                    continue;
+                }
+
+                if (c == ',') {
+                    field = &fields.emplace_back();
+                    ++_position;
+                    continue;
+                }
+
+                if (c == '\n' || c == '\r') {
+                    _position += c == '\r' && _position + 1 < _text.size() && _text[_position + 1] == '\n' ? 2 : 1;
+                    ++_line;
+                    return true;
+                }
+
+                *field += c;
+                ++_position;
+            }
+
+            return true;
+        }
+    };
+
+    [[nodiscard]] bool read_csv(const std::string_view text, const std::filesystem::path& base_directory,
+                                std::vector<publish_entry>& entries, std::size_t& error_line, std::string& error) {
+        csv_reader reader{text};
+        std::vector<std::string> columns;
+        std::vector<std::string> fields;
+        std::size_t record_line = 0;
+
+        if (!reader.read_record(columns, record_line)) {
+            error_line = reader.line();
+            error = reader.error.empty() ? "missing the header row" : std::move(reader.error);
+            return false;
+        }
+
+        for (std::string& column : columns) {
+            while (!column.empty() && (column.back() == ' ' || column.back() == '\t')) {
+                column.pop_back();
+            }
+
+            column.erase(0, column.find_first_not_of(" \t"));
+
+            if (!known_field(column)) {
+                error_line = record_line;
+                error = "unknown column '" + column + "'";
+                return false;
+            }
+        }
+
+        while (reader.read_record(fields, record_line)) {
+            if (fields.size() != columns.size()) {
+                error_line = record_line;
+                error = std::to_string(fields.size()) + " fields, the header has " + std::to_string(columns.size());
+                return false;
+            }
+
+            publish_entry& entry = entries.emplace_back();
+            entry.line = record_line;
+
+            for (std::size_t i = 0; i < fields.size(); ++i) {
+                if (!assign_field(entry, columns[i], field_value{std::move(fields[i])}, base_directory, error)) {
+                    error_line = record_line;
+                    return false;
+                }
+            }
+        }
+
+        if (!reader.error.empty()) {
+            error_line = reader.line();
+            error = std::move(reader.error);
+            return false;
+        }
+
+        return true;
+    }
+
+} // namespace
+
+[[nodiscard]] std::optional<publish_manifest> publish_manifest::parse(const std::string_view text, const format text_format,
+                                                                      const std::filesystem::path& base_directory) noexcept {
+    publish_manifest manifest;
+    std::size_t error_line = 0;
+    std::string error;
+
+    const bool parsed = text_format == format::json ? read_json(text, base_directory, manifest.entries, error_line, error)
+                                                    : read_csv(text, base_directory, manifest.entries, error_line, error);
+
+    if (!parsed) {
+        log_error("Manifest") << "Line " << error_line << ": " << error << "\n";
+        return std::nullopt;
+    }
+
+    bool valid = true;
+
+    for (const publish_entry& entry : manifest.entries) {
+        if (entry.app_id == 0) {
+            log_error("Manifest") << "Line " << entry.line << ": missing the app id\n";
+            valid = false;
+        }
+    }
+
+    if (!valid) {
+        return std::nullopt;
+    }
+
+    return manifest;
+}
+
+[[nodiscard]] std::optional<publish_manifest> publish_manifest::load(const std::filesystem::path& path) noexcept {
+    std::ifstream file{path, std::ios::binary};
+
+    if (!file) {
+        log_error("Manifest") << "Could not open '" << path.string() << "'\n";
+        return std::nullopt;
+    }
+
+    const std::string text{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    if (file.bad()) {
+        log_error("Manifest") << "Could not read '" << path.string() << "'\n";
+        return std::nullopt;
+    }
+
+    const std::size_t first = text.find_first_not_of(" \t\r\n");
+    const bool json = path.extension() == ".json" || (first != std::string::npos && (text[first] == '[' || text[first] == '{'));
+
+    return parse(text, json ? format::json : format::csv, path.parent_path());
+}
@@ -0,0 +1,336 @@
+#include "../include/queryCache.h"
+#include "../include/queryDiskCache.h"
+
+#include <utility>
+
+query_cache::query_cache(steam_helper& helper, options cache_options) noexcept
+    : _helper{helper}, _options{cache_options} {}
+
+// ----------------------------------------------------------------------------
+// Cache utils.
+void query_cache::refresh(const query_key& key, UGCQueryHandle_t query_handle) noexcept {
+    _refreshes.fetch_add(1);
+
+    const SteamAPICall_t api_call = _helper.send_query_request(query_handle,
+        [this, key](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+            auto page = std::make_shared<query_page>();
+            _helper.read_query_page(rc, completed, *page);
+            on_refreshed(key, std::move(page));
+        });
+
+    if (api_call == k_uAPICallInvalid) {
+        auto failed = std::make_shared<query_page>();
+        failed->result = EResult::k_EResultFail;
+        on_refreshed(key, std::move(failed));
+    }
+}
+
+void query_cache::on_refreshed(const query_key& key, page_ptr page) noexcept {
+    std::vector<page_callback> waiters;
+    page_ptr served = page;
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+
+        const auto it = _entries.find(key);
+
+        if (it == _entries.end()) {
+            return;
+        }
+
+        entry& cached = it->second;
+        cached.refreshing = false;
+        waiters.swap(cached.waiters);
+
+        if (page->result == EResult::k_EResultOK) {
+            _bytes -= cached.bytes;
+            cached.page = std::move(page);
+            cached.bytes = page_bytes(*cached.page);
+            cached.stored_at = clock::now();
+            _bytes += cached.bytes;
+
+            touch(cached);
+            evict_to_fit();
+        } else if (cached.page == nullptr) {
+            // Nothing cached to fall back on, drop the placeholder.
+            _lru.erase(cached.lru_position);
+            _entries.erase(it);
+        } else {
+            // Keep serving the stale page, the next lookup will retry.
+            served = cached.page;
+        }
+    }
+
+    for (auto& waiter : waiters) {
+        waiter(served);
+    }
+}
+
+void query_cache::touch(entry& cached) noexcept {
+    _lru.splice(_lru.begin(), _lru, cached.lru_position);
+}
+
+void query_cache::evict_to_fit() noexcept {
+    auto position = _lru.end();
+
+    while (_bytes > _options.max_bytes && position != _lru.begin()) {
+        --position;
+        const auto it = _entries.find(*position);
+
+        // A refresh in flight answers its waiters through the entry, it stays until then.
+        if (it->second.refreshing || !it->second.waiters.empty()) {
+            continue;
+        }
+
+        _bytes -= it->second.bytes;
+        _entries.erase(it);
+        position = _lru.erase(position);
+        _evictions.fetch_add(1);
+    }
+}
+
+bool query_cache::load_from_disk(const query_key& key) noexcept {
+    if (_disk == nullptr) {
+        return false;
+    }
+
+    const auto persisted = _disk->find(key);
+
+    if (!persisted.has_value() ||
+        std::chrono::system_clock::now() - persisted->stored_at() >= _options.disk_max_age) {
+        return false;
+    }
+
+    auto page = std::make_shared<query_page>();
+    persisted->to_page(*page);
+
+    _lru.push_front(key);
+
+    entry loaded;
+    loaded.lru_position = _lru.begin();
+    loaded.page = std::move(page);
+    loaded.bytes = page_bytes(*loaded.page);
+    // Past its ttl, so the first send serves it and refreshes.
+    loaded.stored_at = clock::now() - _options.ttl;
+    _bytes += loaded.bytes;
+
+    _entries.emplace(key, std::move(loaded));
+    _disk_hits.fetch_add(1);
+
+    evict_to_fit();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Public API.
+void query_cache::send(UGCQueryHandle_t query_handle, page_callback callback) noexcept {
+    const std::optional<query_key> key = _helper.get_query_key(query_handle);
+
+    // Not built through the helper, nothing to key it on.
+    if (!key.has_value()) {
+        _misses.fetch_add(1);
+
+        const SteamAPICall_t api_call = _helper.send_query_request(query_handle,
+            [this, callback](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+                auto page = std::make_shared<query_page>();
+                _helper.read_query_page(rc, completed, *page);
+                callback(page);
+            });
+
+        // Not issued, the helper already released the handle and the completion will never run.
+        if (api_call == k_uAPICallInvalid) {
+            auto failed = std::make_shared<query_page>();
+            failed->result = EResult::k_EResultFail;
+            callback(failed);
+        }
+
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock{_mutex};
+
+    auto it = _entries.find(*key);
+
+    if (it == _entries.end() && load_from_disk(*key)) {
+        it = _entries.find(*key);
+    }
+
+    if (it != _entries.end() && it->second.page != nullptr) {
+        entry& cached = it->second;
+        const auto age = clock::now() - cached.stored_at;
+        touch(cached);
+
+        if (age < _options.ttl) {
+            _hits.fetch_add(1);
+
+            page_ptr page = cached.page;
+            lock.unlock();
+
+            _helper.release_query_handle(query_handle);
+            callback(page);
+            return;
+        }
+
+        if (age < _options.ttl + _options.stale_ttl) {
+            _stale_hits.fetch_add(1);
+
+            page_ptr page = cached.page;
+            const bool start_refresh = !cached.refreshing;
+            cached.refreshing = true;
+            lock.unlock();
+
+            if (start_refresh) {
+                refresh(*key, query_handle);
+            } else {
+                _helper.release_query_handle(query_handle);
+            }
+
+            callback(page);
+            return;
+        }
+    }
+
+    _misses.fetch_add(1);
+
+    if (it == _entries.end()) {
+        _lru.push_front(*key);
+
+        entry placeholder;
+        placeholder.lru_position = _lru.begin();
+        it = _entries.emplace(*key, std::move(placeholder)).first;
+    }
+
+    // Too old to serve: wait for the refresh, joining one already in flight.
+    entry& cached = it->second;
+    cached.waiters.push_back(std::move(callback));
+
+    if (cached.refreshing) {
+        lock.unlock();
+        _helper.release_query_handle(query_handle);
+        return;
+    }
+
+    cached.refreshing = true;
+    lock.unlock();
+
+    refresh(*key, query_handle);
+}
+
+[[nodiscard]] query_cache::page_ptr query_cache::lookup(const query_key& key) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    const auto it = _entries.find(key);
+
+    if (it == _entries.end() || it->second.page == nullptr ||
+        clock::now() - it->second.stored_at >= _options.ttl + _options.stale_ttl) {
+        _misses.fetch_add(1);
+        return nullptr;
+    }
+
+    touch(it->second);
+
+    if (clock::now() - it->second.stored_at < _options.ttl) {
+        _hits.fetch_add(1);
+    } else {
+        _stale_hits.fetch_add(1);
+    }
+
+    return it->second.page;
+}
+
+void query_cache::store(const query_key& key, page_ptr page) noexcept {
+    if (page == nullptr || page->result != EResult::k_EResultOK) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    auto it = _entries.find(key);
+
+    if (it == _entries.end()) {
+        _lru.push_front(key);
+
+        entry created;
+        created.lru_position = _lru.begin();
+        it = _entries.emplace(key, std::move(created)).first;
+    }
+
+    entry& cached = it->second;
+    _bytes -= cached.bytes;
+    cached.page = std::move(page);
+    cached.bytes = page_bytes(*cached.page);
+    cached.stored_at = clock::now();
+    _bytes += cached.bytes;
+
+    touch(cached);
+    evict_to_fit();
+}
+
+void query_cache::invalidate(const query_key& key) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    const auto it = _entries.find(key);
+
+    // Pending waiters still need their answer, only forget the page.
+    if (it == _entries.end() || it->second.refreshing) {
+        return;
+    }
+
+    _bytes -= it->second.bytes;
+    _lru.erase(it->second.lru_position);
+    _entries.erase(it);
+}
+
+void query_cache::clear() noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->second.refreshing) {
+            ++it;
+            continue;
+        }
+
+        _bytes -= it->second.bytes;
+        _lru.erase(it->second.lru_position);
+        it = _entries.erase(it);
+    }
+}
+
+[[nodiscard]] query_cache::statistics query_cache::stats() const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    return {_hits.load(), _stale_hits.load(), _misses.load(), _evictions.load(),
+            _refreshes.load(), _disk_hits.load(), _entries.size(), _bytes};
+}
+
+void query_cache::attach_disk_cache(std::shared_ptr<const query_disk_cache> disk) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _disk = std::move(disk);
+}
+
+[[nodiscard]] std::vector<std::pair<query_key, query_cache::page_ptr>> query_cache::snapshot() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    std::vector<std::pair<query_key, page_ptr>> pages;
+    pages.reserve(_entries.size());
+
+    for (const auto& [key, cached] : _entries) {
+        if (cached.page != nullptr) {
+            pages.emplace_back(key, cached.page);
+        }
+    }
+
+    return pages;
+}
+
+[[nodiscard]] std::size_t query_cache::page_bytes(const query_page& page) noexcept {
+    std::size_t bytes = sizeof(query_page) + page.next_cursor.capacity() +
+                        page.items.capacity() * sizeof(SteamUGCDetails_t) +
+                        page.preview_urls.capacity() * sizeof(std::string);
+
+    for (const auto& url : page.preview_urls) {
+        bytes += url.capacity();
+    }
+
+    return bytes;
+}
@@ -0,0 +1,317 @@
+#include "../include/queryDiskCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<query_disk_cache::file_header>);
+static_assert(std::is_trivially_copyable_v<query_disk_cache::page_record>);
+static_assert(std::is_trivially_copyable_v<query_disk_cache::item_record>);
+static_assert(sizeof(query_disk_cache::file_header) % 8 == 0);
+static_assert(sizeof(query_disk_cache::page_record) % 8 == 0);
+static_assert(sizeof(query_disk_cache::item_record) % 8 == 0);
+
+namespace {
+
+    constexpr uint64 align_up(const uint64 value) noexcept { return (value + 7) & ~uint64{7}; }
+
+    template <std::size_t N>
+    std::string_view fixed_string(const char (&chars)[N]) noexcept {
+        const void* end = std::memchr(chars, '\0', N);
+        return {chars, end != nullptr ? static_cast<std::size_t>(static_cast<const char*>(end) - chars) : N};
+    }
+
+    template <std::size_t N>
+    void copy_fixed_string(char (&chars)[N], const std::string_view value) noexcept {
+        const std::size_t length = std::min(value.size(), N - 1);
+        std::memcpy(chars, value.data(), length);
+        chars[length] = '\0';
+    }
+
+    // Appends strings to the pool, 8 byte alignment is restored once at the end.
+    struct string_pool {
+        std::string bytes;
+
+        query_disk_cache::string_ref add(const std::string_view value) {
+            const query_disk_cache::string_ref ref{static_cast<uint32>(bytes.size()), static_cast<uint32>(value.size())};
+            bytes.append(value);
+            return ref;
+        }
+    };
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Views.
+void query_disk_cache::item_view::to_details(SteamUGCDetails_t& details) const noexcept {
+    const item_record& r = *_record;
+
+    details = {};
+    details.m_nPublishedFileId = r.published_file_id;
+    details.m_eResult = static_cast<EResult>(r.result);
+    details.m_eFileType = static_cast<EWorkshopFileType>(r.file_type);
+    details.m_nCreatorAppID = r.creator_app_id;
+    details.m_nConsumerAppID = r.consumer_app_id;
+    copy_fixed_string(details.m_rgchTitle, title());
+    copy_fixed_string(details.m_rgchDescription, description());
+    details.m_ulSteamIDOwner = r.owner_steam_id;
+    details.m_rtimeCreated = r.time_created;
+    details.m_rtimeUpdated = r.time_updated;
+    details.m_rtimeAddedToUserList = r.time_added_to_user_list;
+    details.m_eVisibility = static_cast<ERemoteStoragePublishedFileVisibility>(r.visibility);
+    details.m_bBanned = r.banned != 0;
+    details.m_bAcceptedForUse = r.accepted_for_use != 0;
+    details.m_bTagsTruncated = r.tags_truncated != 0;
+    copy_fixed_string(details.m_rgchTags, tags());
+    details.m_hFile = r.file_handle;
+    details.m_hPreviewFile = r.preview_file_handle;
+    copy_fixed_string(details.m_pchFileName, file_name());
+    details.m_nFileSize = r.file_size;
+    details.m_nPreviewFileSize = r.preview_file_size;
+    copy_fixed_string(details.m_rgchURL, url());
+    details.m_unVotesUp = r.votes_up;
+    details.m_unVotesDown = r.votes_down;
+    details.m_flScore = r.score;
+    details.m_unNumChildren = r.num_children;
+}
+
+void query_disk_cache::page_view::to_page(query_page& page) const {
+    page.result = EResult::k_EResultOK;
+    page.num_returned = _record->num_returned;
+    page.total_matching = _record->total_matching;
+    page.next_cursor.assign(next_cursor());
+    page.items.resize(size());
+    page.preview_urls.clear();
+    page.preview_urls.reserve(size());
+
+    for (std::size_t i = 0; i < size(); ++i) {
+        const item_view item = (*this)[i];
+        item.to_details(page.items[i]);
+        page.preview_urls.emplace_back(item.preview_url());
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Reading.
+[[nodiscard]] std::string_view query_disk_cache::string_at(const string_ref ref) const noexcept {
+    // A corrupt reference reads as empty rather than past the pool.
+    if (static_cast<uint64>(ref.offset) + ref.length > _header->strings_size) {
+        return {};
+    }
+
+    return {_strings + ref.offset, ref.length};
+}
+
+[[nodiscard]] bool query_disk_cache::open(const std::filesystem::path& file_path) noexcept {
+    close();
+
+    if (!_file.open(file_path)) {
+        return false;
+    }
+
+    const std::byte* base = _file.data();
+    const uint64 size = _file.size();
+
+    if (size < sizeof(file_header)) {
+        _file.close();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const file_header*>(base);
+
+    // Written so that no offset or count from the file can wrap the bound.
+    const auto fits = [size](const uint64 offset, const uint64 count, const uint64 record_size) {
+        return offset <= size && count <= (size - offset) / record_size;
+    };
+
+    const bool valid = std::memcmp(header->magic, file_magic, sizeof(file_magic)) == 0 &&
+                       header->version == format_version &&
+                       header->byte_order == byte_order_mark &&
+                       header->header_size == sizeof(file_header) &&
+                       header->page_record_size == sizeof(page_record) &&
+                       header->item_record_size == sizeof(item_record) &&
+                       header->pages_offset % 8 == 0 && header->items_offset % 8 == 0 &&
+                       fits(header->pages_offset, header->page_count, sizeof(page_record)) &&
+                       fits(header->items_offset, header->item_count, sizeof(item_record)) &&
+                       fits(header->strings_offset, header->strings_size, 1);
+
+    if (!valid) {
+        _file.close();
+        return false;
+    }
+
+    _header = header;
+    _pages = reinterpret_cast<const page_record*>(base + header->pages_offset);
+    _items = reinterpret_cast<const item_record*>(base + header->items_offset);
+    _strings = reinterpret_cast<const char*>(base + header->strings_offset);
+    return true;
+}
+
+void query_disk_cache::close() noexcept {
+    _header = nullptr;
+    _pages = nullptr;
+    _items = nullptr;
+    _strings = nullptr;
+    _file.close();
+}
+
+[[nodiscard]] std::optional<query_disk_cache::page_view> query_disk_cache::find(const query_key& key) const noexcept {
+    if (_header == nullptr) {
+        return std::nullopt;
+    }
+
+    const std::string serialized = key.serialize();
+    const uint64 hash = stable_hash(serialized);
+
+    const page_record* end = _pages + _header->page_count;
+    const auto range = std::equal_range(_pages, end, hash, [](const auto& lhs, const auto& rhs) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(lhs)>, page_record>) {
+            return lhs.key_hash < rhs;
+        } else {
+            return lhs < rhs.key_hash;
+        }
+    });
+
+    for (const page_record* record = range.first; record != range.second; ++record) {
+        if (string_at(record->key) == serialized &&
+            uint64{record->first_item} + record->item_count <= _header->item_count) {
+            return page_view{*this, *record};
+        }
+    }
+
+    return std::nullopt;
+}
+
+// ----------------------------------------------------------------------------
+// Writing.
+[[nodiscard]] bool query_disk_cache::write(const std::filesystem::path& file_path,
+                                           const std::vector<std::pair<query_key, query_cache::page_ptr>>& pages) noexcept {
+    std::vector<page_record> page_records;
+    std::vector<item_record> item_records;
+    string_pool strings;
+
+    page_records.reserve(pages.size());
+
+    for (const auto& [key, page] : pages) {
+        if (page == nullptr || page->result != EResult::k_EResultOK) {
+            continue;
+        }
+
+        const std::string serialized = key.serialize();
+
+        page_record record{};
+        record.key_hash = stable_hash(serialized);
+        record.stored_at = static_cast<uint64>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        record.key = strings.add(serialized);
+        record.next_cursor = strings.add(page->next_cursor);
+        record.first_item = static_cast<uint32>(item_records.size());
+        record.item_count = static_cast<uint32>(page->items.size());
+        record.num_returned = page->num_returned;
+        record.total_matching = page->total_matching;
+        page_records.push_back(record);
+
+        for (std::size_t i = 0; i < page->items.size(); ++i) {
+            const SteamUGCDetails_t& details = page->items[i];
+
+            item_record item{};
+            item.published_file_id = details.m_nPublishedFileId;
+            item.owner_steam_id = details.m_ulSteamIDOwner;
+            item.file_handle = details.m_hFile;
+            item.preview_file_handle = details.m_hPreviewFile;
+            item.creator_app_id = details.m_nCreatorAppID;
+            item.consumer_app_id = details.m_nConsumerAppID;
+            item.time_created = details.m_rtimeCreated;
+            item.time_updated = details.m_rtimeUpdated;
+            item.time_added_to_user_list = details.m_rtimeAddedToUserList;
+            item.votes_up = details.m_unVotesUp;
+            item.votes_down = details.m_unVotesDown;
+            item.num_children = details.m_unNumChildren;
+            item.file_size = details.m_nFileSize;
+            item.preview_file_size = details.m_nPreviewFileSize;
+            item.score = details.m_flScore;
+            item.result = static_cast<int32>(details.m_eResult);
+            item.file_type = static_cast<int32>(details.m_eFileType);
+            item.visibility = static_cast<int32>(details.m_eVisibility);
+            item.banned = details.m_bBanned;
+            item.accepted_for_use = details.m_bAcceptedForUse;
+            item.tags_truncated = details.m_bTagsTruncated;
+            item.title = strings.add(fixed_string(details.m_rgchTitle));
+            item.description = strings.add(fixed_string(details.m_rgchDescription));
+            item.tags = strings.add(fixed_string(details.m_rgchTags));
+            item.file_name = strings.add(fixed_string(details.m_pchFileName));
+            item.url = strings.add(fixed_string(details.m_rgchURL));
+            item.preview_url = strings.add(i < page->preview_urls.size() ? std::string_view{page->preview_urls[i]} : std::string_view{});
+            item_records.push_back(item);
+        }
+    }
+
+    std::stable_sort(page_records.begin(), page_records.end(),
+                     [](const page_record& lhs, const page_record& rhs) { return lhs.key_hash < rhs.key_hash; });
+
+    strings.bytes.resize(align_up(strings.bytes.size()), '\0');
+
+    file_header header{};
+    std::memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = format_version;
+    header.byte_order = byte_order_mark;
+    header.header_size = sizeof(file_header);
+    header.page_record_size = sizeof(page_record);
+    header.item_record_size = sizeof(item_record);
+    header.page_count = static_cast<uint32>(page_records.size());
+    header.item_count = static_cast<uint32>(item_records.size());
+    header.pages_offset = sizeof(file_header);
+    header.items_offset = header.pages_offset + page_records.size() * sizeof(page_record);
+    header.strings_offset = header.items_offset + item_records.size() * sizeof(item_record);
+    header.strings_size = strings.bytes.size();
+    header.written_at = static_cast<uint64>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    std::filesystem::path temporary = file_path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream out{temporary, std::ios::binary | std::ios::trunc};
+
+        if (!out) {
+            log_warning("Steam") << "Couldn't write the query cache to " << temporary.string() << '\n';
+            return false;
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(page_records.data()),
+                  static_cast<std::streamsize>(page_records.size() * sizeof(page_record)));
+        out.write(reinterpret_cast<const char*>(item_records.data()),
+                  static_cast<std::streamsize>(item_records.size() * sizeof(item_record)));
+        out.write(strings.bytes.data(), static_cast<std::streamsize>(strings.bytes.size()));
+
+        if (!out.flush()) {
+            log_warning("Steam") << "Couldn't write the query cache to " << temporary.string() << '\n';
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, file_path, error);
+
+    if (error) {
+        log_warning("Steam") << "Couldn't replace the query cache " << file_path.string() << ": " << error.message() << '\n';
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+
+[[nodiscard]] uint64 query_disk_cache::stable_hash(const std::string_view bytes) noexcept {
+    uint64 hash = 0xcbf29ce484222325ull;
+
+    for (const char c : bytes) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
@@ -0,0 +1,127 @@
+#include "../include/queryKey.h"
+
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+
+namespace {
+
+    void hash_combine(std::size_t& seed, const std::size_t value) noexcept {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    void insert_sorted(std::vector<std::string>& tags, const char* tag) {
+        const std::string_view name{tag != nullptr ? tag : ""};
+        const auto it = std::lower_bound(tags.begin(), tags.end(), name);
+
+        if (it == tags.end() || *it != name) {
+            tags.emplace(it, name);
+        }
+    }
+
+    void append_number(std::string& out, const uint64 value) {
+        out += std::to_string(value);
+        out += '\x1f';
+    }
+
+    void append_string(std::string& out, const std::string& value) {
+        // Length prefixed, so no separator needs escaping.
+        append_number(out, value.size());
+        out += value;
+    }
+
+} // namespace
+
+void query_key::add_required_tag(const char* tag) { insert_sorted(required_tags, tag); }
+
+void query_key::add_excluded_tag(const char* tag) { insert_sorted(excluded_tags, tag); }
+
+[[nodiscard]] std::size_t query_key::hash() const noexcept {
+    const std::hash<std::string_view> hash_string;
+    std::size_t seed = static_cast<std::size_t>(type);
+
+    hash_combine(seed, list_type);
+    hash_combine(seed, matching_type);
+    hash_combine(seed, sort_order);
+    hash_combine(seed, account_id);
+    hash_combine(seed, creator_app_id);
+    hash_combine(seed, consumer_app_id);
+    hash_combine(seed, page);
+    hash_combine(seed, hash_string(cursor));
+
+    for (const auto& tag : required_tags) {
+        hash_combine(seed, hash_string(tag));
+    }
+
+    hash_combine(seed, 0x2d);
+
+    for (const auto& tag : excluded_tags) {
+        hash_combine(seed, hash_string(tag));
+    }
+
+    hash_combine(seed, match_any_tag);
+    hash_combine(seed, hash_string(search_text));
+    hash_combine(seed, hash_string(cloud_filename));
+    hash_combine(seed, trend_days);
+    hash_combine(seed, created_start);
+    hash_combine(seed, created_end);
+    hash_combine(seed, long_description);
+    hash_combine(seed, total_only);
+    hash_combine(seed, projection);
+    hash_combine(seed, playtime_stats_days);
+
+    return seed;
+}
+
+[[nodiscard]] std::string query_key::serialize() const {
+    std::string out;
+    out.reserve(96 + cursor.size() + search_text.size() + cloud_filename.size());
+
+    append_number(out, static_cast<uint64>(type));
+    append_number(out, list_type);
+    append_number(out, matching_type);
+    append_number(out, sort_order);
+    append_number(out, account_id);
+    append_number(out, creator_app_id);
+    append_number(out, consumer_app_id);
+    append_number(out, page);
+    append_string(out, cursor);
+
+    append_number(out, required_tags.size());
+
+    for (const auto& tag : required_tags) {
+        append_string(out, tag);
+    }
+
+    append_number(out, excluded_tags.size());
+
+    for (const auto& tag : excluded_tags) {
+        append_string(out, tag);
+    }
+
+    append_number(out, match_any_tag);
+    append_string(out, search_text);
+    append_string(out, cloud_filename);
+    append_number(out, trend_days);
+    append_number(out, created_start);
+    append_number(out, created_end);
+    append_number(out, long_description);
+    append_number(out, total_only);
+    append_number(out, projection);
+    append_number(out, playtime_stats_days);
+
+    return out;
+}
+
+[[nodiscard]] bool query_key::operator==(const query_key& other) const noexcept {
+    const auto tie = [](const query_key& key) {
+        return std::tie(key.type, key.list_type, key.matching_type, key.sort_order, key.account_id,
+                        key.creator_app_id, key.consumer_app_id, key.page, key.cursor,
+                        key.required_tags, key.excluded_tags, key.match_any_tag,
+                        key.search_text, key.cloud_filename, key.trend_days,
+                        key.created_start, key.created_end, key.long_description, key.total_only,
+                        key.projection, key.playtime_stats_days);
+    };
+
+    return tie(*this) == tie(other);
+}
@@ -0,0 +1,429 @@
+#include "../include/queryResultSet.h"
+#include "../include/steamHelper.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <utility>
+
+namespace {
+
+    template <std::size_t N>
+    std::string_view fixed_string(const char (&chars)[N]) noexcept {
+        const void* end = std::memchr(chars, '\0', N);
+        return {chars, end != nullptr ? static_cast<std::size_t>(static_cast<const char*>(end) - chars) : N};
+    }
+
+    template <std::size_t N>
+    void copy_fixed_string(char (&chars)[N], const std::string_view value) noexcept {
+        const std::size_t length = std::min(value.size(), N - 1);
+        std::memcpy(chars, value.data(), length);
+        chars[length] = '\0';
+    }
+
+    void pack_details(arena& storage, const SteamUGCDetails_t& details, query_result_item& item) {
+        item.id = details.m_nPublishedFileId;
+        item.owner_steam_id = details.m_ulSteamIDOwner;
+        item.file_handle = details.m_hFile;
+        item.preview_file_handle = details.m_hPreviewFile;
+        item.creator_app_id = details.m_nCreatorAppID;
+        item.consumer_app_id = details.m_nConsumerAppID;
+        item.time_created = details.m_rtimeCreated;
+        item.time_updated = details.m_rtimeUpdated;
+        item.time_added_to_user_list = details.m_rtimeAddedToUserList;
+        item.votes_up = details.m_unVotesUp;
+        item.votes_down = details.m_unVotesDown;
+        item.num_children = details.m_unNumChildren;
+        item.file_size = details.m_nFileSize;
+        item.preview_file_size = details.m_nPreviewFileSize;
+        item.score = details.m_flScore;
+        item.result = details.m_eResult;
+        item.file_type = details.m_eFileType;
+        item.visibility = details.m_eVisibility;
+        item.banned = details.m_bBanned;
+        item.accepted_for_use = details.m_bAcceptedForUse;
+        item.tags_truncated = details.m_bTagsTruncated;
+
+        item.title = storage.store(fixed_string(details.m_rgchTitle));
+        item.description = storage.store(fixed_string(details.m_rgchDescription));
+        item.tags = storage.store(fixed_string(details.m_rgchTags));
+        item.file_name = storage.store(fixed_string(details.m_pchFileName));
+        item.url = storage.store(fixed_string(details.m_rgchURL));
+    }
+
+} // namespace
+
+void query_result_item::to_details(SteamUGCDetails_t& details) const noexcept {
+    details = {};
+    details.m_nPublishedFileId = id;
+    details.m_eResult = result;
+    details.m_eFileType = file_type;
+    details.m_nCreatorAppID = creator_app_id;
+    details.m_nConsumerAppID = consumer_app_id;
+    copy_fixed_string(details.m_rgchTitle, title);
+    copy_fixed_string(details.m_rgchDescription, description);
+    details.m_ulSteamIDOwner = owner_steam_id;
+    details.m_rtimeCreated = time_created;
+    details.m_rtimeUpdated = time_updated;
+    details.m_rtimeAddedToUserList = time_added_to_user_list;
+    details.m_eVisibility = visibility;
+    details.m_bBanned = banned;
+    details.m_bAcceptedForUse = accepted_for_use;
+    details.m_bTagsTruncated = tags_truncated;
+    copy_fixed_string(details.m_rgchTags, tags);
+    details.m_hFile = file_handle;
+    details.m_hPreviewFile = preview_file_handle;
+    copy_fixed_string(details.m_pchFileName, file_name);
+    details.m_nFileSize = file_size;
+    details.m_nPreviewFileSize = preview_file_size;
+    copy_fixed_string(details.m_rgchURL, url);
+    details.m_unVotesUp = votes_up;
+    details.m_unVotesDown = votes_down;
+    details.m_flScore = score;
+    details.m_unNumChildren = num_children;
+}
+
+void query_result_set::add(const SteamUGCDetails_t& details, const std::string_view preview_url) {
+    query_result_item& item = _items.emplace_back();
+
+    pack_details(_arena, details, item);
+    item.preview_url = _arena.store(preview_url);
+}
+
+[[nodiscard]] std::shared_ptr<query_result_set> query_result_set::read(const EResult rc, const SteamUGCQueryCompleted_t& completed,
+                                                                       const uint32 projection) {
+    auto results = std::make_shared<query_result_set>();
+    results->_result = rc;
+    results->_total_matching = completed.m_unTotalMatchingResults;
+    results->_next_cursor = results->_arena.store(fixed_string(completed.m_rgchNextCursor));
+
+    if (rc != EResult::k_EResultOK) {
+        return results;
+    }
+
+    constexpr uint32 extra_fields = projection_metadata | projection_key_value_tags | projection_children |
+                                    projection_additional_previews | projection_statistics | projection_playtime_stats;
+
+    const uint32 count = completed.m_unNumResultsReturned;
+    const bool ids_only = (projection & projection_ids_only) != 0;
+
+    results->_items.resize(count);
+
+    // Only sets carrying more than details need the per-field slots.
+    if ((projection & extra_fields) != 0) {
+        results->_fields.resize(count);
+    }
+
+    // Borrowed while reading, `_helper` stays null so the set never releases it.
+    results->_handle = completed.m_handle;
+
+    // Scratch buffers reused across items, only the packed copies are kept.
+    SteamUGCDetails_t details;
+    char preview_url[512]; // 512 is the maximum size for the image URL
+
+    for (uint32 i = 0; i < count; ++i) {
+        query_result_item& item = results->_items[i];
+
+        if (!SteamUGC()->GetQueryUGCResult(completed.m_handle, i, &details)) {
+            log_error("Steam") << "Failed to get item details for item " << i << "\n";
+        } else {
+            pack_details(results->_arena, details, item);
+
+            if (!ids_only) {
+                if (SteamUGC()->GetQueryUGCPreviewURL(completed.m_handle, i, preview_url, sizeof(preview_url))) {
+                    item.preview_url = results->_arena.store(preview_url);
+                } else {
+                    log_error("Steam") << "Failed to get image URL for item " << i << "\n";
+                }
+            }
+        }
+
+        if (results->_fields.empty()) {
+            continue;
+        }
+
+        lazy_fields& fields = results->_fields[i];
+        fields.loaded = field_details | field_preview_url;
+        fields.preview_url = item.preview_url;
+
+        if ((projection & projection_metadata) != 0) {
+            results->load(i, field_metadata);
+        }
+
+        if ((projection & projection_key_value_tags) != 0) {
+            results->load(i, field_key_value_tags);
+        }
+
+        if ((projection & projection_children) != 0) {
+            results->load(i, field_children);
+        }
+
+        if ((projection & projection_additional_previews) != 0) {
+            results->load(i, field_additional_previews);
+        }
+
+        if ((projection & (projection_statistics | projection_playtime_stats)) != 0) {
+            for (std::size_t slot = 0; slot < statistic_count; ++slot) {
+                results->load_statistic(i, slot);
+            }
+        }
+
+        // Whatever was not projected reads as empty.
+        fields.loaded = std::numeric_limits<uint16_t>::max();
+        fields.statistics_loaded = std::numeric_limits<uint16_t>::max();
+    }
+
+    results->_handle = k_UGCQueryHandleInvalid;
+    return results;
+}
+
+[[nodiscard]] std::shared_ptr<query_result_set> query_result_set::attach(steam_helper& helper, const SteamUGCQueryCompleted_t& completed) {
+    auto results = std::make_shared<query_result_set>();
+    results->_result = completed.m_eResult;
+    results->_total_matching = completed.m_unTotalMatchingResults;
+    results->_next_cursor = results->_arena.store(fixed_string(completed.m_rgchNextCursor));
+    results->_helper = &helper;
+    results->_handle = completed.m_handle;
+    results->_items.resize(completed.m_unNumResultsReturned);
+    results->_fields.resize(completed.m_unNumResultsReturned);
+
+    return results;
+}
+
+// ----------------------------------------------------------------------------
+// Lazy extraction.
+void query_result_set::load_details(const std::size_t index) const {
+    query_result_item& item = _items[index];
+
+    SteamUGCDetails_t details;
+
+    if (!SteamUGC()->GetQueryUGCResult(_handle, static_cast<uint32>(index), &details)) {
+        log_error("Steam") << "Failed to get item details for item " << index << "\n";
+        return;
+    }
+
+    pack_details(_arena, details, item);
+}
+
+void query_result_set::load(const std::size_t index, const field wanted) const {
+    lazy_fields& fields = _fields[index];
+
+    if ((fields.loaded & wanted) != 0) {
+        return;
+    }
+
+    // Memoized even when it fails or the handle is gone, so it is tried once.
+    fields.loaded |= wanted;
+
+    if (_handle == k_UGCQueryHandleInvalid) {
+        return;
+    }
+
+    const auto steam_index = static_cast<uint32>(index);
+
+    switch (wanted) {
+        case field_details:
+            load_details(index);
+            break;
+
+        case field_preview_url: {
+            char preview_url[512]; // 512 is the maximum size for the image URL
+
+            if (SteamUGC()->GetQueryUGCPreviewURL(_handle, steam_index, preview_url, sizeof(preview_url))) {
+                fields.preview_url = _arena.store(preview_url);
+            } else {
+                log_error("Steam") << "Failed to get image URL for item " << index << "\n";
+            }
+            break;
+        }
+
+        case field_metadata: {
+            char metadata[k_cchDeveloperMetadataMax + 1];
+
+            if (SteamUGC()->GetQueryUGCMetadata(_handle, steam_index, metadata, sizeof(metadata))) {
+                fields.metadata = _arena.store(metadata);
+            }
+            break;
+        }
+
+        case field_key_value_tags: {
+            const uint32 count = SteamUGC()->GetQueryUGCNumKeyValueTags(_handle, steam_index);
+
+            if (count == 0) {
+                break;
+            }
+
+            auto* tags = static_cast<query_result_tag*>(_arena.allocate(count * sizeof(query_result_tag), alignof(query_result_tag)));
+            std::size_t read = 0;
+
+            // Keys and values are at most 255 characters.
+            char key[256];
+            char value[256];
+
+            for (uint32 i = 0; i < count; ++i) {
+                if (SteamUGC()->GetQueryUGCKeyValueTag(_handle, steam_index, i, key, sizeof(key), value, sizeof(value))) {
+                    new (&tags[read++]) query_result_tag{_arena.store(key), _arena.store(value)};
+                }
+            }
+
+            fields.key_value_tags = {tags, read};
+            break;
+        }
+
+        case field_children: {
+            load(index, field_details);
+
+            const uint32 count = _items[index].num_children;
+
+            if (count == 0) {
+                break;
+            }
+
+            auto* children = static_cast<PublishedFileId_t*>(_arena.allocate(count * sizeof(PublishedFileId_t), alignof(PublishedFileId_t)));
+
+            if (SteamUGC()->GetQueryUGCChildren(_handle, steam_index, children, count)) {
+                fields.children = {children, count};
+            }
+            break;
+        }
+
+        case field_additional_previews: {
+            const uint32 count = SteamUGC()->GetQueryUGCNumAdditionalPreviews(_handle, steam_index);
+
+            if (count == 0) {
+                break;
+            }
+
+            auto* previews = static_cast<query_result_preview*>(_arena.allocate(count * sizeof(query_result_preview), alignof(query_result_preview)));
+            std::size_t read = 0;
+
+            char url_or_video_id[512];
+            char original_file_name[k_cchFilenameMax];
+
+            for (uint32 i = 0; i < count; ++i) {
+                EItemPreviewType type;
+
+                if (SteamUGC()->GetQueryUGCAdditionalPreview(_handle, steam_index, i, url_or_video_id, sizeof(url_or_video_id),
+                                                             original_file_name, sizeof(original_file_name), &type)) {
+                    new (&previews[read++]) query_result_preview{_arena.store(url_or_video_id), _arena.store(original_file_name), type};
+                }
+            }
+
+            fields.additional_previews = {previews, read};
+            break;
+        }
+    }
+}
+
+[[nodiscard]] const query_result_item& query_result_set::operator[](const std::size_t index) const {
+    // Eager sets are complete and immutable.
+    if (_fields.empty()) {
+        return _items[index];
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    load(index, field_details);
+    return _items[index];
+}
+
+[[nodiscard]] std::string_view query_result_set::preview_url(const std::size_t index) const {
+    if (_fields.empty()) {
+        return _items[index].preview_url;
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    load(index, field_preview_url);
+    return _fields[index].preview_url;
+}
+
+[[nodiscard]] std::string_view query_result_set::metadata(const std::size_t index) const {
+    if (_fields.empty()) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    load(index, field_metadata);
+    return _fields[index].metadata;
+}
+
+[[nodiscard]] result_span<query_result_tag> query_result_set::key_value_tags(const std::size_t index) const {
+    if (_fields.empty()) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    load(index, field_key_value_tags);
+    return _fields[index].key_value_tags;
+}
+
+void query_result_set::load_statistic(const std::size_t index, const std::size_t slot) const {
+    lazy_fields& fields = _fields[index];
+    const auto bit = static_cast<uint16_t>(1u << slot);
+
+    if ((fields.statistics_loaded & bit) != 0) {
+        return;
+    }
+
+    fields.statistics_loaded |= bit;
+
+    if (_handle != k_UGCQueryHandleInvalid &&
+        SteamUGC()->GetQueryUGCStatistic(_handle, static_cast<uint32>(index), static_cast<EItemStatistic>(slot), &fields.statistics[slot])) {
+        fields.statistics_found |= bit;
+    }
+}
+
+[[nodiscard]] std::optional<uint64> query_result_set::statistic(const std::size_t index, const EItemStatistic statistic) const {
+    const auto slot = static_cast<std::size_t>(statistic);
+
+    if (_fields.empty() || slot >= statistic_count) {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    load_statistic(index, slot);
+
+    if ((_fields[index].statistics_found & (1u << slot)) == 0) {
+        return std::nullopt;
+    }
+
+    return _fields[index].statistics[slot];
+}
+
+[[nodiscard]] result_span<PublishedFileId_t> query_result_set::children(const std::size_t index) const {
+    if (_fields.empty()) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    load(index, field_children);
+    return _fields[index].children;
+}
+
+[[nodiscard]] result_span<query_result_preview> query_result_set::additional_previews(const std::size_t index) const {
+    if (_fields.empty()) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    load(index, field_additional_previews);
+    return _fields[index].additional_previews;
+}
+
+[[nodiscard]] bool query_result_set::holds_handle() const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _handle != k_UGCQueryHandleInvalid;
+}
+
+void query_result_set::release() noexcept {
+    UGCQueryHandle_t handle;
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        handle = std::exchange(_handle, k_UGCQueryHandleInvalid);
+    }
+
+    if (handle != k_UGCQueryHandleInvalid && _helper != nullptr) {
+        _helper->release_query_handle(handle);
+    }
+}
@@ -0,0 +1,166 @@
+#include "../include/querySpec.h"
+
+#include <utility>
+
+namespace {
+
+    void hash_combine(std::size_t& seed, const std::size_t value) noexcept {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+} // namespace
+
+[[nodiscard]] query_spec::shared_state& query_spec::mutate() {
+    if (_shared.use_count() != 1) {
+        _shared = std::make_shared<shared_state>(*_shared);
+    }
+
+    // Only ever shared as const, this spec is now its sole owner.
+    return const_cast<shared_state&>(*_shared);
+}
+
+[[nodiscard]] query_spec query_spec::all(const EUGCQuery list_type, const EUGCMatchingUGCType matching_type,
+                                         const AppId_t creator_app_id, const AppId_t consumer_app_id) {
+    auto shared = std::make_shared<shared_state>();
+    shared->key.type = query_key::kind::all;
+    shared->key.list_type = static_cast<uint32>(list_type);
+    shared->key.matching_type = static_cast<uint32>(matching_type);
+    shared->key.creator_app_id = creator_app_id;
+    shared->key.consumer_app_id = consumer_app_id;
+
+    query_spec spec;
+    spec._shared = std::move(shared);
+    return spec;
+}
+
+[[nodiscard]] query_spec query_spec::user(const AccountID_t account_id, const EUserUGCList list_type, const EUGCMatchingUGCType matching_type,
+                                          const EUserUGCListSortOrder sort_order, const AppId_t creator_app_id, const AppId_t consumer_app_id) {
+    auto shared = std::make_shared<shared_state>();
+    shared->key.type = query_key::kind::user;
+    shared->key.account_id = account_id;
+    shared->key.list_type = static_cast<uint32>(list_type);
+    shared->key.matching_type = static_cast<uint32>(matching_type);
+    shared->key.sort_order = static_cast<uint32>(sort_order);
+    shared->key.creator_app_id = creator_app_id;
+    shared->key.consumer_app_id = consumer_app_id;
+
+    query_spec spec;
+    spec._shared = std::move(shared);
+    return spec;
+}
+
+// ----------------------------------------------------------------------------
+// Filters and flags.
+query_spec& query_spec::required_tag(const char* tag) {
+    mutate().key.add_required_tag(tag);
+    return *this;
+}
+
+query_spec& query_spec::excluded_tag(const char* tag) {
+    mutate().key.add_excluded_tag(tag);
+    return *this;
+}
+
+query_spec& query_spec::match_any_tag(const bool match_any) {
+    mutate().key.match_any_tag = match_any;
+    return *this;
+}
+
+query_spec& query_spec::search_text(const std::string& text) {
+    mutate().key.search_text = text;
+    return *this;
+}
+
+query_spec& query_spec::cloud_filename_filter(const std::string& file_name) {
+    mutate().key.cloud_filename = file_name;
+    return *this;
+}
+
+query_spec& query_spec::ranked_by_trend_days(const uint32 days) {
+    mutate().key.trend_days = days;
+    return *this;
+}
+
+query_spec& query_spec::created_between(const RTime32 start, const RTime32 end) {
+    shared_state& shared = mutate();
+    shared.key.created_start = start;
+    shared.key.created_end = end;
+    return *this;
+}
+
+query_spec& query_spec::long_description(const bool enabled) {
+    mutate().key.long_description = enabled;
+    return *this;
+}
+
+query_spec& query_spec::total_only(const bool enabled) {
+    mutate().key.total_only = enabled;
+    return *this;
+}
+
+query_spec& query_spec::projection(const uint32 projection, const uint32 playtime_stats_days) {
+    shared_state& shared = mutate();
+    shared.key.projection = projection;
+    shared.key.playtime_stats_days = (projection & projection_playtime_stats) != 0 ? playtime_stats_days : 0;
+    return *this;
+}
+
+query_spec& query_spec::allow_cached_response(const uint32 max_age_seconds) {
+    mutate().max_cache_age_seconds = max_age_seconds;
+    return *this;
+}
+
+// ----------------------------------------------------------------------------
+// Paging.
+[[nodiscard]] query_spec query_spec::with_page(const uint32 page) const {
+    query_spec spec{*this};
+    spec._page = page;
+    spec._cursor.clear();
+    return spec;
+}
+
+[[nodiscard]] query_spec query_spec::with_cursor(std::string cursor) const {
+    query_spec spec{*this};
+    spec._cursor = std::move(cursor);
+    return spec;
+}
+
+// ----------------------------------------------------------------------------
+// Identity.
+[[nodiscard]] query_key query_spec::key() const {
+    query_key key = _shared->key;
+
+    // Same as create_all_query records: a cursor replaces the page number.
+    if (key.type == query_key::kind::all && !_cursor.empty()) {
+        key.cursor = _cursor;
+    } else {
+        key.page = _page;
+    }
+
+    return key;
+}
+
+[[nodiscard]] std::size_t query_spec::hash() const noexcept {
+    std::size_t seed = _shared->key.hash();
+
+    hash_combine(seed, _page);
+    hash_combine(seed, std::hash<std::string>{}(_cursor));
+    hash_combine(seed, _shared->max_cache_age_seconds);
+
+    return seed;
+}
+
+[[nodiscard]] bool query_spec::operator==(const query_spec& other) const noexcept {
+    if (_page != other._page || _cursor != other._cursor) {
+        return false;
+    }
+
+    return _shared == other._shared ||
+           (_shared->key == other._shared->key && _shared->max_cache_age_seconds == other._shared->max_cache_age_seconds);
+}
+
+// ----------------------------------------------------------------------------
+// Execution.
+[[nodiscard]] UGCQueryHandle_t query_spec::create_handle(steam_helper& helper) const noexcept {
+    return helper.create_query_handle(key(), _shared->max_cache_age_seconds);
+}
@@ -0,0 +1,149 @@
+#include "../include/queryStream.h"
+
+query_stream::query_stream(steam_helper& helper, EUGCQuery list_type, EUGCMatchingUGCType matching_type,
+                           AppId_t creator_app_id, AppId_t consumer_app_id,
+                           query_configurator configure, uint32_t max_pages) noexcept
+    : _helper{helper}, _kind{query_kind::all}, _configure{std::move(configure)},
+      _all_list_type{list_type}, _matching_type{matching_type},
+      _creator_app_id{creator_app_id}, _consumer_app_id{consumer_app_id},
+      _state{std::make_shared<state>()}, _cursor{"*"}, _page_number{1}, _pages_fetched{0},
+      _max_pages{max_pages}, _exhausted{false}, _page_timeout{default_page_timeout} {}
+
+query_stream::query_stream(steam_helper& helper, AccountID_t account_id, EUserUGCList list_type,
+                           EUGCMatchingUGCType matching_type, EUserUGCListSortOrder sort_order,
+                           AppId_t creator_app_id, AppId_t consumer_app_id,
+                           query_configurator configure, uint32_t max_pages) noexcept
+    : _helper{helper}, _kind{query_kind::user}, _configure{std::move(configure)},
+      _account_id{account_id}, _user_list_type{list_type}, _sort_order{sort_order},
+      _matching_type{matching_type}, _creator_app_id{creator_app_id}, _consumer_app_id{consumer_app_id},
+      _state{std::make_shared<state>()}, _cursor{"*"}, _page_number{1}, _pages_fetched{0},
+      _max_pages{max_pages}, _exhausted{false}, _page_timeout{default_page_timeout} {}
+
+// ----------------------------------------------------------------------------
+// Paging utils.
+[[nodiscard]] UGCQueryHandle_t query_stream::create_page_query() noexcept {
+    UGCQueryHandle_t query_handle = k_UGCQueryHandleInvalid;
+
+    if (_kind == query_kind::all) {
+        _helper.create_all_query(query_handle, _all_list_type, _matching_type,
+                                 _creator_app_id, _consumer_app_id, _cursor);
+    } else {
+        _helper.create_user_query(query_handle, _account_id, _user_list_type, _matching_type,
+                                  _sort_order, _creator_app_id, _consumer_app_id, _page_number);
+    }
+
+    return query_handle;
+}
+
+bool query_stream::request_next_page() noexcept {
+    const UGCQueryHandle_t query_handle = create_page_query();
+
+    if (query_handle == k_UGCQueryHandleInvalid) {
+        return false;
+    }
+
+    if (_configure && !_configure(_helper, query_handle)) {
+        _helper.release_query_handle(query_handle);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{_state->mutex};
+        _state->in_flight = true;
+    }
+
+    const SteamAPICall_t api_call = _helper.send_query_request(query_handle,
+        [helper = &_helper, shared = _state](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+            query_page page;
+            helper->read_query_page(rc, completed, page);
+
+            std::lock_guard<std::mutex> lock{shared->mutex};
+            shared->ready.emplace(std::move(page));
+            shared->in_flight = false;
+        });
+
+    if (api_call == k_uAPICallInvalid) {
+        std::lock_guard<std::mutex> lock{_state->mutex};
+        _state->in_flight = false;
+        return false;
+    }
+
+    return true;
+}
+
+void query_stream::advance(const query_page& page) noexcept {
+    if (page.result != EResult::k_EResultOK || page.num_returned == 0) {
+        _exhausted = true;
+        return;
+    }
+
+    if (_max_pages != 0 && _pages_fetched >= _max_pages) {
+        _exhausted = true;
+        return;
+    }
+
+    if (_kind == query_kind::all) {
+        // Steam hands back the same cursor once the listing is exhausted.
+        if (page.next_cursor.empty() || page.next_cursor == _cursor) {
+            _exhausted = true;
+            return;
+        }
+
+        _cursor = page.next_cursor;
+        return;
+    }
+
+    if (static_cast<uint64_t>(_page_number) * kNumUGCResultsPerPage >= page.total_matching) {
+        _exhausted = true;
+        return;
+    }
+
+    ++_page_number;
+}
+
+[[nodiscard]] std::optional<query_page> query_stream::next_page() noexcept {
+    if (_exhausted) {
+        return std::nullopt;
+    }
+
+    bool pending = false;
+
+    {
+        std::lock_guard<std::mutex> lock{_state->mutex};
+        pending = _state->ready.has_value() || _state->in_flight;
+    }
+
+    // First page, or the prefetch could not be issued.
+    if (!pending && !request_next_page()) {
+        _exhausted = true;
+        return std::nullopt;
+    }
+
+    const bool received = _helper.run_callbacks_until([shared = _state] {
+        std::lock_guard<std::mutex> lock{shared->mutex};
+        return shared->ready.has_value();
+    }, _page_timeout);
+
+    if (!received) {
+        log_error("Steam") << "Timed out waiting for query page " << (_pages_fetched + 1) << "\n";
+        _exhausted = true;
+        return std::nullopt;
+    }
+
+    std::optional<query_page> page;
+
+    {
+        std::lock_guard<std::mutex> lock{_state->mutex};
+        page.swap(_state->ready);
+    }
+
+    ++_pages_fetched;
+    advance(*page);
+
+    // Prefetch while the caller processes this page.
+    if (!_exhausted) {
+        request_next_page();
+    }
+
+    return page;
+}
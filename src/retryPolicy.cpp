@@ -0,0 +1,47 @@
+#include "../include/retryPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+
+[[nodiscard]] std::chrono::milliseconds retry_policy::backoff(const uint32_t retry, const double unit) const noexcept {
+    const double initial = static_cast<double>(std::max<std::chrono::milliseconds::rep>(initial_backoff.count(), 0));
+    const double ceiling = static_cast<double>(std::max(max_backoff, initial_backoff).count());
+    const double exponent = static_cast<double>(std::max<uint32_t>(retry, 1) - 1);
+
+    // Capped before the jitter, so the ceiling holds whatever the multiplier.
+    const double delay = std::min(initial * std::pow(std::max(multiplier, 1.0), exponent), ceiling);
+    const double jittered = delay / 2 + delay / 2 * std::min(std::max(unit, 0.0), 1.0);
+
+    return std::chrono::milliseconds{static_cast<std::chrono::milliseconds::rep>(jittered)};
+}
+
+retry_budget::retry_budget(const retry_policy& policy) noexcept
+    : _tokens{policy.budget_capacity}, _ratio{policy.budget_ratio}, _capacity{policy.budget_capacity} {}
+
+void retry_budget::reset(const retry_policy& policy) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _tokens = policy.budget_capacity;
+    _ratio = policy.budget_ratio;
+    _capacity = policy.budget_capacity;
+}
+
+void retry_budget::deposit() noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _tokens = std::min(_tokens + _ratio, _capacity);
+}
+
+[[nodiscard]] bool retry_budget::try_withdraw() noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    if (_tokens < 1.0) {
+        return false;
+    }
+
+    _tokens -= 1.0;
+    return true;
+}
+
+[[nodiscard]] double retry_budget::tokens() const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _tokens;
+}
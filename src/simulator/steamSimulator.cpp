@@ -0,0 +1,1524 @@
+// ----------------------------------------------------------------------------
+// In-process Steam simulator, the UGC backend of -DSTEAM_WRAPPER_BACKEND=simulator.
+//
+// Implements the subset of the Steamworks API declared in steamSimulatorApi.h
+// over a synthetic, seed generated catalog. Call results are computed when the
+// call is issued and handed to their CCallResult from SteamAPI_RunCallbacks
+// once their simulated latency has elapsed, like the real client does.
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../../include/steamSimulator.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// Constants.
+constexpr PublishedFileId_t first_item_id = 2000000000ull;
+constexpr AccountID_t local_account_id = 1;
+constexpr uint32 account_pool_size = 64;
+constexpr uint64 steam_id_base = 76561197960265728ull;
+constexpr RTime32 catalog_epoch = 1400000000u;
+constexpr RTime32 catalog_span = 300000000u;
+constexpr uint32 short_description_length = 255;
+constexpr uint32 statistic_count = k_EItemStatistic_NumPlaytimeSessionsDuringTimePeriod + 1;
+
+constexpr std::array<std::string_view, 24> tag_pool{
+    "Maps", "Mods", "Weapons", "Vehicles", "Characters", "Skins", "Audio", "UI",
+    "Gameplay", "Multiplayer", "Singleplayer", "Campaign", "Sandbox", "Survival", "Horror", "Comedy",
+    "Realistic", "Stylized", "Small", "Large", "Beta", "Stable", "Tools", "Translations",
+};
+
+constexpr std::array<std::string_view, 8> title_adjectives{
+    "Ancient", "Broken", "Crimson", "Endless", "Frozen", "Hidden", "Silent", "Wild",
+};
+
+constexpr std::array<std::string_view, 8> title_nouns{
+    "Outpost", "Harbor", "Arsenal", "Caravan", "Citadel", "Garden", "Relay", "Workshop",
+};
+
+constexpr std::string_view lorem =
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore "
+    "magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo "
+    "consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur. "
+    "Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum. ";
+
+using clock_type = std::chrono::steady_clock;
+
+// ----------------------------------------------------------------------------
+// Catalog.
+struct preview {
+    std::string url_or_video_id;
+    std::string original_file_name;
+    EItemPreviewType type = k_EItemPreviewType_Image;
+};
+
+struct item {
+    PublishedFileId_t id = 0;
+    EWorkshopFileType file_type = k_EWorkshopFileTypeCommunity;
+    ERemoteStoragePublishedFileVisibility visibility = k_ERemoteStoragePublishedFileVisibilityPublic;
+    AccountID_t owner = 0;
+    RTime32 created = 0;
+    RTime32 updated = 0;
+    std::string title;
+    std::string description;
+    std::vector<std::string> tags;
+    std::vector<std::pair<std::string, std::string>> key_value_tags;
+    std::string metadata;
+    std::string file_name;
+    std::string preview_url;
+    int32 file_size = 0;
+    int32 preview_file_size = 0;
+    uint32 votes_up = 0;
+    uint32 votes_down = 0;
+    std::vector<PublishedFileId_t> children;
+    std::vector<preview> previews;
+    std::array<uint64, statistic_count> statistics{};
+    bool subscribed = false;
+};
+
+// ----------------------------------------------------------------------------
+// Handles.
+struct query_state {
+    bool user_query = false;
+    EUGCQuery query_type = k_EUGCQuery_RankedByVote;
+    EUserUGCList list_type = k_EUserUGCList_Published;
+    EUserUGCListSortOrder sort_order = k_EUserUGCListSortOrder_CreationOrderDesc;
+    EUGCMatchingUGCType matching_type = k_EUGCMatchingUGCType_Items;
+    AccountID_t account_id = 0;
+    AppId_t consumer_app_id = 0;
+    uint32 page = 1;
+    std::optional<std::string> cursor;
+
+    std::vector<std::string> required_tags;
+    std::vector<std::string> excluded_tags;
+    bool match_any_tag = false;
+    std::string search_text;
+    std::string cloud_file_name;
+    RTime32 created_start = 0;
+    RTime32 created_end = 0;
+
+    bool only_ids = false;
+    bool key_value_tags = false;
+    bool long_description = false;
+    bool metadata = false;
+    bool children = false;
+    bool additional_previews = false;
+    bool total_only = false;
+    uint32 playtime_stats_days = 0;
+
+    // Filled when the request is sent, readable once its call result is due.
+    bool sent = false;
+    clock_type::time_point ready_at;
+    std::vector<item> results;
+};
+
+struct update_state {
+    PublishedFileId_t item_id = 0;
+    std::optional<std::string> title;
+    std::optional<std::string> description;
+    std::optional<std::string> content_folder;
+    std::optional<std::string> preview_file;
+
+    // Submit timeline, the phases reported by GetItemUpdateProgress.
+    bool submitted = false;
+    clock_type::time_point submitted_at;
+    std::chrono::microseconds prepare{0};
+    std::chrono::microseconds content_upload{0};
+    std::chrono::microseconds preview_upload{0};
+    std::chrono::microseconds commit{0};
+    uint64 content_bytes = 0;
+    uint64 preview_bytes = 0;
+};
+
+// ----------------------------------------------------------------------------
+// Pending call results.
+using call_payload = std::variant<CreateItemResult_t, SubmitItemUpdateResult_t, SteamUGCQueryCompleted_t,
+                                  RemoteStorageSubscribePublishedFileResult_t, RemoteStorageUnsubscribePublishedFileResult_t>;
+
+// Catalog change applied when the call is due, only for calls that succeed.
+enum class commit_kind { none, create, update, subscribe, unsubscribe };
+
+struct pending_call {
+    clock_type::time_point due;
+    call_payload payload;
+    bool io_failure = false;
+
+    commit_kind commit = commit_kind::none;
+    PublishedFileId_t item_id = 0;
+    UGCUpdateHandle_t update_handle = 0;
+    std::optional<item> created;
+};
+
+struct registration {
+    int callback_id = 0;
+    void* target = nullptr;
+    steam_simulator_detail::call_result_handler handler = nullptr;
+};
+
+int callback_id_of(const call_payload& payload) noexcept {
+    return std::visit([](const auto& result) { return static_cast<int>(std::decay_t<decltype(result)>::k_iCallback); }, payload);
+}
+
+void* payload_address(call_payload& payload) noexcept {
+    return std::visit([](auto& result) { return static_cast<void*>(&result); }, payload);
+}
+
+// ----------------------------------------------------------------------------
+// Simulator state, every access goes through `mutex`.
+struct simulator {
+    std::mutex mutex;
+    bool configured = false;
+    int init_count = 0;
+
+    steam_simulator::config config;
+    steam_simulator::statistics stats;
+    std::mt19937_64 rng;
+
+    std::vector<item> catalog;
+    std::unordered_map<PublishedFileId_t, std::size_t> index_of;
+
+    PublishedFileId_t next_item_id = first_item_id;
+    uint64 next_handle = 1;
+    SteamAPICall_t next_call = 1;
+    std::unordered_map<UGCQueryHandle_t, query_state> queries;
+    std::unordered_map<UGCUpdateHandle_t, update_state> updates;
+
+    std::unordered_map<SteamAPICall_t, pending_call> pending;
+    std::unordered_map<SteamAPICall_t, registration> registrations;
+    using due_entry = std::pair<clock_type::time_point, SteamAPICall_t>;
+    std::priority_queue<due_entry, std::vector<due_entry>, std::greater<>> due_order;
+    // Due calls still waiting for their CCallResult to be set.
+    std::vector<SteamAPICall_t> due_unregistered;
+};
+
+simulator& instance() noexcept {
+    static simulator state;
+    return state;
+}
+
+ISteamUGC& ugc_interface() noexcept {
+    static ISteamUGC ugc;
+    return ugc;
+}
+
+// ----------------------------------------------------------------------------
+// Catalog generation, every item only depends on the seed and its index.
+uint64 split_mix(uint64 x) noexcept {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+EWorkshopFileType pick_file_type(const uint64 roll) noexcept {
+    switch (roll % 20) {
+        case 0: return k_EWorkshopFileTypeCollection;
+        case 1: return k_EWorkshopFileTypeArt;
+        case 2: return k_EWorkshopFileTypeScreenshot;
+        case 3: return k_EWorkshopFileTypeMicrotransaction;
+        default: return k_EWorkshopFileTypeCommunity;
+    }
+}
+
+std::string make_description(std::mt19937_64& rng) {
+    std::string description;
+    const std::size_t length = 64 + rng() % 1984;
+    description.reserve(length);
+
+    while (description.size() < length) {
+        description.append(lorem.substr(0, std::min(lorem.size(), length - description.size())));
+    }
+
+    return description;
+}
+
+item generate_item(const uint64 seed, const uint32 index, const uint32 catalog_size) {
+    std::mt19937_64 rng{split_mix(seed ^ (static_cast<uint64>(index) << 1))};
+
+    item generated;
+    generated.id = first_item_id + index;
+    generated.file_type = pick_file_type(rng());
+    generated.owner = 2 + static_cast<AccountID_t>(rng() % account_pool_size);
+    generated.created = catalog_epoch + static_cast<RTime32>(rng() % catalog_span);
+    generated.updated = generated.created + static_cast<RTime32>(rng() % (catalog_epoch + catalog_span - generated.created + 1));
+
+    generated.title = std::string{title_adjectives[rng() % title_adjectives.size()]} + " " +
+                      std::string{title_nouns[rng() % title_nouns.size()]} + " #" + std::to_string(index);
+    generated.description = make_description(rng);
+
+    const std::size_t tag_count = 1 + rng() % 4;
+    for (std::size_t i = 0; i < tag_count; ++i) {
+        std::string tag{tag_pool[rng() % tag_pool.size()]};
+
+        if (std::find(generated.tags.begin(), generated.tags.end(), tag) == generated.tags.end()) {
+            generated.tags.push_back(std::move(tag));
+        }
+    }
+
+    const std::size_t key_value_count = rng() % 4;
+    for (std::size_t i = 0; i < key_value_count; ++i) {
+        generated.key_value_tags.emplace_back("key" + std::to_string(i), std::to_string(rng() % 1000));
+    }
+
+    generated.metadata = "{\"version\":" + std::to_string(1 + rng() % 20) + ",\"seed\":" + std::to_string(index) + "}";
+    generated.file_name = "item_" + std::to_string(generated.id) + ".bin";
+    generated.preview_url = "https://steamuserimages-a.akamaihd.net/ugc/" + std::to_string(generated.id) + "/preview.jpg";
+    generated.file_size = static_cast<int32>(1024 + rng() % (64u << 20));
+    generated.preview_file_size = static_cast<int32>(16384 + rng() % (1u << 20));
+    generated.votes_up = static_cast<uint32>(rng() % 5000);
+    generated.votes_down = static_cast<uint32>(rng() % 1000);
+
+    if (generated.file_type == k_EWorkshopFileTypeCollection && catalog_size != 0) {
+        const std::size_t child_count = 2 + rng() % 7;
+        for (std::size_t i = 0; i < child_count; ++i) {
+            generated.children.push_back(first_item_id + rng() % catalog_size);
+        }
+    }
+
+    const std::size_t preview_count = rng() % 4;
+    for (std::size_t i = 0; i < preview_count; ++i) {
+        preview extra;
+        if (rng() % 4 == 0) {
+            extra.url_or_video_id = "dQw4w9WgXcQ";
+            extra.type = k_EItemPreviewType_YouTubeVideo;
+        } else {
+            extra.url_or_video_id = generated.preview_url + "?" + std::to_string(i);
+            extra.original_file_name = "screenshot_" + std::to_string(i) + ".jpg";
+        }
+        generated.previews.push_back(std::move(extra));
+    }
+
+    for (auto& statistic : generated.statistics) {
+        statistic = rng() % 100000;
+    }
+
+    return generated;
+}
+
+void reset(simulator& state, const steam_simulator::config& config) {
+    state.config = config;
+    state.stats = {};
+    state.rng.seed(config.seed);
+
+    state.catalog.clear();
+    state.index_of.clear();
+    state.catalog.reserve(config.catalog_size);
+
+    for (uint32 i = 0; i < config.catalog_size; ++i) {
+        state.catalog.push_back(generate_item(config.seed, i, config.catalog_size));
+        state.index_of.emplace(state.catalog.back().id, i);
+    }
+
+    state.next_item_id = first_item_id + config.catalog_size;
+    state.queries.clear();
+    state.updates.clear();
+    state.pending.clear();
+    state.registrations.clear();
+    state.due_order = {};
+    state.due_unregistered.clear();
+    state.configured = true;
+}
+
+void ensure_configured(simulator& state) {
+    if (!state.configured) {
+        reset(state, steam_simulator::config{});
+    }
+}
+
+item* find_item(simulator& state, const PublishedFileId_t id) noexcept {
+    const auto it = state.index_of.find(id);
+    return it == state.index_of.end() ? nullptr : &state.catalog[it->second];
+}
+
+// ----------------------------------------------------------------------------
+// Latency and fault injection.
+std::chrono::microseconds draw_latency(simulator& state, const steam_simulator::latency& latency) {
+    using distribution = steam_simulator::latency::distribution;
+
+    const double mean = static_cast<double>(latency.mean.count());
+    const double spread = static_cast<double>(latency.spread.count());
+    double drawn = mean;
+
+    switch (latency.shape) {
+        case distribution::fixed:
+            break;
+        case distribution::uniform:
+            drawn = std::uniform_real_distribution<double>{mean - spread, mean + spread}(state.rng);
+            break;
+        case distribution::normal:
+            drawn = spread > 0.0 ? std::normal_distribution<double>{mean, spread}(state.rng) : mean;
+            break;
+        case distribution::exponential:
+            drawn = mean > 0.0 ? std::exponential_distribution<double>{1.0 / mean}(state.rng) : 0.0;
+            break;
+    }
+
+    return std::chrono::microseconds{static_cast<int64>(std::max(drawn, 0.0))};
+}
+
+struct injected_fault {
+    EResult result = k_EResultOK;
+    bool io_failure = false;
+};
+
+injected_fault draw_fault(simulator& state, const steam_simulator::faults& faults) {
+    std::uniform_real_distribution<double> roll{0.0, 1.0};
+    injected_fault fault;
+
+    if (roll(state.rng) < faults.busy) {
+        fault.result = k_EResultBusy;
+    } else if (roll(state.rng) < faults.rate_limit_exceeded) {
+        fault.result = k_EResultRateLimitExceeded;
+    } else if (roll(state.rng) < faults.io_failure) {
+        fault.io_failure = true;
+    }
+
+    if (fault.result != k_EResultOK || fault.io_failure) {
+        ++state.stats.faults_injected;
+    }
+
+    return fault;
+}
+
+SteamAPICall_t issue_call(simulator& state, const std::chrono::microseconds delay, pending_call call) {
+    const SteamAPICall_t api_call = state.next_call++;
+    call.due = clock_type::now() + delay;
+
+    state.due_order.emplace(call.due, api_call);
+    state.pending.emplace(api_call, std::move(call));
+    ++state.stats.calls_issued;
+    return api_call;
+}
+
+SteamAPICall_t issue_call(simulator& state, const std::chrono::microseconds delay, call_payload payload, const bool io_failure) {
+    pending_call call;
+    call.payload = std::move(payload);
+    call.io_failure = io_failure;
+    return issue_call(state, delay, std::move(call));
+}
+
+// ----------------------------------------------------------------------------
+// Queries.
+bool matches_type(const EUGCMatchingUGCType matching_type, const EWorkshopFileType file_type) noexcept {
+    switch (matching_type) {
+        case k_EUGCMatchingUGCType_All:
+            return true;
+        case k_EUGCMatchingUGCType_Items:
+        case k_EUGCMatchingUGCType_Items_ReadyToUse:
+        case k_EUGCMatchingUGCType_UsableInGame:
+            return file_type == k_EWorkshopFileTypeCommunity || file_type == k_EWorkshopFileTypeMicrotransaction;
+        case k_EUGCMatchingUGCType_Items_Mtx:
+            return file_type == k_EWorkshopFileTypeMicrotransaction;
+        case k_EUGCMatchingUGCType_Collections:
+            return file_type == k_EWorkshopFileTypeCollection;
+        case k_EUGCMatchingUGCType_Artwork:
+            return file_type == k_EWorkshopFileTypeArt;
+        case k_EUGCMatchingUGCType_Videos:
+            return file_type == k_EWorkshopFileTypeVideo;
+        case k_EUGCMatchingUGCType_Screenshots:
+            return file_type == k_EWorkshopFileTypeScreenshot;
+        case k_EUGCMatchingUGCType_AllGuides:
+            return file_type == k_EWorkshopFileTypeWebGuide || file_type == k_EWorkshopFileTypeIntegratedGuide;
+        case k_EUGCMatchingUGCType_WebGuides:
+            return file_type == k_EWorkshopFileTypeWebGuide;
+        case k_EUGCMatchingUGCType_IntegratedGuides:
+            return file_type == k_EWorkshopFileTypeIntegratedGuide;
+        case k_EUGCMatchingUGCType_ControllerBindings:
+            return file_type == k_EWorkshopFileTypeControllerBinding;
+        case k_EUGCMatchingUGCType_GameManagedItems:
+            return file_type == k_EWorkshopFileTypeGameManagedItem;
+    }
+
+    return false;
+}
+
+bool contains_case_insensitive(const std::string_view text, const std::string_view pattern) noexcept {
+    const auto it = std::search(text.begin(), text.end(), pattern.begin(), pattern.end(), [](const char a, const char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    });
+
+    return it != text.end();
+}
+
+bool has_tag(const item& candidate, const std::string& tag) noexcept {
+    return std::find(candidate.tags.begin(), candidate.tags.end(), tag) != candidate.tags.end();
+}
+
+bool matches(const simulator& state, const query_state& query, const item& candidate) noexcept {
+    if (query.consumer_app_id != state.config.app_id || !matches_type(query.matching_type, candidate.file_type)) {
+        return false;
+    }
+
+    if (query.user_query) {
+        switch (query.list_type) {
+            case k_EUserUGCList_Published:
+                if (candidate.owner != query.account_id) {
+                    return false;
+                }
+                break;
+            case k_EUserUGCList_Subscribed:
+                if (query.account_id != local_account_id || !candidate.subscribed) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (!query.required_tags.empty()) {
+        const auto required = [&candidate](const std::string& tag) { return has_tag(candidate, tag); };
+
+        if (query.match_any_tag ? std::none_of(query.required_tags.begin(), query.required_tags.end(), required)
+                                : !std::all_of(query.required_tags.begin(), query.required_tags.end(), required)) {
+            return false;
+        }
+    }
+
+    for (const auto& tag : query.excluded_tags) {
+        if (has_tag(candidate, tag)) {
+            return false;
+        }
+    }
+
+    if (!query.search_text.empty() && !contains_case_insensitive(candidate.title, query.search_text)) {
+        return false;
+    }
+
+    if (!query.cloud_file_name.empty() && candidate.file_name != query.cloud_file_name) {
+        return false;
+    }
+
+    if (query.created_end != 0 && (candidate.created < query.created_start || candidate.created > query.created_end)) {
+        return false;
+    }
+
+    return true;
+}
+
+// Key an item is ranked by, larger first unless `ascending`.
+struct ranking {
+    uint64 (*key)(const item&) = nullptr;
+    bool ascending = false;
+};
+
+ranking ranking_of(const query_state& query) noexcept {
+    const auto by_score = [](const item& i) -> uint64 { return i.votes_up * 10000ull / (i.votes_up + i.votes_down + 1); };
+    const auto by_created = [](const item& i) -> uint64 { return i.created; };
+    const auto by_updated = [](const item& i) -> uint64 { return i.updated; };
+    const auto by_votes_up = [](const item& i) -> uint64 { return i.votes_up; };
+    const auto by_total_votes = [](const item& i) -> uint64 { return i.votes_up + i.votes_down; };
+    const auto by_title = [](const item& i) -> uint64 { return static_cast<unsigned char>(i.title.empty() ? 0 : i.title.front()); };
+    const auto by_subscriptions = [](const item& i) -> uint64 { return i.statistics[k_EItemStatistic_NumUniqueSubscriptions]; };
+    const auto by_playtime = [](const item& i) -> uint64 { return i.statistics[k_EItemStatistic_NumSecondsPlayed]; };
+    const auto by_reports = [](const item& i) -> uint64 { return i.statistics[k_EItemStatistic_ReportScore]; };
+
+    if (query.user_query) {
+        switch (query.sort_order) {
+            case k_EUserUGCListSortOrder_CreationOrderAsc: return {by_created, true};
+            case k_EUserUGCListSortOrder_TitleAsc: return {by_title, true};
+            case k_EUserUGCListSortOrder_LastUpdatedDesc: return {by_updated, false};
+            case k_EUserUGCListSortOrder_VoteScoreDesc: return {by_score, false};
+            case k_EUserUGCListSortOrder_ForModeration: return {by_reports, false};
+            default: return {by_created, false};
+        }
+    }
+
+    switch (query.query_type) {
+        case k_EUGCQuery_RankedByPublicationDate:
+        case k_EUGCQuery_AcceptedForGameRankedByAcceptanceDate:
+        case k_EUGCQuery_FavoritedByFriendsRankedByPublicationDate:
+        case k_EUGCQuery_CreatedByFriendsRankedByPublicationDate:
+        case k_EUGCQuery_CreatedByFollowedUsersRankedByPublicationDate:
+            return {by_created, false};
+        case k_EUGCQuery_RankedByLastUpdatedDate:
+            return {by_updated, false};
+        case k_EUGCQuery_RankedByVotesUp:
+            return {by_votes_up, false};
+        case k_EUGCQuery_RankedByTotalVotesAsc:
+        case k_EUGCQuery_NotYetRated:
+            return {by_total_votes, true};
+        case k_EUGCQuery_RankedByNumTimesReported:
+            return {by_reports, false};
+        case k_EUGCQuery_RankedByTrend:
+        case k_EUGCQuery_RankedByTotalUniqueSubscriptions:
+            return {by_subscriptions, false};
+        case k_EUGCQuery_RankedByPlaytimeTrend:
+        case k_EUGCQuery_RankedByTotalPlaytime:
+        case k_EUGCQuery_RankedByAveragePlaytimeTrend:
+        case k_EUGCQuery_RankedByLifetimeAveragePlaytime:
+        case k_EUGCQuery_RankedByPlaytimeSessionsTrend:
+        case k_EUGCQuery_RankedByLifetimePlaytimeSessions:
+            return {by_playtime, false};
+        default:
+            return {by_score, false};
+    }
+}
+
+// Parses a cursor handed out by a previous page, "*" is the first page.
+std::optional<std::size_t> parse_cursor(const std::string& cursor) noexcept {
+    if (cursor.empty() || cursor == "*") {
+        return 0;
+    }
+
+    char* end = nullptr;
+    const unsigned long long offset = std::strtoull(cursor.c_str(), &end, 10);
+
+    if (end == cursor.c_str() || *end != '\0') {
+        return std::nullopt;
+    }
+
+    return static_cast<std::size_t>(offset);
+}
+
+// Runs the query against the catalog, fills the handle's results and the call result.
+SteamUGCQueryCompleted_t execute_query(simulator& state, const UGCQueryHandle_t handle, query_state& query) {
+    SteamUGCQueryCompleted_t completed{};
+    completed.m_handle = handle;
+    completed.m_eResult = k_EResultOK;
+
+    std::size_t offset = static_cast<std::size_t>(query.page == 0 ? 0 : query.page - 1) * kNumUGCResultsPerPage;
+
+    if (query.cursor.has_value()) {
+        const auto parsed = parse_cursor(*query.cursor);
+
+        if (!parsed.has_value()) {
+            completed.m_eResult = k_EResultInvalidParam;
+            return completed;
+        }
+
+        offset = *parsed;
+    }
+
+    std::vector<const item*> matching;
+    for (const item& candidate : state.catalog) {
+        if (matches(state, query, candidate)) {
+            matching.push_back(&candidate);
+        }
+    }
+
+    completed.m_unTotalMatchingResults = static_cast<uint32>(matching.size());
+
+    const std::size_t begin = std::min(offset, matching.size());
+    const std::size_t end = std::min(begin + kNumUGCResultsPerPage, matching.size());
+
+    if (!query.total_only && begin != end) {
+        const ranking rank = ranking_of(query);
+
+        std::partial_sort(matching.begin(), matching.begin() + static_cast<std::ptrdiff_t>(end), matching.end(),
+                          [rank](const item* a, const item* b) {
+                              const uint64 ka = rank.key(*a);
+                              const uint64 kb = rank.key(*b);
+
+                              if (ka != kb) {
+                                  return rank.ascending ? ka < kb : ka > kb;
+                              }
+
+                              return a->id < b->id;
+                          });
+
+        query.results.reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i) {
+            query.results.push_back(*matching[i]);
+        }
+    }
+
+    completed.m_unNumResultsReturned = static_cast<uint32>(query.results.size());
+
+    // Exhausted listings hand back the cursor they were given.
+    if (query.cursor.has_value()) {
+        const std::string next = end == begin ? *query.cursor : std::to_string(end);
+        std::strncpy(completed.m_rgchNextCursor, next.c_str(), sizeof(completed.m_rgchNextCursor) - 1);
+    }
+
+    return completed;
+}
+
+const item* query_result(simulator& state, const UGCQueryHandle_t handle, const uint32 index, query_state** query = nullptr) noexcept {
+    const auto it = state.queries.find(handle);
+
+    if (it == state.queries.end() || !it->second.sent || clock_type::now() < it->second.ready_at ||
+        index >= it->second.results.size()) {
+        return nullptr;
+    }
+
+    if (query != nullptr) {
+        *query = &it->second;
+    }
+
+    return &it->second.results[index];
+}
+
+query_state* building_query(simulator& state, const UGCQueryHandle_t handle) noexcept {
+    const auto it = state.queries.find(handle);
+    return it == state.queries.end() || it->second.sent ? nullptr : &it->second;
+}
+
+bool copy_string(char* destination, const uint32 capacity, const std::string_view source) noexcept {
+    if (destination == nullptr || capacity == 0) {
+        return false;
+    }
+
+    const std::size_t length = std::min<std::size_t>(source.size(), capacity - 1);
+    std::memcpy(destination, source.data(), length);
+    destination[length] = '\0';
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Updates.
+uint64 directory_size(const std::string& folder) noexcept {
+    std::error_code ec;
+    uint64 total = 0;
+
+    for (auto it = std::filesystem::recursive_directory_iterator{folder, ec};
+         !ec && it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            total += it->file_size(ec);
+        }
+    }
+
+    return total;
+}
+
+std::chrono::microseconds upload_time(const simulator& state, const uint64 bytes) noexcept {
+    if (state.config.upload_bytes_per_second == 0) {
+        return std::chrono::microseconds{0};
+    }
+
+    return std::chrono::microseconds{static_cast<int64>(bytes * 1000000ull / state.config.upload_bytes_per_second)};
+}
+
+void commit(simulator& state, pending_call& call) {
+    switch (call.commit) {
+        case commit_kind::none:
+            break;
+        case commit_kind::create:
+            state.index_of.emplace(call.item_id, state.catalog.size());
+            state.catalog.push_back(std::move(*call.created));
+            break;
+        case commit_kind::update:
+            if (item* target = find_item(state, call.item_id)) {
+                const auto it = state.updates.find(call.update_handle);
+
+                if (it != state.updates.end()) {
+                    update_state& update = it->second;
+
+                    if (update.title.has_value()) {
+                        target->title = *update.title;
+                    }
+                    if (update.description.has_value()) {
+                        target->description = *update.description;
+                    }
+                    if (update.content_bytes != 0) {
+                        target->file_size = static_cast<int32>(std::min<uint64>(update.content_bytes, INT32_MAX));
+                    }
+                    if (update.preview_bytes != 0) {
+                        target->preview_file_size = static_cast<int32>(std::min<uint64>(update.preview_bytes, INT32_MAX));
+                    }
+                }
+
+                target->updated = static_cast<RTime32>(std::time(nullptr));
+            }
+            break;
+        case commit_kind::subscribe:
+        case commit_kind::unsubscribe:
+            if (item* target = find_item(state, call.item_id)) {
+                target->subscribed = call.commit == commit_kind::subscribe;
+            }
+            break;
+    }
+
+    call.commit = commit_kind::none;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Control surface.
+void steam_simulator::configure(const config& new_config) noexcept {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    reset(state, new_config);
+}
+
+steam_simulator::config steam_simulator::configuration() noexcept {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    ensure_configured(state);
+    return state.config;
+}
+
+steam_simulator::statistics steam_simulator::stats() noexcept {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    statistics current = state.stats;
+    current.query_handles_open = state.queries.size();
+    current.update_handles_open = state.updates.size();
+    return current;
+}
+
+uint32_t steam_simulator::catalog_size() noexcept {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    ensure_configured(state);
+    return static_cast<uint32_t>(state.catalog.size());
+}
+
+uint32_t steam_simulator::pending_calls() noexcept {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    return static_cast<uint32_t>(state.pending.size());
+}
+
+// ----------------------------------------------------------------------------
+// Steam API.
+bool SteamAPI_Init() {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    ensure_configured(state);
+    ++state.init_count;
+    return true;
+}
+
+void SteamAPI_Shutdown() {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    if (state.init_count > 0) {
+        --state.init_count;
+    }
+}
+
+ISteamUGC* SteamUGC() {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    return state.init_count > 0 ? &ugc_interface() : nullptr;
+}
+
+void SteamAPI_RunCallbacks() {
+    auto& state = instance();
+
+    std::unique_lock<std::mutex> lock{state.mutex};
+    const auto now = clock_type::now();
+
+    // Calls issued by the handlers below are due after `now`, they wait for the next run.
+    while (!state.due_order.empty() && state.due_order.top().first <= now) {
+        const SteamAPICall_t call = state.due_order.top().second;
+        state.due_order.pop();
+
+        if (const auto it = state.pending.find(call); it != state.pending.end()) {
+            commit(state, it->second);
+        }
+
+        state.due_unregistered.push_back(call);
+    }
+
+    std::vector<SteamAPICall_t> waiting;
+    waiting.swap(state.due_unregistered);
+
+    for (std::size_t i = 0; i < waiting.size(); ++i) {
+        const SteamAPICall_t call = waiting[i];
+        const auto pending = state.pending.find(call);
+
+        if (pending == state.pending.end()) {
+            continue;
+        }
+
+        const auto registered = state.registrations.find(call);
+        if (registered == state.registrations.end()) {
+            state.due_unregistered.push_back(call);
+            continue;
+        }
+
+        const registration target = registered->second;
+        call_payload payload = std::move(pending->second.payload);
+        const bool io_failure = pending->second.io_failure;
+
+        state.registrations.erase(registered);
+        state.pending.erase(pending);
+
+        if (target.callback_id != callback_id_of(payload)) {
+            ++state.stats.calls_cancelled;
+            continue;
+        }
+
+        ++state.stats.calls_dispatched;
+
+        // One call at a time without the lock, handlers may issue, set or cancel call results.
+        lock.unlock();
+        target.handler(target.target, payload_address(payload), io_failure);
+        lock.lock();
+    }
+}
+
+void steam_simulator_detail::register_call_result(const SteamAPICall_t api_call, const int callback_id, void* target,
+                                                  const call_result_handler handler) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    if (state.pending.count(api_call) != 0) {
+        state.registrations[api_call] = registration{callback_id, target, handler};
+    }
+}
+
+void steam_simulator_detail::unregister_call_result(const SteamAPICall_t api_call, void* target) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    const auto it = state.registrations.find(api_call);
+    if (it != state.registrations.end() && it->second.target == target) {
+        state.registrations.erase(it);
+        ++state.stats.calls_cancelled;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Query creation.
+UGCQueryHandle_t ISteamUGC::CreateQueryUserUGCRequest(const AccountID_t unAccountID, const EUserUGCList eListType,
+                                                      const EUGCMatchingUGCType eMatchingUGCType, const EUserUGCListSortOrder eSortOrder,
+                                                      AppId_t, const AppId_t nConsumerAppID, const uint32 unPage) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    if (unPage == 0) {
+        return k_UGCQueryHandleInvalid;
+    }
+
+    query_state query;
+    query.user_query = true;
+    query.account_id = unAccountID;
+    query.list_type = eListType;
+    query.matching_type = eMatchingUGCType;
+    query.sort_order = eSortOrder;
+    query.consumer_app_id = nConsumerAppID;
+    query.page = unPage;
+
+    const UGCQueryHandle_t handle = state.next_handle++;
+    state.queries.emplace(handle, std::move(query));
+    return handle;
+}
+
+UGCQueryHandle_t ISteamUGC::CreateQueryAllUGCRequest(const EUGCQuery eQueryType, const EUGCMatchingUGCType eMatchingeMatchingUGCTypeFileType,
+                                                     AppId_t, const AppId_t nConsumerAppID, const uint32 unPage) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    if (unPage == 0) {
+        return k_UGCQueryHandleInvalid;
+    }
+
+    query_state query;
+    query.query_type = eQueryType;
+    query.matching_type = eMatchingeMatchingUGCTypeFileType;
+    query.consumer_app_id = nConsumerAppID;
+    query.page = unPage;
+
+    const UGCQueryHandle_t handle = state.next_handle++;
+    state.queries.emplace(handle, std::move(query));
+    return handle;
+}
+
+UGCQueryHandle_t ISteamUGC::CreateQueryAllUGCRequest(const EUGCQuery eQueryType, const EUGCMatchingUGCType eMatchingeMatchingUGCTypeFileType,
+                                                     AppId_t, const AppId_t nConsumerAppID, const char* pchCursor) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state query;
+    query.query_type = eQueryType;
+    query.matching_type = eMatchingeMatchingUGCTypeFileType;
+    query.consumer_app_id = nConsumerAppID;
+    query.cursor = pchCursor != nullptr ? pchCursor : "*";
+
+    const UGCQueryHandle_t handle = state.next_handle++;
+    state.queries.emplace(handle, std::move(query));
+    return handle;
+}
+
+SteamAPICall_t ISteamUGC::SendQueryUGCRequest(const UGCQueryHandle_t handle) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = building_query(state, handle);
+    if (query == nullptr) {
+        return k_uAPICallInvalid;
+    }
+
+    const auto& profile = state.config.profiles.query;
+    const auto delay = draw_latency(state, profile.delay);
+    const auto fault = draw_fault(state, profile.injected);
+
+    SteamUGCQueryCompleted_t completed{};
+    completed.m_handle = handle;
+    completed.m_eResult = fault.result;
+
+    if (fault.result == k_EResultOK && !fault.io_failure) {
+        completed = execute_query(state, handle, *query);
+    }
+
+    query->sent = true;
+    query->ready_at = clock_type::now() + delay;
+    return issue_call(state, delay, completed, fault.io_failure);
+}
+
+bool ISteamUGC::ReleaseQueryUGCRequest(const UGCQueryHandle_t handle) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+    return state.queries.erase(handle) != 0;
+}
+
+// ----------------------------------------------------------------------------
+// Query results.
+bool ISteamUGC::GetQueryUGCResult(const UGCQueryHandle_t handle, const uint32 index, SteamUGCDetails_t* pDetails) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+
+    if (result == nullptr || pDetails == nullptr) {
+        return false;
+    }
+
+    std::memset(pDetails, 0, sizeof(SteamUGCDetails_t));
+    pDetails->m_nPublishedFileId = result->id;
+    pDetails->m_eResult = k_EResultOK;
+
+    if (query->only_ids) {
+        return true;
+    }
+
+    pDetails->m_eFileType = result->file_type;
+    pDetails->m_nCreatorAppID = state.config.app_id;
+    pDetails->m_nConsumerAppID = state.config.app_id;
+    pDetails->m_ulSteamIDOwner = steam_id_base + result->owner;
+    pDetails->m_rtimeCreated = result->created;
+    pDetails->m_rtimeUpdated = result->updated;
+    pDetails->m_eVisibility = result->visibility;
+    pDetails->m_bAcceptedForUse = true;
+    pDetails->m_hFile = result->id;
+    pDetails->m_hPreviewFile = result->id + 1;
+    pDetails->m_nFileSize = result->file_size;
+    pDetails->m_nPreviewFileSize = result->preview_file_size;
+    pDetails->m_unVotesUp = result->votes_up;
+    pDetails->m_unVotesDown = result->votes_down;
+    pDetails->m_flScore = static_cast<float>(result->votes_up) / static_cast<float>(std::max(1u, result->votes_up + result->votes_down));
+    pDetails->m_unNumChildren = static_cast<uint32>(result->children.size());
+
+    copy_string(pDetails->m_rgchTitle, sizeof(pDetails->m_rgchTitle), result->title);
+
+    const std::string_view description = result->description;
+    copy_string(pDetails->m_rgchDescription, sizeof(pDetails->m_rgchDescription),
+                query->long_description ? description : description.substr(0, short_description_length));
+
+    std::string tags;
+    for (const auto& tag : result->tags) {
+        if (!tags.empty()) {
+            tags += ',';
+        }
+        tags += tag;
+    }
+    pDetails->m_bTagsTruncated = tags.size() >= sizeof(pDetails->m_rgchTags);
+    copy_string(pDetails->m_rgchTags, sizeof(pDetails->m_rgchTags), tags);
+
+    copy_string(pDetails->m_pchFileName, sizeof(pDetails->m_pchFileName), result->file_name);
+    return true;
+}
+
+bool ISteamUGC::GetQueryUGCPreviewURL(const UGCQueryHandle_t handle, const uint32 index, char* pchURL, const uint32 cchURLSize) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    const item* result = query_result(state, handle, index);
+    return result != nullptr && copy_string(pchURL, cchURLSize, result->preview_url);
+}
+
+bool ISteamUGC::GetQueryUGCMetadata(const UGCQueryHandle_t handle, const uint32 index, char* pchMetadata, const uint32 cchMetadatasize) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+    return result != nullptr && copy_string(pchMetadata, cchMetadatasize, query->metadata ? std::string_view{result->metadata} : "");
+}
+
+bool ISteamUGC::GetQueryUGCChildren(const UGCQueryHandle_t handle, const uint32 index, PublishedFileId_t* pvecPublishedFileID,
+                                    const uint32 cMaxEntries) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+
+    if (result == nullptr || !query->children || pvecPublishedFileID == nullptr) {
+        return false;
+    }
+
+    const std::size_t count = std::min<std::size_t>(cMaxEntries, result->children.size());
+    std::copy_n(result->children.begin(), count, pvecPublishedFileID);
+    return true;
+}
+
+bool ISteamUGC::GetQueryUGCStatistic(const UGCQueryHandle_t handle, const uint32 index, const EItemStatistic eStatType, uint64* pStatValue) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+
+    if (result == nullptr || pStatValue == nullptr || static_cast<uint32>(eStatType) >= statistic_count) {
+        return false;
+    }
+
+    // Playtime statistics are only returned for queries asking for them.
+    const bool playtime = eStatType == k_EItemStatistic_NumSecondsPlayed || eStatType == k_EItemStatistic_NumPlaytimeSessions ||
+                          eStatType == k_EItemStatistic_NumSecondsPlayedDuringTimePeriod ||
+                          eStatType == k_EItemStatistic_NumPlaytimeSessionsDuringTimePeriod;
+
+    if (playtime && query->playtime_stats_days == 0) {
+        return false;
+    }
+
+    *pStatValue = result->statistics[eStatType];
+    return true;
+}
+
+uint32 ISteamUGC::GetQueryUGCNumAdditionalPreviews(const UGCQueryHandle_t handle, const uint32 index) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+    return result != nullptr && query->additional_previews ? static_cast<uint32>(result->previews.size()) : 0;
+}
+
+bool ISteamUGC::GetQueryUGCAdditionalPreview(const UGCQueryHandle_t handle, const uint32 index, const uint32 previewIndex,
+                                             char* pchURLOrVideoID, const uint32 cchURLSize, char* pchOriginalFileName,
+                                             const uint32 cchOriginalFileNameSize, EItemPreviewType* pPreviewType) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+
+    if (result == nullptr || !query->additional_previews || previewIndex >= result->previews.size()) {
+        return false;
+    }
+
+    const preview& extra = result->previews[previewIndex];
+    copy_string(pchURLOrVideoID, cchURLSize, extra.url_or_video_id);
+    copy_string(pchOriginalFileName, cchOriginalFileNameSize, extra.original_file_name);
+
+    if (pPreviewType != nullptr) {
+        *pPreviewType = extra.type;
+    }
+
+    return true;
+}
+
+uint32 ISteamUGC::GetQueryUGCNumKeyValueTags(const UGCQueryHandle_t handle, const uint32 index) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+    return result != nullptr && query->key_value_tags ? static_cast<uint32>(result->key_value_tags.size()) : 0;
+}
+
+bool ISteamUGC::GetQueryUGCKeyValueTag(const UGCQueryHandle_t handle, const uint32 index, const uint32 keyValueTagIndex, char* pchKey,
+                                       const uint32 cchKeySize, char* pchValue, const uint32 cchValueSize) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = nullptr;
+    const item* result = query_result(state, handle, index, &query);
+
+    if (result == nullptr || !query->key_value_tags || keyValueTagIndex >= result->key_value_tags.size()) {
+        return false;
+    }
+
+    const auto& [key, value] = result->key_value_tags[keyValueTagIndex];
+    return copy_string(pchKey, cchKeySize, key) && copy_string(pchValue, cchValueSize, value);
+}
+
+// ----------------------------------------------------------------------------
+// Query filters, only accepted before the request is sent.
+namespace {
+
+template <typename F>
+bool update_query(const UGCQueryHandle_t handle, F&& update) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    query_state* query = building_query(state, handle);
+    return query != nullptr && update(*query);
+}
+
+} // namespace
+
+bool ISteamUGC::AddRequiredTag(const UGCQueryHandle_t handle, const char* pTagName) {
+    return update_query(handle, [pTagName](query_state& query) {
+        if (pTagName == nullptr || *pTagName == '\0') {
+            return false;
+        }
+        query.required_tags.emplace_back(pTagName);
+        return true;
+    });
+}
+
+bool ISteamUGC::AddExcludedTag(const UGCQueryHandle_t handle, const char* pTagName) {
+    return update_query(handle, [pTagName](query_state& query) {
+        if (pTagName == nullptr || *pTagName == '\0') {
+            return false;
+        }
+        query.excluded_tags.emplace_back(pTagName);
+        return true;
+    });
+}
+
+bool ISteamUGC::SetReturnOnlyIDs(const UGCQueryHandle_t handle, const bool bReturnOnlyIDs) {
+    return update_query(handle, [=](query_state& query) { return query.only_ids = bReturnOnlyIDs, true; });
+}
+
+bool ISteamUGC::SetReturnKeyValueTags(const UGCQueryHandle_t handle, const bool bReturnKeyValueTags) {
+    return update_query(handle, [=](query_state& query) { return query.key_value_tags = bReturnKeyValueTags, true; });
+}
+
+bool ISteamUGC::SetReturnLongDescription(const UGCQueryHandle_t handle, const bool bReturnLongDescription) {
+    return update_query(handle, [=](query_state& query) { return query.long_description = bReturnLongDescription, true; });
+}
+
+bool ISteamUGC::SetReturnMetadata(const UGCQueryHandle_t handle, const bool bReturnMetadata) {
+    return update_query(handle, [=](query_state& query) { return query.metadata = bReturnMetadata, true; });
+}
+
+bool ISteamUGC::SetReturnChildren(const UGCQueryHandle_t handle, const bool bReturnChildren) {
+    return update_query(handle, [=](query_state& query) { return query.children = bReturnChildren, true; });
+}
+
+bool ISteamUGC::SetReturnAdditionalPreviews(const UGCQueryHandle_t handle, const bool bReturnAdditionalPreviews) {
+    return update_query(handle, [=](query_state& query) { return query.additional_previews = bReturnAdditionalPreviews, true; });
+}
+
+bool ISteamUGC::SetReturnTotalOnly(const UGCQueryHandle_t handle, const bool bReturnTotalOnly) {
+    return update_query(handle, [=](query_state& query) { return query.total_only = bReturnTotalOnly, true; });
+}
+
+bool ISteamUGC::SetReturnPlaytimeStats(const UGCQueryHandle_t handle, const uint32 unDays) {
+    return update_query(handle, [=](query_state& query) { return query.playtime_stats_days = unDays, true; });
+}
+
+bool ISteamUGC::SetAllowCachedResponse(const UGCQueryHandle_t handle, uint32) {
+    return update_query(handle, [](query_state&) { return true; });
+}
+
+bool ISteamUGC::SetCloudFileNameFilter(const UGCQueryHandle_t handle, const char* pMatchCloudFileName) {
+    return update_query(handle, [pMatchCloudFileName](query_state& query) {
+        query.cloud_file_name = pMatchCloudFileName != nullptr ? pMatchCloudFileName : "";
+        return true;
+    });
+}
+
+bool ISteamUGC::SetMatchAnyTag(const UGCQueryHandle_t handle, const bool bMatchAnyTag) {
+    return update_query(handle, [=](query_state& query) { return query.match_any_tag = bMatchAnyTag, true; });
+}
+
+bool ISteamUGC::SetSearchText(const UGCQueryHandle_t handle, const char* pSearchText) {
+    return update_query(handle, [pSearchText](query_state& query) {
+        query.search_text = pSearchText != nullptr ? pSearchText : "";
+        return true;
+    });
+}
+
+bool ISteamUGC::SetRankedByTrendDays(const UGCQueryHandle_t handle, uint32) {
+    return update_query(handle, [](query_state& query) { return !query.user_query; });
+}
+
+bool ISteamUGC::SetTimeCreatedDateRange(const UGCQueryHandle_t handle, const RTime32 rtStart, const RTime32 rtEnd) {
+    return update_query(handle, [=](query_state& query) {
+        if (query.user_query || rtEnd < rtStart) {
+            return false;
+        }
+        query.created_start = rtStart;
+        query.created_end = rtEnd;
+        return true;
+    });
+}
+
+// ----------------------------------------------------------------------------
+// Item creation and updates.
+SteamAPICall_t ISteamUGC::CreateItem(const AppId_t nConsumerAppId, const EWorkshopFileType eFileType) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    const auto& profile = state.config.profiles.create_item;
+    const auto delay = draw_latency(state, profile.delay);
+    const auto fault = draw_fault(state, profile.injected);
+
+    CreateItemResult_t created{};
+    created.m_eResult = fault.result;
+
+    if (nConsumerAppId != state.config.app_id) {
+        created.m_eResult = k_EResultInvalidParam;
+    }
+
+    if (created.m_eResult != k_EResultOK || fault.io_failure) {
+        return issue_call(state, delay, created, fault.io_failure);
+    }
+
+    // Reserved now, visible to queries once the call result is due.
+    created.m_nPublishedFileId = state.next_item_id++;
+
+    item fresh;
+    fresh.id = created.m_nPublishedFileId;
+    fresh.file_type = eFileType;
+    fresh.owner = local_account_id;
+    fresh.visibility = k_ERemoteStoragePublishedFileVisibilityPrivate;
+    fresh.created = fresh.updated = static_cast<RTime32>(std::time(nullptr));
+    fresh.file_name = "item_" + std::to_string(fresh.id) + ".bin";
+
+    pending_call call;
+    call.payload = created;
+    call.commit = commit_kind::create;
+    call.item_id = created.m_nPublishedFileId;
+    call.created.emplace(std::move(fresh));
+    return issue_call(state, delay, std::move(call));
+}
+
+UGCUpdateHandle_t ISteamUGC::StartItemUpdate(const AppId_t nConsumerAppId, const PublishedFileId_t nPublishedFileID) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    if (nConsumerAppId != state.config.app_id || nPublishedFileID == k_PublishedFileIdInvalid) {
+        return k_UGCUpdateHandleInvalid;
+    }
+
+    const UGCUpdateHandle_t handle = state.next_handle++;
+    state.updates[handle].item_id = nPublishedFileID;
+    return handle;
+}
+
+namespace {
+
+template <typename F>
+bool update_item(const UGCUpdateHandle_t handle, F&& update) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    const auto it = state.updates.find(handle);
+    return it != state.updates.end() && !it->second.submitted && update(it->second);
+}
+
+} // namespace
+
+bool ISteamUGC::SetItemTitle(const UGCUpdateHandle_t handle, const char* pchTitle) {
+    return update_item(handle, [pchTitle](update_state& update) {
+        if (pchTitle == nullptr || std::strlen(pchTitle) >= static_cast<std::size_t>(k_cchPublishedDocumentTitleMax)) {
+            return false;
+        }
+        update.title = pchTitle;
+        return true;
+    });
+}
+
+bool ISteamUGC::SetItemDescription(const UGCUpdateHandle_t handle, const char* pchDescription) {
+    return update_item(handle, [pchDescription](update_state& update) {
+        if (pchDescription == nullptr || std::strlen(pchDescription) >= static_cast<std::size_t>(k_cchPublishedDocumentDescriptionMax)) {
+            return false;
+        }
+        update.description = pchDescription;
+        return true;
+    });
+}
+
+bool ISteamUGC::SetItemContent(const UGCUpdateHandle_t handle, const char* pszContentFolder) {
+    return update_item(handle, [pszContentFolder](update_state& update) {
+        if (pszContentFolder == nullptr) {
+            return false;
+        }
+        update.content_folder = pszContentFolder;
+        return true;
+    });
+}
+
+bool ISteamUGC::SetItemPreview(const UGCUpdateHandle_t handle, const char* pszPreviewFile) {
+    return update_item(handle, [pszPreviewFile](update_state& update) {
+        if (pszPreviewFile == nullptr) {
+            return false;
+        }
+        update.preview_file = pszPreviewFile;
+        return true;
+    });
+}
+
+SteamAPICall_t ISteamUGC::SubmitItemUpdate(const UGCUpdateHandle_t handle, const char*) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    const auto it = state.updates.find(handle);
+    if (it == state.updates.end() || it->second.submitted) {
+        return k_uAPICallInvalid;
+    }
+
+    update_state& update = it->second;
+    const auto& profile = state.config.profiles.submit_item;
+    const auto delay = draw_latency(state, profile.delay);
+    const auto fault = draw_fault(state, profile.injected);
+
+    SubmitItemUpdateResult_t submitted{};
+    submitted.m_eResult = fault.result;
+    submitted.m_nPublishedFileId = update.item_id;
+
+    item* target = find_item(state, update.item_id);
+    std::error_code ec;
+
+    if (submitted.m_eResult == k_EResultOK) {
+        if (target == nullptr) {
+            submitted.m_eResult = k_EResultFileNotFound;
+        } else if (target->owner != local_account_id) {
+            submitted.m_eResult = k_EResultAccessDenied;
+        } else if (update.content_folder.has_value() && !std::filesystem::is_directory(*update.content_folder, ec)) {
+            submitted.m_eResult = k_EResultFileNotFound;
+        } else if (update.preview_file.has_value() && !std::filesystem::is_regular_file(*update.preview_file, ec)) {
+            submitted.m_eResult = k_EResultFileNotFound;
+        }
+    }
+
+    update.submitted = true;
+    update.submitted_at = clock_type::now();
+    update.prepare = delay / 2;
+    update.commit = delay - update.prepare;
+
+    if (submitted.m_eResult == k_EResultOK) {
+        update.content_bytes = update.content_folder.has_value() ? directory_size(*update.content_folder) : 0;
+        update.preview_bytes = update.preview_file.has_value() ? std::filesystem::file_size(*update.preview_file, ec) : 0;
+        update.content_upload = upload_time(state, update.content_bytes);
+        update.preview_upload = upload_time(state, update.preview_bytes);
+    }
+
+    const auto total = update.prepare + update.content_upload + update.preview_upload + update.commit;
+
+    if (submitted.m_eResult != k_EResultOK || fault.io_failure) {
+        return issue_call(state, total, submitted, fault.io_failure);
+    }
+
+    // The new values only show up in queries once the call result is due.
+    pending_call call;
+    call.payload = submitted;
+    call.commit = commit_kind::update;
+    call.item_id = update.item_id;
+    call.update_handle = handle;
+    return issue_call(state, total, std::move(call));
+}
+
+EItemUpdateStatus ISteamUGC::GetItemUpdateProgress(const UGCUpdateHandle_t handle, uint64* punBytesProcessed, uint64* punBytesTotal) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    uint64 processed = 0;
+    uint64 total = 0;
+    EItemUpdateStatus status = k_EItemUpdateStatusInvalid;
+
+    const auto it = state.updates.find(handle);
+    if (it != state.updates.end() && it->second.submitted) {
+        const update_state& update = it->second;
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - update.submitted_at);
+
+        const auto progress = [&elapsed](const std::chrono::microseconds phase, const uint64 bytes) {
+            return phase.count() == 0 ? bytes : static_cast<uint64>(static_cast<double>(bytes) * elapsed.count() / phase.count());
+        };
+
+        if (elapsed < update.prepare / 2) {
+            status = k_EItemUpdateStatusPreparingConfig;
+        } else if (elapsed < update.prepare) {
+            status = k_EItemUpdateStatusPreparingContent;
+        } else if ((elapsed -= update.prepare) < update.content_upload) {
+            status = k_EItemUpdateStatusUploadingContent;
+            processed = progress(update.content_upload, update.content_bytes);
+            total = update.content_bytes;
+        } else if ((elapsed -= update.content_upload) < update.preview_upload) {
+            status = k_EItemUpdateStatusUploadingPreviewFile;
+            processed = progress(update.preview_upload, update.preview_bytes);
+            total = update.preview_bytes;
+        } else if ((elapsed -= update.preview_upload) < update.commit) {
+            status = k_EItemUpdateStatusCommittingChanges;
+        }
+    }
+
+    if (punBytesProcessed != nullptr) {
+        *punBytesProcessed = processed;
+    }
+    if (punBytesTotal != nullptr) {
+        *punBytesTotal = total;
+    }
+
+    return status;
+}
+
+// ----------------------------------------------------------------------------
+// Subscriptions.
+namespace {
+
+template <typename Result>
+SteamAPICall_t toggle_subscription(const PublishedFileId_t id, const bool subscribe) {
+    auto& state = instance();
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    const auto& profile = state.config.profiles.subscribe;
+    const auto delay = draw_latency(state, profile.delay);
+    const auto fault = draw_fault(state, profile.injected);
+
+    Result result{};
+    result.m_eResult = fault.result;
+    result.m_nPublishedFileId = id;
+
+    item* target = find_item(state, id);
+    if (result.m_eResult == k_EResultOK && target == nullptr) {
+        result.m_eResult = k_EResultFileNotFound;
+    }
+
+    if (result.m_eResult != k_EResultOK || fault.io_failure) {
+        return issue_call(state, delay, result, fault.io_failure);
+    }
+
+    pending_call call;
+    call.payload = result;
+    call.commit = subscribe ? commit_kind::subscribe : commit_kind::unsubscribe;
+    call.item_id = id;
+    return issue_call(state, delay, std::move(call));
+}
+
+} // namespace
+
+SteamAPICall_t ISteamUGC::SubscribeItem(const PublishedFileId_t nPublishedFileID) {
+    return toggle_subscription<RemoteStorageSubscribePublishedFileResult_t>(nPublishedFileID, true);
+}
+
+SteamAPICall_t ISteamUGC::UnsubscribeItem(const PublishedFileId_t nPublishedFileID) {
+    return toggle_subscription<RemoteStorageUnsubscribePublishedFileResult_t>(nPublishedFileID, false);
+}
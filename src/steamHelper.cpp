@@ -23,15 +23,13 @@
 #include <unordered_map>
 #include <filesystem>
 #include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
 
 // ----------------------------------------------------------------------------
 // Utilities.
-[[nodiscard]] std::ostream& log(const std::string_view category) noexcept
-{
-    std::cout << "[" << category << "] ";
-    return std::cout;
-}
-
 template <typename T>
 [[nodiscard]] T read_integer() noexcept
 {
@@ -114,21 +112,10 @@ template <typename T>
 }
 
 [[nodiscard]] bool poll_steam_callbacks(steam_helper& _steam_helper) noexcept {
-    using clock = std::chrono::high_resolution_clock;
-    using time_point = clock::time_point;
-
-    const time_point loop_begin_time = clock::now();
-
-    while (_steam_helper.any_pending_operation()) {
-        if (!_steam_helper.run_callbacks()) {
-            log("CLI") << "Could not run Steam API callbacks\n";
-            return false;
-        }
-
-        if (clock::now() - loop_begin_time > std::chrono::seconds(240)) {
-            log("CLI") << "Timed out\n";
-            return false;
-        }
+    if (!_steam_helper.run_callbacks_until([&_steam_helper] { return !_steam_helper.any_pending_operation(); },
+                                           std::chrono::seconds(240))) {
+        log_error("CLI") << "Timed out\n";
+        return false;
     }
 
     return true;
@@ -138,468 +125,1087 @@ template <typename T>
 // Steam stuff.
 
 steam_helper::~steam_helper() noexcept {
+    stop_callback_pump();
+
+    // Unregister the outstanding call results while the API is still up.
+    {
+        std::lock_guard<std::mutex> lock{_operations_mutex};
+        _operations.clear();
+        _retired_operations.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{_retry_mutex};
+        _retry_queue.clear();
+    }
+
+    _scheduler.clear();
+
     if (_initialized)
     {
-        log("Steam") << "Shutting down Steam API\n";
+        log_debug("Steam") << "Shutting down Steam API\n";
         SteamAPI_Shutdown();
-        log("Steam") << "Shut down Steam API\n";
+        log_info("Steam") << "Shut down Steam API\n";
     }
 }
 
 // ------------------------------------------------------------------------
-// Type aliases.
-using create_item_continuation = std::function<void(PublishedFileId_t)>;
-using submit_item_continuation = std::function<void()>;
+// Initialization utils.
+[[nodiscard]] bool steam_helper::initialize_steamworks() {
+    log_debug("Steam") << "Initializing Steam API\n";
+
+    if(SteamAPI_Init())
+    {
+        log_info("Steam") << "Steam API successfully initialized\n";
+        return true;
+    }
+
+    log_error("Steam") << "Failed to initialize Steam API\n";
+    return false;
+}
 
 // ------------------------------------------------------------------------
-// Data members.
-bool _initialized;
-std::atomic<int> _pending_operations;
+// Operation table utils.
+template <typename Result, typename Completion>
+std::unique_ptr<steam_helper::operation<Result, Completion>> steam_helper::make_operation(
+    const SteamAPICall_t key, const uint64 ugc_handle, Completion&& completion,
+    void (steam_helper::*on_completed)(operation<Result, Completion>&, Result*, bool), reissue_function&& reissue) noexcept {
+    auto entry = std::make_unique<operation<Result, Completion>>();
+    entry->helper = this;
+    entry->api_call = key;
+    entry->ugc_handle = ugc_handle;
+    entry->kind = operation_kind_of<Result>();
+    entry->priority = current_call_priority();
+    entry->issued = std::chrono::steady_clock::now();
+    entry->reissue = std::move(reissue);
+    entry->completion = std::move(completion);
+    entry->on_completed = on_completed;
+    return entry;
+}
+
+template <typename Result, typename Completion>
+SteamAPICall_t steam_helper::register_operation(const SteamAPICall_t api_call, const uint64 ugc_handle, Completion&& completion,
+                                                void (steam_helper::*on_completed)(operation<Result, Completion>&, Result*, bool),
+                                                reissue_function&& reissue) noexcept {
+    if (api_call == k_uAPICallInvalid) {
+        log_error("Steam") << "Steam API call could not be issued\n";
+        _metrics.issue_failed(operation_kind_of<Result>());
+        remove_pending_operation(operation_kind_of<Result>());
+        return k_uAPICallInvalid;
+    }
+
+    auto entry = make_operation(api_call, ugc_handle, std::move(completion), on_completed, std::move(reissue));
+    auto& registered = *entry;
 
-CCallResult<steam_helper, CreateItemResult_t> _create_item_result;
-create_item_continuation _create_item_continuation;
+    {
+        std::lock_guard<std::mutex> lock{_operations_mutex};
+        _operations.emplace(api_call, std::move(entry));
+    }
 
-CCallResult<steam_helper, SubmitItemUpdateResult_t> _submit_item_result;
-submit_item_continuation _submit_item_continuation;
+    _retry_budget.deposit();
+
+    // Registered last, the callback may fire as soon as the pump runs.
+    registered.call_result.Set(api_call, &registered, &operation<Result, Completion>::on_result);
+    wake_pump();
+    return api_call;
+}
+
+template <typename Result, typename Completion, typename Issue>
+SteamAPICall_t steam_helper::issue_operation(Issue&& issue, const uint64 ugc_handle, Completion&& completion,
+                                             void (steam_helper::*on_completed)(operation<Result, Completion>&, Result*, bool),
+                                             reissue_function&& reissue) noexcept {
+    const operation_kind kind = operation_kind_of<Result>();
+    const call_priority priority = current_call_priority();
+
+    if (_scheduler.try_acquire(kind, priority)) {
+        return register_operation(issue(), ugc_handle, std::move(completion), on_completed, std::move(reissue));
+    }
+
+    const SteamAPICall_t key = deferred_call_bit | _next_deferred_call.fetch_add(1);
+    auto entry = make_operation(key, ugc_handle, std::move(completion), on_completed, std::move(reissue));
+    entry->deferred_issue = [issue = std::forward<Issue>(issue)](operation_base&) mutable { return issue(); };
+
+    {
+        std::lock_guard<std::mutex> lock{_operations_mutex};
+        _operations.emplace(key, std::move(entry));
+    }
+
+    _retry_budget.deposit();
+    _scheduler.enqueue(kind, priority, key);
+    wake_pump();
+
+    log_trace("Steam") << "Deferred " << operation_kind_name(kind) << ", out of tokens\n";
+    return key;
+}
+
+void steam_helper::retire_operation(const SteamAPICall_t api_call) noexcept {
+    std::lock_guard<std::mutex> lock{_operations_mutex};
+
+    if (const auto it = _operations.find(api_call); it != _operations.end()) {
+        _retired_operations.push_back(std::move(it->second));
+        _operations.erase(it);
+    }
+}
+
+void steam_helper::release_retired_operations() noexcept {
+    std::vector<std::unique_ptr<operation_base>> retired;
+
+    {
+        std::lock_guard<std::mutex> lock{_operations_mutex};
+        retired.swap(_retired_operations);
+    }
+}
+
+void steam_helper::record_completion(const operation_base& operation, const EResult rc) noexcept {
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - operation.issued);
+    _metrics.operation_completed(operation.kind, rc, latency);
+    _scheduler.on_result(operation.kind, rc);
+}
 
 // ------------------------------------------------------------------------
-// Initialization utils.
-[[nodiscard]] bool steam_helper::initialize_steamworks() {
-    log("Steam") << "Initializing Steam API\n";
+// Retry utils.
+[[nodiscard]] bool steam_helper::schedule_retry(operation_base& operation, const EResult rc) noexcept {
+    if (!is_retryable_result(rc) || !operation.reissue) {
+        return false;
+    }
 
-    if(SteamAPI_Init())
     {
-        log("Steam") << "Steam API successfully initialized\n";
-        return true;
+        std::lock_guard<std::mutex> lock{_retry_mutex};
+
+        if (operation.attempt >= _retry_policy.max_attempts) {
+            log_warning("Steam") << "Giving up on " << operation_kind_name(operation.kind) << " after "
+                                 << operation.attempt << " attempts (" << result_to_string(rc) << ")\n";
+            return false;
+        }
+
+        if (!_retry_budget.try_withdraw()) {
+            _metrics.retry_denied(operation.kind);
+            log_warning("Steam") << "Retry budget exhausted, not retrying " << operation_kind_name(operation.kind)
+                                 << " (" << result_to_string(rc) << ")\n";
+            return false;
+        }
+
+        const double unit = std::uniform_real_distribution<double>{0.0, 1.0}(_retry_random);
+        const std::chrono::milliseconds delay = _retry_policy.backoff(operation.attempt, unit);
+
+        _retry_queue.push_back({std::chrono::steady_clock::now() + delay, operation.api_call, operation.kind, operation.priority});
+        _metrics.operation_retried(operation.kind);
+        ++operation.attempt;
+
+        log_warning("Steam") << "Retrying " << operation_kind_name(operation.kind) << " after " << result_to_string(rc)
+                             << " in " << delay.count() << " ms (attempt " << operation.attempt << '/'
+                             << _retry_policy.max_attempts << ")\n";
     }
 
-    log("Steam") << "Failed to initialize Steam API\n";
-    return false;
+    // The pump may be sleeping past the retry's due time, it picks the new deadline up.
+    wake_pump();
+    return true;
+}
+
+[[nodiscard]] std::optional<std::chrono::steady_clock::time_point> steam_helper::next_retry_due() const noexcept {
+    std::lock_guard<std::mutex> lock{_retry_mutex};
+
+    if (_retry_queue.empty()) {
+        return std::nullopt;
+    }
+
+    return std::min_element(_retry_queue.begin(), _retry_queue.end(),
+                            [](const scheduled_retry& a, const scheduled_retry& b) { return a.due < b.due; })
+        ->due;
+}
+
+void steam_helper::issue_scheduled_calls() noexcept {
+    {
+        std::lock_guard<std::mutex> lock{_retry_mutex};
+
+        if (!_retry_queue.empty()) {
+            const auto now = std::chrono::steady_clock::now();
+            const auto waiting = std::partition(_retry_queue.begin(), _retry_queue.end(),
+                                                [now](const scheduled_retry& retry) { return retry.due > now; });
+
+            for (auto it = waiting; it != _retry_queue.end(); ++it) {
+                _scheduler.enqueue(it->kind, it->priority, it->key);
+            }
+
+            _retry_queue.erase(waiting, _retry_queue.end());
+        }
+    }
+
+    std::vector<SteamAPICall_t> ready;
+    _scheduler.take_ready(ready);
+
+    for (const SteamAPICall_t key : ready) {
+        operation_base* pending = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock{_operations_mutex};
+
+            if (const auto it = _operations.find(key); it != _operations.end()) {
+                pending = it->second.get();
+            }
+        }
+
+        // Entries only leave the table on this thread, it outlives the call.
+        if (pending != nullptr) {
+            pending->issue_pending();
+        }
+    }
+}
+
+[[nodiscard]] steam_helper::reissue_function steam_helper::query_reissue(const UGCQueryHandle_t query_handle) noexcept {
+    std::optional<query_key> key = get_query_key(query_handle);
+
+    if (!key.has_value()) {
+        return {};
+    }
+
+    return [this, key = std::move(*key)](operation_base& operation) {
+        // A fresh handle, the failed one is only released once the new call is out.
+        const UGCQueryHandle_t retry_handle = create_query_handle(key);
+
+        if (retry_handle == k_UGCQueryHandleInvalid) {
+            return k_uAPICallInvalid;
+        }
+
+        const SteamAPICall_t api_call = SteamUGC()->SendQueryUGCRequest(retry_handle);
+
+        if (api_call == k_uAPICallInvalid) {
+            release_query_handle(retry_handle);
+            return k_uAPICallInvalid;
+        }
+
+        release_query_handle(operation.ugc_handle);
+        operation.ugc_handle = retry_handle;
+        return api_call;
+    };
+}
+
+[[nodiscard]] steam_helper::reissue_function steam_helper::submit_reissue(const UGCUpdateHandle_t update_handle, const char* change_note) noexcept {
+    item_update update;
+
+    {
+        std::lock_guard<std::mutex> lock{_item_updates_mutex};
+        const auto it = _item_updates.find(update_handle);
+
+        if (it == _item_updates.end()) {
+            return {};
+        }
+
+        update = std::move(it->second);
+        _item_updates.erase(it);
+    }
+
+    // Steam consumes an update handle on submit, the retry replays the fields on a new one.
+    return [this, update_handle, update = std::move(update), note = std::string{change_note != nullptr ? change_note : ""}](operation_base& operation) {
+        const std::optional<UGCUpdateHandle_t> retry_handle = start_workshop_item_update(update.app_id, update.item_id);
+
+        if (!retry_handle.has_value()) {
+            return k_uAPICallInvalid;
+        }
+
+        const bool applied = (!update.title.has_value() || set_workshop_item_title(*retry_handle, *update.title)) &&
+                             (!update.description.has_value() || set_workshop_item_description(*retry_handle, *update.description)) &&
+                             (!update.content.has_value() || set_workshop_item_content(*retry_handle, *update.content)) &&
+                             (!update.preview.has_value() || set_workshop_item_preview_image(*retry_handle, *update.preview));
+
+        // Recorded again by the setters, the retry keeps its own copy.
+        {
+            std::lock_guard<std::mutex> lock{_item_updates_mutex};
+            _item_updates.erase(*retry_handle);
+        }
+
+        if (!applied) {
+            return k_uAPICallInvalid;
+        }
+
+        const SteamAPICall_t api_call = SteamUGC()->SubmitItemUpdate(*retry_handle, note.c_str());
+
+        if (api_call != k_uAPICallInvalid) {
+            operation.ugc_handle = *retry_handle;
+            _uploads.rebind(update_handle, *retry_handle);
+        }
+
+        return api_call;
+    };
+}
+
+void steam_helper::set_retry_policy(const retry_policy& policy) noexcept {
+    std::lock_guard<std::mutex> lock{_retry_mutex};
+    _retry_policy = policy;
+    _retry_budget.reset(policy);
+}
+
+[[nodiscard]] retry_policy steam_helper::get_retry_policy() const noexcept {
+    std::lock_guard<std::mutex> lock{_retry_mutex};
+    return _retry_policy;
+}
+
+// ------------------------------------------------------------------------
+// Query key utils.
+template <typename F>
+void steam_helper::record_query_key(const UGCQueryHandle_t query_handle, F&& update) noexcept {
+    std::lock_guard<std::mutex> lock{_query_keys_mutex};
+
+    if (const auto it = _query_keys.find(query_handle); it != _query_keys.end()) {
+        update(it->second);
+    }
+}
+
+template <typename F>
+void steam_helper::record_item_update(const UGCUpdateHandle_t update_handle, F&& update) noexcept {
+    std::lock_guard<std::mutex> lock{_item_updates_mutex};
+
+    if (const auto it = _item_updates.find(update_handle); it != _item_updates.end()) {
+        update(it->second);
+    }
+}
+
+[[nodiscard]] std::optional<steam_helper::item_update> steam_helper::find_item_update(const UGCUpdateHandle_t update_handle, const char* what) const noexcept {
+    {
+        std::lock_guard<std::mutex> lock{_item_updates_mutex};
+
+        if (const auto it = _item_updates.find(update_handle); it != _item_updates.end()) {
+            return it->second;
+        }
+    }
+
+    log_error("Steam") << "Unknown update handle " << update_handle << ", cannot " << what << "\n";
+    return std::nullopt;
 }
 
 // ------------------------------------------------------------------------
 // Steam API callback handlers.
-void steam_helper::on_create_item(CreateItemResult_t* result, bool io_failure) {
-    const auto guard = scope_guard{[this] { remove_pending_operation(); }};
+void steam_helper::on_create_item(create_item_operation& operation, CreateItemResult_t* result, bool io_failure) {
+    const auto guard = scope_guard{[this, api_call = operation.api_call, kind = operation.kind] {
+        retire_operation(api_call);
+        remove_pending_operation(kind);
+    }};
 
     if(io_failure)
     {
-        log("Steam") << "Error creating item. IO failure.\n";
+        log_error("Steam") << "Error creating item. IO failure.\n";
+        operation.completion(EResult::k_EResultIOFailure, 0);
         return;
     }
 
     if(const EResult rc = result->m_eResult; rc != EResult::k_EResultOK)
     {
-        log("Steam") << "Error creating item. Error code '"
+        log_error("Steam") << "Error creating item. Error code '"
                         << static_cast<int>(rc) << "' ("
                         << result_to_string(rc) << ")\n";
 
+        operation.completion(rc, 0);
         return;
     }
 
     const PublishedFileId_t fileId = result->m_nPublishedFileId;
-    log("Steam") << "Successfully created workshop item with id '" << fileId
+    log_info("Steam") << "Successfully created workshop item with id '" << fileId
                     << "'\n";
 
-    assert(_create_item_continuation);
-    _create_item_continuation(fileId);
-    _create_item_continuation = create_item_continuation{};
+    operation.completion(EResult::k_EResultOK, fileId);
 }
 
 // ------------------------------------------------------------------------
 // Other utils.
-[[nodiscard]] constexpr std::string_view steam_helper::result_to_string(const EResult rc) noexcept {
-    #define RETURN_IF_EQUALS(e) \
-    do                      \
-    {                       \
-        if(rc == e)         \
-        {                   \
-            return #e;      \
-        }                   \
-    }                       \
-    while(false)
-
-        RETURN_IF_EQUALS(EResult::k_EResultNone);
-        RETURN_IF_EQUALS(EResult::k_EResultOK);
-        RETURN_IF_EQUALS(EResult::k_EResultFail);
-        RETURN_IF_EQUALS(EResult::k_EResultNoConnection);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidPassword);
-        RETURN_IF_EQUALS(EResult::k_EResultLoggedInElsewhere);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidProtocolVer);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidParam);
-        RETURN_IF_EQUALS(EResult::k_EResultFileNotFound);
-        RETURN_IF_EQUALS(EResult::k_EResultBusy);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidState);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidName);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidEmail);
-        RETURN_IF_EQUALS(EResult::k_EResultDuplicateName);
-        RETURN_IF_EQUALS(EResult::k_EResultAccessDenied);
-        RETURN_IF_EQUALS(EResult::k_EResultTimeout);
-        RETURN_IF_EQUALS(EResult::k_EResultBanned);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountNotFound);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidSteamID);
-        RETURN_IF_EQUALS(EResult::k_EResultServiceUnavailable);
-        RETURN_IF_EQUALS(EResult::k_EResultNotLoggedOn);
-        RETURN_IF_EQUALS(EResult::k_EResultPending);
-        RETURN_IF_EQUALS(EResult::k_EResultEncryptionFailure);
-        RETURN_IF_EQUALS(EResult::k_EResultInsufficientPrivilege);
-        RETURN_IF_EQUALS(EResult::k_EResultLimitExceeded);
-        RETURN_IF_EQUALS(EResult::k_EResultRevoked);
-        RETURN_IF_EQUALS(EResult::k_EResultExpired);
-        RETURN_IF_EQUALS(EResult::k_EResultAlreadyRedeemed);
-        RETURN_IF_EQUALS(EResult::k_EResultDuplicateRequest);
-        RETURN_IF_EQUALS(EResult::k_EResultAlreadyOwned);
-        RETURN_IF_EQUALS(EResult::k_EResultIPNotFound);
-        RETURN_IF_EQUALS(EResult::k_EResultPersistFailed);
-        RETURN_IF_EQUALS(EResult::k_EResultLockingFailed);
-        RETURN_IF_EQUALS(EResult::k_EResultLogonSessionReplaced);
-        RETURN_IF_EQUALS(EResult::k_EResultConnectFailed);
-        RETURN_IF_EQUALS(EResult::k_EResultHandshakeFailed);
-        RETURN_IF_EQUALS(EResult::k_EResultIOFailure);
-        RETURN_IF_EQUALS(EResult::k_EResultRemoteDisconnect);
-        RETURN_IF_EQUALS(EResult::k_EResultShoppingCartNotFound);
-        RETURN_IF_EQUALS(EResult::k_EResultBlocked);
-        RETURN_IF_EQUALS(EResult::k_EResultIgnored);
-        RETURN_IF_EQUALS(EResult::k_EResultNoMatch);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountDisabled);
-        RETURN_IF_EQUALS(EResult::k_EResultServiceReadOnly);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountNotFeatured);
-        RETURN_IF_EQUALS(EResult::k_EResultAdministratorOK);
-        RETURN_IF_EQUALS(EResult::k_EResultContentVersion);
-        RETURN_IF_EQUALS(EResult::k_EResultTryAnotherCM);
-        RETURN_IF_EQUALS(EResult::k_EResultPasswordRequiredToKickSession);
-        RETURN_IF_EQUALS(EResult::k_EResultAlreadyLoggedInElsewhere);
-        RETURN_IF_EQUALS(EResult::k_EResultSuspended);
-        RETURN_IF_EQUALS(EResult::k_EResultCancelled);
-        RETURN_IF_EQUALS(EResult::k_EResultDataCorruption);
-        RETURN_IF_EQUALS(EResult::k_EResultDiskFull);
-        RETURN_IF_EQUALS(EResult::k_EResultRemoteCallFailed);
-        RETURN_IF_EQUALS(EResult::k_EResultPasswordUnset);
-        RETURN_IF_EQUALS(EResult::k_EResultExternalAccountUnlinked);
-        RETURN_IF_EQUALS(EResult::k_EResultPSNTicketInvalid);
-        RETURN_IF_EQUALS(EResult::k_EResultExternalAccountAlreadyLinked);
-        RETURN_IF_EQUALS(EResult::k_EResultRemoteFileConflict);
-        RETURN_IF_EQUALS(EResult::k_EResultIllegalPassword);
-        RETURN_IF_EQUALS(EResult::k_EResultSameAsPreviousValue);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountLogonDenied);
-        RETURN_IF_EQUALS(EResult::k_EResultCannotUseOldPassword);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidLoginAuthCode);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountLogonDeniedNoMail);
-        RETURN_IF_EQUALS(EResult::k_EResultHardwareNotCapableOfIPT);
-        RETURN_IF_EQUALS(EResult::k_EResultIPTInitError);
-        RETURN_IF_EQUALS(EResult::k_EResultParentalControlRestricted);
-        RETURN_IF_EQUALS(EResult::k_EResultFacebookQueryError);
-        RETURN_IF_EQUALS(EResult::k_EResultExpiredLoginAuthCode);
-        RETURN_IF_EQUALS(EResult::k_EResultIPLoginRestrictionFailed);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountLockedDown);
-        RETURN_IF_EQUALS(
-            EResult::k_EResultAccountLogonDeniedVerifiedEmailRequired);
-        RETURN_IF_EQUALS(EResult::k_EResultNoMatchingURL);
-        RETURN_IF_EQUALS(EResult::k_EResultBadResponse);
-        RETURN_IF_EQUALS(EResult::k_EResultRequirePasswordReEntry);
-        RETURN_IF_EQUALS(EResult::k_EResultValueOutOfRange);
-        RETURN_IF_EQUALS(EResult::k_EResultUnexpectedError);
-        RETURN_IF_EQUALS(EResult::k_EResultDisabled);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidCEGSubmission);
-        RETURN_IF_EQUALS(EResult::k_EResultRestrictedDevice);
-        RETURN_IF_EQUALS(EResult::k_EResultRegionLocked);
-        RETURN_IF_EQUALS(EResult::k_EResultRateLimitExceeded);
-        RETURN_IF_EQUALS(EResult::k_EResultLimitExceeded);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountLoginDeniedNeedTwoFactor);
-        RETURN_IF_EQUALS(EResult::k_EResultItemDeleted);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountLoginDeniedThrottle);
-        RETURN_IF_EQUALS(EResult::k_EResultTwoFactorCodeMismatch);
-        RETURN_IF_EQUALS(EResult::k_EResultTwoFactorActivationCodeMismatch);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountAssociatedToMultiplePartners);
-        RETURN_IF_EQUALS(EResult::k_EResultNotModified);
-        RETURN_IF_EQUALS(EResult::k_EResultNoMobileDevice);
-        RETURN_IF_EQUALS(EResult::k_EResultTimeNotSynced);
-        RETURN_IF_EQUALS(EResult::k_EResultSmsCodeFailed);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountLimitExceeded);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountActivityLimitExceeded);
-        RETURN_IF_EQUALS(EResult::k_EResultPhoneActivityLimitExceeded);
-        RETURN_IF_EQUALS(EResult::k_EResultRefundToWallet);
-        RETURN_IF_EQUALS(EResult::k_EResultEmailSendFailure);
-        RETURN_IF_EQUALS(EResult::k_EResultNotSettled);
-        RETURN_IF_EQUALS(EResult::k_EResultNeedCaptcha);
-        RETURN_IF_EQUALS(EResult::k_EResultGSLTDenied);
-        RETURN_IF_EQUALS(EResult::k_EResultGSOwnerDenied);
-        RETURN_IF_EQUALS(EResult::k_EResultInvalidItemType);
-        RETURN_IF_EQUALS(EResult::k_EResultIPBanned);
-        RETURN_IF_EQUALS(EResult::k_EResultGSLTExpired);
-        RETURN_IF_EQUALS(EResult::k_EResultInsufficientFunds);
-        RETURN_IF_EQUALS(EResult::k_EResultTooManyPending);
-        RETURN_IF_EQUALS(EResult::k_EResultNoSiteLicensesFound);
-        RETURN_IF_EQUALS(EResult::k_EResultWGNetworkSendExceeded);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountNotFriends);
-        RETURN_IF_EQUALS(EResult::k_EResultLimitedUserAccount);
-        RETURN_IF_EQUALS(EResult::k_EResultCantRemoveItem);
-        RETURN_IF_EQUALS(EResult::k_EResultAccountDeleted);
-        RETURN_IF_EQUALS(EResult::k_EResultExistingUserCancelledLicense);
-        RETURN_IF_EQUALS(EResult::k_EResultCommunityCooldown);
-    #undef RETURN_IF_EQUALS
-
-    return "unknown EResult value";
-}
+[[nodiscard]] std::string_view steam_helper::result_to_string(const EResult rc) noexcept { return describe_result(rc).name; }
 
 // UGC Query Functions
 //-----------------------------------------------------------------------------------------------------
 
 void steam_helper::get_query_results(std::vector<SteamUGCDetails_t> &itemDetails, std::vector<char*> &previewImageURL) noexcept {
-    for (const auto& result : _query_results) {
-        itemDetails.push_back(result.item_details);
-        previewImageURL.push_back(result.image_url);
+    get_query_results(last_query_results(), itemDetails, previewImageURL);
+}
+
+void steam_helper::get_query_results(std::shared_ptr<const query_result_set> results, std::vector<SteamUGCDetails_t> &itemDetails,
+                                     std::vector<char*> &previewImageURL) noexcept {
+    if (results == nullptr) {
+        return;
+    }
+
+    {
+        // The URLs handed out point into this set, keep it until the caller asks for the next one.
+        std::lock_guard<std::mutex> lock{_query_results_mutex};
+        _legacy_query_results = results;
+    }
+
+    itemDetails.reserve(itemDetails.size() + results->size());
+    previewImageURL.reserve(previewImageURL.size() + results->size());
+
+    for (std::size_t i = 0; i < results->size(); ++i) {
+        // Items whose details couldn't be read are left out, as they always were.
+        if ((*results)[i].result != EResult::k_EResultOK) {
+            continue;
+        }
+
+        (*results)[i].to_details(itemDetails.emplace_back());
+        // The legacy signature takes char*, callers only ever read the URL.
+        previewImageURL.push_back(const_cast<char*>(results->preview_url(i).data()));
     }
 }
 
+[[nodiscard]] std::shared_ptr<const query_result_set> steam_helper::last_query_results() const noexcept {
+    std::lock_guard<std::mutex> lock{_query_results_mutex};
+    return _query_results;
+}
+
 void steam_helper::create_user_query(UGCQueryHandle_t &query_handle, AccountID_t accountID, EUserUGCList listType, EUGCMatchingUGCType matchingType, EUserUGCListSortOrder sortOrder, uint32_t creatorAppID, uint32_t consumerAppID, uint32_t page) noexcept { 
     
     query_handle = SteamUGC()->CreateQueryUserUGCRequest(accountID, listType, matchingType, sortOrder, creatorAppID, consumerAppID, page);
     if ( query_handle == k_UGCQueryHandleInvalid) {
-        log("Steam") << "Failed to create query handle\n";
+        log_error("Steam") << "Failed to create query handle\n";
         return;
     }
-    log("Steam") << "Query handle created successfully\n";
+
+    query_key key;
+    key.type = query_key::kind::user;
+    key.account_id = accountID;
+    key.list_type = static_cast<uint32>(listType);
+    key.matching_type = static_cast<uint32>(matchingType);
+    key.sort_order = static_cast<uint32>(sortOrder);
+    key.creator_app_id = creatorAppID;
+    key.consumer_app_id = consumerAppID;
+    key.page = page;
+
+    {
+        std::lock_guard<std::mutex> lock{_query_keys_mutex};
+        _query_keys.insert_or_assign(query_handle, std::move(key));
+    }
+    log_debug("Steam") << "Query handle created successfully\n";
 }
 
 void steam_helper::create_all_query(UGCQueryHandle_t &query_handle, EUGCQuery listType, EUGCMatchingUGCType matchingType, AppId_t creatorAppID, AppId_t consumerAppID, uint32_t page) noexcept {
     
     query_handle = SteamUGC()->CreateQueryAllUGCRequest(listType, matchingType, creatorAppID, consumerAppID, page);
     if ( query_handle == k_UGCQueryHandleInvalid) {
-        log("Steam") << "Failed to create query handle\n";
+        log_error("Steam") << "Failed to create query handle\n";
         return;
     }
-    log("Steam") << "Query handle created successfully\n";
+
+    query_key key;
+    key.list_type = static_cast<uint32>(listType);
+    key.matching_type = static_cast<uint32>(matchingType);
+    key.creator_app_id = creatorAppID;
+    key.consumer_app_id = consumerAppID;
+    key.page = page;
+
+    {
+        std::lock_guard<std::mutex> lock{_query_keys_mutex};
+        _query_keys.insert_or_assign(query_handle, std::move(key));
+    }
+    log_debug("Steam") << "Query handle created successfully\n";
+}
+
+void steam_helper::create_all_query(UGCQueryHandle_t &query_handle, EUGCQuery listType, EUGCMatchingUGCType matchingType, AppId_t creatorAppID, AppId_t consumerAppID, const std::string& cursor) noexcept {
+
+    query_handle = SteamUGC()->CreateQueryAllUGCRequest(listType, matchingType, creatorAppID, consumerAppID, cursor.c_str());
+    if ( query_handle == k_UGCQueryHandleInvalid) {
+        log_error("Steam") << "Failed to create query handle\n";
+        return;
+    }
+
+    query_key key;
+    key.list_type = static_cast<uint32>(listType);
+    key.matching_type = static_cast<uint32>(matchingType);
+    key.creator_app_id = creatorAppID;
+    key.consumer_app_id = consumerAppID;
+    key.cursor = cursor;
+
+    {
+        std::lock_guard<std::mutex> lock{_query_keys_mutex};
+        _query_keys.insert_or_assign(query_handle, std::move(key));
+    }
+    log_debug("Steam") << "Query handle created successfully\n";
 }
 
 bool steam_helper::set_cloud_filename_filter(const UGCQueryHandle_t query_handle, const char* match_cloud_name) noexcept {
     if (!SteamUGC()->SetCloudFileNameFilter(query_handle, match_cloud_name)) {
-        log("Steam") << "Failed to set cloud name filter\n";
-        log("Steam") << "Available only for \"User\" request type\n";
+        log_error("Steam") << "Failed to set cloud name filter\n";
+        log_warning("Steam") << "Available only for \"User\" request type\n";
         return false;
     }
-    log("Steam") << "Cloud name filter set successfully\n";
+    log_debug("Steam") << "Cloud name filter set successfully\n";
+    record_query_key(query_handle, [&](query_key& key) { key.cloud_filename = match_cloud_name; });
     return true;
 }
 
 bool steam_helper::set_ranked_by_trend_days(const UGCQueryHandle_t query_handle, const uint32 unDays) noexcept {
     if (!SteamUGC()->SetRankedByTrendDays(query_handle, unDays)) {
-        log("Steam") << "Failed to set ranked by trend days\n";
-        log("Steam") << "Available only for \"All\" request type\n";
+        log_error("Steam") << "Failed to set ranked by trend days\n";
+        log_warning("Steam") << "Available only for \"All\" request type\n";
+        return false;
+    }
+    log_debug("Steam") << "Rank by trend set successfully\n";
+    record_query_key(query_handle, [&](query_key& key) { key.trend_days = unDays; });
+    return true;
+}
+
+bool steam_helper::set_time_created_date_range(const UGCQueryHandle_t query_handle, const RTime32 start, const RTime32 end) noexcept {
+    if (!SteamUGC()->SetTimeCreatedDateRange(query_handle, start, end)) {
+        log_error("Steam") << "Failed to set time created date range\n";
+        log_warning("Steam") << "Available only for \"All\" request type\n";
         return false;
     }
-    log("Steam") << "Rank by trend set successfully\n";
+    log_debug("Steam") << "Time created date range set successfully\n";
+    record_query_key(query_handle, [&](query_key& key) {
+        key.created_start = start;
+        key.created_end = end;
+    });
     return true;
 }
 
 bool steam_helper::set_match_anytag(const UGCQueryHandle_t query_handle, const bool match_any_tag) noexcept {
     if (!SteamUGC()->SetMatchAnyTag(query_handle, match_any_tag)) {
-        log("Steam") << "Failed to set match any tag\n";
-        log("Steam") << "Available only for \"All\" request type\n";
+        log_error("Steam") << "Failed to set match any tag\n";
+        log_warning("Steam") << "Available only for \"All\" request type\n";
         return false;
     }
-    log("Steam") << "Match any tag set successfully\n";
+    log_debug("Steam") << "Match any tag set successfully\n";
+    record_query_key(query_handle, [&](query_key& key) { key.match_any_tag = match_any_tag; });
     return true;
 }
 
 bool steam_helper::set_search_text(const UGCQueryHandle_t query_handle, const char* searchText) noexcept {
     if (!SteamUGC()->SetSearchText(query_handle, searchText)) {
-        log("Steam") << "Failed to set search text\n";
-        log("Steam") << "Available only for \"All\" request type\n";
+        log_error("Steam") << "Failed to set search text\n";
+        log_warning("Steam") << "Available only for \"All\" request type\n";
         return false;
     }
-    log("Steam") << "Search text set successfully\n";
+    log_debug("Steam") << "Search text set successfully\n";
+    record_query_key(query_handle, [&](query_key& key) { key.search_text = searchText != nullptr ? searchText : ""; });
     return true;
 }
 
 bool steam_helper::add_required_tag(const UGCQueryHandle_t query_handle, const char* tagName) noexcept {
     if (!SteamUGC()->AddRequiredTag(query_handle, tagName)) {
-        log("Steam") << "Failed to add a required tag\n";
+        log_error("Steam") << "Failed to add a required tag\n";
         return false;
     }
-    log("Steam") << "Required tag added successfully\n";
+    log_debug("Steam") << "Required tag added successfully\n";
+    record_query_key(query_handle, [&](query_key& key) { key.add_required_tag(tagName); });
     return true;
 }
 
 bool steam_helper::add_excluded_tag(const UGCQueryHandle_t query_handle, const char* tagName) noexcept {
     if (!SteamUGC()->AddExcludedTag(query_handle, tagName)) {
-        log("Steam") << "Failed to exclude a tag\n";
+        log_error("Steam") << "Failed to exclude a tag\n";
         return false;
     }
-    log("Steam") << "Excluded tag added successfully\n";
+    log_debug("Steam") << "Excluded tag added successfully\n";
+    record_query_key(query_handle, [&](query_key& key) { key.add_excluded_tag(tagName); });
     return true;
 }
 
 bool steam_helper::return_long_description(const UGCQueryHandle_t query_handle, const bool returnLongDescription) noexcept {
     if (!SteamUGC()->SetReturnLongDescription(query_handle, returnLongDescription)) {
-        log("Steam") << "Failed to return the long description\n";
+        log_error("Steam") << "Failed to return the long description\n";
         return false;
     }
-    log("Steam") << "Returning long description\n";
+    log_debug("Steam") << "Returning long description\n";
+    record_query_key(query_handle, [&](query_key& key) { key.long_description = returnLongDescription; });
     return true;
 }
 
 bool steam_helper::return_total_only(const UGCQueryHandle_t query_handle, const bool returnTotalOnly) noexcept {
     if (!SteamUGC()->SetReturnTotalOnly(query_handle, returnTotalOnly)) {
-        log("Steam") << "Failed to return the long description\n";
+        log_error("Steam") << "Failed to return the long description\n";
         return false;
     }
-    log("Steam") << "Returning total only\n";
+    log_debug("Steam") << "Returning total only\n";
+    record_query_key(query_handle, [&](query_key& key) { key.total_only = returnTotalOnly; });
     return true;
 }
 
 bool steam_helper::allow_cached_response(const UGCQueryHandle_t query_handle, const uint32 maxAgeSeconds) noexcept {
     if (!SteamUGC()->SetAllowCachedResponse(query_handle, maxAgeSeconds)) {
-        log("Steam") << "Failed to allow cached response\n";
+        log_error("Steam") << "Failed to allow cached response\n";
         return false;
     }
-    log("Steam") << "Allowing cached response\n";
+    log_debug("Steam") << "Allowing cached response\n";
     return true;
 }
 
-void steam_helper::on_query_completed(SteamUGCQueryCompleted_t* result, bool io_failure)
+bool steam_helper::set_projection(const UGCQueryHandle_t query_handle, const uint32 projection, const uint32 playtime_stats_days) noexcept {
+    const bool projected =
+        SteamUGC()->SetReturnOnlyIDs(query_handle, (projection & projection_ids_only) != 0) &&
+        SteamUGC()->SetReturnMetadata(query_handle, (projection & projection_metadata) != 0) &&
+        SteamUGC()->SetReturnKeyValueTags(query_handle, (projection & projection_key_value_tags) != 0) &&
+        SteamUGC()->SetReturnChildren(query_handle, (projection & projection_children) != 0) &&
+        SteamUGC()->SetReturnAdditionalPreviews(query_handle, (projection & projection_additional_previews) != 0) &&
+        ((projection & projection_playtime_stats) == 0 || SteamUGC()->SetReturnPlaytimeStats(query_handle, playtime_stats_days));
+
+    if (!projected) {
+        log_error("Steam") << "Failed to set the query projection\n";
+        return false;
+    }
+    log_debug("Steam") << "Query projection set\n";
+    record_query_key(query_handle, [&](query_key& key) {
+        key.projection = projection;
+        key.playtime_stats_days = (projection & projection_playtime_stats) != 0 ? playtime_stats_days : 0;
+    });
+    return true;
+}
+
+void steam_helper::on_query_completed(query_operation& operation, SteamUGCQueryCompleted_t* result, bool io_failure)
 {
-    const auto guard = scope_guard{[this] { remove_pending_operation(); }};
+    const auto guard = scope_guard{[this, &operation] {
+        release_query_handle(operation.ugc_handle);
+        retire_operation(operation.api_call);
+        remove_pending_operation(operation.kind);
+    }};
 
     if(io_failure)
     {
-        log("Steam") << "Error querying items. IO failure.\n";
+        log_error("Steam") << "Error querying items. IO failure.\n";
+
+        SteamUGCQueryCompleted_t failed{};
+        failed.m_handle = operation.ugc_handle;
+        failed.m_eResult = EResult::k_EResultIOFailure;
+
+        operation.completion(EResult::k_EResultIOFailure, failed);
         return;
     }
 
     if(const EResult rc = result->m_eResult; rc != EResult::k_EResultOK)
     {
-        log("Steam") << "Error querying items. Error code '"
+        log_error("Steam") << "Error querying items. Error code '"
                         << static_cast<int>(rc) << "' ("
                         << result_to_string(rc) << ")\n";
 
+        operation.completion(rc, *result);
         return;
     }
 
-    const auto num_items = result->m_unNumResultsReturned;
-    log("Steam") << "Query completed. Found " << num_items << " items\n";
+    log_debug("Steam") << "Query completed. Found " << result->m_unNumResultsReturned << " items\n";
 
-    for(uint32_t i = 0; i < num_items; ++i)
+    // The handle stays valid until the completion returns.
+    operation.completion(EResult::k_EResultOK, *result);
+}
+
+void steam_helper::on_query_results(query_results_operation& operation, SteamUGCQueryCompleted_t* result, bool io_failure)
+{
+    const auto guard = scope_guard{[this, &operation] {
+        // Zeroed once a result set took the handle over.
+        if (operation.ugc_handle != 0) {
+            release_query_handle(operation.ugc_handle);
+        }
+
+        retire_operation(operation.api_call);
+        remove_pending_operation(operation.kind);
+    }};
+
+    if(io_failure)
     {
+        log_error("Steam") << "Error querying items. IO failure.\n";
+
+        SteamUGCQueryCompleted_t failed{};
+        failed.m_handle = operation.ugc_handle;
+        failed.m_eResult = EResult::k_EResultIOFailure;
+
+        operation.completion(EResult::k_EResultIOFailure, query_result_set::read(EResult::k_EResultIOFailure, failed));
+        return;
+    }
+
+    if(const EResult rc = result->m_eResult; rc != EResult::k_EResultOK)
+    {
+        log_error("Steam") << "Error querying items. Error code '"
+                        << static_cast<int>(rc) << "' ("
+                        << result_to_string(rc) << ")\n";
+
+        operation.completion(rc, query_result_set::read(rc, *result));
+        return;
+    }
+
+    log_debug("Steam") << "Query completed. Found " << result->m_unNumResultsReturned << " items\n";
+
+    auto results = query_result_set::attach(*this, *result);
+    operation.ugc_handle = 0;
+
+    operation.completion(EResult::k_EResultOK, std::move(results));
+}
+
+[[nodiscard]] bool steam_helper::get_query_result(const UGCQueryHandle_t query_handle, const uint32 index,
+                                                  SteamUGCDetails_t& item_details, std::string& preview_url) noexcept {
+    if(!SteamUGC()->GetQueryUGCResult(query_handle, index, &item_details))
+    {
+        log_error("Steam") << "Failed to get item details for item " << index << "\n";
+        return false;
+    }
+
+    char image_url[512]; // 512 is the maximum size for the image URL
+
+    if (!SteamUGC()->GetQueryUGCPreviewURL(query_handle, index, image_url, sizeof(image_url))) {
+        log_error("Steam") << "Failed to get image URL for item " << index << "\n";
+        return false;
+    }
+
+    preview_url = image_url;
+    return true;
+}
+
+void steam_helper::read_query_page(const EResult rc, const SteamUGCQueryCompleted_t& completed, query_page& page) noexcept {
+    page.result = rc;
+    page.num_returned = completed.m_unNumResultsReturned;
+    page.total_matching = completed.m_unTotalMatchingResults;
+    page.next_cursor = completed.m_rgchNextCursor;
+
+    if (rc != EResult::k_EResultOK) {
+        return;
+    }
+
+    page.items.reserve(completed.m_unNumResultsReturned);
+    page.preview_urls.reserve(completed.m_unNumResultsReturned);
+
+    // IDs-only queries have no preview URL to read, the details hold the ID.
+    if (const auto key = get_query_key(completed.m_handle); key.has_value() && (key->projection & projection_ids_only) != 0) {
         SteamUGCDetails_t item_details;
-        if(!SteamUGC()->GetQueryUGCResult(result->m_handle, i, &item_details))
-        {
-            log("Steam") << "Failed to get item details for item " << i << "\n";
-            continue;
+
+        for (uint32 i = 0; i < completed.m_unNumResultsReturned; ++i) {
+            if (SteamUGC()->GetQueryUGCResult(completed.m_handle, i, &item_details)) {
+                page.items.push_back(item_details);
+                page.preview_urls.emplace_back();
+            }
         }
 
-        // log("Steam") << "Item is titled '" << item_details.m_rgchTitle << "'\n";
-        // log("Steam") << "Item has description '" << item_details.m_rgchDescription << "'\n";
-        
-        uint32_t image_size = 512; // 512 is the maximum size for the image URL
-        char* image_url = new char[image_size];
+        return;
+    }
 
-        if (!SteamUGC()->GetQueryUGCPreviewURL(result->m_handle, i, image_url, image_size)) {
-            log("Steam") << "Failed to get image URL for item " << i << "\n";
-            continue;
+    for (uint32 i = 0; i < completed.m_unNumResultsReturned; ++i) {
+        SteamUGCDetails_t item_details;
+        std::string preview_url;
+
+        if (get_query_result(completed.m_handle, i, item_details, preview_url)) {
+            page.items.push_back(item_details);
+            page.preview_urls.push_back(std::move(preview_url));
         }
-        _query_results.push_back({item_details, image_url});
     }
+}
 
-    assert(_submit_query_continuation);
-    _submit_query_continuation(result->m_handle);
+SteamAPICall_t steam_helper::send_query_request(UGCQueryHandle_t query_handle, submit_query_continuation&& continuation) noexcept {
+    return send_query_request(query_handle, query_completion{
+        [this, continuation = std::move(continuation)](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+            // A failed query still replaces the previous results, with an empty set.
+            const auto key = get_query_key(completed.m_handle);
+            auto results = query_result_set::read(rc, completed, key.has_value() ? key->projection : projection_default);
+
+            {
+                std::lock_guard<std::mutex> lock{_query_results_mutex};
+                _query_results = std::move(results);
+            }
+
+            if (rc != EResult::k_EResultOK) {
+                return;
+            }
+
+            assert(continuation);
+            continuation(completed.m_handle);
+        }});
+}
 
-    _submit_query_continuation = submit_query_continuation{};
+SteamAPICall_t steam_helper::send_query_request(UGCQueryHandle_t query_handle, query_completion&& completion) noexcept {
+    log_debug("Steam") << "Sending workshop item query request...\n";
+    add_pending_operation(operation_kind::query);
 
-    SteamUGC()->ReleaseQueryUGCRequest(result->m_handle);
+    reissue_function reissue = query_reissue(query_handle);
+    const SteamAPICall_t api_call =
+        issue_operation([query_handle] { return SteamUGC()->SendQueryUGCRequest(query_handle); }, query_handle,
+                        std::move(completion), &steam_helper::on_query_completed, std::move(reissue));
+
+    if (api_call == k_uAPICallInvalid) {
+        release_query_handle(query_handle);
+        return k_uAPICallInvalid;
+    }
+
+    return api_call;
 }
 
-void steam_helper::send_query_request(UGCQueryHandle_t query_handle, submit_query_continuation&& continuation) noexcept {
-    log("Steam") << "Sending workshop item query request...\n";
-    add_pending_operation();
+SteamAPICall_t steam_helper::send_query_request(UGCQueryHandle_t query_handle, query_results_completion&& completion) noexcept {
+    log_debug("Steam") << "Sending workshop item query request...\n";
+    add_pending_operation(operation_kind::query);
 
+    reissue_function reissue = query_reissue(query_handle);
     const SteamAPICall_t api_call =
-        SteamUGC()->SendQueryUGCRequest(query_handle);
+        issue_operation([query_handle] { return SteamUGC()->SendQueryUGCRequest(query_handle); }, query_handle,
+                        std::move(completion), &steam_helper::on_query_results, std::move(reissue));
 
-    std::vector<query_result_t> query_results;
-    _submit_query_result.Set(api_call, this, &steam_helper::on_query_completed);
-    _submit_query_continuation = std::move(continuation);
+    if (api_call == k_uAPICallInvalid) {
+        release_query_handle(query_handle);
+        return k_uAPICallInvalid;
+    }
+
+    return api_call;
 }
 
 void steam_helper::release_query_handle(UGCQueryHandle_t query_handle) noexcept {
     SteamUGC()->ReleaseQueryUGCRequest(query_handle);
-    log("Steam") << "Query handle released\n";
+
+    {
+        std::lock_guard<std::mutex> lock{_query_keys_mutex};
+        _query_keys.erase(query_handle);
+    }
+
+    log_debug("Steam") << "Query handle released\n";
+}
+
+[[nodiscard]] std::optional<query_key> steam_helper::get_query_key(const UGCQueryHandle_t query_handle) const noexcept {
+    std::lock_guard<std::mutex> lock{_query_keys_mutex};
+
+    if (const auto it = _query_keys.find(query_handle); it != _query_keys.end()) {
+        return it->second;
+    }
+
+    return std::nullopt;
+}
+
+[[nodiscard]] UGCQueryHandle_t steam_helper::create_query_handle(const query_key& key, const uint32 max_cache_age_seconds) noexcept {
+    UGCQueryHandle_t query_handle = k_UGCQueryHandleInvalid;
+
+    if (key.type == query_key::kind::user) {
+        create_user_query(query_handle, key.account_id, static_cast<EUserUGCList>(key.list_type),
+                          static_cast<EUGCMatchingUGCType>(key.matching_type),
+                          static_cast<EUserUGCListSortOrder>(key.sort_order),
+                          key.creator_app_id, key.consumer_app_id, key.page);
+    } else if (!key.cursor.empty()) {
+        create_all_query(query_handle, static_cast<EUGCQuery>(key.list_type),
+                         static_cast<EUGCMatchingUGCType>(key.matching_type),
+                         key.creator_app_id, key.consumer_app_id, key.cursor);
+    } else {
+        create_all_query(query_handle, static_cast<EUGCQuery>(key.list_type),
+                         static_cast<EUGCMatchingUGCType>(key.matching_type),
+                         key.creator_app_id, key.consumer_app_id, key.page);
+    }
+
+    if (query_handle == k_UGCQueryHandleInvalid) {
+        return k_UGCQueryHandleInvalid;
+    }
+
+    // Only what differs from Steam's defaults is applied, keeping the recorded key equal to key().
+    bool applied = true;
+
+    for (const auto& tag : key.required_tags) {
+        applied = applied && add_required_tag(query_handle, tag.c_str());
+    }
+
+    for (const auto& tag : key.excluded_tags) {
+        applied = applied && add_excluded_tag(query_handle, tag.c_str());
+    }
+
+    if (key.match_any_tag) {
+        applied = applied && set_match_anytag(query_handle, true);
+    }
+
+    if (!key.search_text.empty()) {
+        applied = applied && set_search_text(query_handle, key.search_text.c_str());
+    }
+
+    if (!key.cloud_filename.empty()) {
+        applied = applied && set_cloud_filename_filter(query_handle, key.cloud_filename.c_str());
+    }
+
+    if (key.trend_days != 0) {
+        applied = applied && set_ranked_by_trend_days(query_handle, key.trend_days);
+    }
+
+    if (key.created_start != 0 || key.created_end != 0) {
+        applied = applied && set_time_created_date_range(query_handle, key.created_start, key.created_end);
+    }
+
+    if (key.long_description) {
+        applied = applied && return_long_description(query_handle, true);
+    }
+
+    if (key.total_only) {
+        applied = applied && return_total_only(query_handle, true);
+    }
+
+    if (key.projection != projection_default) {
+        applied = applied && set_projection(query_handle, key.projection, key.playtime_stats_days);
+    }
+
+    if (max_cache_age_seconds != 0) {
+        applied = applied && allow_cached_response(query_handle, max_cache_age_seconds);
+    }
+
+    if (!applied) {
+        release_query_handle(query_handle);
+        return k_UGCQueryHandleInvalid;
+    }
+
+    return query_handle;
 }
 
 // UGC Upload Functions
 //-----------------------------------------------------------------------------------------------------
 
-void steam_helper::on_submit_item(SubmitItemUpdateResult_t* result, bool io_failure)
+void steam_helper::on_submit_item(submit_item_operation& operation, SubmitItemUpdateResult_t* result, bool io_failure)
 {
-    const auto guard = scope_guard{[this] { remove_pending_operation(); }};
+    const auto guard = scope_guard{[this, api_call = operation.api_call, kind = operation.kind] {
+        retire_operation(api_call);
+        remove_pending_operation(kind);
+    }};
 
     if(io_failure)
     {
-        log("Steam") << "Error creating item. IO failure.\n";
+        log_error("Steam") << "Error updating item. IO failure.\n";
+        operation.completion(EResult::k_EResultIOFailure, 0);
         return;
     }
 
 
     if(const EResult rc = result->m_eResult; rc != EResult::k_EResultOK)
     {
-        log("Steam") << "Error updating item. Error code '"
+        log_error("Steam") << "Error updating item. Error code '"
                         << static_cast<int>(rc) << "' ("
                         << result_to_string(rc) << ")\n";
 
+        operation.completion(rc, result->m_nPublishedFileId);
         return;
     }
 
-    assert(_submit_item_continuation);
-    _submit_item_continuation();
-    _submit_item_continuation = submit_item_continuation{};
+    operation.completion(EResult::k_EResultOK, result->m_nPublishedFileId);
 }
 
-void steam_helper::create_workshop_item(create_item_continuation&& continuation) noexcept {
+SteamAPICall_t steam_helper::create_workshop_item(create_item_continuation&& continuation) noexcept {
+    return create_workshop_item(create_item_completion{
+        [continuation = std::move(continuation)](const EResult rc, const PublishedFileId_t item_id) {
+            if (rc != EResult::k_EResultOK) {
+                return;
+            }
+
+            assert(continuation);
+            continuation(item_id);
+        }});
+}
+
+SteamAPICall_t steam_helper::create_workshop_item(create_item_completion&& completion) noexcept {
+    return create_workshop_item(app_id, std::move(completion));
+}
+
+SteamAPICall_t steam_helper::create_workshop_item(const AppId_t creator_app_id, create_item_completion&& completion) noexcept {
     if(!initialized())
     {
-        return;
+        return k_uAPICallInvalid;
     }
 
-    log("Steam") << "Creating workshop item...\n";
-    add_pending_operation();
+    log_debug("Steam") << "Creating workshop item...\n";
+    add_pending_operation(operation_kind::create_item);
 
-    const SteamAPICall_t api_call = SteamUGC()->CreateItem(
-        app_id, EWorkshopFileType::k_EWorkshopFileTypeCommunity);
+    const auto create = [creator_app_id] { return SteamUGC()->CreateItem(creator_app_id, EWorkshopFileType::k_EWorkshopFileTypeCommunity); };
 
-    _create_item_result.Set(api_call, this, &steam_helper::on_create_item);
-    _create_item_continuation = std::move(continuation);
+    return issue_operation(create, 0, std::move(completion), &steam_helper::on_create_item,
+                           [create](operation_base&) { return create(); });
 }
 
 [[nodiscard]] std::optional<UGCUpdateHandle_t> steam_helper::start_workshop_item_update(const PublishedFileId_t item_id) noexcept {
+    return start_workshop_item_update(app_id, item_id);
+}
+
+[[nodiscard]] std::optional<UGCUpdateHandle_t> steam_helper::start_workshop_item_update(const AppId_t consumer_app_id, const PublishedFileId_t item_id) noexcept {
     const UGCUpdateHandle_t handle =
-        SteamUGC()->StartItemUpdate(app_id, item_id);
+        SteamUGC()->StartItemUpdate(consumer_app_id, item_id);
 
     if(handle == k_UGCUpdateHandleInvalid)
     {
-        log("Steam") << "Invalid update handle for file id '" << item_id
+        log_error("Steam") << "Invalid update handle for file id '" << item_id
                         << "'\n";
 
         return std::nullopt;
     }
 
+    {
+        std::lock_guard<std::mutex> lock{_item_updates_mutex};
+        item_update& update = _item_updates[handle];
+        update.app_id = consumer_app_id;
+        update.item_id = item_id;
+    }
+
     return {handle};
 }
 
 bool steam_helper::set_workshop_item_content(const UGCUpdateHandle_t update_handle, const std::filesystem::path& directory_path) noexcept {
-    [[maybe_unused]] std::error_code ec;
+    std::error_code ec;
 
-    assert(std::filesystem::exists(directory_path, ec));
-    assert(std::filesystem::is_directory(directory_path, ec));
+    // Steam only finds out once the upload starts, after a whole round trip.
+    if (!std::filesystem::is_directory(directory_path, ec)) {
+        log_error("Steam") << "Workshop item content folder '" << directory_path << "' not found\n";
+        return false;
+    }
 
     if(!SteamUGC()->SetItemContent(
             update_handle, directory_path.string().data()))
     {
-        log("Steam") << "Failed to set workshop item contents from path '"
+        log_error("Steam") << "Failed to set workshop item contents from path '"
                         << directory_path << "'\n";
 
         return false;
     }
 
+    record_item_update(update_handle, [&](item_update& update) { update.content = directory_path; });
+    return true;
+}
+
+bool steam_helper::stage_workshop_item_content(const UGCUpdateHandle_t update_handle, const std::filesystem::path& source,
+                                               const std::filesystem::path& staging_root, const staging_rules& rules,
+                                               const staging_options& options) noexcept {
+    const std::optional<item_update> update = find_item_update(update_handle, "stage its content");
+
+    if (!update.has_value()) {
+        return false;
+    }
+
+    const std::filesystem::path staged = staging_root / (std::to_string(update->app_id) + "-" + std::to_string(update->item_id));
+
+    if (!content_stager{options}.stage(source, staged, rules).has_value()) {
+        log_error("Steam") << "Failed to stage workshop item contents from path '" << source << "'\n";
+        return false;
+    }
+
+    if (!set_workshop_item_content(update_handle, staged)) {
+        return false;
+    }
+
+    record_item_update(update_handle, [&](item_update& recorded) { recorded.staged = staged; });
+    return true;
+}
+
+bool steam_helper::pack_workshop_item_content(const UGCUpdateHandle_t update_handle, const std::filesystem::path& source,
+                                              const std::filesystem::path& staging_root, const staging_rules& rules,
+                                              const pack_options& options) noexcept {
+    const std::optional<item_update> update = find_item_update(update_handle, "pack its content");
+
+    if (!update.has_value()) {
+        return false;
+    }
+
+    const std::filesystem::path staged = staging_root / (std::to_string(update->app_id) + "-" + std::to_string(update->item_id));
+    std::error_code ec;
+    const std::filesystem::path source_root = std::filesystem::weakly_canonical(source, ec);
+    const std::filesystem::path staged_root = ec ? std::filesystem::path{} : std::filesystem::weakly_canonical(staged, ec);
+
+    const auto inside = [](const std::filesystem::path& path, const std::filesystem::path& folder) {
+        const std::filesystem::path relative = path.lexically_relative(folder);
+        return !relative.empty() && *relative.begin() != "..";
+    };
+
+    // The pack would pack itself next time, and clearing its folder could delete the source.
+    if (ec || inside(staged_root, source_root) || inside(source_root, staged_root)) {
+        log_error("Steam") << "Pack folder '" << staged << "' overlaps the source folder '" << source << "'\n";
+        return false;
+    }
+
+    // Only the pack is uploaded, whatever an earlier staging left there goes.
+    content_stager::remove(staged);
+    std::filesystem::create_directories(staged, ec);
+
+    if (ec || !content_pack_writer{options}.write(source, staged / content_pack::file_name, rules).has_value()) {
+        log_error("Steam") << "Failed to pack workshop item contents from path '" << source << "'\n";
+        return false;
+    }
+
+    if (!set_workshop_item_content(update_handle, staged)) {
+        return false;
+    }
+
+    record_item_update(update_handle, [&](item_update& recorded) { recorded.staged = staged; });
     return true;
 }
 
@@ -608,29 +1214,33 @@ bool steam_helper::set_workshop_item_description(const UGCUpdateHandle_t update_
 
     if(!SteamUGC()->SetItemDescription(update_handle, description.data()))
     {
-        log("Steam")
+        log_error("Steam")
             << "Failed to set workshop description" << "'\n";
         return false;
     }
 
+    record_item_update(update_handle, [&](item_update& update) { update.description = description; });
     return true;
 }
 
 bool steam_helper::set_workshop_item_preview_image(const UGCUpdateHandle_t update_handle, const std::filesystem::path& file_path) noexcept {
-    [[maybe_unused]] std::error_code ec;
+    std::error_code ec;
 
-    assert(std::filesystem::exists(file_path, ec));
-    assert(std::filesystem::is_regular_file(file_path, ec));
+    if (!std::filesystem::is_regular_file(file_path, ec)) {
+        log_error("Steam") << "Workshop item preview image '" << file_path << "' not found\n";
+        return false;
+    }
 
     if(!SteamUGC()->SetItemPreview(update_handle, file_path.string().data()))
     {
-        log("Steam")
+        log_error("Steam")
             << "Failed to set workshop item preview image from path '"
             << file_path << "'\n";
 
         return false;
     }
 
+    record_item_update(update_handle, [&](item_update& update) { update.preview = file_path; });
     return true;
 }
 
@@ -638,40 +1248,86 @@ bool steam_helper::set_workshop_item_title(const UGCUpdateHandle_t update_handle
 
     if(!SteamUGC()->SetItemTitle(update_handle, title.data()))
     {
-        log("Steam")
+        log_error("Steam")
             << "Failed to set workshop title" << "'\n";
         return false;
     }
 
+    record_item_update(update_handle, [&](item_update& update) { update.title = title; });
     return true;
 }
 
-void steam_helper::submit_item_update(const UGCUpdateHandle_t handle, const char* change_note, submit_item_continuation&& continuation) noexcept {
-    log("Steam") << "Submitting workshop item update...\n";
-    add_pending_operation();
+SteamAPICall_t steam_helper::submit_item_update(const UGCUpdateHandle_t handle, const char* change_note, submit_item_continuation&& continuation) noexcept {
+    return submit_item_update(handle, change_note, submit_item_completion{
+        [continuation = std::move(continuation)](const EResult rc, const PublishedFileId_t) {
+            if (rc != EResult::k_EResultOK) {
+                return;
+            }
 
-    const SteamAPICall_t api_call =
-        SteamUGC()->SubmitItemUpdate(handle, change_note);
-
-    _submit_item_result.Set(api_call, this, &steam_helper::on_submit_item);
-    _submit_item_continuation = std::move(continuation);
+            assert(continuation);
+            continuation();
+        }});
 }
 
-bool steam_helper::get_item_upload_progress(const UGCUpdateHandle_t update_handle, uint64_t *Processed, uint64_t *Total) noexcept {
+SteamAPICall_t steam_helper::submit_item_update(const UGCUpdateHandle_t handle, const char* change_note, submit_item_completion&& completion) noexcept {
+    log_debug("Steam") << "Submitting workshop item update...\n";
+    add_pending_operation(operation_kind::submit_item);
+
+    PublishedFileId_t item_id = 0;
+    std::optional<std::filesystem::path> staged;
 
-    if(!SteamUGC()->GetItemUpdateProgress(update_handle, Processed, Total))
     {
-        log("Steam")
-            << "Failed to get workshop item upload progress" << "'\n";
-        return false;
+        std::lock_guard<std::mutex> lock{_item_updates_mutex};
+
+        if (const auto it = _item_updates.find(handle); it != _item_updates.end()) {
+            item_id = it->second.item_id;
+            staged = it->second.staged;
+        }
     }
-    if (*Processed == *Total && *Total != 0) {
-        log("Steam")
-            << "Workshop item upload complete\n";
-        return false;
+
+    reissue_function reissue = submit_reissue(handle, change_note);
+
+    // Tracked before the call goes out, its completion may run on the pump right away.
+    _uploads.track(handle, item_id);
+
+    const SteamAPICall_t api_call = issue_operation(
+        [handle, note = std::string{change_note != nullptr ? change_note : ""}] {
+            return SteamUGC()->SubmitItemUpdate(handle, note.c_str());
+        },
+        handle,
+        submit_item_completion{[this, handle, staged = std::move(staged), completion = std::move(completion)](const EResult rc, const PublishedFileId_t submitted_id) {
+            _uploads.finish(handle, rc);
+
+            // Kept after a failure, the next attempt only stages what changed.
+            if (staged.has_value() && rc == EResult::k_EResultOK) {
+                content_stager::remove(*staged);
+            }
+
+            completion(rc, submitted_id);
+        }},
+        &steam_helper::on_submit_item, std::move(reissue));
+
+    if (api_call == k_uAPICallInvalid) {
+        _uploads.finish(handle, EResult::k_EResultFail);
     }
 
-    return true;
+    return api_call;
+}
+
+bool steam_helper::get_item_upload_progress(const UGCUpdateHandle_t update_handle, uint64_t *Processed, uint64_t *Total) noexcept {
+    return get_item_upload_status(update_handle, *Processed, *Total) != EItemUpdateStatus::k_EItemUpdateStatusInvalid;
+}
+
+[[nodiscard]] EItemUpdateStatus steam_helper::get_item_upload_status(const UGCUpdateHandle_t update_handle, uint64_t& processed, uint64_t& total) noexcept {
+    // A retry submits the update again on another handle, the one passed in then knows nothing.
+    const EItemUpdateStatus status = SteamUGC()->GetItemUpdateProgress(_uploads.current_handle(update_handle), &processed, &total);
+
+    // Also what Steam answers once the upload is over, not worth an error.
+    if (status == EItemUpdateStatus::k_EItemUpdateStatusInvalid) {
+        log_debug("Steam") << "No upload in progress for update handle " << update_handle << "\n";
+    }
+
+    return status;
 }
 
 bool steam_helper::run_callbacks() noexcept {
@@ -680,33 +1336,225 @@ bool steam_helper::run_callbacks() noexcept {
         return false;
     }
 
+    // Only one thread may dispatch callbacks, leave it to the pump if running.
+    if(callback_pump_running() && std::this_thread::get_id() != _pump_thread.get_id())
+    {
+        return true;
+    }
+
     SteamAPI_RunCallbacks();
+    _metrics.callback_run();
+    _uploads.sample();
+    issue_scheduled_calls();
+    release_retired_operations();
+    return true;
+}
+
+// Callback pump
+//-----------------------------------------------------------------------------------------------------
+
+void steam_helper::pump_callbacks() noexcept {
+    std::chrono::microseconds interval = _pump_min_interval;
+    std::unique_lock<std::mutex> lock{_pump_mutex};
+
+    while (_pump_running.load()) {
+        if (!any_pending_operation()) {
+            // Nothing in flight, sleep until an operation is issued.
+            interval = _pump_min_interval;
+            _pump_cv.wait(lock, [this] { return !_pump_running.load() || any_pending_operation(); });
+            continue;
+        }
+
+        const uint64_t completed_before = _completed_operations.load();
+        const uint64_t wakeups_before = _pump_wakeups;
+        _metrics.pump_iteration();
+
+        lock.unlock();
+        run_callbacks();
+        const auto retry_due = next_retry_due();
+        lock.lock();
+
+        if (_completed_operations.load() != completed_before) {
+            interval = _pump_min_interval;
+        } else {
+            interval = std::min(interval * 2, _pump_max_interval);
+        }
+
+        // Backs off, but never past a retry's due time nor once new work is queued.
+        auto wake_at = std::chrono::steady_clock::now() + interval;
+
+        if (retry_due.has_value()) {
+            wake_at = std::min(wake_at, *retry_due);
+        }
+
+        _pump_cv.wait_until(lock, wake_at, [this, wakeups_before] { return !_pump_running.load() || _pump_wakeups != wakeups_before; });
+
+        if (_pump_wakeups != wakeups_before) {
+            interval = _pump_min_interval;
+        }
+    }
+}
+
+void steam_helper::start_callback_pump(std::chrono::microseconds min_interval, std::chrono::microseconds max_interval) noexcept {
+    if (!initialized()) {
+        log_error("Steam") << "Cannot start callback pump, Steam API is not initialized\n";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{_pump_mutex};
+
+    if (_pump_running.load()) {
+        return;
+    }
+
+    _pump_min_interval = std::max(min_interval, std::chrono::microseconds{1});
+    _pump_max_interval = std::max(max_interval, _pump_min_interval);
+    _pump_running.store(true);
+    _pump_thread = std::thread{&steam_helper::pump_callbacks, this};
+
+    log_info("Steam") << "Callback pump started\n";
+}
+
+void steam_helper::stop_callback_pump() noexcept {
+    {
+        std::lock_guard<std::mutex> lock{_pump_mutex};
+
+        if (!_pump_running.load()) {
+            return;
+        }
+
+        _pump_running.store(false);
+    }
+
+    _pump_cv.notify_all();
+    _pump_thread.join();
+
+    log_info("Steam") << "Callback pump stopped\n";
+}
+
+[[nodiscard]] bool steam_helper::callback_pump_running() const noexcept { return _pump_running.load(); }
+
+// Blocks on the pump when it runs, dispatches the callbacks itself otherwise.
+[[nodiscard]] bool steam_helper::wait_for_pending_operations(std::chrono::microseconds timeout) noexcept {
+    return run_callbacks_until([this] { return !any_pending_operation(); }, timeout);
+}
+
+[[nodiscard]] bool steam_helper::run_callbacks_until(const std::function<bool()>& done, std::chrono::microseconds timeout) noexcept {
+    using clock = std::chrono::steady_clock;
+
+    // The background pump owns the callback dispatch, just block until it
+    // has completed what the caller waits on.
+    if (callback_pump_running()) {
+        std::unique_lock<std::mutex> lock{_pump_mutex};
+
+        if (!_completion_cv.wait_for(lock, timeout, done)) {
+            _metrics.wait_timed_out();
+            return false;
+        }
+
+        return true;
+    }
+
+    const clock::time_point deadline = clock::now() + timeout;
+    std::chrono::microseconds interval = _pump_min_interval;
+
+    while (!done()) {
+        const uint64_t completed_before = completed_operations();
+
+        if (!run_callbacks()) {
+            log_error("Steam") << "Could not run Steam API callbacks\n";
+            return false;
+        }
+
+        if (done()) {
+            return true;
+        }
+
+        if (clock::now() > deadline) {
+            _metrics.wait_timed_out();
+            return false;
+        }
+
+        // Back off while nothing completes instead of spinning a full core.
+        if (completed_operations() != completed_before) {
+            interval = _pump_min_interval;
+        } else {
+            interval = std::min(interval * 2, _pump_max_interval);
+        }
+
+        std::this_thread::sleep_for(interval);
+    }
+
     return true;
 }
 
+[[nodiscard]] uint64_t steam_helper::completed_operations() const noexcept { return _completed_operations.load(); }
+
 [[nodiscard]] bool steam_helper::initialized() const noexcept { return _initialized; }
 
-[[nodiscard]] bool steam_helper::any_pending_operation() const noexcept { return _pending_operations.load() > 0; }
+[[nodiscard]] const steam_metrics& steam_helper::metrics() const noexcept { return _metrics; }
+
+[[nodiscard]] steam_metrics& steam_helper::metrics() noexcept { return _metrics; }
+
+[[nodiscard]] const call_scheduler& steam_helper::scheduler() const noexcept { return _scheduler; }
+
+[[nodiscard]] call_scheduler& steam_helper::scheduler() noexcept { return _scheduler; }
+
+[[nodiscard]] const upload_monitor& steam_helper::uploads() const noexcept { return _uploads; }
+
+[[nodiscard]] upload_monitor& steam_helper::uploads() noexcept { return _uploads; }
+
+[[nodiscard]] bool steam_helper::any_pending_operation() const noexcept { return _metrics.in_flight() > 0; }
+
+[[nodiscard]] std::size_t steam_helper::in_flight_operations() const noexcept {
+    std::lock_guard<std::mutex> lock{_operations_mutex};
+    return _operations.size();
+}
+
+[[nodiscard]] bool steam_helper::is_operation_in_flight(const SteamAPICall_t api_call) const noexcept {
+    std::lock_guard<std::mutex> lock{_operations_mutex};
+    return _operations.find(api_call) != _operations.end();
+}
+
+void steam_helper::wake_pump() noexcept {
+    {
+        std::lock_guard<std::mutex> lock{_pump_mutex};
+        ++_pump_wakeups;
+    }
+
+    _pump_cv.notify_one();
+}
+
+void steam_helper::add_pending_operation(const operation_kind kind) noexcept {
+    {
+        std::lock_guard<std::mutex> lock{_pump_mutex};
+        _metrics.operation_issued(kind);
+    }
 
-void steam_helper::add_pending_operation() noexcept {
-    _pending_operations.store(_pending_operations.load() + 1);
-    log("Steam") << "Added pending operation\n";
+    _pump_cv.notify_one();
+    log_trace("Steam") << "Added pending operation\n";
 }
 
-void steam_helper::remove_pending_operation() noexcept {
-    assert(any_pending_operation());
+void steam_helper::remove_pending_operation(const operation_kind kind) noexcept {
+    assert(_metrics.in_flight(kind) > 0);
+
+    {
+        std::lock_guard<std::mutex> lock{_pump_mutex};
+        _metrics.operation_finished(kind);
+        _completed_operations.fetch_add(1);
+    }
 
-    _pending_operations.store(_pending_operations.load() - 1);
-    log("Steam") << "Removed pending operation\n";
+    _completion_cv.notify_all();
+    log_trace("Steam") << "Removed pending operation\n";
 }
 
 [[nodiscard]] bool steam_helper::unsubscribe_item(PublishedFileId_t item_id) noexcept {
 
     if (SteamUGC()->UnsubscribeItem(item_id)) {
-        log("Steam") << "Successfully unsubscribed from workshop item.\n";
+        log_info("Steam") << "Successfully unsubscribed from workshop item.\n";
         return true;
     } else {
-        log("Steam") << "Failed to unsubscribe from workshop item.\n";
+        log_error("Steam") << "Failed to unsubscribe from workshop item.\n";
         return false;
     }
 }
@@ -0,0 +1,427 @@
+#include "../include/steamMetrics.h"
+
+#include "../include/steamHelper.h"
+
+#include <cmath>
+#include <cstdio>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+    [[nodiscard]] unsigned highest_bit(const uint64_t value) noexcept {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+    }
+
+    void update_min(std::atomic<uint64_t>& target, const uint64_t value) noexcept {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    void update_max(std::atomic<uint64_t>& target, const uint64_t value) noexcept {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    constexpr std::array<double, 5> reported_quantiles{0.5, 0.9, 0.99, 0.999, 1.0};
+
+    void append_number(std::string& out, const double value) {
+        char text[32];
+        const int length = std::snprintf(text, sizeof(text), "%.9g", value);
+        out.append(text, static_cast<std::size_t>(std::max(length, 0)));
+    }
+
+    void append_number(std::string& out, const uint64_t value) { out += std::to_string(value); }
+
+    void append_number(std::string& out, const int64_t value) { out += std::to_string(value); }
+
+    [[nodiscard]] double to_seconds(const uint64_t microseconds) noexcept { return static_cast<double>(microseconds) / 1e6; }
+
+    // One Prometheus sample, `labels` already formatted without the braces.
+    template <typename T>
+    void append_sample(std::string& out, const std::string_view name, const std::string_view labels, const T value) {
+        out += name;
+
+        if (!labels.empty()) {
+            out += '{';
+            out += labels;
+            out += '}';
+        }
+
+        out += ' ';
+        append_number(out, value);
+        out += '\n';
+    }
+
+    void append_header(std::string& out, const std::string_view name, const std::string_view type, const std::string_view help) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    // "k_EResultOK", without the enum scope result_to_string spells out.
+    [[nodiscard]] std::string_view result_name(const EResult result) noexcept {
+        std::string_view name = steam_helper::result_to_string(result);
+
+        if (const std::size_t scope = name.rfind("::"); scope != std::string_view::npos) {
+            name.remove_prefix(scope + 2);
+        }
+
+        return name;
+    }
+
+    [[nodiscard]] std::string operation_label(const operation_kind kind) {
+        return "operation=\"" + std::string{operation_kind_name(kind)} + '"';
+    }
+
+} // namespace
+
+[[nodiscard]] std::string_view operation_kind_name(const operation_kind kind) noexcept {
+    switch (kind) {
+        case operation_kind::create_item: return "create_item";
+        case operation_kind::submit_item: return "submit_item";
+        case operation_kind::query: return "query";
+    }
+
+    return "unknown";
+}
+
+// ----------------------------------------------------------------------------
+// Latency histogram.
+latency_histogram::latency_histogram() : _buckets{std::make_unique<std::atomic<uint64_t>[]>(bucket_count)} {
+    reset();
+}
+
+[[nodiscard]] std::size_t latency_histogram::bucket_index(uint64_t value) noexcept {
+    value = std::min(value, max_value);
+
+    if (value < sub_bucket_count) {
+        return static_cast<std::size_t>(value);
+    }
+
+    // The top sub_bucket_bits + 1 bits of the value pick the bucket.
+    const unsigned shift = highest_bit(value) - sub_bucket_bits;
+    return static_cast<std::size_t>((shift + 1) * sub_bucket_count + ((value >> shift) - sub_bucket_count));
+}
+
+[[nodiscard]] uint64_t latency_histogram::bucket_upper_bound(const std::size_t index) noexcept {
+    if (index < sub_bucket_count) {
+        return index;
+    }
+
+    const unsigned shift = static_cast<unsigned>(index / sub_bucket_count) - 1;
+    const uint64_t lower = ((index % sub_bucket_count) + sub_bucket_count) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+}
+
+void latency_histogram::record(const uint64_t value) noexcept {
+    _buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+    update_min(_min, value);
+    update_max(_max, value);
+}
+
+[[nodiscard]] latency_histogram::snapshot latency_histogram::read() const {
+    snapshot copy;
+    copy.buckets.resize(bucket_count);
+
+    // Counted from the buckets so percentiles agree with the count.
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        copy.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        copy.count += copy.buckets[i];
+    }
+
+    copy.sum = _sum.load(std::memory_order_relaxed);
+
+    if (copy.count != 0) {
+        copy.min = _min.load(std::memory_order_relaxed);
+        copy.max = _max.load(std::memory_order_relaxed);
+    }
+
+    return copy;
+}
+
+void latency_histogram::reset() noexcept {
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _min.store(UINT64_MAX, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+[[nodiscard]] double latency_histogram::snapshot::mean() const noexcept {
+    return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+}
+
+[[nodiscard]] uint64_t latency_histogram::snapshot::percentile(const double q) const noexcept {
+    if (count == 0) {
+        return 0;
+    }
+
+    const double clamped = std::min(std::max(q, 0.0), 1.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * static_cast<double>(count))));
+    uint64_t seen = 0;
+
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), max);
+        }
+    }
+
+    return max;
+}
+
+// ----------------------------------------------------------------------------
+// Recording.
+void steam_metrics::operation_issued(const operation_kind kind) noexcept {
+    operation_counters& operation = counters(kind);
+    operation.issued.fetch_add(1, std::memory_order_relaxed);
+    operation.in_flight.fetch_add(1);
+    _in_flight.fetch_add(1);
+}
+
+void steam_metrics::operation_finished(const operation_kind kind) noexcept {
+    counters(kind).in_flight.fetch_sub(1);
+    _in_flight.fetch_sub(1);
+}
+
+void steam_metrics::issue_failed(const operation_kind kind) noexcept {
+    counters(kind).issue_failures.fetch_add(1, std::memory_order_relaxed);
+}
+
+void steam_metrics::operation_completed(const operation_kind kind, const EResult result, const std::chrono::microseconds latency) noexcept {
+    operation_counters& operation = counters(kind);
+    operation.completed.fetch_add(1, std::memory_order_relaxed);
+
+    if (const auto index = static_cast<std::size_t>(result); index < result_capacity) {
+        operation.results[index].fetch_add(1, std::memory_order_relaxed);
+    } else {
+        operation.other_results.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    operation.latency.record(latency);
+}
+
+// ----------------------------------------------------------------------------
+// Reading.
+[[nodiscard]] uint64_t steam_metrics::result_count(const operation_kind kind, const EResult result) const noexcept {
+    const auto index = static_cast<std::size_t>(result);
+    return index < result_capacity ? counters(kind).results[index].load(std::memory_order_relaxed) : 0;
+}
+
+[[nodiscard]] steam_metrics::snapshot steam_metrics::read() const {
+    snapshot copy;
+
+    for (std::size_t i = 0; i < operation_kind_count; ++i) {
+        const operation_counters& operation = _operations[i];
+        operation_snapshot& out = copy.operations[i];
+
+        out.kind = static_cast<operation_kind>(i);
+        out.in_flight = operation.in_flight.load();
+        out.issued = operation.issued.load(std::memory_order_relaxed);
+        out.completed = operation.completed.load(std::memory_order_relaxed);
+        out.issue_failures = operation.issue_failures.load(std::memory_order_relaxed);
+        out.retries = operation.retries.load(std::memory_order_relaxed);
+        out.retries_denied = operation.retries_denied.load(std::memory_order_relaxed);
+        out.other_results = operation.other_results.load(std::memory_order_relaxed);
+        out.latency = operation.latency.read();
+
+        for (std::size_t result = 0; result < result_capacity; ++result) {
+            if (const uint64_t count = operation.results[result].load(std::memory_order_relaxed); count != 0) {
+                out.results.emplace_back(static_cast<EResult>(result), count);
+            }
+        }
+    }
+
+    copy.callback_runs = _callback_runs.load(std::memory_order_relaxed);
+    copy.pump_iterations = _pump_iterations.load(std::memory_order_relaxed);
+    copy.wait_timeouts = _wait_timeouts.load(std::memory_order_relaxed);
+    return copy;
+}
+
+void steam_metrics::reset() noexcept {
+    for (operation_counters& operation : _operations) {
+        operation.issued.store(0, std::memory_order_relaxed);
+        operation.completed.store(0, std::memory_order_relaxed);
+        operation.issue_failures.store(0, std::memory_order_relaxed);
+        operation.retries.store(0, std::memory_order_relaxed);
+        operation.retries_denied.store(0, std::memory_order_relaxed);
+        operation.other_results.store(0, std::memory_order_relaxed);
+
+        for (auto& result : operation.results) {
+            result.store(0, std::memory_order_relaxed);
+        }
+
+        operation.latency.reset();
+    }
+
+    _callback_runs.store(0, std::memory_order_relaxed);
+    _pump_iterations.store(0, std::memory_order_relaxed);
+    _wait_timeouts.store(0, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+// Exposition.
+[[nodiscard]] std::string steam_metrics::to_prometheus() const {
+    const snapshot metrics = read();
+    std::string out;
+
+    append_header(out, "steam_wrapper_operation_latency_seconds", "summary",
+                  "Time from issuing a Steam call to the dispatch of its call result.");
+    for (const operation_snapshot& operation : metrics.operations) {
+        const std::string label = operation_label(operation.kind);
+
+        for (const double q : reported_quantiles) {
+            std::string labels = label + ",quantile=\"";
+            append_number(labels, q);
+            labels += '"';
+            append_sample(out, "steam_wrapper_operation_latency_seconds", labels, to_seconds(operation.latency.percentile(q)));
+        }
+
+        append_sample(out, "steam_wrapper_operation_latency_seconds_sum", label, to_seconds(operation.latency.sum));
+        append_sample(out, "steam_wrapper_operation_latency_seconds_count", label, operation.latency.count);
+    }
+
+    append_header(out, "steam_wrapper_operations_in_flight", "gauge", "Steam calls issued and not completed yet.");
+    for (const operation_snapshot& operation : metrics.operations) {
+        append_sample(out, "steam_wrapper_operations_in_flight", operation_label(operation.kind), operation.in_flight);
+    }
+
+    append_header(out, "steam_wrapper_operations_issued_total", "counter", "Steam calls issued.");
+    for (const operation_snapshot& operation : metrics.operations) {
+        append_sample(out, "steam_wrapper_operations_issued_total", operation_label(operation.kind), operation.issued);
+    }
+
+    append_header(out, "steam_wrapper_operation_issue_failures_total", "counter", "Steam calls the API refused to issue.");
+    for (const operation_snapshot& operation : metrics.operations) {
+        append_sample(out, "steam_wrapper_operation_issue_failures_total", operation_label(operation.kind), operation.issue_failures);
+    }
+
+    append_header(out, "steam_wrapper_operation_retries_total", "counter", "Steam calls issued again after a retryable failure.");
+    for (const operation_snapshot& operation : metrics.operations) {
+        append_sample(out, "steam_wrapper_operation_retries_total", operation_label(operation.kind), operation.retries);
+    }
+
+    append_header(out, "steam_wrapper_operation_retries_denied_total", "counter", "Retries turned down by the retry budget.");
+    for (const operation_snapshot& operation : metrics.operations) {
+        append_sample(out, "steam_wrapper_operation_retries_denied_total", operation_label(operation.kind), operation.retries_denied);
+    }
+
+    append_header(out, "steam_wrapper_operation_results_total", "counter", "Completed Steam calls by EResult.");
+    for (const operation_snapshot& operation : metrics.operations) {
+        const std::string label = operation_label(operation.kind);
+
+        for (const auto& [result, count] : operation.results) {
+            append_sample(out, "steam_wrapper_operation_results_total",
+                          label + ",result=\"" + std::string{result_name(result)} + '"', count);
+        }
+
+        if (operation.other_results != 0) {
+            append_sample(out, "steam_wrapper_operation_results_total", label + ",result=\"other\"", operation.other_results);
+        }
+    }
+
+    append_header(out, "steam_wrapper_callback_runs_total", "counter", "SteamAPI_RunCallbacks dispatches.");
+    append_sample(out, "steam_wrapper_callback_runs_total", "", metrics.callback_runs);
+
+    append_header(out, "steam_wrapper_callback_pump_iterations_total", "counter", "Wake-ups of the background callback pump.");
+    append_sample(out, "steam_wrapper_callback_pump_iterations_total", "", metrics.pump_iterations);
+
+    append_header(out, "steam_wrapper_wait_timeouts_total", "counter", "Waits on pending operations that timed out.");
+    append_sample(out, "steam_wrapper_wait_timeouts_total", "", metrics.wait_timeouts);
+
+    return out;
+}
+
+[[nodiscard]] std::string steam_metrics::to_json() const {
+    const snapshot metrics = read();
+    std::string out = "{\"operations\":{";
+
+    for (std::size_t i = 0; i < metrics.operations.size(); ++i) {
+        const operation_snapshot& operation = metrics.operations[i];
+        const latency_histogram::snapshot& latency = operation.latency;
+
+        if (i != 0) {
+            out += ',';
+        }
+
+        out += '"';
+        out += operation_kind_name(operation.kind);
+        out += "\":{\"in_flight\":";
+        append_number(out, operation.in_flight);
+        out += ",\"issued\":";
+        append_number(out, operation.issued);
+        out += ",\"completed\":";
+        append_number(out, operation.completed);
+        out += ",\"issue_failures\":";
+        append_number(out, operation.issue_failures);
+        out += ",\"retries\":";
+        append_number(out, operation.retries);
+        out += ",\"retries_denied\":";
+        append_number(out, operation.retries_denied);
+
+        out += ",\"latency_us\":{\"count\":";
+        append_number(out, latency.count);
+        out += ",\"min\":";
+        append_number(out, latency.min);
+        out += ",\"mean\":";
+        append_number(out, latency.mean());
+        out += ",\"p50\":";
+        append_number(out, latency.percentile(0.5));
+        out += ",\"p90\":";
+        append_number(out, latency.percentile(0.9));
+        out += ",\"p99\":";
+        append_number(out, latency.percentile(0.99));
+        out += ",\"p999\":";
+        append_number(out, latency.percentile(0.999));
+        out += ",\"max\":";
+        append_number(out, latency.max);
+
+        out += "},\"results\":{";
+        bool first = true;
+
+        for (const auto& [result, count] : operation.results) {
+            out += first ? "\"" : ",\"";
+            out += result_name(result);
+            out += "\":";
+            append_number(out, count);
+            first = false;
+        }
+
+        if (operation.other_results != 0) {
+            out += first ? "\"other\":" : ",\"other\":";
+            append_number(out, operation.other_results);
+        }
+
+        out += "}}";
+    }
+
+    out += "},\"callback_runs\":";
+    append_number(out, metrics.callback_runs);
+    out += ",\"pump_iterations\":";
+    append_number(out, metrics.pump_iterations);
+    out += ",\"wait_timeouts\":";
+    append_number(out, metrics.wait_timeouts);
+    out += '}';
+    return out;
+}
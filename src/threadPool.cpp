@@ -0,0 +1,115 @@
+#include "../include/threadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+thread_pool::thread_pool(const std::size_t threads) {
+    const std::size_t count = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    _workers.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        _workers.emplace_back([this] { work(); });
+    }
+}
+
+thread_pool::~thread_pool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _stopping = true;
+    }
+
+    _wake.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+[[nodiscard]] thread_pool& thread_pool::shared() {
+    static thread_pool pool;
+    return pool;
+}
+
+void thread_pool::work() noexcept {
+    for (;;) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _wake.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+            if (_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+void thread_pool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _tasks.push_back(std::move(task));
+    }
+
+    _wake.notify_one();
+}
+
+void thread_pool::run_parallel(const std::size_t count, const std::function<void(std::size_t)>& body) {
+    // Helpers still queued when the caller is done must not touch `body`
+    // anymore, they find the loop closed and leave.
+    struct loop {
+        std::size_t count = 0;
+        std::atomic<std::size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t running = 0;
+        bool closed = false;
+        const std::function<void(std::size_t)>* body = nullptr;
+
+        void run() {
+            for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                (*body)(i);
+            }
+        }
+    };
+
+    const auto shared = std::make_shared<loop>();
+    shared->body = &body;
+    shared->count = count;
+
+    const std::size_t helpers = std::min(count - 1, _workers.size());
+
+    for (std::size_t i = 0; i < helpers; ++i) {
+        submit([shared] {
+            {
+                std::lock_guard<std::mutex> lock{shared->mutex};
+
+                if (shared->closed) {
+                    return;
+                }
+
+                ++shared->running;
+            }
+
+            shared->run();
+
+            std::lock_guard<std::mutex> lock{shared->mutex};
+
+            if (--shared->running == 0) {
+                shared->done.notify_all();
+            }
+        });
+    }
+
+    shared->run();
+
+    std::unique_lock<std::mutex> lock{shared->mutex};
+    shared->closed = true;
+    shared->done.wait(lock, [&shared] { return shared->running == 0; });
+}
@@ -0,0 +1,203 @@
+#include "../include/uploadMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    [[nodiscard]] bool uploading(const EItemUpdateStatus status) noexcept {
+        return status == EItemUpdateStatus::k_EItemUpdateStatusUploadingContent ||
+               status == EItemUpdateStatus::k_EItemUpdateStatusUploadingPreviewFile;
+    }
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Sampling.
+bool upload_monitor::advance(upload_progress& progress, const EItemUpdateStatus status, const uint64_t processed, const uint64_t total,
+                             const std::chrono::microseconds since_last_sample, const std::chrono::milliseconds smoothing) noexcept {
+    const bool same_phase = status == progress.status && total == progress.bytes_total;
+    const double seconds = std::chrono::duration<double>(since_last_sample).count();
+
+    // Rates only make sense within a phase, a new one starts from its own zero.
+    if (same_phase && uploading(status) && seconds > 0.0 && processed >= progress.bytes_processed) {
+        const double instant = static_cast<double>(processed - progress.bytes_processed) / seconds;
+        const double window = std::chrono::duration<double>(smoothing).count();
+        const double alpha = window > 0.0 ? 1.0 - std::exp(-seconds / window) : 1.0;
+
+        progress.bytes_per_second = progress.bytes_per_second == 0.0 ? instant : progress.bytes_per_second + alpha * (instant - progress.bytes_per_second);
+    }
+
+    const bool changed = !same_phase || processed != progress.bytes_processed;
+
+    progress.status = status;
+    progress.bytes_processed = processed;
+    progress.bytes_total = total;
+
+    if (uploading(status) && progress.bytes_per_second > 0.0 && total >= processed) {
+        progress.eta = std::chrono::milliseconds{static_cast<int64_t>(static_cast<double>(total - processed) * 1000.0 / progress.bytes_per_second)};
+    } else {
+        progress.eta.reset();
+    }
+
+    return changed;
+}
+
+void upload_monitor::configure(const config& updated) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _config = updated;
+}
+
+void upload_monitor::track(const UGCUpdateHandle_t update_handle, const PublishedFileId_t item_id, const clock::time_point now) {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    upload& target = _uploads[update_handle];
+    target = {};
+    target.progress.update_handle = update_handle;
+    target.progress.item_id = item_id;
+    target.current_handle = update_handle;
+    target.started = now;
+    target.sampled = now;
+}
+
+void upload_monitor::rebind(const UGCUpdateHandle_t update_handle, const UGCUpdateHandle_t current_handle) noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    if (const auto it = _uploads.find(update_handle); it != _uploads.end()) {
+        it->second.current_handle = current_handle;
+    }
+}
+
+void upload_monitor::finish(const UGCUpdateHandle_t update_handle, const EResult result, const clock::time_point now) {
+    std::vector<upload_progress> events;
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        const auto it = _uploads.find(update_handle);
+
+        if (it == _uploads.end()) {
+            return;
+        }
+
+        upload_progress& progress = it->second.progress;
+        progress.finished = true;
+        progress.result = result;
+        progress.status = EItemUpdateStatus::k_EItemUpdateStatusInvalid;
+        progress.eta.reset();
+        progress.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - it->second.started);
+
+        if (result == EResult::k_EResultOK) {
+            progress.bytes_processed = progress.bytes_total;
+        }
+
+        events.push_back(std::move(progress));
+        _uploads.erase(it);
+    }
+
+    publish(events);
+}
+
+void upload_monitor::sample(const clock::time_point now) {
+    std::vector<upload_progress> events;
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+
+        if (_uploads.empty() || now - _last_sample < _config.sample_interval) {
+            return;
+        }
+
+        _last_sample = now;
+
+        for (auto& [handle, target] : _uploads) {
+            uint64 processed = 0;
+            uint64 total = 0;
+            const EItemUpdateStatus status = SteamUGC()->GetItemUpdateProgress(target.current_handle, &processed, &total);
+
+            const auto since_last_sample = std::chrono::duration_cast<std::chrono::microseconds>(now - target.sampled);
+            target.sampled = now;
+            target.progress.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - target.started);
+
+            if (advance(target.progress, status, processed, total, since_last_sample, _config.smoothing)) {
+                events.push_back(target.progress);
+            }
+        }
+    }
+
+    publish(events);
+}
+
+// ----------------------------------------------------------------------------
+// Readers.
+void upload_monitor::publish(const std::vector<upload_progress>& events) const {
+    if (events.empty()) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<const subscriber>> subscribers;
+
+    {
+        std::lock_guard<std::mutex> lock{_subscribers_mutex};
+        subscribers.reserve(_subscribers.size());
+
+        for (const auto& entry : _subscribers) {
+            subscribers.push_back(entry.second);
+        }
+    }
+
+    for (const upload_progress& event : events) {
+        for (const auto& callback : subscribers) {
+            (*callback)(event);
+        }
+    }
+}
+
+[[nodiscard]] upload_monitor::subscription upload_monitor::subscribe(subscriber callback) {
+    std::lock_guard<std::mutex> lock{_subscribers_mutex};
+    const subscription id = _next_subscription++;
+    _subscribers.emplace_back(id, std::make_shared<const subscriber>(std::move(callback)));
+    return id;
+}
+
+void upload_monitor::unsubscribe(const subscription id) noexcept {
+    std::lock_guard<std::mutex> lock{_subscribers_mutex};
+    _subscribers.erase(std::remove_if(_subscribers.begin(), _subscribers.end(), [id](const auto& entry) { return entry.first == id; }),
+                       _subscribers.end());
+}
+
+[[nodiscard]] std::optional<upload_progress> upload_monitor::progress(const UGCUpdateHandle_t update_handle) const {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    if (const auto it = _uploads.find(update_handle); it != _uploads.end()) {
+        return it->second.progress;
+    }
+
+    return std::nullopt;
+}
+
+[[nodiscard]] UGCUpdateHandle_t upload_monitor::current_handle(const UGCUpdateHandle_t update_handle) const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    if (const auto it = _uploads.find(update_handle); it != _uploads.end()) {
+        return it->second.current_handle;
+    }
+
+    return update_handle;
+}
+
+[[nodiscard]] std::vector<upload_progress> upload_monitor::uploads() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    std::vector<upload_progress> active;
+    active.reserve(_uploads.size());
+
+    for (const auto& entry : _uploads) {
+        active.push_back(entry.second.progress);
+    }
+
+    return active;
+}
+
+[[nodiscard]] std::size_t upload_monitor::active() const noexcept {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _uploads.size();
+}
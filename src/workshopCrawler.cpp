@@ -0,0 +1,178 @@
+#include "../include/workshopCrawler.h"
+
+#include <algorithm>
+#include <ctime>
+
+workshop_crawler::workshop_crawler(steam_helper& helper, options crawl_options) noexcept
+    : _helper{helper}, _options{std::move(crawl_options)} {}
+
+// ----------------------------------------------------------------------------
+// Crawl utils.
+bool workshop_crawler::issue(const std::shared_ptr<crawl_state>& state, const window& shard) noexcept {
+    UGCQueryHandle_t query_handle = k_UGCQueryHandleInvalid;
+
+    _helper.create_all_query(query_handle, EUGCQuery::k_EUGCQuery_RankedByPublicationDate, _options.matching_type,
+                             _options.creator_app_id, _options.consumer_app_id, shard.cursor);
+
+    if (query_handle == k_UGCQueryHandleInvalid) {
+        return false;
+    }
+
+    if (!_helper.set_time_created_date_range(query_handle, shard.start, shard.end) ||
+        (_options.configure && !_options.configure(_helper, query_handle))) {
+        _helper.release_query_handle(query_handle);
+        return false;
+    }
+
+    // Bulk traffic, queries issued interactively meanwhile go first.
+    const call_priority_scope background{call_priority::background};
+
+    const SteamAPICall_t api_call = _helper.send_query_request(query_handle,
+        [helper = &_helper, state, shard](const EResult rc, const SteamUGCQueryCompleted_t& completed) {
+            query_page page;
+            helper->read_query_page(rc, completed, page);
+            on_page(*state, shard, std::move(page));
+        });
+
+    return api_call != k_uAPICallInvalid;
+}
+
+void workshop_crawler::on_page(crawl_state& state, const window& shard, query_page&& page) noexcept {
+    std::lock_guard<std::mutex> lock{state.mutex};
+
+    --state.in_flight;
+    ++state.completions;
+
+    if (page.result != EResult::k_EResultOK) {
+        log_error("Steam") << "Crawl of window [" << shard.start << ", " << shard.end << "] failed\n";
+
+        if (state.output.result == EResult::k_EResultOK) {
+            state.output.result = page.result;
+        }
+
+        return;
+    }
+
+    ++state.output.pages;
+
+    // Too large to walk serially: split it and let the halves run in parallel.
+    // Items of this first page are kept, the halves will just report them again.
+    const bool first_page = shard.cursor == "*";
+
+    if (first_page && page.total_matching > state.split_threshold &&
+        shard.end - shard.start > state.min_window) {
+        const RTime32 middle = shard.start + (shard.end - shard.start) / 2;
+
+        state.pending.push_back({shard.start, middle, "*"});
+        state.pending.push_back({middle + 1, shard.end, "*"});
+        ++state.output.splits;
+    } else if (page.num_returned != 0 && !page.next_cursor.empty() && page.next_cursor != shard.cursor) {
+        state.pending.push_back({shard.start, shard.end, page.next_cursor});
+    }
+
+    for (std::size_t i = 0; i < page.items.size(); ++i) {
+        if (!state.seen.insert(page.items[i].m_nPublishedFileId).second) {
+            ++state.output.duplicates;
+            continue;
+        }
+
+        state.output.items.push_back(page.items[i]);
+        state.output.preview_urls.push_back(std::move(page.preview_urls[i]));
+    }
+}
+
+[[nodiscard]] workshop_crawler::result workshop_crawler::run() noexcept {
+    auto state = std::make_shared<crawl_state>();
+    state->split_threshold = _options.split_threshold;
+    state->min_window = _options.min_window;
+
+    const RTime32 created_before = _options.created_before != 0
+        ? _options.created_before
+        : static_cast<RTime32>(std::time(nullptr));
+
+    const RTime32 span = created_before > _options.created_after ? created_before - _options.created_after : 0;
+    const uint32_t shards = std::max<uint32_t>(1, std::min<uint32_t>(_options.initial_shards, span + 1));
+    const uint32_t max_in_flight = std::max<uint32_t>(1, _options.max_in_flight);
+
+    for (uint32_t i = 0; i < shards; ++i) {
+        const RTime32 start = _options.created_after + static_cast<RTime32>(static_cast<uint64_t>(span) * i / shards);
+        const RTime32 end = i + 1 == shards
+            ? created_before
+            : _options.created_after + static_cast<RTime32>(static_cast<uint64_t>(span) * (i + 1) / shards) - 1;
+
+        state->pending.push_back({start, end, "*"});
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+
+    // Requests are issued from this thread only, completions just queue follow-up work.
+    for (;;) {
+        uint64_t completions_seen = 0;
+
+        {
+            std::unique_lock<std::mutex> lock{state->mutex};
+
+            if (state->output.result != EResult::k_EResultOK) {
+                // Stop scheduling, drain what is already in flight.
+                state->pending.clear();
+            }
+
+            while (state->in_flight < max_in_flight && !state->pending.empty()) {
+                const window shard = state->pending.front();
+                state->pending.pop_front();
+                ++state->in_flight;
+                ++state->output.windows;
+
+                lock.unlock();
+                const bool issued = issue(state, shard);
+                lock.lock();
+
+                if (!issued) {
+                    --state->in_flight;
+
+                    if (state->output.result == EResult::k_EResultOK) {
+                        state->output.result = EResult::k_EResultFail;
+                    }
+                }
+            }
+
+            if (state->in_flight == 0 && state->pending.empty()) {
+                break;
+            }
+
+            completions_seen = state->completions;
+        }
+
+        std::chrono::microseconds wait = _options.stall_timeout;
+
+        if (_options.deadline.count() > 0) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+            wait = std::min(wait, std::max(std::chrono::microseconds{0}, _options.deadline - elapsed));
+        }
+
+        const bool progressed = _helper.run_callbacks_until([&state, completions_seen] {
+            std::lock_guard<std::mutex> lock{state->mutex};
+            return state->completions != completions_seen;
+        }, wait);
+
+        if (!progressed) {
+            log_error("Steam") << (wait < _options.stall_timeout ? "Workshop crawl past its deadline\n" : "Workshop crawl stalled, no page completed in time\n");
+
+            std::lock_guard<std::mutex> lock{state->mutex};
+            state->pending.clear();
+
+            if (state->output.result == EResult::k_EResultOK) {
+                state->output.result = EResult::k_EResultTimeout;
+            }
+
+            // In-flight completions still reference the shared state, hand out a copy.
+            return state->output;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock{state->mutex};
+    log_info("Steam") << "Workshop crawl done: " << state->output.items.size() << " items, "
+                 << state->output.pages << " pages, " << state->output.splits << " splits\n";
+
+    return std::move(state->output);
+}
@@ -0,0 +1,332 @@
+// ----------------------------------------------------------------------------
+// Content packs written from a folder and read back, and damaged packs.
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/contentFingerprint.h"
+#include "../include/contentPack.h"
+#include "../include/logger.h"
+
+#include "testing.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t block_size = 4096;
+
+std::filesystem::path temp_path(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("steam_wrapper_test_" + name);
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+void write_file(const std::filesystem::path& path, const std::string& contents) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+std::string text_of(const std::size_t size) {
+    std::string text;
+
+    for (int line = 0; text.size() < size; ++line) {
+        text += "entry " + std::to_string(line % 50) + " of a repeated manifest line\n";
+    }
+
+    text.resize(size);
+    return text;
+}
+
+std::string noise_of(const std::size_t size, const uint32_t seed) {
+    std::mt19937 random{seed};
+    std::string noise(size, '\0');
+
+    for (char& byte : noise) {
+        byte = static_cast<char>(random());
+    }
+
+    return noise;
+}
+
+// A folder with every kind of file the writer tells apart.
+struct source_folder {
+    std::filesystem::path root = temp_path("pack_source");
+
+    source_folder() {
+        std::filesystem::remove_all(root);
+        write_file(root / "empty", "");
+        write_file(root / "text/exact.txt", text_of(block_size));
+        write_file(root / "text/large.txt", text_of(block_size * 3 + 100));
+        write_file(root / "text/small.txt", text_of(300));
+        write_file(root / "media/exact.bin", noise_of(block_size, 1));
+        write_file(root / "media/large.bin", noise_of(block_size * 2 + 7, 2));
+        write_file(root / "excluded.tmp", "scratch");
+    }
+
+    ~source_folder() { std::filesystem::remove_all(root); }
+
+    source_folder(const source_folder&) = delete;
+    source_folder& operator=(const source_folder&) = delete;
+};
+
+const std::vector<std::string> packed_paths{"empty", "media/exact.bin", "media/large.bin", "text/exact.txt", "text/large.txt", "text/small.txt"};
+
+std::optional<content_pack_writer::stats> pack_folder(const source_folder& source, const std::filesystem::path& pack, const bool compress = true) {
+    pack_options options;
+    options.block_size = block_size;
+    options.compress = compress;
+    return content_pack_writer{options}.write(source.root, pack, staging_rules{{}, {"*.tmp"}});
+}
+
+bool same_bytes(const std::vector<std::byte>& bytes, const std::string& expected) {
+    return bytes.size() == expected.size() && (expected.empty() || std::memcmp(bytes.data(), expected.data(), expected.size()) == 0);
+}
+
+// ----------------------------------------------------------------------------
+// Index editing, to damage a pack while keeping its checksum right.
+uint64_t get_u64(const std::string& bytes, const std::size_t at) {
+    uint64_t value = 0;
+
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | static_cast<uint8_t>(bytes[at + static_cast<std::size_t>(i)]);
+    }
+
+    return value;
+}
+
+void set_u64(std::string& bytes, const std::size_t at, const uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        bytes[at + static_cast<std::size_t>(i)] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+// Offset of the entry's size field in the index.
+std::size_t size_field_of(const std::string& bytes, const std::string& path) {
+    const std::size_t index_offset = get_u64(bytes, bytes.size() - 32);
+    std::size_t at = index_offset;
+
+    while (at < bytes.size() - 32) {
+        const std::size_t path_size = static_cast<uint8_t>(bytes[at]) | (std::size_t{static_cast<uint8_t>(bytes[at + 1])} << 8);
+        const bool found = bytes.compare(at + 2, path_size, path) == 0 && path_size == path.size();
+        at += 2 + path_size + 1;
+
+        if (found) {
+            return at + 16;
+        }
+
+        at += 32;
+    }
+
+    return 0;
+}
+
+void rehash_index(std::string& bytes) {
+    const std::size_t footer = bytes.size() - 32;
+    const std::size_t index_offset = get_u64(bytes, footer);
+    set_u64(bytes, footer + 16, xxhash64::hash(bytes.data() + index_offset, footer - index_offset));
+}
+
+// ----------------------------------------------------------------------------
+// Round trips.
+void packs_round_trip_stored_and_compressed_files() {
+    const source_folder source;
+    const std::filesystem::path pack_path = temp_path("pack_round_trip.swpk");
+
+    const auto stats = pack_folder(source, pack_path);
+    CHECK(stats.has_value());
+    CHECK(stats.has_value() && stats->files == packed_paths.size());
+    CHECK(stats.has_value() && stats->compressed_files == 3); // The text files.
+    CHECK(stats.has_value() && stats->packed_bytes == std::filesystem::file_size(pack_path));
+
+    const auto pack = content_pack::open(pack_path);
+    CHECK(pack.has_value());
+
+    if (pack.has_value()) {
+        CHECK(pack->entries().size() == packed_paths.size());
+        CHECK(pack->find("excluded.tmp") == nullptr);
+
+        std::vector<std::byte> bytes;
+
+        for (const std::string& path : packed_paths) {
+            const std::string expected = read_file(source.root / path);
+            CHECK(pack->read(path, bytes, true) && same_bytes(bytes, expected));
+
+            // Only the files kept as they are are served from the mapping.
+            const auto view = pack->view_of(path);
+            const bool compressed = path.rfind("text/", 0) == 0;
+            CHECK(view.has_value() != compressed);
+            CHECK(!view.has_value() || (view->size == expected.size() && (expected.empty() || std::memcmp(view->data, expected.data(), expected.size()) == 0)));
+        }
+
+        CHECK(pack->find("text/exact.txt") != nullptr && pack->find("text/exact.txt")->storage == content_pack::method::blocks);
+        CHECK(pack->find("text/large.txt") != nullptr && pack->find("text/large.txt")->storage == content_pack::method::blocks);
+        CHECK(!pack->read("missing", bytes));
+    }
+
+    std::filesystem::remove(pack_path);
+}
+
+void uncompressed_packs_serve_every_file_from_the_mapping() {
+    const source_folder source;
+    const std::filesystem::path pack_path = temp_path("pack_stored.swpk");
+
+    const auto stats = pack_folder(source, pack_path, false);
+    CHECK(stats.has_value() && stats->compressed_files == 0);
+
+    const auto pack = content_pack::open(pack_path);
+    CHECK(pack.has_value());
+
+    for (const std::string& path : packed_paths) {
+        const auto view = pack.has_value() ? pack->view_of(path) : std::nullopt;
+        const std::string expected = read_file(source.root / path);
+        CHECK(view.has_value() && view->size == expected.size());
+        CHECK(view.has_value() && (expected.empty() || std::memcmp(view->data, expected.data(), expected.size()) == 0));
+    }
+
+    std::filesystem::remove(pack_path);
+}
+
+void empty_folders_make_empty_packs() {
+    const std::filesystem::path folder = temp_path("pack_empty_source");
+    const std::filesystem::path pack_path = temp_path("pack_empty.swpk");
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+
+    const auto stats = content_pack_writer{}.write(folder, pack_path);
+    CHECK(stats.has_value() && stats->files == 0);
+
+    const auto pack = content_pack::open(pack_path);
+    CHECK(pack.has_value() && pack->entries().empty());
+
+    CHECK(!content_pack_writer{}.write(folder / "missing", pack_path).has_value());
+
+    std::filesystem::remove_all(folder);
+    std::filesystem::remove(pack_path);
+}
+
+// ----------------------------------------------------------------------------
+// Damaged packs: refused on open, or their damaged files on read.
+void damaged_packs_are_refused() {
+    const source_folder source;
+    const std::filesystem::path pack_path = temp_path("pack_intact.swpk");
+    const std::filesystem::path damaged_path = temp_path("pack_damaged.swpk");
+    CHECK(pack_folder(source, pack_path).has_value());
+
+    const std::string bytes = read_file(pack_path);
+    const auto open_damaged = [&damaged_path](const std::string& contents) {
+        write_file(damaged_path, contents);
+        return content_pack::open(damaged_path);
+    };
+
+    CHECK(open_damaged(bytes).has_value());
+
+    // Cut short: no footer, or one pointing past the end.
+    CHECK(!open_damaged(bytes.substr(0, bytes.size() - 1)).has_value());
+    CHECK(!open_damaged(bytes.substr(0, bytes.size() / 2)).has_value());
+    CHECK(!open_damaged(bytes.substr(0, 20)).has_value());
+
+    std::string shifted = bytes.substr(0, 16) + bytes.substr(17);
+    CHECK(!open_damaged(shifted).has_value());
+
+    // An index byte changed without its checksum.
+    std::string index_flipped = bytes;
+    index_flipped[get_u64(bytes, bytes.size() - 32) + 3] ^= 0x40;
+    CHECK(!open_damaged(index_flipped).has_value());
+
+    std::string foreign = bytes;
+    foreign[0] = 'X';
+    CHECK(!open_damaged(foreign).has_value());
+
+    // Sizes no block could decompress to, checksum fixed up: refused before anything is allocated.
+    const std::size_t size_field = size_field_of(bytes, "text/large.txt");
+    CHECK(size_field != 0);
+
+    std::string oversize = bytes;
+    set_u64(oversize, size_field, ~uint64_t{0} >> 1);
+    rehash_index(oversize);
+    CHECK(!open_damaged(oversize).has_value());
+
+    // Within what the blocks could hold, but not what they hold.
+    std::string mismatched = bytes;
+    set_u64(mismatched, size_field, get_u64(bytes, size_field) + 1);
+    rehash_index(mismatched);
+
+    const auto mismatched_pack = open_damaged(mismatched);
+    std::vector<std::byte> out;
+    CHECK(mismatched_pack.has_value() && !mismatched_pack->read("text/large.txt", out));
+
+    std::filesystem::remove(pack_path);
+    std::filesystem::remove(damaged_path);
+}
+
+void corrupt_blocks_fail_their_read_only() {
+    const source_folder source;
+    const std::filesystem::path pack_path = temp_path("pack_blocks.swpk");
+    const std::filesystem::path damaged_path = temp_path("pack_blocks_damaged.swpk");
+    CHECK(pack_folder(source, pack_path).has_value());
+
+    const std::string bytes = read_file(pack_path);
+    const auto intact = content_pack::open(pack_path);
+    const content_pack::entry* large = intact.has_value() ? intact->find("text/large.txt") : nullptr;
+    CHECK(large != nullptr);
+
+    if (large == nullptr) {
+        return;
+    }
+
+    const auto offset = static_cast<std::size_t>(large->offset);
+    std::vector<std::byte> out;
+
+    // A block claiming more bytes than the file has left.
+    {
+        std::string damaged = bytes;
+        damaged[offset + 2] = static_cast<char>(0x7f);
+        write_file(damaged_path, damaged);
+
+        const auto pack = content_pack::open(damaged_path);
+        CHECK(pack.has_value() && !pack->read("text/large.txt", out));
+        CHECK(pack.has_value() && pack->read("text/small.txt", out, true));
+    }
+
+    // Compressed bytes changed: the decompression fails, or the checksum does.
+    for (std::size_t at = offset + 4; at < offset + 64; at += 7) {
+        std::string damaged = bytes;
+        damaged[at] = static_cast<char>(damaged[at] ^ 0x21);
+        write_file(damaged_path, damaged);
+
+        const auto pack = content_pack::open(damaged_path);
+        CHECK(pack.has_value() && !pack->read("text/large.txt", out, true));
+    }
+
+    std::filesystem::remove(pack_path);
+    std::filesystem::remove(damaged_path);
+}
+
+} // namespace
+
+int main() {
+    logger::instance().set_sink(nullptr);
+
+    return testing::run({
+        {"packs round-trip stored and compressed files", packs_round_trip_stored_and_compressed_files},
+        {"uncompressed packs serve every file from the mapping", uncompressed_packs_serve_every_file_from_the_mapping},
+        {"empty folders make empty packs", empty_folders_make_empty_packs},
+        {"damaged packs are refused", damaged_packs_are_refused},
+        {"corrupt blocks fail their read only", corrupt_blocks_fail_their_read_only},
+    });
+}
@@ -0,0 +1,534 @@
+// ----------------------------------------------------------------------------
+// PNG decoding, shrinking and JPEG encoding of previews, on images built here
+// and on damaged ones.
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/imageCodec.h"
+
+#include "testing.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t white[3] = {255, 255, 255};
+
+// ----------------------------------------------------------------------------
+// PNG writing, stored or fixed Huffman deflate only.
+uint32_t crc32(const uint8_t* data, const std::size_t size) noexcept {
+    uint32_t crc = 0xffffffff;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xedb88320 & (0u - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
+uint32_t adler32(const std::vector<uint8_t>& data) noexcept {
+    uint32_t a = 1;
+    uint32_t b = 0;
+
+    for (const uint8_t byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    return (b << 16) | a;
+}
+
+void put_be32(std::vector<uint8_t>& out, const uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+class bit_stream {
+
+private:
+    std::vector<uint8_t> _bytes;
+    int _used = 8;
+
+public:
+    // LSB first, as deflate packs everything but the Huffman codes.
+    void write(const uint32_t value, const int bits) {
+        for (int i = 0; i < bits; ++i) {
+            if (_used == 8) {
+                _bytes.push_back(0);
+                _used = 0;
+            }
+
+            _bytes.back() |= static_cast<uint8_t>(((value >> i) & 1) << _used++);
+        }
+    }
+
+    // Huffman codes go most significant bit first.
+    void write_code(const uint32_t code, const int bits) {
+        for (int i = bits - 1; i >= 0; --i) {
+            write((code >> i) & 1, 1);
+        }
+    }
+
+    [[nodiscard]] std::vector<uint8_t> bytes() const { return _bytes; }
+};
+
+std::vector<uint8_t> zlib_wrap(const std::vector<uint8_t>& deflated, const std::vector<uint8_t>& raw) {
+    std::vector<uint8_t> stream;
+    stream.reserve(2 + deflated.size() + 4);
+    stream.push_back(0x78);
+    stream.push_back(0x01);
+    stream.insert(stream.end(), deflated.begin(), deflated.end());
+    put_be32(stream, adler32(raw));
+    return stream;
+}
+
+std::vector<uint8_t> zlib_stored(const std::vector<uint8_t>& raw) {
+    std::vector<uint8_t> deflated;
+    std::size_t at = 0;
+
+    do {
+        const std::size_t length = std::min<std::size_t>(raw.size() - at, 65535);
+        deflated.push_back(at + length == raw.size() ? 1 : 0);
+        deflated.push_back(static_cast<uint8_t>(length));
+        deflated.push_back(static_cast<uint8_t>(length >> 8));
+        deflated.push_back(static_cast<uint8_t>(~length));
+        deflated.push_back(static_cast<uint8_t>(~length >> 8));
+        deflated.insert(deflated.end(), raw.begin() + static_cast<std::ptrdiff_t>(at), raw.begin() + static_cast<std::ptrdiff_t>(at + length));
+        at += length;
+    } while (at < raw.size());
+
+    return zlib_wrap(deflated, raw);
+}
+
+// Literals, and runs of a repeated byte as length 3 distance 1 copies.
+std::vector<uint8_t> zlib_fixed(const std::vector<uint8_t>& raw) {
+    bit_stream bits;
+    bits.write(1, 1);
+    bits.write(1, 2);
+
+    for (std::size_t i = 0; i < raw.size();) {
+        if (i > 0 && i + 3 <= raw.size() && raw[i] == raw[i - 1] && raw[i + 1] == raw[i - 1] && raw[i + 2] == raw[i - 1]) {
+            bits.write_code(1, 7); // 257: length 3.
+            bits.write_code(0, 5); // Distance 1.
+            i += 3;
+            continue;
+        }
+
+        const uint8_t literal = raw[i++];
+
+        if (literal < 144) {
+            bits.write_code(0x30u + literal, 8);
+        } else {
+            bits.write_code(0x190u + (literal - 144u), 9);
+        }
+    }
+
+    bits.write_code(0, 7); // End of block.
+    return zlib_wrap(bits.bytes(), raw);
+}
+
+void put_chunk(std::vector<uint8_t>& file, const char (&type)[5], const std::vector<uint8_t>& data) {
+    put_be32(file, static_cast<uint32_t>(data.size()));
+
+    const std::size_t start = file.size();
+    file.insert(file.end(), type, type + 4);
+    file.insert(file.end(), data.begin(), data.end());
+    put_be32(file, crc32(file.data() + start, file.size() - start));
+}
+
+struct png_chunk {
+    char type[5];
+    std::vector<uint8_t> data;
+};
+
+std::vector<uint8_t> png_file(const uint32_t width, const uint32_t height, const uint8_t depth, const uint8_t color,
+                              const std::vector<uint8_t>& zlib_stream, const std::vector<png_chunk>& extra = {}) {
+    std::vector<uint8_t> file{0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    std::vector<uint8_t> header;
+    put_be32(header, width);
+    put_be32(header, height);
+    header.insert(header.end(), {depth, color, 0, 0, 0});
+    put_chunk(file, "IHDR", header);
+
+    for (const png_chunk& chunk : extra) {
+        put_chunk(file, {chunk.type[0], chunk.type[1], chunk.type[2], chunk.type[3], '\0'}, chunk.data);
+    }
+
+    put_chunk(file, "IDAT", zlib_stream);
+    put_chunk(file, "IEND", {});
+    return file;
+}
+
+// Rows of 8 bit samples, each row filtered with the type given for it.
+std::vector<uint8_t> filter_rows(const std::vector<uint8_t>& pixels, const uint32_t height, const std::size_t stride,
+                                 const std::size_t pixel_bytes, const std::vector<uint8_t>& filters) {
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> previous(stride, 0);
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* line = pixels.data() + y * stride;
+        const uint8_t filter = filters[y % filters.size()];
+        raw.push_back(filter);
+
+        for (std::size_t x = 0; x < stride; ++x) {
+            const int left = x >= pixel_bytes ? line[x - pixel_bytes] : 0;
+            const int up = previous[x];
+            const int up_left = x >= pixel_bytes ? previous[x - pixel_bytes] : 0;
+
+            int predicted = 0;
+
+            switch (filter) {
+                case 1: predicted = left; break;
+                case 2: predicted = up; break;
+                case 3: predicted = (left + up) >> 1; break;
+                case 4: {
+                    const int p = left + up - up_left;
+                    const int pa = std::abs(p - left);
+                    const int pb = std::abs(p - up);
+                    const int pc = std::abs(p - up_left);
+                    predicted = pa <= pb && pa <= pc ? left : pb <= pc ? up : up_left;
+                    break;
+                }
+                default: break;
+            }
+
+            raw.push_back(static_cast<uint8_t>(line[x] - predicted));
+        }
+
+        std::memcpy(previous.data(), line, stride);
+    }
+
+    return raw;
+}
+
+std::optional<rgb_image> decode(const std::vector<uint8_t>& file, const uint8_t (&background)[3] = white) {
+    return image_codec::decode_png(reinterpret_cast<const std::byte*>(file.data()), file.size(), background);
+}
+
+std::vector<uint8_t> random_bytes(const std::size_t count, const uint32_t seed) {
+    std::mt19937 random{seed};
+    std::vector<uint8_t> bytes(count);
+
+    for (uint8_t& byte : bytes) {
+        byte = static_cast<uint8_t>(random());
+    }
+
+    return bytes;
+}
+
+// A 16 x 16 RGB image deflated by zlib with a dynamic Huffman block: 4 x 4 cells,
+// red (x / 4) * 40, green (y / 4) * 40, blue 255 on every other cell.
+constexpr uint8_t dynamic_stream[] = {
+    0x78, 0xda, 0xcd, 0xcf, 0x31, 0x0d, 0x00, 0x40, 0x10, 0x02, 0x41, 0xe4, 0x20, 0x07, 0x39, 0xb8, 0xe7, 0xbb, 0xcd, 0x4b, 0x38,
+    0x32, 0xed, 0x16, 0x48, 0xdf, 0xac, 0x21, 0x12, 0xaa, 0x41, 0x17, 0x03, 0x0f, 0xb6, 0x10, 0x0f, 0xb5, 0x70, 0x32, 0xf8, 0xde,
+    0x39, 0x43, 0x22, 0x34, 0xc3, 0xc9, 0xa0, 0x83, 0x2b, 0xa4, 0x43, 0x2b, 0x1c, 0x0c, 0x1e, 0x2f, 0x5e, 0xf7, 0x81};
+
+// ----------------------------------------------------------------------------
+// Decoding.
+void png_round_trips_every_filter() {
+    constexpr uint32_t width = 13;
+    constexpr uint32_t height = 10;
+
+    const std::vector<uint8_t> pixels = random_bytes(width * height * 3, 7);
+    const std::vector<uint8_t> raw = filter_rows(pixels, height, width * 3, 3, {0, 1, 2, 3, 4});
+
+    const auto image = decode(png_file(width, height, 8, 2, zlib_stored(raw)));
+    CHECK(image.has_value());
+    CHECK(image.has_value() && image->width == width && image->height == height);
+    CHECK(image.has_value() && image->pixels == pixels);
+}
+
+void png_decodes_stored_blocks_over_64k() {
+    constexpr uint32_t width = 200;
+    constexpr uint32_t height = 120;
+
+    const std::vector<uint8_t> pixels = random_bytes(width * height * 3, 11);
+    const std::vector<uint8_t> raw = filter_rows(pixels, height, width * 3, 3, {4, 1});
+
+    const auto image = decode(png_file(width, height, 8, 2, zlib_stored(raw)));
+    CHECK(image.has_value() && image->pixels == pixels);
+}
+
+void png_decodes_fixed_huffman_blocks() {
+    constexpr uint32_t width = 24;
+    constexpr uint32_t height = 6;
+
+    std::vector<uint8_t> gray(width * height);
+
+    for (uint32_t i = 0; i < gray.size(); ++i) {
+        gray[i] = static_cast<uint8_t>((i / 5) * 37);
+    }
+
+    const auto image = decode(png_file(width, height, 8, 0, zlib_fixed(filter_rows(gray, height, width, 1, {0, 2}))));
+    CHECK(image.has_value());
+
+    for (std::size_t i = 0; image.has_value() && i < gray.size(); ++i) {
+        CHECK(image->pixels[i * 3] == gray[i] && image->pixels[i * 3 + 1] == gray[i] && image->pixels[i * 3 + 2] == gray[i]);
+    }
+}
+
+void png_decodes_dynamic_huffman_blocks() {
+    const std::vector<uint8_t> stream(std::begin(dynamic_stream), std::end(dynamic_stream));
+    const auto image = decode(png_file(16, 16, 8, 2, stream));
+    CHECK(image.has_value());
+
+    for (uint32_t y = 0; image.has_value() && y < 16; ++y) {
+        for (uint32_t x = 0; x < 16; ++x) {
+            const uint8_t* pixel = image->pixels.data() + (y * 16 + x) * 3;
+            CHECK(pixel[0] == (x / 4) * 40);
+            CHECK(pixel[1] == (y / 4) * 40);
+            CHECK(pixel[2] == ((x / 4 + y / 4) % 2) * 255);
+        }
+    }
+}
+
+void png_blends_transparency_over_the_background() {
+    constexpr uint8_t background[3] = {0, 0, 200};
+
+    // 1 bit palette: opaque red, then a fully transparent entry.
+    const std::vector<uint8_t> palette_raw{0, 0b01000000};
+    const auto palette = decode(png_file(2, 1, 1, 3, zlib_stored(palette_raw),
+                                         {{"PLTE", {255, 0, 0, 0, 255, 0}}, {"tRNS", {255, 0}}}),
+                                background);
+    CHECK(palette.has_value() && palette->pixels == (std::vector<uint8_t>{255, 0, 0, 0, 0, 200}));
+
+    // RGBA at half opacity.
+    const std::vector<uint8_t> rgba_raw{0, 255, 255, 255, 128};
+    const auto rgba = decode(png_file(1, 1, 8, 6, zlib_stored(rgba_raw)), background);
+    CHECK(rgba.has_value() && rgba->pixels == (std::vector<uint8_t>{128, 128, 228}));
+
+    // 16 bit gray keeps its high byte.
+    const std::vector<uint8_t> gray16_raw{0, 0xab, 0xcd};
+    const auto gray16 = decode(png_file(1, 1, 16, 0, zlib_stored(gray16_raw)));
+    CHECK(gray16.has_value() && gray16->pixels == (std::vector<uint8_t>{0xab, 0xab, 0xab}));
+}
+
+// ----------------------------------------------------------------------------
+// Damaged files: nullopt, never a crash nor a huge allocation.
+void truncated_pngs_are_refused() {
+    const std::vector<uint8_t> raw = filter_rows(random_bytes(8 * 8 * 3, 3), 8, 24, 3, {1});
+    const std::vector<uint8_t> file = png_file(8, 8, 8, 2, zlib_fixed(raw));
+
+    // Every cut before the end chunk loses image data.
+    const std::size_t end_chunk = file.size() - 12;
+
+    for (std::size_t size = 0; size < end_chunk; ++size) {
+        const std::vector<uint8_t> cut(file.begin(), file.begin() + static_cast<std::ptrdiff_t>(size));
+        CHECK(!decode(cut).has_value());
+    }
+
+    CHECK(decode(file).has_value());
+
+    // A whole IDAT chunk whose deflate stream stops short.
+    std::vector<uint8_t> stream = zlib_fixed(raw);
+    stream.resize(stream.size() / 2);
+    CHECK(!decode(png_file(8, 8, 8, 2, stream)).has_value());
+}
+
+void bad_huffman_lengths_are_refused() {
+    // Dynamic block whose 19 code length codes all have length 1.
+    {
+        bit_stream bits;
+        bits.write(1, 1);
+        bits.write(2, 2);
+        bits.write(0, 5);
+        bits.write(0, 5);
+        bits.write(15, 4);
+
+        for (int i = 0; i < 19; ++i) {
+            bits.write(1, 3);
+        }
+
+        bits.write(0, 32);
+        const std::vector<uint8_t> raw(2, 0);
+        CHECK(!decode(png_file(1, 1, 8, 0, zlib_wrap(bits.bytes(), raw))).has_value());
+    }
+
+    // Valid code length code, then 258 literal and distance lengths of 1.
+    {
+        bit_stream bits;
+        bits.write(1, 1);
+        bits.write(2, 2);
+        bits.write(0, 5);  // 257 literal / length codes.
+        bits.write(0, 5);  // 1 distance code.
+        bits.write(14, 4); // 18 code length codes, up to the one for length 1.
+
+        // In the order 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1.
+        for (int i = 0; i < 18; ++i) {
+            bits.write(i == 2 || i == 17 ? 1 : 0, 3);
+        }
+
+        // Length 1 is the code 0, the lower symbol.
+        for (int i = 0; i < 258; ++i) {
+            bits.write_code(0, 1);
+        }
+
+        bits.write(0, 32);
+        const std::vector<uint8_t> raw(2, 0);
+        CHECK(!decode(png_file(1, 1, 8, 0, zlib_wrap(bits.bytes(), raw))).has_value());
+    }
+}
+
+void oversize_dimensions_are_refused() {
+    const std::vector<uint8_t> row(1 + 16385, 0);
+    CHECK(!decode(png_file(16385, 1, 8, 0, zlib_stored(row))).has_value());
+    CHECK(!decode(png_file(1, 16385, 8, 0, zlib_stored(std::vector<uint8_t>(2 * 16385, 0)))).has_value());
+    CHECK(!decode(png_file(0, 1, 8, 0, zlib_stored({0}))).has_value());
+
+    // In bounds, but gigabytes of pixels claimed by a few bytes of data.
+    CHECK(!decode(png_file(16384, 16384, 16, 6, zlib_stored(std::vector<uint8_t>(64, 0)))).has_value());
+}
+
+void unknown_filters_are_refused() {
+    std::vector<uint8_t> raw = filter_rows(random_bytes(4 * 4 * 3, 5), 4, 12, 3, {0});
+    raw[2 * 13] = 5;
+    CHECK(!decode(png_file(4, 4, 8, 2, zlib_stored(raw))).has_value());
+}
+
+void unsupported_headers_are_refused() {
+    const std::vector<uint8_t> raw(1 + 3, 0);
+
+    std::vector<uint8_t> interlaced = png_file(1, 1, 8, 2, zlib_stored(raw));
+    interlaced[8 + 8 + 12] = 1;
+    CHECK(!decode(interlaced).has_value());
+
+    CHECK(!decode(png_file(1, 1, 3, 2, zlib_stored(raw))).has_value());
+    CHECK(!decode(png_file(1, 1, 8, 5, zlib_stored(raw))).has_value());
+
+    std::vector<uint8_t> preset_dictionary = zlib_stored(raw);
+    preset_dictionary[1] |= 0x20;
+    CHECK(!decode(png_file(1, 1, 8, 2, preset_dictionary)).has_value());
+}
+
+void damaged_bytes_never_crash() {
+    const std::vector<uint8_t> raw = filter_rows(random_bytes(16 * 16 * 3, 9), 16, 48, 3, {0, 1, 2, 3, 4});
+    const std::vector<std::vector<uint8_t>> originals{
+        png_file(16, 16, 8, 2, zlib_fixed(raw)),
+        png_file(16, 16, 8, 2, std::vector<uint8_t>(std::begin(dynamic_stream), std::end(dynamic_stream))),
+    };
+
+    std::mt19937 random{13};
+
+    for (const std::vector<uint8_t>& original : originals) {
+        for (int round = 0; round < 2000; ++round) {
+            std::vector<uint8_t> damaged = original;
+
+            for (int flips = 1 + static_cast<int>(random() % 4); flips > 0; --flips) {
+                damaged[33 + random() % (damaged.size() - 33)] ^= static_cast<uint8_t>(1u << (random() % 8));
+            }
+
+            const auto image = decode(damaged);
+            CHECK(!image.has_value() || image->pixels.size() == std::size_t{image->width} * image->height * 3);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Shrinking and JPEG.
+rgb_image gradient(const uint32_t width, const uint32_t height) {
+    rgb_image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(std::size_t{width} * height * 3);
+
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* pixel = image.pixels.data() + (std::size_t{y} * width + x) * 3;
+            pixel[0] = static_cast<uint8_t>(x * 255 / width);
+            pixel[1] = static_cast<uint8_t>(y * 255 / height);
+            pixel[2] = 90;
+        }
+    }
+
+    return image;
+}
+
+void shrink_keeps_the_aspect_ratio_and_never_enlarges() {
+    const rgb_image wide = gradient(100, 50);
+
+    const rgb_image shrunk = image_codec::shrink_to_fit(wide, 40, 40);
+    CHECK(shrunk.width == 40 && shrunk.height == 20);
+    CHECK(shrunk.pixels.size() == 40u * 20 * 3);
+
+    const rgb_image same = image_codec::shrink_to_fit(wide, 400, 400);
+    CHECK(same.width == 100 && same.height == 50 && same.pixels == wide.pixels);
+
+    // An area average of a flat color is that color.
+    rgb_image flat;
+    flat.width = 30;
+    flat.height = 30;
+    flat.pixels.assign(30 * 30 * 3, 77);
+
+    const rgb_image flat_shrunk = image_codec::shrink_to_fit(flat, 7, 7);
+    CHECK(flat_shrunk.width == 7 && flat_shrunk.height == 7);
+
+    for (const uint8_t value : flat_shrunk.pixels) {
+        CHECK(value == 77);
+    }
+}
+
+void jpeg_is_well_formed_and_sized_by_quality() {
+    const rgb_image image = gradient(37, 21);
+
+    const std::vector<std::byte> fine = image_codec::encode_jpeg(image, 90);
+    const std::vector<std::byte> coarse = image_codec::encode_jpeg(image, 20);
+
+    CHECK(fine.size() > 4 && fine[0] == std::byte{0xff} && fine[1] == std::byte{0xd8});
+    CHECK(fine.size() > 4 && fine[fine.size() - 2] == std::byte{0xff} && fine[fine.size() - 1] == std::byte{0xd9});
+    CHECK(coarse.size() < fine.size());
+
+    const image_info info = image_codec::probe(fine.data(), fine.size());
+    CHECK(info.format == image_format::jpeg && info.width == 37 && info.height == 21);
+
+    const std::vector<std::byte> single = image_codec::encode_jpeg(gradient(1, 1), 75);
+    CHECK(image_codec::probe(single.data(), single.size()).width == 1);
+}
+
+void probe_reads_the_header_only() {
+    const std::vector<uint8_t> png = png_file(640, 360, 8, 2, {});
+    const image_info png_info = image_codec::probe(reinterpret_cast<const std::byte*>(png.data()), png.size());
+    CHECK(png_info.format == image_format::png && png_info.width == 640 && png_info.height == 360);
+
+    const uint8_t gif[] = {'G', 'I', 'F', '8', '9', 'a', 0x20, 0x03, 0x58, 0x02, 0, 0, 0};
+    const image_info gif_info = image_codec::probe(reinterpret_cast<const std::byte*>(gif), sizeof(gif));
+    CHECK(gif_info.format == image_format::gif && gif_info.width == 800 && gif_info.height == 600);
+
+    const uint8_t text[] = {'h', 'e', 'l', 'l', 'o'};
+    CHECK(image_codec::probe(reinterpret_cast<const std::byte*>(text), sizeof(text)).format == image_format::unknown);
+}
+
+} // namespace
+
+int main() {
+    return testing::run({
+        {"png round-trips every filter", png_round_trips_every_filter},
+        {"png decodes stored blocks over 64k", png_decodes_stored_blocks_over_64k},
+        {"png decodes fixed Huffman blocks", png_decodes_fixed_huffman_blocks},
+        {"png decodes dynamic Huffman blocks", png_decodes_dynamic_huffman_blocks},
+        {"png blends transparency over the background", png_blends_transparency_over_the_background},
+        {"truncated pngs are refused", truncated_pngs_are_refused},
+        {"bad Huffman lengths are refused", bad_huffman_lengths_are_refused},
+        {"oversize dimensions are refused", oversize_dimensions_are_refused},
+        {"unknown filters are refused", unknown_filters_are_refused},
+        {"unsupported headers are refused", unsupported_headers_are_refused},
+        {"damaged bytes never crash", damaged_bytes_never_crash},
+        {"shrink keeps the aspect ratio and never enlarges", shrink_keeps_the_aspect_ratio_and_never_enlarges},
+        {"jpeg is well formed and sized by quality", jpeg_is_well_formed_and_sized_by_quality},
+        {"probe reads the header only", probe_reads_the_header_only},
+    });
+}
@@ -0,0 +1,310 @@
+// ----------------------------------------------------------------------------
+// Query cache freshness, eviction and the disk cache, against the Steam simulator.
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/logger.h"
+#include "../include/queryCache.h"
+#include "../include/queryDiskCache.h"
+#include "../include/steamHelper.h"
+#include "../include/steamSimulator.h"
+
+#include "testing.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr AppId_t test_app_id = 480;
+constexpr std::chrono::seconds wait_limit{20};
+
+void configure_simulator() {
+    steam_simulator::config config;
+    config.catalog_size = 200;
+    config.app_id = test_app_id;
+    steam_simulator::configure(config);
+}
+
+UGCQueryHandle_t page_query(steam_helper& helper, const uint32_t page) {
+    UGCQueryHandle_t handle = k_UGCQueryHandleInvalid;
+    helper.create_all_query(handle, k_EUGCQuery_RankedByVote, k_EUGCMatchingUGCType_Items, test_app_id, test_app_id, page);
+    return handle;
+}
+
+query_key page_key(steam_helper& helper, const uint32_t page) {
+    const UGCQueryHandle_t handle = page_query(helper, page);
+    query_key key = helper.get_query_key(handle).value_or(query_key{});
+    helper.release_query_handle(handle);
+    return key;
+}
+
+// Serves the page through the cache, dispatching the callbacks until it is there.
+query_cache::page_ptr fetch(steam_helper& helper, query_cache& cache, const uint32_t page) {
+    query_cache::page_ptr served;
+    bool done = false;
+
+    cache.send(page_query(helper, page), [&](const query_cache::page_ptr& result) {
+        served = result;
+        done = true;
+    });
+
+    (void)helper.run_callbacks_until([&done] { return done; }, wait_limit);
+    return served;
+}
+
+std::shared_ptr<query_page> page_of(const std::size_t items) {
+    auto page = std::make_shared<query_page>();
+    page->result = EResult::k_EResultOK;
+    page->items.resize(items);
+    page->preview_urls.resize(items);
+    return page;
+}
+
+std::filesystem::path temp_file(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("steam_wrapper_test_" + name);
+}
+
+// ----------------------------------------------------------------------------
+// Freshness.
+void fresh_pages_are_served_without_steam() {
+    configure_simulator();
+    steam_helper helper;
+
+    query_cache::options options;
+    options.ttl = 1h;
+    query_cache cache{helper, options};
+
+    const auto first = fetch(helper, cache, 1);
+    CHECK(first != nullptr && first->result == EResult::k_EResultOK && !first->items.empty());
+    CHECK(steam_simulator::stats().calls_issued == 1);
+
+    const auto second = fetch(helper, cache, 1);
+    CHECK(second == first);
+    CHECK(steam_simulator::stats().calls_issued == 1);
+
+    // Another page is another key.
+    CHECK(fetch(helper, cache, 2) != first);
+    CHECK(steam_simulator::stats().calls_issued == 2);
+
+    const auto stats = cache.stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 2);
+    CHECK(stats.entries == 2);
+    CHECK(steam_simulator::stats().query_handles_open == 0);
+}
+
+void stale_pages_are_served_and_refreshed_once() {
+    configure_simulator();
+    steam_helper helper;
+
+    query_cache::options options;
+    options.ttl = 1ms;
+    options.stale_ttl = 1h;
+    query_cache cache{helper, options};
+
+    const auto first = fetch(helper, cache, 1);
+    CHECK(first != nullptr);
+    std::this_thread::sleep_for(5ms);
+
+    // Both served the stale page right away, only one of them refreshes it.
+    int served_stale = 0;
+    cache.send(page_query(helper, 1), [&](const query_cache::page_ptr& page) { served_stale += page == first ? 1 : 0; });
+    cache.send(page_query(helper, 1), [&](const query_cache::page_ptr& page) { served_stale += page == first ? 1 : 0; });
+    CHECK(served_stale == 2);
+
+    CHECK(helper.run_callbacks_until([&helper] { return !helper.any_pending_operation(); }, wait_limit));
+    CHECK(steam_simulator::stats().calls_issued == 2);
+
+    const auto stats = cache.stats();
+    CHECK(stats.stale_hits == 2);
+    // The miss filling the cache, then a single stale refresh.
+    CHECK(stats.refreshes == 2);
+
+    const auto refreshed = cache.lookup(page_key(helper, 1));
+    CHECK(refreshed != nullptr && refreshed != first);
+    CHECK(steam_simulator::stats().query_handles_open == 0);
+}
+
+void expired_pages_wait_for_steam() {
+    configure_simulator();
+    steam_helper helper;
+
+    query_cache::options options;
+    options.ttl = 1ms;
+    options.stale_ttl = 1ms;
+    query_cache cache{helper, options};
+
+    const auto first = fetch(helper, cache, 1);
+    std::this_thread::sleep_for(5ms);
+
+    CHECK(cache.lookup(page_key(helper, 1)) == nullptr);
+
+    const auto second = fetch(helper, cache, 1);
+    CHECK(second != nullptr && second != first);
+    CHECK(cache.stats().stale_hits == 0);
+    CHECK(steam_simulator::stats().calls_issued == 2);
+}
+
+// ----------------------------------------------------------------------------
+// Eviction.
+void least_recently_used_pages_are_evicted() {
+    configure_simulator();
+    steam_helper helper;
+
+    const auto page = page_of(10);
+    const std::size_t bytes = query_cache::page_bytes(*page);
+
+    query_cache::options options;
+    options.ttl = 1h;
+    options.max_bytes = bytes * 2 + bytes / 2;
+    query_cache cache{helper, options};
+
+    const query_key first = page_key(helper, 1);
+    const query_key second = page_key(helper, 2);
+    const query_key third = page_key(helper, 3);
+
+    cache.store(first, page);
+    cache.store(second, page);
+    CHECK(cache.lookup(first) != nullptr); // Now more recent than the second.
+
+    cache.store(third, page);
+    CHECK(cache.lookup(second) == nullptr);
+    CHECK(cache.lookup(first) != nullptr);
+    CHECK(cache.lookup(third) != nullptr);
+
+    const auto stats = cache.stats();
+    CHECK(stats.evictions == 1);
+    CHECK(stats.entries == 2);
+    CHECK(stats.bytes <= options.max_bytes);
+
+    cache.invalidate(first);
+    CHECK(cache.lookup(first) == nullptr);
+    CHECK(cache.stats().bytes == bytes);
+}
+
+// ----------------------------------------------------------------------------
+// Disk cache.
+void disk_cache_round_trips_the_pages() {
+    configure_simulator();
+    steam_helper helper;
+
+    query_cache::options options;
+    options.ttl = 1h;
+    query_cache cache{helper, options};
+
+    const auto first = fetch(helper, cache, 1);
+    const auto second = fetch(helper, cache, 2);
+    CHECK(first != nullptr && second != nullptr);
+
+    const std::filesystem::path file_path = temp_file("query_cache.bin");
+    CHECK(query_disk_cache::write(file_path, cache.snapshot()));
+
+    auto disk = std::make_shared<query_disk_cache>();
+    CHECK(disk->open(file_path));
+    CHECK(disk->page_count() == 2);
+
+    // A cold cache, as in the next session.
+    query_cache cold{helper, options};
+    cold.attach_disk_cache(disk);
+
+    const uint64_t calls_before = steam_simulator::stats().calls_issued;
+    query_cache::page_ptr loaded;
+
+    cold.send(page_query(helper, 1), [&loaded](const query_cache::page_ptr& page) { loaded = page; });
+    CHECK(cold.stats().disk_hits == 1);
+
+    CHECK(loaded != nullptr && loaded->result == EResult::k_EResultOK);
+    CHECK(loaded != nullptr && loaded->items.size() == first->items.size());
+    CHECK(loaded != nullptr && loaded->total_matching == first->total_matching);
+
+    for (std::size_t i = 0; loaded != nullptr && i < loaded->items.size() && i < first->items.size(); ++i) {
+        CHECK(loaded->items[i].m_nPublishedFileId == first->items[i].m_nPublishedFileId);
+        CHECK(std::strcmp(loaded->items[i].m_rgchTitle, first->items[i].m_rgchTitle) == 0);
+        CHECK(loaded->preview_urls[i] == first->preview_urls[i]);
+    }
+
+    // Served as stale, so it is refreshed from Steam.
+    CHECK(helper.run_callbacks_until([&helper] { return !helper.any_pending_operation(); }, wait_limit));
+    CHECK(steam_simulator::stats().calls_issued == calls_before + 1);
+
+    disk->close();
+    std::filesystem::remove(file_path);
+}
+
+void damaged_disk_caches_are_refused() {
+    configure_simulator();
+    steam_helper helper;
+
+    query_cache cache{helper, {}};
+    CHECK(fetch(helper, cache, 1) != nullptr);
+
+    const std::filesystem::path file_path = temp_file("query_cache_damaged.bin");
+    CHECK(query_disk_cache::write(file_path, cache.snapshot()));
+
+    std::string bytes;
+    {
+        std::ifstream file{file_path, std::ios::binary};
+        bytes.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+
+    const auto write_and_open = [&file_path](const std::string& contents) {
+        {
+            std::ofstream file{file_path, std::ios::binary | std::ios::trunc};
+            file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        }
+
+        query_disk_cache disk;
+        return disk.open(file_path);
+    };
+
+    CHECK(write_and_open(bytes));
+
+    // Cut short of its strings.
+    CHECK(!write_and_open(bytes.substr(0, bytes.size() - 1)));
+
+    // Not a cache file.
+    std::string foreign = bytes;
+    foreign[0] = 'X';
+    CHECK(!write_and_open(foreign));
+
+    // An offset wrapping the bounds check around.
+    std::string wrapped = bytes;
+    const uint64 huge = ~uint64{0} - 7;
+    std::memcpy(wrapped.data() + offsetof(query_disk_cache::file_header, strings_offset), &huge, sizeof(huge));
+    CHECK(!write_and_open(wrapped));
+
+    std::string counted = bytes;
+    const uint32 many = ~uint32{0};
+    std::memcpy(counted.data() + offsetof(query_disk_cache::file_header, item_count), &many, sizeof(many));
+    CHECK(!write_and_open(counted));
+
+    std::filesystem::remove(file_path);
+}
+
+} // namespace
+
+int main() {
+    logger::instance().set_sink(nullptr);
+
+    return testing::run({
+        {"fresh pages are served without Steam", fresh_pages_are_served_without_steam},
+        {"stale pages are served and refreshed once", stale_pages_are_served_and_refreshed_once},
+        {"expired pages wait for Steam", expired_pages_wait_for_steam},
+        {"least recently used pages are evicted", least_recently_used_pages_are_evicted},
+        {"disk cache round-trips the pages", disk_cache_round_trips_the_pages},
+        {"damaged disk caches are refused", damaged_disk_caches_are_refused},
+    });
+}
@@ -0,0 +1,465 @@
+// ----------------------------------------------------------------------------
+// Retries, rate limiting, deferred calls, upload progress and bulk publishing,
+// against the Steam simulator with injected faults.
+
+// ----------------------------------------------------------------------------
+// Steam includes.
+#include "../include/bulkPublisher.h"
+#include "../include/callScheduler.h"
+#include "../include/logger.h"
+#include "../include/steamHelper.h"
+#include "../include/steamSimulator.h"
+
+#include "testing.h"
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr AppId_t test_app_id = 480;
+constexpr std::chrono::seconds wait_limit{20};
+
+steam_simulator::config simulator_config() {
+    steam_simulator::config config;
+    config.catalog_size = 200;
+    config.app_id = test_app_id;
+    return config;
+}
+
+retry_policy fast_retries(const uint32_t max_attempts, const double budget_capacity) {
+    retry_policy policy;
+    policy.max_attempts = max_attempts;
+    policy.initial_backoff = 1ms;
+    policy.max_backoff = 2ms;
+    policy.budget_ratio = 0.0;
+    policy.budget_capacity = budget_capacity;
+    return policy;
+}
+
+UGCQueryHandle_t first_page_query(steam_helper& helper) {
+    UGCQueryHandle_t handle = k_UGCQueryHandleInvalid;
+    helper.create_all_query(handle, k_EUGCQuery_RankedByVote, k_EUGCMatchingUGCType_Items, test_app_id, test_app_id, 1);
+    return handle;
+}
+
+// Sends the query and dispatches the callbacks until it completes, k_EResultPending if it never does.
+EResult run_query(steam_helper& helper, const UGCQueryHandle_t handle) {
+    EResult outcome = EResult::k_EResultPending;
+    bool done = false;
+
+    helper.send_query_request(handle, [&](const EResult rc, const SteamUGCQueryCompleted_t&) {
+        outcome = rc;
+        done = true;
+    });
+
+    (void)helper.run_callbacks_until([&] { return done; }, wait_limit);
+    return outcome;
+}
+
+PublishedFileId_t create_item(steam_helper& helper) {
+    PublishedFileId_t created = 0;
+    bool done = false;
+
+    helper.create_workshop_item(test_app_id, std::function<void(EResult, PublishedFileId_t)>{[&](const EResult, const PublishedFileId_t item_id) {
+        created = item_id;
+        done = true;
+    }});
+
+    (void)helper.run_callbacks_until([&] { return done; }, wait_limit);
+    return created;
+}
+
+std::filesystem::path content_folder(const std::string& name, const std::size_t bytes) {
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / ("steam_wrapper_test_" + name);
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+
+    std::ofstream file{folder / "data.bin", std::ios::binary};
+    file << std::string(bytes, 'x');
+    return folder;
+}
+
+// ----------------------------------------------------------------------------
+// Retries.
+void retries_stop_when_the_budget_is_exhausted() {
+    auto config = simulator_config();
+    config.profiles.query.injected.busy = 1.0;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.scheduler().configure(call_scheduler::config::unlimited());
+    helper.set_retry_policy(fast_retries(10, 2.0));
+
+    CHECK(run_query(helper, first_page_query(helper)) == EResult::k_EResultBusy);
+    // The first call, then one retry per token of the budget.
+    CHECK(steam_simulator::stats().calls_issued == 3);
+
+    // Nothing earned back, the next failure is not retried at all.
+    CHECK(run_query(helper, first_page_query(helper)) == EResult::k_EResultBusy);
+    CHECK(steam_simulator::stats().calls_issued == 4);
+}
+
+void retries_stop_after_max_attempts() {
+    auto config = simulator_config();
+    config.profiles.query.injected.io_failure = 1.0;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.scheduler().configure(call_scheduler::config::unlimited());
+    helper.set_retry_policy(fast_retries(3, 20.0));
+
+    CHECK(run_query(helper, first_page_query(helper)) == EResult::k_EResultIOFailure);
+    CHECK(steam_simulator::stats().calls_issued == 3);
+}
+
+void disabled_retries_report_the_first_failure() {
+    auto config = simulator_config();
+    config.profiles.query.injected.busy = 1.0;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.scheduler().configure(call_scheduler::config::unlimited());
+    helper.set_retry_policy(retry_policy::disabled());
+
+    CHECK(run_query(helper, first_page_query(helper)) == EResult::k_EResultBusy);
+    CHECK(steam_simulator::stats().calls_issued == 1);
+}
+
+// ----------------------------------------------------------------------------
+// Rate limiting.
+void rate_limit_answers_slow_the_scheduler_down() {
+    auto config = simulator_config();
+    config.profiles.query.injected.rate_limit_exceeded = 1.0;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.set_retry_policy(retry_policy::disabled());
+
+    const double initial_rate = helper.scheduler().rate(operation_kind::query);
+
+    CHECK(run_query(helper, first_page_query(helper)) == EResult::k_EResultRateLimitExceeded);
+    CHECK(helper.scheduler().rate(operation_kind::query) == initial_rate * 0.5);
+
+    // Other kinds keep their own rate.
+    CHECK(helper.scheduler().rate(operation_kind::create_item) == helper.scheduler().configuration().buckets[0].rate);
+}
+
+void scheduler_backs_off_once_per_cooldown_and_recovers() {
+    call_scheduler::config config;
+    config.buckets[static_cast<std::size_t>(operation_kind::query)] = {8.0, 2.0, 1.0, 16.0};
+    config.additive_increase = 4.0;
+    config.multiplicative_decrease = 0.5;
+    config.decrease_cooldown = 1000ms;
+
+    call_scheduler scheduler{config};
+    const auto start = call_scheduler::clock::now() + 1h;
+
+    // A quota limit, not throttling.
+    scheduler.on_result(operation_kind::query, EResult::k_EResultLimitExceeded, start - 1h);
+    CHECK(scheduler.rate(operation_kind::query) == 8.0);
+
+    scheduler.on_result(operation_kind::query, EResult::k_EResultRateLimitExceeded, start);
+    scheduler.on_result(operation_kind::query, EResult::k_EResultRateLimitExceeded, start + 10ms);
+    CHECK(scheduler.rate(operation_kind::query) == 4.0);
+
+    scheduler.on_result(operation_kind::query, EResult::k_EResultRateLimitExceeded, start + 1010ms);
+    CHECK(scheduler.rate(operation_kind::query) == 2.0);
+
+    // Held at min_rate however many limits follow.
+    scheduler.on_result(operation_kind::query, EResult::k_EResultRateLimitExceeded, start + 3s);
+    scheduler.on_result(operation_kind::query, EResult::k_EResultRateLimitExceeded, start + 5s);
+    CHECK(scheduler.rate(operation_kind::query) == 1.0);
+
+    // Plain failures are not a reason to slow down, successes speed back up.
+    scheduler.on_result(operation_kind::query, EResult::k_EResultFail, start + 6s);
+    CHECK(scheduler.rate(operation_kind::query) == 1.0);
+
+    scheduler.on_result(operation_kind::query, EResult::k_EResultOK, start + 6s);
+    CHECK(scheduler.rate(operation_kind::query) == 5.0);
+}
+
+void scheduler_queues_past_the_burst_interactive_first() {
+    call_scheduler::config config;
+    config.buckets[static_cast<std::size_t>(operation_kind::query)] = {10.0, 2.0, 1.0, 10.0};
+
+    call_scheduler scheduler{config};
+    const auto start = call_scheduler::clock::now();
+
+    CHECK(scheduler.try_acquire(operation_kind::query, call_priority::interactive, start));
+    CHECK(scheduler.try_acquire(operation_kind::query, call_priority::interactive, start));
+    CHECK(!scheduler.try_acquire(operation_kind::query, call_priority::interactive, start));
+
+    scheduler.enqueue(operation_kind::query, call_priority::background, 1);
+    scheduler.enqueue(operation_kind::query, call_priority::interactive, 2);
+    CHECK(scheduler.waiting(operation_kind::query) == 2);
+
+    // No overtaking the queue, whatever the priority.
+    CHECK(!scheduler.try_acquire(operation_kind::query, call_priority::interactive, start));
+
+    std::vector<SteamAPICall_t> ready;
+    scheduler.take_ready(ready, start + 100ms);
+    CHECK(ready.size() == 1 && ready[0] == 2);
+
+    scheduler.take_ready(ready, start + 200ms);
+    CHECK(ready.size() == 2 && ready[1] == 1);
+    CHECK(scheduler.waiting(operation_kind::query) == 0);
+}
+
+// ----------------------------------------------------------------------------
+// Deferred calls.
+void deferred_call_failing_to_issue_completes_with_fail() {
+    steam_simulator::configure(simulator_config());
+
+    steam_helper helper;
+    helper.set_retry_policy(retry_policy::disabled());
+
+    call_scheduler::config config;
+    config.buckets[static_cast<std::size_t>(operation_kind::query)] = {20.0, 1.0, 20.0, 20.0};
+    helper.scheduler().configure(config);
+
+    EResult first = EResult::k_EResultPending;
+    EResult deferred = EResult::k_EResultPending;
+
+    helper.send_query_request(first_page_query(helper), [&](const EResult rc, const SteamUGCQueryCompleted_t&) { first = rc; });
+
+    const UGCQueryHandle_t doomed = first_page_query(helper);
+    helper.send_query_request(doomed, [&](const EResult rc, const SteamUGCQueryCompleted_t&) { deferred = rc; });
+    CHECK(helper.scheduler().waiting(operation_kind::query) == 1);
+
+    // Released while waiting for a token, Steam refuses the call once it is issued.
+    helper.release_query_handle(doomed);
+
+    CHECK(helper.run_callbacks_until([&] { return first != EResult::k_EResultPending && deferred != EResult::k_EResultPending; }, wait_limit));
+    CHECK(first == EResult::k_EResultOK);
+    CHECK(deferred == EResult::k_EResultFail);
+    CHECK(!helper.any_pending_operation());
+}
+
+void deferred_calls_are_issued_in_order() {
+    steam_simulator::configure(simulator_config());
+
+    steam_helper helper;
+
+    call_scheduler::config config;
+    config.buckets[static_cast<std::size_t>(operation_kind::query)] = {50.0, 1.0, 50.0, 50.0};
+    helper.scheduler().configure(config);
+
+    std::vector<int> completed;
+
+    for (int i = 0; i < 5; ++i) {
+        helper.send_query_request(first_page_query(helper), [&completed, i](const EResult rc, const SteamUGCQueryCompleted_t&) {
+            completed.push_back(rc == EResult::k_EResultOK ? i : -1);
+        });
+    }
+
+    CHECK(helper.scheduler().waiting(operation_kind::query) == 4);
+    CHECK(helper.run_callbacks_until([&] { return completed.size() == 5; }, wait_limit));
+    CHECK((completed == std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+// ----------------------------------------------------------------------------
+// Upload progress.
+void upload_monitor_follows_an_upload_to_its_result() {
+    auto config = simulator_config();
+    config.upload_bytes_per_second = 4 * 1024 * 1024;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.app_id = test_app_id;
+    helper.uploads().configure({10ms, 100ms});
+
+    std::vector<upload_progress> events;
+    const auto subscription = helper.uploads().subscribe([&events](const upload_progress& progress) { events.push_back(progress); });
+
+    const PublishedFileId_t item_id = create_item(helper);
+    CHECK(item_id != 0);
+
+    const auto update = helper.start_workshop_item_update(test_app_id, item_id);
+    CHECK(update.has_value());
+    CHECK(helper.set_workshop_item_content(*update, content_folder("upload", 1024 * 1024)));
+
+    bool done = false;
+    helper.submit_item_update(*update, "", std::function<void(EResult, PublishedFileId_t)>{[&done](const EResult, const PublishedFileId_t) { done = true; }});
+    CHECK(helper.run_callbacks_until([&done] { return done; }, wait_limit));
+
+    helper.uploads().unsubscribe(subscription);
+
+    CHECK(events.size() >= 2);
+    CHECK(!events.empty() && events.back().finished && events.back().result == EResult::k_EResultOK);
+
+    bool saw_progress = false;
+    uint64_t last_processed = 0;
+
+    for (const upload_progress& progress : events) {
+        CHECK(progress.item_id == item_id);
+
+        if (progress.status == EItemUpdateStatus::k_EItemUpdateStatusUploadingContent) {
+            CHECK(progress.bytes_processed >= last_processed);
+            last_processed = progress.bytes_processed;
+            saw_progress = saw_progress || progress.bytes_processed > 0;
+        }
+    }
+
+    CHECK(saw_progress);
+    CHECK(helper.uploads().active() == 0);
+}
+
+void upload_monitor_reports_a_failed_upload() {
+    auto config = simulator_config();
+    config.profiles.submit_item.injected.io_failure = 1.0;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.app_id = test_app_id;
+    helper.set_retry_policy(retry_policy::disabled());
+
+    std::vector<upload_progress> finished;
+    const auto subscription = helper.uploads().subscribe([&finished](const upload_progress& progress) {
+        if (progress.finished) {
+            finished.push_back(progress);
+        }
+    });
+
+    const PublishedFileId_t item_id = create_item(helper);
+    const auto update = helper.start_workshop_item_update(test_app_id, item_id);
+    CHECK(update.has_value());
+    CHECK(helper.set_workshop_item_title(*update, "Failing"));
+
+    EResult submitted = EResult::k_EResultPending;
+    helper.submit_item_update(*update, "", std::function<void(EResult, PublishedFileId_t)>{[&submitted](const EResult rc, const PublishedFileId_t) { submitted = rc; }});
+    CHECK(helper.run_callbacks_until([&submitted] { return submitted != EResult::k_EResultPending; }, wait_limit));
+    CHECK(submitted == EResult::k_EResultIOFailure);
+
+    helper.uploads().unsubscribe(subscription);
+
+    CHECK(finished.size() == 1);
+    CHECK(!finished.empty() && finished[0].result == EResult::k_EResultIOFailure && finished[0].item_id == item_id);
+
+    // Forgotten once finished.
+    CHECK(!helper.uploads().progress(*update).has_value());
+    CHECK(helper.uploads().active() == 0);
+}
+
+// ----------------------------------------------------------------------------
+// Bulk publishing.
+std::vector<publish_entry> new_items(const std::size_t count) {
+    std::vector<publish_entry> entries(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        entries[i].app_id = test_app_id;
+        entries[i].title = "Item " + std::to_string(i);
+    }
+
+    return entries;
+}
+
+void bulk_publisher_reports_failed_creates() {
+    auto config = simulator_config();
+    config.profiles.create_item.injected.busy = 1.0;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.app_id = test_app_id;
+    helper.set_retry_policy(retry_policy::disabled());
+
+    const auto published = bulk_publisher{helper, {}}.run(new_items(3));
+
+    CHECK(published.result == EResult::k_EResultBusy);
+    CHECK(published.published == 0);
+    CHECK(published.failed == 3);
+
+    for (const bulk_publisher::item_outcome& item : published.items) {
+        CHECK(item.result == EResult::k_EResultBusy);
+        CHECK(item.reached == bulk_publisher::stage::create);
+        CHECK(!item.created);
+    }
+}
+
+void bulk_publisher_stops_after_a_failure_when_asked() {
+    auto config = simulator_config();
+    config.profiles.create_item.injected.busy = 1.0;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.app_id = test_app_id;
+    helper.set_retry_policy(retry_policy::disabled());
+
+    bulk_publisher::options options;
+    options.max_creates_in_flight = 1;
+    options.stop_on_failure = true;
+
+    const auto published = bulk_publisher{helper, options}.run(new_items(3));
+
+    CHECK(published.failed >= 1);
+    CHECK(published.items.back().result == EResult::k_EResultCancelled);
+}
+
+void bulk_publisher_times_out_stalled_items() {
+    auto config = simulator_config();
+    config.profiles.create_item.delay.mean = 30s;
+    steam_simulator::configure(config);
+
+    steam_helper helper;
+    helper.app_id = test_app_id;
+
+    bulk_publisher::options options;
+    options.timeout = 50ms;
+
+    const auto published = bulk_publisher{helper, options}.run(new_items(2));
+
+    CHECK(published.result == EResult::k_EResultTimeout);
+    CHECK(published.published == 0);
+
+    for (const bulk_publisher::item_outcome& item : published.items) {
+        CHECK(item.result == EResult::k_EResultTimeout);
+    }
+}
+
+void bulk_publisher_publishes_new_items() {
+    steam_simulator::configure(simulator_config());
+
+    steam_helper helper;
+    helper.app_id = test_app_id;
+
+    const auto published = bulk_publisher{helper, {}}.run(new_items(4));
+
+    CHECK(published.result == EResult::k_EResultOK);
+    CHECK(published.published == 4);
+
+    for (const bulk_publisher::item_outcome& item : published.items) {
+        CHECK(item.created && item.item_id != 0);
+        CHECK(item.reached == bulk_publisher::stage::done);
+    }
+}
+
+} // namespace
+
+int main() {
+    logger::instance().set_sink(nullptr);
+
+    return testing::run({
+        {"retries stop when the budget is exhausted", retries_stop_when_the_budget_is_exhausted},
+        {"retries stop after max attempts", retries_stop_after_max_attempts},
+        {"disabled retries report the first failure", disabled_retries_report_the_first_failure},
+        {"rate limit answers slow the scheduler down", rate_limit_answers_slow_the_scheduler_down},
+        {"scheduler backs off once per cooldown and recovers", scheduler_backs_off_once_per_cooldown_and_recovers},
+        {"scheduler queues past the burst, interactive first", scheduler_queues_past_the_burst_interactive_first},
+        {"deferred call failing to issue completes with Fail", deferred_call_failing_to_issue_completes_with_fail},
+        {"deferred calls are issued in order", deferred_calls_are_issued_in_order},
+        {"upload monitor follows an upload to its result", upload_monitor_follows_an_upload_to_its_result},
+        {"upload monitor reports a failed upload", upload_monitor_reports_a_failed_upload},
+        {"bulk publisher reports failed creates", bulk_publisher_reports_failed_creates},
+        {"bulk publisher stops after a failure when asked", bulk_publisher_stops_after_a_failure_when_asked},
+        {"bulk publisher times out stalled items", bulk_publisher_times_out_stalled_items},
+        {"bulk publisher publishes new items", bulk_publisher_publishes_new_items},
+    });
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Minimal harness of the behavior tests, one executable per area.
+//
+// Each case runs in order, a failed CHECK reports its line and marks the case
+// failed without stopping it. The executable fails if any case did, which is
+// all ctest looks at.
+
+// ----------------------------------------------------------------------------
+// Standard includes.
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <string_view>
+
+namespace testing {
+
+struct test_case {
+    std::string_view name;
+    void (*run)();
+};
+
+inline int failed_checks = 0;
+
+inline void check(const bool passed, const char* expression, const char* file, const int line) noexcept {
+    if (!passed) {
+        ++failed_checks;
+        std::fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", file, line, expression);
+    }
+}
+
+/// @brief Runs the cases in order, EXIT_FAILURE if any check failed.
+inline int run(const std::initializer_list<test_case> cases) noexcept {
+    int failed_cases = 0;
+
+    for (const test_case& current : cases) {
+        const int failed_before = failed_checks;
+        current.run();
+
+        const bool passed = failed_checks == failed_before;
+        failed_cases += passed ? 0 : 1;
+        std::printf("[%s] %.*s\n", passed ? "  ok  " : " FAIL ", static_cast<int>(current.name.size()), current.name.data());
+    }
+
+    std::printf("%zu cases, %d failed\n", cases.size(), failed_cases);
+    return failed_cases == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace testing
+
+#define CHECK(condition) ::testing::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)